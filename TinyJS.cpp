@@ -53,18 +53,6 @@
 #	define ASSERT(X) assert(X)
 #endif
 
-#ifndef NO_REGEXP 
-#	if defined HAVE_TR1_REGEX
-#		include <tr1/regex>
-		using namespace std::tr1;
-#	elif defined HAVE_BOOST_REGEX
-#		include <boost/regex.hpp>
-		using namespace boost;
-#	else
-#		include <regex>
-#	endif
-#endif
-
 #include <algorithm>
 #include <cmath>
 #include <memory>
@@ -82,12 +70,20 @@ using namespace std;
 
 vector<CScriptVar*> allocatedVars;
 vector<CScriptVarLink*> allocatedLinks;
+#ifndef NO_THREADING
+static CScriptMutex allocatedMutex; // the forks of a snapshot runs in parallel threads
+#	define ALLOCATED_LOCK CScriptUniqueLock lock(allocatedMutex)
+#else
+#	define ALLOCATED_LOCK
+#endif
 
 void mark_allocated(CScriptVar *v) {
+	ALLOCATED_LOCK;
 	allocatedVars.push_back(v);
 }
 
 void mark_deallocated(CScriptVar *v) {
+	ALLOCATED_LOCK;
 	for (size_t i=0;i<allocatedVars.size();i++) {
 		if (allocatedVars[i] == v) {
 			allocatedVars.erase(allocatedVars.begin()+i);
@@ -97,10 +93,12 @@ void mark_deallocated(CScriptVar *v) {
 }
 
 void mark_allocated(CScriptVarLink *v) {
+	ALLOCATED_LOCK;
 	allocatedLinks.push_back(v);
 }
 
 void mark_deallocated(CScriptVarLink *v) {
+	ALLOCATED_LOCK;
 	for (size_t i=0;i<allocatedLinks.size();i++) {
 		if (allocatedLinks[i] == v) {
 			allocatedLinks.erase(allocatedLinks.begin()+i);
@@ -109,17 +107,34 @@ void mark_deallocated(CScriptVarLink *v) {
 	}
 }
 
-void show_allocated() {
-	for (size_t i=0;i<allocatedVars.size();i++) {
-		printf("ALLOCATED, %d refs\n", allocatedVars[i]->getRefs());
-		allocatedVars[i]->trace("  ");
-	}
-	for (size_t i=0;i<allocatedLinks.size();i++) {
-		printf("ALLOCATED LINK %s, allocated[%d] to \n", allocatedLinks[i]->getName().c_str(), allocatedLinks[i]->getVarPtr()->getRefs());
-		allocatedLinks[i]->getVarPtr()->trace("  ");
+static CTinyJS *linkContext(CScriptVarLink *Link) { // a link without a var belongs to the context of its owner (0 while constructed in an other thread)
+	if(Link->getVarPtr()) return Link->getVarPtr()->getContext();
+	return Link->getOwner() ? Link->getOwner()->getContext() : 0;
+}
+
+void show_allocated(CTinyJS *Context) { // only the vars of Context - the other contexts are still alive
+	vector<CScriptVar*> vars;
+	vector<CScriptVarLink*> links;
+	{
+		ALLOCATED_LOCK;
+		vector<CScriptVar*> otherVars;
+		vector<CScriptVarLink*> otherLinks;
+		for (size_t i=0;i<allocatedVars.size();i++)
+			(allocatedVars[i]->getContext() == Context ? vars : otherVars).push_back(allocatedVars[i]);
+		for (size_t i=0;i<allocatedLinks.size();i++)
+			(linkContext(allocatedLinks[i]) == Context ? links : otherLinks).push_back(allocatedLinks[i]);
+		allocatedVars.swap(otherVars);
+		allocatedLinks.swap(otherLinks);
+	}
+	for (size_t i=0;i<vars.size();i++) {
+		printf("ALLOCATED, %d refs\n", vars[i]->getRefs());
+		vars[i]->trace("  ");
+	}
+	for (size_t i=0;i<links.size();i++) {
+		if(!links[i]->getVarPtr()) { printf("ALLOCATED LINK %s, without var\n", links[i]->getName().c_str()); continue; }
+		printf("ALLOCATED LINK %s, allocated[%d] to \n", links[i]->getName().c_str(), links[i]->getVarPtr()->getRefs());
+		links[i]->getVarPtr()->trace("  ");
 	}
-	allocatedVars.clear();
-	allocatedLinks.clear();
 }
 #endif
 
@@ -248,6 +263,167 @@ static inline string getIDString(const string& str) {
 }
 
 
+//////////////////////////////////////////////////////////////////////////
+/// CScriptAtom
+//////////////////////////////////////////////////////////////////////////
+
+#define ATOM_CHUNK_BITS 10
+#define ATOM_CHUNK_SIZE (1<<ATOM_CHUNK_BITS)
+#define ATOM_MAX_CHUNKS (1<<14) // max. 16M atoms
+#define ATOM_HASH_MIN_SIZE 1024
+
+struct CScriptAtomEntry {
+	string name;
+	uint32_t arrayIndex;
+	uint32_t hash;
+	CScriptAtomicCounter refs;
+};
+// the entries are allocated in chunks, so an entry never moves and getName needs no lock
+static CScriptAtomEntry *atomChunks[ATOM_MAX_CHUNKS];
+static uint32_t atomLastID = 0; // the highest ID ever used
+static uint32_t atomCount = 0; // the atoms in use
+// the table is never destroyed - atoms held by static objects may be released after the statics of this file
+static vector<uint32_t> &atomHash = *new vector<uint32_t>; // open addressing hash-table of IDs (0 == unused)
+static vector<uint32_t> &atomFreeIDs = *new vector<uint32_t>; // the IDs of the released atoms
+static const string atomEmptyName;
+#ifndef NO_THREADING
+static CScriptMutex &atomMutex = *new CScriptMutex;
+#endif
+
+static inline CScriptAtomEntry &atomEntry(uint32_t ID) {
+	return atomChunks[ID>>ATOM_CHUNK_BITS][ID&(ATOM_CHUNK_SIZE-1)];
+}
+static inline uint32_t atomHashOf(const string &Name) { // FNV-1a
+	uint32_t hash = 2166136261U;
+	for(string::const_iterator it = Name.begin(); it != Name.end(); ++it)
+		hash = (hash ^ (unsigned char)*it) * 16777619U;
+	return hash;
+}
+// returns the position of Name in atomHash or the position to insert Name
+static uint32_t atomHashFind(const string &Name, uint32_t Hash) {
+	uint32_t mask = uint32_t(atomHash.size()-1);
+	for(uint32_t pos = Hash & mask; ; pos = (pos+1) & mask) {
+		uint32_t ID = atomHash[pos];
+		if(!ID) return pos;
+		CScriptAtomEntry &entry = atomEntry(ID);
+		if(entry.hash == Hash && entry.name == Name) return pos;
+	}
+}
+
+uint32_t CScriptAtom::intern(const string &Name) {
+	if(Name.empty()) return 0;
+	uint32_t hash = atomHashOf(Name);
+#ifndef NO_THREADING
+	CScriptUniqueLock lock(atomMutex);
+#endif
+	if(atomHash.empty()) atomHash.resize(ATOM_HASH_MIN_SIZE, 0);
+	uint32_t pos = atomHashFind(Name, hash);
+	if(atomHash[pos]) {
+		++atomEntry(atomHash[pos]).refs;
+		return atomHash[pos];
+	}
+
+	uint32_t ID;
+	if(atomFreeIDs.size()) {
+		ID = atomFreeIDs.back();
+		atomFreeIDs.pop_back();
+	} else {
+		ID = atomLastID+1;
+		if((ID>>ATOM_CHUNK_BITS) >= ATOM_MAX_CHUNKS) throw CScriptException(Error, "too many property-names");
+		CScriptAtomEntry *&chunk = atomChunks[ID>>ATOM_CHUNK_BITS];
+		if(!chunk) chunk = new CScriptAtomEntry[ATOM_CHUNK_SIZE];
+		atomLastID = ID;
+	}
+	CScriptAtomEntry &entry = atomEntry(ID);
+	entry.name = Name;
+	entry.arrayIndex = isArrayIndex(Name);
+	entry.hash = hash;
+	++entry.refs;
+	atomHash[pos] = ID;
+
+	if(++atomCount*2 > atomHash.size()) { // keep the load-factor below 0.5
+		vector<uint32_t> old(atomHash.size()*2, 0);
+		old.swap(atomHash);
+		uint32_t mask = uint32_t(atomHash.size()-1);
+		for(vector<uint32_t>::iterator it = old.begin(); it != old.end(); ++it) {
+			if(!*it) continue;
+			uint32_t newPos = atomEntry(*it).hash & mask;
+			while(atomHash[newPos]) newPos = (newPos+1) & mask;
+			atomHash[newPos] = *it;
+		}
+	}
+	return ID;
+}
+
+void CScriptAtom::ref(uint32_t ID) {
+	++atomEntry(ID).refs; // the caller holds a reference - no lock needed
+}
+
+void CScriptAtom::release(uint32_t ID) {
+	CScriptAtomEntry &entry = atomEntry(ID);
+	for(int32_t refs = entry.refs.get(); refs > 1; )
+		if(entry.refs.compareExchange(refs, refs-1)) return;
+	// maybe the last reference - decremented under the lock, so intern can't find the entry meanwhile
+#ifndef NO_THREADING
+	CScriptUniqueLock lock(atomMutex);
+#endif
+	if(--entry.refs) return;
+	// backward-shift deletion - no tombstones needed
+	uint32_t mask = uint32_t(atomHash.size()-1);
+	uint32_t hole = atomHashFind(entry.name, entry.hash);
+	for(uint32_t i = (hole+1) & mask; atomHash[i]; i = (i+1) & mask) {
+		uint32_t home = atomEntry(atomHash[i]).hash & mask;
+		if(((i - home) & mask) >= ((i - hole) & mask)) {
+			atomHash[hole] = atomHash[i];
+			hole = i;
+		}
+	}
+	atomHash[hole] = 0;
+	string().swap(entry.name);
+	atomFreeIDs.push_back(ID);
+	--atomCount;
+}
+
+bool CScriptAtom::find(const string &Name, CScriptAtom &Atom) {
+	if(Name.empty()) { Atom = CScriptAtom(); return true; }
+	uint32_t hash = atomHashOf(Name);
+	CScriptAtom found;
+	{
+#ifndef NO_THREADING
+		CScriptUniqueLock lock(atomMutex);
+#endif
+		if(atomHash.empty()) return false;
+		uint32_t ID = atomHash[atomHashFind(Name, hash)];
+		if(!ID) return false;
+		++atomEntry(ID).refs;
+		found.id = ID;
+	}
+	Atom = found; // outside of the lock - releasing the old atom may lock
+	return true;
+}
+
+uint32_t CScriptAtom::getCount() {
+#ifndef NO_THREADING
+	CScriptUniqueLock lock(atomMutex);
+#endif
+	return atomCount;
+}
+
+const string &CScriptAtom::getName() const {
+	return id ? atomEntry(id).name : atomEmptyName;
+}
+
+uint32_t CScriptAtom::getArrayIndex() const {
+	return id ? atomEntry(id).arrayIndex : uint32_t(-1);
+}
+
+static const CScriptAtom atom___proto__(TINYJS___PROTO___VAR);
+static const CScriptAtom atom_this("this");
+static const CScriptAtom atom___scope_parent__(TINYJS_SCOPE_PARENT_VAR);
+static const CScriptAtom atom___scope_with__(TINYJS_SCOPE_WITH_VAR);
+static const CScriptAtom atom___function_closure__(TINYJS_FUNCTION_CLOSURE_VAR);
+
+
 //////////////////////////////////////////////////////////////////////////
 /// CScriptException
 //////////////////////////////////////////////////////////////////////////
@@ -572,8 +748,8 @@ void CScriptLex::getNextToken() {
 				}
 				if(currCh == '/') {
 #ifndef NO_REGEXP
-					try { regex(tkStr.substr(1), regex_constants::ECMAScript); } catch(regex_error e) {
-						throw CScriptException(SyntaxError, string(e.what())+" - "+CScriptVarRegExp::ErrorStr(e.code()), currentFile, pos.currentLine, currentColumn());
+					try { CScriptRegex check(tkStr.substr(1)); } catch(CScriptRegexError &e) {
+						throw CScriptException(SyntaxError, e.what(), currentFile, pos.currentLine, currentColumn());
 					}
 #endif /* NO_REGEXP */
 					do {
@@ -632,6 +808,16 @@ void CScriptTokenDataForwards::serialize(ostream &out) const
 	for(FNC_SET_it it=functions.begin(); it != functions.end(); ++it)
 		it->serialize(out);
 }
+CScriptTokenData *CScriptTokenDataForwards::fork(CScriptVarForker &Forker) {
+	CScriptTokenDataForwards *copy = new CScriptTokenDataForwards(*this);
+	copy->functions.clear();
+	for(FNC_SET_it it=functions.begin(); it != functions.end(); ++it) {
+		CScriptToken function(*it);
+		function.fork(Forker);
+		copy->functions.insert(function);
+	}
+	return copy;
+}
 
 bool CScriptTokenDataForwards::compare_fnc_token_by_name::operator()(const CScriptToken& lhs, const CScriptToken& rhs) const {
 	return lhs.Fnc().name < rhs.Fnc().name;
@@ -692,6 +878,14 @@ void CScriptTokenDataLoop::serialize(ostream &out) const {
 	CScriptToken::serialize(iter, out);
 	CScriptToken::serialize(body, out);
 }
+CScriptTokenData *CScriptTokenDataLoop::fork(CScriptVarForker &Forker) {
+	CScriptTokenDataLoop *copy = new CScriptTokenDataLoop(*this);
+	Forker.forkTokens(copy->init);
+	Forker.forkTokens(copy->condition);
+	Forker.forkTokens(copy->iter);
+	Forker.forkTokens(copy->body);
+	return copy;
+}
 
 string CScriptTokenDataLoop::getParsableString(const string &IndentString/*=""*/, const string &Indent/*=""*/ ) {
 	static const char *heads[] = {"for each(", "for(", "for(", "for(", "while(", "do "};
@@ -724,6 +918,13 @@ void CScriptTokenDataIf::serialize(ostream &out) const {
 	CScriptToken::serialize(if_body, out);
 	CScriptToken::serialize(else_body, out);
 }
+CScriptTokenData *CScriptTokenDataIf::fork(CScriptVarForker &Forker) {
+	CScriptTokenDataIf *copy = new CScriptTokenDataIf(*this);
+	Forker.forkTokens(copy->condition);
+	Forker.forkTokens(copy->if_body);
+	Forker.forkTokens(copy->else_body);
+	return copy;
+}
 
 string CScriptTokenDataIf::getParsableString(const string &IndentString/*=""*/, const string &Indent/*=""*/ ) {
 	string out = "if(";
@@ -751,6 +952,11 @@ CScriptTokenDataArrayComprehensionsBody::CScriptTokenDataArrayComprehensionsBody
 void CScriptTokenDataArrayComprehensionsBody::serialize(ostream &out) const { 
 	CScriptToken::serialize(body, out); 
 } 
+CScriptTokenData *CScriptTokenDataArrayComprehensionsBody::fork(CScriptVarForker &Forker) {
+	CScriptTokenDataArrayComprehensionsBody *copy = new CScriptTokenDataArrayComprehensionsBody(*this);
+	Forker.forkTokens(copy->body);
+	return copy;
+}
 
 
 //////////////////////////////////////////////////////////////////////////
@@ -781,6 +987,17 @@ void CScriptTokenDataTry::serialize(ostream &out) const {
 	}
 	CScriptToken::serialize(finallyBlock, out);
 }
+CScriptTokenData *CScriptTokenDataTry::fork(CScriptVarForker &Forker) {
+	CScriptTokenDataTry *copy = new CScriptTokenDataTry(*this);
+	Forker.forkTokens(copy->tryBlock);
+	for(CATCHBLOCKS_it it=copy->catchBlocks.begin(); it!=copy->catchBlocks.end(); ++it) {
+		if(it->indentifiers) it->indentifiers = CScriptTokenDataPtr<CScriptTokenDataDestructuringVar>(*static_cast<CScriptTokenDataDestructuringVar*>(Forker.forkTokenData(&*it->indentifiers)));
+		Forker.forkTokens(it->condition);
+		Forker.forkTokens(it->block);
+	}
+	Forker.forkTokens(copy->finallyBlock);
+	return copy;
+}
 
 string CScriptTokenDataTry::getParsableString( const string &IndentString/*=""*/, const string &Indent/*=""*/ ) {
 	string out = "try ";
@@ -804,12 +1021,27 @@ string CScriptTokenDataTry::getParsableString( const string &IndentString/*=""*/
 // CScriptTokenDataString
 //////////////////////////////////////////////////////////////////////////
 
-CScriptTokenDataString::CScriptTokenDataString(istream &in) {
-	CScriptToken::unserialize(tokenStr, in);
+CScriptTokenDataString::CScriptTokenDataString(istream &in) : inlineCache(0) {
+	bool isAtom;
+	if(CScriptToken::unserialize(isAtom, in))
+		CScriptToken::unserialize(atom, in);
+	else
+		CScriptToken::unserialize(tokenStr, in);
 }
 
 void CScriptTokenDataString::serialize(ostream &out) const {
-	CScriptToken::serialize(tokenStr, out);
+	bool isAtom = !atom.empty();
+	CScriptToken::serialize(isAtom, out);
+	if(isAtom)
+		CScriptToken::serialize(atom, out);
+	else
+		CScriptToken::serialize(tokenStr, out);
+}
+CScriptTokenData *CScriptTokenDataString::fork(CScriptVarForker &Forker) {
+	if(atom.empty()) return this; // string- and regexp-literals are never changed
+	CScriptTokenDataString *copy = new CScriptTokenDataString(*this);
+	if(inlineCache) copy->inlineCache = new CScriptInlineCache(*inlineCache); // the forked context has the same shape-IDs
+	return copy;
 }
 
 
@@ -818,7 +1050,7 @@ void CScriptTokenDataString::serialize(ostream &out) const {
 // CScriptTokenDataFnc
 //////////////////////////////////////////////////////////////////////////
 
-CScriptTokenDataFnc::CScriptTokenDataFnc(std::istream &in)
+CScriptTokenDataFnc::CScriptTokenDataFnc(std::istream &in) : argumentsKind(ARGUMENTS_UNCHECKED)
 {
 	CScriptToken::unserialize(file, in);
 	CScriptToken::unserialize(line, in);
@@ -827,6 +1059,7 @@ CScriptTokenDataFnc::CScriptTokenDataFnc(std::istream &in)
 	CScriptToken::unserialize(body, in);
 	CScriptToken::unserialize(isGenerator, in);
 	CScriptToken::unserialize(isArrowFunction, in);
+	CScriptToken::unserialize(usesArguments, in);
 }
 
 void CScriptTokenDataFnc::serialize(ostream &out) const {
@@ -837,6 +1070,14 @@ void CScriptTokenDataFnc::serialize(ostream &out) const {
 	CScriptToken::serialize(body, out);
 	CScriptToken::serialize(isGenerator, out);
 	CScriptToken::serialize(isArrowFunction, out);
+	CScriptToken::serialize(usesArguments, out);
+}
+CScriptTokenData *CScriptTokenDataFnc::fork(CScriptVarForker &Forker) {
+	if(body.empty() && argumentsKind == ARGUMENTS_SIMPLE) return this; // e.g. natives - nothing is changed while executing
+	CScriptTokenDataFnc *copy = new CScriptTokenDataFnc(*this);
+	Forker.forkTokens(copy->arguments);
+	Forker.forkTokens(copy->body);
+	return copy;
 }
 
 string CScriptTokenDataFnc::getArgumentsString( bool forArrowFunction/*=false*/ ) {
@@ -859,6 +1100,23 @@ string CScriptTokenDataFnc::getArgumentsString( bool forArrowFunction/*=false*/
 	return destination.str();
 }
 
+bool CScriptTokenDataFnc::hasSimpleArguments() {
+	if(argumentsKind == ARGUMENTS_UNCHECKED) {
+		argumentsKind = ARGUMENTS_SIMPLE;
+		argumentAtoms.clear();
+		for(TOKEN_VECT_it argument=arguments.begin(); argument!=arguments.end(); ++argument) {
+			CScriptTokenDataDestructuringVar &DestructuringVar = argument->DestructuringVar();
+			if(DestructuringVar.vars.size() != 1 || DestructuringVar.assignment.size()) {
+				argumentsKind = ARGUMENTS_DESTRUCTURING;
+				argumentAtoms.clear();
+				break;
+			}
+			argumentAtoms.push_back(CScriptAtom(DestructuringVar.vars.front().second));
+		}
+	}
+	return argumentsKind == ARGUMENTS_SIMPLE;
+}
+
 
 //////////////////////////////////////////////////////////////////////////
 // CScriptTokenDataDestructuringVar
@@ -885,6 +1143,11 @@ void CScriptTokenDataDestructuringVar::serialize(ostream &out) const {
 	}
 	CScriptToken::serialize(assignment, out);
 }
+CScriptTokenData *CScriptTokenDataDestructuringVar::fork(CScriptVarForker &Forker) {
+	CScriptTokenDataDestructuringVar *copy = new CScriptTokenDataDestructuringVar(*this);
+	Forker.forkTokens(copy->assignment);
+	return copy;
+}
 
 string CScriptTokenDataDestructuringVar::getParsableString()
 {
@@ -954,6 +1217,12 @@ void CScriptTokenDataObjectLiteral::serialize(ostream &out) const {
 		CScriptToken::serialize(it->value, out);
 	}
 }
+CScriptTokenData *CScriptTokenDataObjectLiteral::fork(CScriptVarForker &Forker) {
+	CScriptTokenDataObjectLiteral *copy = new CScriptTokenDataObjectLiteral(*this);
+	for(ELEMENTS_it it=copy->elements.begin(); it!=copy->elements.end(); ++it)
+		Forker.forkTokens(it->value);
+	return copy;
+}
 
 string CScriptTokenDataObjectLiteral::getParsableString() {
 	string out = type == OBJECT ? "{ " : "[";
@@ -1132,12 +1401,14 @@ CScriptToken::CScriptToken(CScriptLex *l, int Match, int Alternate) : line(l->cu
 	if(token == LEX_INT || LEX_TOKEN_DATA_FLOAT(token)) {
 		CNumber number(l->tkStr);
 		if(number.isInfinity())
-			token=LEX_ID, (tokenData=new CScriptTokenDataString("Infinity"))->ref();
+			token=LEX_ID, (tokenData=new CScriptTokenDataString(CScriptAtom("Infinity")))->ref();
 		else if(number.isInt32())
 			token=LEX_INT, intData=number.toInt32();
 		else
 			token=LEX_FLOAT, floatData=new double(number.toDouble());
-	} else if(LEX_TOKEN_DATA_STRING(token))
+	} else if(LEX_TOKEN_DATA_ATOM(token))
+		(tokenData = new CScriptTokenDataString(CScriptAtom(l->tkStr)))->ref();
+	else if(LEX_TOKEN_DATA_STRING(token))
 		(tokenData = new CScriptTokenDataString(l->tkStr))->ref();
 	else if(LEX_TOKEN_DATA_FUNCTION(token))
 		(tokenData = new CScriptTokenDataFnc)->ref();
@@ -1192,7 +1463,9 @@ CScriptToken::CScriptToken(uint16_t Tk, double FloatData) : line(0), column(0),
 }
 
 CScriptToken::CScriptToken(uint16_t Tk, const string &TkStr) : line(0), column(0), token(Tk), intData(0) {
-	if(LEX_TOKEN_DATA_STRING(token))
+	if(LEX_TOKEN_DATA_ATOM(token))
+		(tokenData = new CScriptTokenDataString(CScriptAtom(TkStr)))->ref();
+	else if(LEX_TOKEN_DATA_STRING(token))
 		(tokenData = new CScriptTokenDataString(TkStr))->ref();
 	else if (LEX_TOKEN_DATA_DESTRUCTURING_VAR(token)) {
 		CScriptTokenDataDestructuringVar *tmp = new CScriptTokenDataDestructuringVar;
@@ -1362,6 +1635,14 @@ void CScriptToken::clear()
 		tokenData->unref();
 	token = 0;
 }
+void CScriptToken::fork(CScriptVarForker &Forker) {
+	if(LEX_TOKEN_DATA_FLOAT(token) || LEX_TOKEN_DATA_SIMPLE(token)) return;
+	CScriptTokenData *copy = Forker.forkTokenData(tokenData);
+	if(copy == tokenData) return;
+	copy->ref();
+	tokenData->unref();
+	tokenData = copy;
+}
 string CScriptToken::getTokenStr( int token, const char *tokenStr/*=0*/, bool *need_space/*=0 */ ) {
 	if(!tokens2str_sorted) tokens2str_sorted=tokens2str_sort();
 	if(token == LEX_ID && tokenStr) {
@@ -1427,6 +1708,40 @@ string &CScriptToken::unserialize(string &value, istream &in) {
 }
 
 
+// the atom-table of a compiled-tokens stream is attached to the stream with ios_base::pword
+struct CScriptAtomTable {
+	map<CScriptAtom, uint32_t> index;
+	vector<CScriptAtom> atoms;
+};
+static int atomTableIdx() {
+	static int idx = ios_base::xalloc();
+	return idx;
+}
+void CScriptToken::serialize(const CScriptAtom &value, ostream &out) {
+	CScriptAtomTable *table = static_cast<CScriptAtomTable*>(out.pword(atomTableIdx()));
+	if(!table) {
+		serialize(value.getName(), out);
+		return;
+	}
+	map<CScriptAtom, uint32_t>::iterator it = table->index.find(value);
+	if(it == table->index.end()) {
+		it = table->index.insert(make_pair(value, uint32_t(table->atoms.size()))).first;
+		table->atoms.push_back(value);
+	}
+	serialize(it->second, out);
+}
+CScriptAtom &CScriptToken::unserialize(CScriptAtom &value, istream &in) {
+	CScriptAtomTable *table = static_cast<CScriptAtomTable*>(in.pword(atomTableIdx()));
+	if(!table) {
+		string name;
+		return value = CScriptAtom(unserialize(name, in));
+	}
+	uint32_t idx;
+	unserialize(idx, in);
+	if(idx >= table->atoms.size()) throw CScriptException(Error, "invalid compiled tokens");
+	return value = table->atoms[idx];
+}
+
 void CScriptToken::serialize(const STRING_VECTOR_t &value, ostream &out) {
 	serialize(value.size(), out);
 	for(STRING_VECTOR_cit it=value.begin(); it != value.end(); ++it)
@@ -1495,9 +1810,9 @@ static string &read_string_from_istream(istream &in, string &out)
 }
 
 #define COMPILED_TOKENS_ID 0x006a7300 /* '\0', 'j', 's', '0' */
-#define COMPILED_TOKENS_VERSION 0x0100
-#define COMPILED_TOKENS_VERSION_MIN 0x0100
-#define COMPILED_TOKENS_VERSION_MAX 0x0100
+#define COMPILED_TOKENS_VERSION 0x0201 /* 0x0200: with atom-table, 0x0201: functions with usesArguments */
+#define COMPILED_TOKENS_VERSION_MIN 0x0201
+#define COMPILED_TOKENS_VERSION_MAX 0x0201
 void CScriptTokenizer::unserialize(const string &File, const string &FileC)
 {
 	if(FileC.size()) {
@@ -1511,7 +1826,17 @@ void CScriptTokenizer::unserialize(const string &File, const string &FileC)
 				if(v >= COMPILED_TOKENS_VERSION_MIN && COMPILED_TOKENS_VERSION_MAX >= v) {
 					tokens.clear();
 					tokenScopeStack.clear();
+					CScriptAtomTable atomTable;
+					uint32_t count;
+					CScriptToken::unserialize(count, in);
+					atomTable.atoms.reserve(count);
+					while(in && count--) {
+						string name;
+						atomTable.atoms.push_back(CScriptAtom(CScriptToken::unserialize(name, in)));
+					}
+					in.pword(atomTableIdx()) = &atomTable;
 					CScriptToken::unserialize(tokens, in);
+					in.pword(atomTableIdx()) = 0;
 					pushTokenScope(tokens);
 					currentFile = File;
 					tk = getToken().token;
@@ -1535,7 +1860,17 @@ void CScriptTokenizer::serialize(ostream &out)
 	uint16_t v = COMPILED_TOKENS_VERSION;
 	CScriptToken::serialize(id, out);
 	CScriptToken::serialize(v, out);
-	CScriptToken::serialize(tokens, out);
+	// the tokens are written first to collect the atom-table
+	ostringstream body(ios_base::out | ios_base::binary);
+	CScriptAtomTable atomTable;
+	body.pword(atomTableIdx()) = &atomTable;
+	CScriptToken::serialize(tokens, body);
+	body.pword(atomTableIdx()) = 0;
+	CScriptToken::serialize(uint32_t(atomTable.atoms.size()), out);
+	for(vector<CScriptAtom>::iterator it = atomTable.atoms.begin(); it != atomTable.atoms.end(); ++it)
+		CScriptToken::serialize(it->getName(), out);
+	string data = body.str();
+	out.write(data.data(), data.size());
 }
 
 void CScriptTokenizer::serialize(const string &File)
@@ -2067,6 +2402,7 @@ CScriptToken CScriptTokenizer::tokenizeVarIdentifier( STRING_VECTOR_t *VarNames/
 		l->match('=');
 		ScriptTokenState assignmentState;
 		tokenizeCondition(assignmentState, 0);
+		assignmentState.Tokens.push_back(CScriptToken(LEX_T_END_EXPRESSION));
 		token.DestructuringVar().assignment.swap(assignmentState.Tokens);
 	}
 	return token;
@@ -2094,6 +2430,7 @@ void CScriptTokenizer::tokenizeArrowFunction(const TOKEN_VECT &Arguments, Script
 		tokenizeExpression(functionState, 0);
 		functionState.HaveReturnValue = true;
 	}
+	FncData.usesArguments = functionState.FunctionUsesArguments;
 	functionState.Tokens.swap(FncData.body);
 	State.Tokens.push_back(FncToken);
 }
@@ -2146,6 +2483,7 @@ void CScriptTokenizer::tokenizeFunction(ScriptTokenState &State, int Flags, bool
 	if(functionState.HaveReturnValue == true && functionState.FunctionIsGenerator == true)
 		throw CScriptException(TypeError, "generator function returns a value.", l->currentFile, functionPos.currentLine, functionPos.currentColumn());
 	FncData.isGenerator = functionState.FunctionIsGenerator;
+	FncData.usesArguments = functionState.FunctionUsesArguments;
 
 	functionState.Tokens.swap(FncData.body);
 	if(forward) {
@@ -2329,6 +2667,7 @@ void CScriptTokenizer::_tokenizeLiteralObject(ScriptTokenState &State, int Flags
 						msgColumn = l->currentColumn();
 						;
 					}
+					if(element.id == TINYJS_ARGUMENTS_VAR) State.FunctionUsesArguments = true;
 					element.value.push_back(Token);
 				} else
 					assign = true;
@@ -2470,6 +2809,7 @@ void CScriptTokenizer::tokenizeLiteral(ScriptTokenState &State, int Flags) {
 		{
 			string label = l->tkStr;
 			l->match(LEX_ID);
+			if(label == TINYJS_ARGUMENTS_VAR || label == "eval") State.FunctionUsesArguments = true;
 			if(label != "this" && l->tk == LEX_ARROW) { // Arrow-Function
 				TOKEN_VECT arguments; 
 				CScriptToken token(LEX_T_DESTRUCTURING_VAR);
@@ -2889,13 +3229,347 @@ void CScriptTokenizer::throwTokenNotExpected() {
 }
 
 
+//////////////////////////////////////////////////////////////////////////
+/// CScriptVarShape
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef NO_THREADING
+static CScriptMutex shapeIDMutex;
+#endif
+uint64_t CScriptVarShape::allocID() {
+#ifndef NO_THREADING
+	CScriptUniqueLock lock(shapeIDMutex);
+#endif
+	static uint64_t lastID = 0;
+	return ++lastID;
+}
+
+CScriptVarShape::CScriptVarShape() : parent(0), refs(0), used(false), slotCount(0), arrayLength(0), id(allocID()), table(0), dictionary(0) {}
+CScriptVarShape::CScriptVarShape(CScriptVarShape *Parent, const CScriptAtom &Name) 
+	: parent(Parent), name(Name), refs(0), used(false), slotCount(Parent->slotCount+1), arrayLength(Parent->arrayLength), id(allocID()), table(0), dictionary(0) {
+	parent->ref();
+	uint32_t Idx = Name.getArrayIndex();
+	if(Idx != uint32_t(-1) && Idx >= arrayLength) arrayLength = Idx+1;
+}
+CScriptVarShape::CScriptVarShape(CScriptVarShape *From, uint32_t RemoveSlot)
+	: parent(0), refs(0), used(false), slotCount(0), arrayLength(From->arrayLength), id(allocID()), table(0), dictionary(new DICTIONARY_t) {
+	dictionary->names.resize(From->slotCount);
+	for(CScriptVarShape *shape = From; shape->parent; shape = shape->parent)
+		dictionary->names[shape->slotCount-1] = shape->name;
+	if(RemoveSlot != SHAPE_NO_SLOT) {
+		dictionary->names[RemoveSlot] = CScriptAtom(); // leaves a hole like removeProperty
+		dictionary->holes = 1;
+	}
+	size_t size = 16;
+	while(size < dictionary->names.size()*2) size <<= 1;
+	dictionary->index.resize(size);
+	for(; slotCount < dictionary->names.size(); ++slotCount)
+		if(slotCount != RemoveSlot) dictionaryInsert(slotCount);
+}
+CScriptVarShape::CScriptVarShape(const CScriptVarShape *Original, CScriptVarShape *Parent)
+	: parent(Parent), name(Original->name), refs(0), used(false), slotCount(Original->slotCount), arrayLength(Original->arrayLength), id(Original->id), table(0), dictionary(0) {
+	parent->ref();
+}
+CScriptVarShape *CScriptVarShape::cloneDictionary() const {
+	ASSERT(dictionary);
+	CScriptVarShape *shape = new CScriptVarShape;
+	shape->slotCount = slotCount;
+	shape->arrayLength = arrayLength;
+	shape->dictionary = new DICTIONARY_t(*dictionary);
+	return shape;
+}
+CScriptVarShape::~CScriptVarShape() {
+	// the tree can be very deep -> delete the transitions without recursion
+	vector<CScriptVarShape*> stack;
+	for(TRANSITIONS_it it = transitions.begin(); it != transitions.end(); ++it)
+		stack.push_back(it->second);
+	transitions.clear();
+	while(stack.size()) {
+		CScriptVarShape *shape = stack.back();
+		stack.pop_back();
+		for(TRANSITIONS_it it = shape->transitions.begin(); it != shape->transitions.end(); ++it)
+			stack.push_back(it->second);
+		shape->transitions.clear();
+		delete shape;
+	}
+	delete table;
+	delete dictionary;
+}
+
+CScriptVarShape *CScriptVarShape::getRoot() {
+	CScriptVarShape *shape = this;
+	while(shape->parent) shape = shape->parent;
+	return shape;
+}
+
+uint32_t CScriptVarShape::getTreeSize() {
+	uint32_t count = 0;
+	vector<CScriptVarShape*> stack(1, this);
+	while(stack.size()) {
+		CScriptVarShape *shape = stack.back();
+		stack.pop_back();
+		++count;
+		for(TRANSITIONS_it it = shape->transitions.begin(); it != shape->transitions.end(); ++it)
+			stack.push_back(it->second);
+	}
+	return count;
+}
+
+uint32_t CScriptVarShape::prune() {
+	vector<CScriptVarShape*> shapes(1, this);
+	for(size_t i=0; i<shapes.size(); ++i) // pre-order -> the transitions are behind its shape
+		for(TRANSITIONS_it it = shapes[i]->transitions.begin(); it != shapes[i]->transitions.end(); ++it)
+			shapes.push_back(it->second);
+	uint32_t count = 0;
+	for(vector<CScriptVarShape*>::reverse_iterator it = shapes.rbegin(); it != shapes.rend(); ++it) {
+		CScriptVarShape *shape = *it;
+		if(shape != this && !shape->refs && !shape->used) { // without vars and transitions (these are removed before)
+			shape->parent->transitions.erase(shape->name);
+			shape->parent->release();
+			delete shape;
+		} else {
+			shape->used = false;
+			if(shape->refs > shape->transitions.size()) ++count;
+		}
+	}
+	return count;
+}
+
+uint32_t CScriptVarShape::findSlot(const CScriptAtom &Name) {
+	if(dictionary) return dictionaryFind(Name);
+	if(!table) {
+		if(slotCount <= SHAPE_LINEAR_SEARCH_MAX) {
+			for(CScriptVarShape *shape = this; shape->parent; shape = shape->parent)
+				if(shape->name == Name) return shape->slotCount-1;
+			return SHAPE_NO_SLOT;
+		}
+		table = new TABLE_t;
+		for(CScriptVarShape *shape = this; shape->parent; shape = shape->parent)
+			table->insert(TABLE_t::value_type(shape->name, shape->slotCount-1));
+	}
+	TABLE_it it = table->find(Name);
+	return it != table->end() ? it->second : SHAPE_NO_SLOT;
+}
+
+CScriptVarShape *CScriptVarShape::addProperty(const CScriptAtom &Name) {
+	if(dictionary) {
+		uint32_t Idx = Name.getArrayIndex();
+		if(Idx != uint32_t(-1) && Idx >= arrayLength) arrayLength = Idx+1;
+		dictionary->names.push_back(Name);
+		if(size_t(slotCount+1)*2 > dictionary->index.size()) { // grow
+			dictionary->index.assign(dictionary->index.size()*2, 0);
+			for(uint32_t slot=0; slot<slotCount; ++slot)
+				if(!dictionary->names[slot].empty()) dictionaryInsert(slot);
+		}
+		dictionaryInsert(slotCount++);
+		id = allocID();
+		return this;
+	}
+	if(slotCount >= SHAPE_DICTIONARY_MIN_SLOTS)
+		return (new CScriptVarShape(this, SHAPE_NO_SLOT))->addProperty(Name);
+	CScriptVarShape *&next = transitions[Name];
+	if(!next) {
+		next = new CScriptVarShape(this, Name);
+		if(table) { // hand over the table - objects growing property by property needs the table only at the end
+			next->table = table;
+			table = 0;
+			next->table->insert(TABLE_t::value_type(Name, slotCount));
+		}
+	}
+	return next;
+}
+
+CScriptVarShape *CScriptVarShape::removeProperty(uint32_t Slot) {
+	ASSERT(Slot < slotCount);
+	if(dictionary) {
+		dictionaryRemove(Slot);
+		id = allocID();
+		return this;
+	}
+	if(slotCount-Slot-1 > SHAPE_LINEAR_SEARCH_MAX) // rebuilding the path behind Slot creates too many shapes
+		return new CScriptVarShape(this, Slot);
+	vector<CScriptAtom> names; // the names behind Slot in reverse order
+	CScriptVarShape *shape = this;
+	for(; shape->slotCount > Slot+1; shape = shape->parent)
+		names.push_back(shape->name);
+	shape = shape->parent; // skip the removed property
+	for(vector<CScriptAtom>::reverse_iterator it = names.rbegin(); it != names.rend(); ++it)
+		shape = shape->addProperty(*it);
+	return shape;
+}
+
+void CScriptVarShape::getNames(STRING_VECTOR_t &Names) {
+	Names.resize(slotCount);
+	if(dictionary) {
+		for(uint32_t slot=0; slot<slotCount; ++slot) Names[slot] = dictionary->names[slot].getName();
+		return;
+	}
+	for(CScriptVarShape *shape = this; shape->parent; shape = shape->parent)
+		Names[shape->slotCount-1] = shape->name.getName();
+}
+
+static inline uint32_t shapeHash(const CScriptAtom &Name) {
+	uint32_t h = Name.getID() * 0x9e3779b1u;
+	return h ^ (h >> 15);
+}
+uint32_t CScriptVarShape::dictionaryFind(const CScriptAtom &Name, uint32_t *Pos/*=0*/) {
+	vector<uint32_t> &index = dictionary->index;
+	uint32_t mask = uint32_t(index.size()) - 1;
+	for(uint32_t i = shapeHash(Name) & mask; index[i]; i = (i+1) & mask) {
+		if(dictionary->names[index[i]-1] == Name) {
+			if(Pos) *Pos = i;
+			return index[i]-1;
+		}
+	}
+	return SHAPE_NO_SLOT;
+}
+void CScriptVarShape::dictionaryInsert(uint32_t Slot) {
+	vector<uint32_t> &index = dictionary->index;
+	uint32_t mask = uint32_t(index.size()) - 1;
+	uint32_t i = shapeHash(dictionary->names[Slot]) & mask;
+	while(index[i]) i = (i+1) & mask;
+	index[i] = Slot+1;
+}
+void CScriptVarShape::dictionaryRemove(uint32_t Slot) {
+	vector<uint32_t> &index = dictionary->index;
+	uint32_t mask = uint32_t(index.size()) - 1;
+	uint32_t hole = 0;
+	dictionaryFind(dictionary->names[Slot], &hole);
+	// backward-shift deletion - no tombstones needed
+	for(uint32_t i = (hole+1) & mask; index[i]; i = (i+1) & mask) {
+		uint32_t home = shapeHash(dictionary->names[index[i]-1]) & mask;
+		if(((i - home) & mask) >= ((i - hole) & mask)) {
+			index[hole] = index[i];
+			hole = i;
+		}
+	}
+	index[hole] = 0;
+	// leaves a hole - the slots are kept until compact, so a remove is O(1)
+	dictionary->names[Slot] = CScriptAtom();
+	++dictionary->holes; // arrayLength is kept - it is only an upper bound for the prototype-lookup of indexes
+}
+void CScriptVarShape::compact() {
+	ASSERT(dictionary);
+	vector<CScriptAtom> &names = dictionary->names;
+	uint32_t count = 0;
+	for(uint32_t slot=0; slot<slotCount; ++slot)
+		if(!names[slot].empty()) {
+			if(count != slot) names[count] = names[slot];
+			++count;
+		}
+	names.resize(count);
+	size_t size = 16;
+	while(size < names.size()*2) size <<= 1;
+	dictionary->index.assign(size, 0);
+	for(slotCount = 0; slotCount < count; ++slotCount)
+		dictionaryInsert(slotCount);
+	dictionary->holes = 0;
+	id = allocID();
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+/// CScriptInlineCache
+//////////////////////////////////////////////////////////////////////////
+
+CScriptVarLink *CScriptInlineCache::lookup(CScriptVar *Receiver, uint32_t &Depth) {
+	if(Receiver->hasLazyPrototype()) Receiver->findChild(atom___proto__); // the cached paths needs the __proto__-link
+	if(Receiver->hasLazyNatives()) Receiver->installLazyNatives(); // the shape doesn't know the natives
+	uint64_t receiverShapeID = Receiver->getShape()->getID();
+	for(Entry *entry = entries, *end = entries+count; entry < end; ++entry) {
+		if(entry->shapeIDs[0] != receiverShapeID) continue;
+		CScriptVar *holder = Receiver;
+		uint32_t depth;
+		for(depth = 0; depth < entry->depth; ++depth) {
+			holder = holder->Childs[entry->protoSlots[depth]]->getVarPtr().getVar();
+			if(holder->hasLazyNatives()) holder->installLazyNatives();
+			if(holder->getShape()->getID() != entry->shapeIDs[depth+1]) break;
+		}
+		if(depth < entry->depth) continue; // prototype-chain has changed
+		Depth = depth;
+		return holder->Childs[entry->slot].operator->();
+	}
+	return 0;
+}
+
+void CScriptInlineCache::update(CScriptVar *Receiver, const CScriptAtom &Name) {
+	Entry entry;
+	CScriptVar *holder = Receiver;
+	for(entry.depth = 0; ; ++entry.depth) {
+		CScriptVarShape *shape = holder->getShape();
+		entry.shapeIDs[entry.depth] = shape->getID();
+		if((entry.slot = shape->findSlot(Name)) != SHAPE_NO_SLOT) break;
+		if(entry.depth == INLINE_CACHE_MAX_DEPTH) return; // too deep
+		uint32_t protoSlot = shape->findSlot(atom___proto__);
+		if(protoSlot == SHAPE_NO_SLOT) return;
+		entry.protoSlots[entry.depth] = protoSlot;
+		holder = holder->Childs[protoSlot]->getVarPtr().getVar();
+	}
+	add(entry);
+}
+
+CScriptVarLink *CScriptInlineCache::lookupInScopes(CScriptVar *Scope) {
+	uint64_t scopeShapeID = Scope->getShape()->getID();
+	for(Entry *entry = entries, *end = entries+count; entry < end; ++entry) {
+		if(entry->shapeIDs[0] != scopeShapeID) continue;
+		CScriptVar *holder = Scope;
+		uint32_t depth;
+		for(depth = 0; depth < entry->depth; ++depth) {
+			uint32_t parentSlot = entry->protoSlots[depth];
+			holder = parentSlot == SHAPE_NO_SLOT ? holder->getContext()->getRoot().getVar() : holder->Childs[parentSlot]->getVarPtr().getVar();
+			if(holder->getShape()->getID() != entry->shapeIDs[depth+1]) break;
+		}
+		if(depth < entry->depth) continue; // scope-chain has changed
+		return holder->Childs[entry->slot].operator->();
+	}
+	return 0;
+}
+
+void CScriptInlineCache::updateInScopes(CScriptVar *Scope, const CScriptAtom &Name) {
+	Entry entry;
+	CScriptVar *holder = Scope;
+	CScriptVar *root = Scope->getContext()->getRoot().getVar();
+	for(entry.depth = 0; ; ++entry.depth) {
+		CScriptVarShape *shape = holder->getShape();
+		if(shape->findSlot(atom___scope_with__) != SHAPE_NO_SLOT) return; // with-scopes are dynamic
+		entry.shapeIDs[entry.depth] = shape->getID();
+		if((entry.slot = shape->findSlot(Name)) != SHAPE_NO_SLOT) break;
+		if(entry.depth == INLINE_CACHE_MAX_DEPTH || holder == root) return; // too deep or not found
+		uint32_t parentSlot = shape->findSlot(atom___scope_parent__);
+		if(parentSlot == SHAPE_NO_SLOT) parentSlot = shape->findSlot(atom___function_closure__);
+		if(parentSlot == SHAPE_NO_SLOT) {
+			if(!dynamic_cast<CScriptVarScopeFnc*>(holder)) return; // only function-scopes continues at the root-scope
+			holder = root;
+		} else
+			holder = holder->Childs[parentSlot]->getVarPtr().getVar();
+		entry.protoSlots[entry.depth] = parentSlot;
+	}
+	add(entry);
+}
+
+void CScriptInlineCache::add(const Entry &entry) {
+	if(count < INLINE_CACHE_ENTRIES)
+		entries[count++] = entry;
+	else { // megamorphic - replace the entries round robin
+		entries[replace] = entry;
+		replace = (replace+1) % INLINE_CACHE_ENTRIES;
+	}
+}
+
+
 //////////////////////////////////////////////////////////////////////////
 /// CScriptVar
 //////////////////////////////////////////////////////////////////////////
 
 CScriptVar::CScriptVar(CTinyJS *Context, const CScriptVarPtr &Prototype) {
 	extensible = true;
+	lazyNatives = false;
+	shared = false;
 	context = Context;
+	shape = context->getRootShape();
+	shape->ref();
+	elements = 0;
+	lazyPrototype = 0;
 	memset(temporaryMark, 0, sizeof(temporaryMark));
 	if(context->first) {
 		next = context->first;
@@ -2904,17 +3578,24 @@ CScriptVar::CScriptVar(CTinyJS *Context, const CScriptVarPtr &Prototype) {
 		next = 0;
 	}
 	context->first = this;
+	++context->varCount;
+	++context->collectorAllocs;
+	collectorMark = context->collectorEpoch; // vars created while collecting are reachable
 	prev = 0;
 	refs = 0;
 	if(Prototype)
-		addChild(TINYJS___PROTO___VAR, Prototype, SCRIPTVARLINK_WRITABLE);
+		addChild(atom___proto__, Prototype, SCRIPTVARLINK_WRITABLE);
 #if DEBUG_MEMORY
 	mark_allocated(this);
 #endif
 }
 CScriptVar::CScriptVar(const CScriptVar &Copy) {
+	CScriptVarForker *forker = Copy.context->forker; // a fork is created in the target-context
+	if(Copy.lazyNatives && !forker) const_cast<CScriptVar&>(Copy).installLazyNatives(); // the copy gets all natives
 	extensible = Copy.extensible;
-	context = Copy.context;
+	lazyNatives = forker && Copy.lazyNatives; // the fork installs the natives lazily as well
+	shared = forker && Copy.shared; // the fork of a cache-entry is a cache-entry of the target
+	context = forker ? forker->getTarget() : Copy.context;
 	memset(temporaryMark, 0, sizeof(temporaryMark));
 	if(context->first) {
 		next = context->first;
@@ -2923,11 +3604,29 @@ CScriptVar::CScriptVar(const CScriptVar &Copy) {
 		next = 0;
 	}
 	context->first = this;
+	++context->varCount;
+	++context->collectorAllocs;
+	collectorMark = context->collectorEpoch; // vars created while collecting are reachable
 	prev = 0;
 	refs = 0;
-	SCRIPTVAR_CHILDS_cit it;
-	for(it = Copy.Childs.begin(); it!= Copy.Childs.end(); ++it) {
-		addChild((*it)->getName(), (*it)->getVarPtr(), (*it)->getFlags());
+	if(forker) {
+		shape = forker->forkShape(Copy.shape);
+		lazyPrototype = forker->forkMember(Copy.lazyPrototype);
+	} else {
+		shape = Copy.shape->isDictionary() ? Copy.shape->cloneDictionary() : Copy.shape; // same properties in the same order -> same shape
+		lazyPrototype = Copy.lazyPrototype;
+	}
+	shape->ref();
+	elements = 0; // copied by CScriptVarArray
+	Childs.reserve(Copy.Childs.size());
+	for(SCRIPTVAR_CHILDS_cit it = Copy.Childs.begin(); it!= Copy.Childs.end(); ++it) {
+		if(!*it) { // a hole of the dictionary-shape
+			Childs.push_back(CScriptVarLinkPtr());
+			continue;
+		}
+		CScriptVarLinkPtr link((*it)->getVarPtr(), (*it)->getAtom(), (*it)->getFlags());
+		link->setOwner(this);
+		Childs.push_back(link);
 	}
 
 #if DEBUG_MEMORY
@@ -2939,14 +3638,26 @@ CScriptVar::~CScriptVar(void) {
 	mark_deallocated(this);
 #endif
 	for(SCRIPTVAR_CHILDS_it it = Childs.begin(); it != Childs.end(); ++it)
-		(*it)->setOwner(0);
+		if(*it) (*it)->setOwner(0);
 	removeAllChildren();
+	shape->release(); // the root-shape
 	if(prev)
 		prev->next = next;
 	else
 		context->first = next;
 	if(next)
 		next->prev = prev;
+	--context->varCount;
+	if(context->collectorScanCursor == this)
+		context->collectorScanCursor = next;
+}
+
+void CScriptVar::setShape(CScriptVarShape *Shape) {
+	bool inUse = Shape->ref() && !Shape->isDictionary();
+	CScriptVarShape *old = shape;
+	shape = Shape;
+	if(old->release() && old->isDictionary()) delete old; // owned by this
+	if(inUse) context->shapeInUse(); // at last - a prune removes neither Shape nor old
 }
 
 /// Type
@@ -2956,6 +3667,8 @@ bool CScriptVar::isError()			{return false;}
 bool CScriptVar::isArray()			{return false;}
 bool CScriptVar::isDate()			{return false;}
 bool CScriptVar::isRegExp()		{return false;}
+bool CScriptVar::isArrayBuffer()	{return false;}
+bool CScriptVar::isTypedArray()	{return false;}
 bool CScriptVar::isAccessor()		{return false;}
 bool CScriptVar::isNull()			{return false;}
 bool CScriptVar::isUndefined()	{return false;}
@@ -3105,7 +3818,6 @@ string CScriptVar::getParsableString() {
 }
 
 string CScriptVar::getParsableString(const string &indentString, const string &indent, uint32_t uniqueID, bool &hasRecursion) {
-	getParsableStringRecursionsCheck();
 	return indentString+toString();
 }
 
@@ -3114,24 +3826,36 @@ CScriptVarPtr CScriptVar::getNumericVar() { return newScriptVar(toNumber()); }
 ////// Flags
 
 void CScriptVar::seal() {
+	installLazyNatives();
 	preventExtensions(); 
 	for(SCRIPTVAR_CHILDS_it it = Childs.begin(); it != Childs.end(); ++it)
+		if(*it) (*it)->setConfigurable(false);
+	if(elements) for(CScriptVarElements::iterator it(*elements); it; ++it)
 		(*it)->setConfigurable(false);
 }
 bool CScriptVar::isSealed() const {
 	if(isExtensible()) return false; 
+	if(lazyNatives) const_cast<CScriptVar*>(this)->installLazyNatives();
 	for(SCRIPTVAR_CHILDS_cit it = Childs.begin(); it != Childs.end(); ++it)
+		if(*it && (*it)->isConfigurable()) return false;
+	if(elements) for(CScriptVarElements::iterator it(*elements); it; ++it)
 		if((*it)->isConfigurable()) return false;
 	return true;
 }
 void CScriptVar::freeze() {
+	installLazyNatives();
 	preventExtensions(); 
 	for(SCRIPTVAR_CHILDS_it it = Childs.begin(); it != Childs.end(); ++it)
+		if(*it) (*it)->setConfigurable(false), (*it)->setWritable(false);
+	if(elements) for(CScriptVarElements::iterator it(*elements); it; ++it)
 		(*it)->setConfigurable(false), (*it)->setWritable(false);
 }
 bool CScriptVar::isFrozen() const {
 	if(isExtensible()) return false; 
+	if(lazyNatives) const_cast<CScriptVar*>(this)->installLazyNatives();
 	for(SCRIPTVAR_CHILDS_cit it = Childs.begin(); it != Childs.end(); ++it)
+		if(*it && ((*it)->isConfigurable() || (*it)->isWritable())) return false;
+	if(elements) for(CScriptVarElements::iterator it(*elements); it; ++it)
 		if((*it)->isConfigurable() || (*it)->isWritable()) return false;
 	return true;
 }
@@ -3227,20 +3951,53 @@ cant_redefine:
 	return "can't redefine non-configurable property";
 }
 
+void CScriptVar::installLazyNatives() {
+	if(lazyNatives) context->installLazyNatives(this);
+}
+
 CScriptVarLinkPtr CScriptVar::findChild(const string &childName) {
-	if(Childs.empty()) return 0;
-	SCRIPTVAR_CHILDS_it it = lower_bound(Childs.begin(), Childs.end(), childName);
-	if(it != Childs.end() && (*it)->getName() == childName)
-		return *it;
+	CScriptAtom atom;
+	if(CScriptAtom::find(childName, atom)) return findChild(atom);
+	if(lazyNatives) { // the natives may intern the name
+		installLazyNatives();
+		return findChild(childName);
+	}
+	// a never interned name can only be an array-element
+	if(elements) {
+		uint32_t Idx = isArrayIndex(childName);
+		if(Idx != uint32_t(-1)) return elements->find(Idx);
+	}
+	return 0;
+}
+CScriptVarLinkPtr CScriptVar::findChild(const CScriptAtom &childName) {
+	if(elements) {
+		uint32_t Idx = childName.getArrayIndex();
+		if(Idx != uint32_t(-1)) return elements->find(Idx);
+	}
+	uint32_t slot = shape->findSlot(childName);
+	if(slot != SHAPE_NO_SLOT)
+		return Childs[slot];
+	if(lazyNatives) {
+		installLazyNatives();
+		return findChild(childName);
+	}
+	if(lazyPrototype && childName == atom___proto__) {
+		const CScriptVarPtr &prototype = *lazyPrototype;
+		lazyPrototype = 0;
+		if(prototype) return addChild(atom___proto__, prototype, shared ? 0 : SCRIPTVARLINK_WRITABLE); // i.__proto__=... must not change the prototype of every cached 3
+	}
 	return 0;
 }
 
 CScriptVarLinkWorkPtr CScriptVar::findChildWithStringChars(const string &childName) {
+	return findChildWithStringChars(CScriptAtom(childName));
+}
+CScriptVarLinkWorkPtr CScriptVar::findChildWithStringChars(const CScriptAtom &childName) {
 	CScriptVarLinkWorkPtr child = findChild(childName);
 	if(child) return child;
 	CScriptVarStringPtr strVar = getRawPrimitive();
 	uint32_t Idx;
-	if (strVar && (Idx=isArrayIndex(childName))!=uint32_t(-1)) {
+	if (strVar && (Idx=childName.getArrayIndex())!=uint32_t(-1)) {
 		if (Idx<strVar->stringLength()) {
 			int Char = strVar->getChar(Idx);
 			child(newScriptVar(string(1, (char)Char)), childName, SCRIPTVARLINK_ENUMERABLE);
@@ -3254,11 +4011,14 @@ CScriptVarLinkWorkPtr CScriptVar::findChildWithStringChars(const string &childNa
 }
 
 CScriptVarLinkPtr CScriptVar::findChildInPrototypeChain(const string &childName) {
+	return findChildInPrototypeChain(CScriptAtom(childName));
+}
+CScriptVarLinkPtr CScriptVar::findChildInPrototypeChain(const CScriptAtom &childName) {
 	unsigned int uniqueID = context->allocUniqueID();
 	// Look for links to actual parent classes
 	CScriptVarPtr object = this;
 	CScriptVarLinkPtr __proto__;
-	while( object->getTemporaryMark() != uniqueID && (__proto__ = object->findChild(TINYJS___PROTO___VAR)) ) {
+	while( object->getTemporaryMark() != uniqueID && (__proto__ = object->findChild(atom___proto__)) ) {
 		CScriptVarLinkPtr implementation = __proto__->getVarPtr()->findChild(childName);
 		if (implementation) {
 			context->freeUniqueID();
@@ -3272,15 +4032,33 @@ CScriptVarLinkPtr CScriptVar::findChildInPrototypeChain(const string &childName)
 }
 
 CScriptVarLinkWorkPtr CScriptVar::findChildWithPrototypeChain(const string &childName) {
+	return findChildWithPrototypeChain(CScriptAtom(childName));
+}
+CScriptVarLinkWorkPtr CScriptVar::findChildWithPrototypeChain(const CScriptAtom &childName) {
 	CScriptVarLinkWorkPtr child = findChildWithStringChars(childName);
 	if(child) return child;
 	child = findChildInPrototypeChain(childName);
 	if(child) {
-		child(child->getVarPtr(), child->getName(), child->getFlags()); // recreate implementation
+		child(child->getVarPtr(), child->getAtom(), child->getFlags()); // recreate implementation
 		child.setReferencedOwner(this); // fake referenced Owner
 	}
 	return child;
 }
+CScriptVarLinkWorkPtr CScriptVar::findChildWithPrototypeChain(uint32_t idx) {
+	if(!elements) return findChildWithPrototypeChain(int2string(idx));
+	CScriptVarLinkWorkPtr child = elements->find(idx);
+	if(child) return child;
+	// the string-lookup is only needed if a prototype can have this index
+	CScriptVar *object = this;
+	for(int depth=0; depth<16; ++depth) {
+		CScriptVarLinkPtr __proto__ = object->findChild(atom___proto__);
+		if(!__proto__ || __proto__->getVarPtr().getVar() == object) return 0;
+		object = __proto__->getVarPtr().getVar();
+		if(object->elements ? object->elements->getLength() > idx : object->shape->getArrayLength() > idx)
+			break;
+	}
+	return findChildWithPrototypeChain(int2string(idx));
+}
 CScriptVarLinkPtr CScriptVar::findChildByPath(const string &path) {
 	string::size_type p = path.find('.');
 	CScriptVarLinkPtr child;
@@ -3311,7 +4089,12 @@ CScriptVarLinkPtr CScriptVar::findChildOrCreateByPath(const string &path) {
 void CScriptVar::keys(set<string> &Keys, bool OnlyEnumerable/*=true*/, uint32_t ID/*=0*/)
 {
 	if(ID) setTemporaryMark(ID);
+	installLazyNatives();
 	for(SCRIPTVAR_CHILDS_it it = Childs.begin(); it != Childs.end(); ++it) {
+		if(*it && (!OnlyEnumerable || (*it)->isEnumerable()))
+			Keys.insert((*it)->getName());
+	}
+	if(elements) for(CScriptVarElements::iterator it(*elements); it; ++it) {
 		if(!OnlyEnumerable || (*it)->isEnumerable())
 			Keys.insert((*it)->getName());
 	}
@@ -3320,21 +4103,44 @@ void CScriptVar::keys(set<string> &Keys, bool OnlyEnumerable/*=true*/, uint32_t
 		size_t length = isStringObj->stringLength();
 		for(size_t i=0; i<length; ++i)
 			Keys.insert(int2string(i));
+	} else if(isTypedArray()) { // the elements are not stored as Childs
+		uint32_t length = static_cast<CScriptVarTypedArray*>(this)->getLength();
+		for(uint32_t i=0; i<length; ++i)
+			Keys.insert(int2string(i));
 	}
 	CScriptVarLinkPtr __proto__;
-	if( ID && (__proto__ = findChild(TINYJS___PROTO___VAR)) && __proto__->getVarPtr()->getTemporaryMark() != ID )
+	if( ID && (__proto__ = findChild(atom___proto__)) && __proto__->getVarPtr()->getTemporaryMark() != ID )
 		__proto__->getVarPtr()->keys(Keys, OnlyEnumerable, ID);
 }
 
 /// add & remove
 CScriptVarLinkPtr CScriptVar::addChild(const string &childName, const CScriptVarPtr &child, int linkFlags /*= SCRIPTVARLINK_DEFAULT*/) {
+	return addChild(CScriptAtom(childName), child, linkFlags);
+}
+CScriptVarLinkPtr CScriptVar::addChild(const CScriptAtom &childName, const CScriptVarPtr &child, int linkFlags /*= SCRIPTVARLINK_DEFAULT*/) {
 	CScriptVarLinkPtr link;
-	SCRIPTVAR_CHILDS_it it = lower_bound(Childs.begin(), Childs.end(), childName);
-	if(it == Childs.end() || (*it)->getName() != childName) {
+	if(lazyNatives) installLazyNatives();
+	if(childName == atom___proto__) lazyPrototype = 0;
+	if(elements) {
+		uint32_t Idx = childName.getArrayIndex();
+		if(Idx != uint32_t(-1)) {
+			if(!elements->find(Idx))
+				link = elements->add(this, Idx, child?child:constScriptVar(Undefined), linkFlags);
+#ifdef _DEBUG
+			else
+				ASSERT(0); // addChild - the child exists 
+#endif
+			return link;
+		}
+	}
+	// an existing transition implies that the child not exists
+	CScriptVarShape *nextShape = shape->findTransition(childName);
+	if(nextShape || shape->findSlot(childName) == SHAPE_NO_SLOT) {
 		link = CScriptVarLinkPtr(child?child:constScriptVar(Undefined), childName, linkFlags);
 		link->setOwner(this);
 
-		Childs.insert(it, 1, link);
+		Childs.push_back(link);
+		setShape(nextShape ? nextShape : shape->addProperty(childName));
 #ifdef _DEBUG
 	} else {
 		ASSERT(0); // addChild - the child exists 
@@ -3346,23 +4152,60 @@ CScriptVarLinkPtr CScriptVar::addChildNoDup(const string &childName, const CScri
 	return addChildOrReplace(childName, child, linkFlags); 
 }
 CScriptVarLinkPtr CScriptVar::addChildOrReplace(const string &childName, const CScriptVarPtr &child, int linkFlags /*= SCRIPTVARLINK_DEFAULT*/) {
-	SCRIPTVAR_CHILDS_it it = lower_bound(Childs.begin(), Childs.end(), childName);
-	if(it == Childs.end() || (*it)->getName() != childName) {
+	return addChildOrReplace(CScriptAtom(childName), child, linkFlags);
+}
+CScriptVarLinkPtr CScriptVar::addChildOrReplace(const CScriptAtom &childName, const CScriptVarPtr &child, int linkFlags /*= SCRIPTVARLINK_DEFAULT*/) {
+	if(lazyNatives) installLazyNatives();
+	if(childName == atom___proto__) lazyPrototype = 0;
+	if(elements) {
+		uint32_t Idx = childName.getArrayIndex();
+		if(Idx != uint32_t(-1)) {
+			CScriptVarLinkPtr link = elements->find(Idx);
+			if(!link) return elements->add(this, Idx, child, linkFlags);
+			link->setVarPtr(child);
+			return link;
+		}
+	}
+	CScriptVarShape *nextShape = shape->findTransition(childName);
+	uint32_t slot = nextShape ? SHAPE_NO_SLOT : shape->findSlot(childName);
+	if(slot == SHAPE_NO_SLOT) {
 		CScriptVarLinkPtr link(child, childName, linkFlags);
 		link->setOwner(this);
-		Childs.insert(it, 1, link);
+		Childs.push_back(link);
+		setShape(nextShape ? nextShape : shape->addProperty(childName));
 		return link;
 	} else {
-		(*it)->setVarPtr(child);
-		return (*it);
+		Childs[slot]->setVarPtr(child);
+		return Childs[slot];
 	}
 }
 
 bool CScriptVar::removeLink(CScriptVarLinkPtr &link) {
 	if (!link) return false;
-	SCRIPTVAR_CHILDS_it it = lower_bound(Childs.begin(), Childs.end(), link->getName());
-	if(it != Childs.end() && (*it) == link) {
-		Childs.erase(it);
+	if(elements && link->isElement()) {
+#ifdef _DEBUG
+		ASSERT(elements->remove(link)); // removeLink - the link is not atached to this var 
+#else
+		elements->remove(link);
+#endif
+		link.clear();
+		return true;
+	}
+	uint32_t slot = shape->findSlot(link->getAtom());
+	if(slot != SHAPE_NO_SLOT && Childs[slot] == link) {
+		CScriptVarShape *nextShape = shape->removeProperty(slot);
+		if(nextShape->isDictionary()) // leaves a hole
+			Childs[slot].clear();
+		else
+			Childs.erase(Childs.begin()+slot);
+		setShape(nextShape);
+		if(shape->needsCompaction()) { // more than the half are holes -> each remove pays for one moved slot
+			shape->compact();
+			SCRIPTVAR_CHILDS_it to = Childs.begin();
+			for(SCRIPTVAR_CHILDS_it it = Childs.begin(); it != Childs.end(); ++it)
+				if(*it) *to++ = *it;
+			Childs.erase(to, Childs.end());
+		}
 #ifdef _DEBUG
 	} else {
 		ASSERT(0); // removeLink - the link is not atached to this var 
@@ -3372,29 +4215,46 @@ bool CScriptVar::removeLink(CScriptVarLinkPtr &link) {
 	return true;
 }
 void CScriptVar::removeAllChildren() {
+	if(lazyNatives) {
+		lazyNatives = false;
+		context->removeLazyNatives(this);
+	}
 	Childs.clear();
+	setShape(context->getRootShape());
+	if(elements) elements->clear();
 }
 
 CScriptVarPtr CScriptVar::getArrayIndex(uint32_t idx) {
-	CScriptVarLinkPtr link = findChild(int2string(idx));
+	CScriptVarLinkPtr link = getArrayIndexLink(idx);
 	if (link) return link;
 	else return constScriptVar(Undefined); // undefined
 }
 
-void CScriptVar::setArrayIndex(uint32_t idx, const CScriptVarPtr &value) {
-	string sIdx = int2string(idx);
-	CScriptVarLinkPtr link = findChild(sIdx);
+CScriptVarLinkPtr CScriptVar::getArrayIndexLink(uint32_t idx) {
+	if(elements) return elements->find(idx);
+	return findChild(int2string(idx));
+}
 
-	if (link) {
+CScriptVarLinkPtr CScriptVar::setArrayIndex(uint32_t idx, const CScriptVarPtr &value) {
+	if(elements) {
+		CScriptVarLinkPtr link = elements->find(idx);
+		if(!link) return elements->add(this, idx, value, SCRIPTVARLINK_DEFAULT);
 		link->setVarPtr(value);
-	} else {
-		addChild(sIdx, value);
+		return link;
 	}
+	return addChildOrReplace(int2string(idx), value);
 }
 
 uint32_t CScriptVar::getArrayLength() {
-	if (!isArray() || Childs.size()==0) return 0;
-	return isArrayIndex(Childs.back()->getName())+1; 
+	if (!elements) return 0;
+	return elements->getLength(); 
+}
+
+size_t CScriptVar::getChildren() {
+	installLazyNatives();
+	size_t count = Childs.size() - shape->getHoleCount();
+	if(elements) for(CScriptVarElements::iterator it(*elements); it; ++it) ++count;
+	return count;
 }
 
 CScriptVarPtr CScriptVar::mathsOp(const CScriptVarPtr &b, int op) {
@@ -3422,7 +4282,12 @@ void CScriptVar::trace(string &indentStr, uint32_t uniqueID, const string &name)
 	if(getTemporaryMark() != uniqueID) {
 		setTemporaryMark(uniqueID);
 		indentStr+=indent;
+		installLazyNatives();
 		for(SCRIPTVAR_CHILDS_it it = Childs.begin(); it != Childs.end(); ++it) {
+			if(*it && (*it)->isEnumerable())
+				(*it)->getVarPtr()->trace(indentStr, uniqueID, (*it)->getName());
+		}
+		if(elements) for(CScriptVarElements::iterator it(*elements); it; ++it) {
 			if((*it)->isEnumerable())
 				(*it)->getVarPtr()->trace(indentStr, uniqueID, (*it)->getName());
 		}
@@ -3463,25 +4328,53 @@ int CScriptVar::getRefs() {
 
 void CScriptVar::setTemporaryMark_recursive(uint32_t ID)
 {
-	if(getTemporaryMark() != ID) {
-		setTemporaryMark(ID);
-		for(SCRIPTVAR_CHILDS_it it = Childs.begin(); it != Childs.end(); ++it) {
-			(*it)->getVarPtr()->setTemporaryMark_recursive(ID);
-		}
+	vector<CScriptVar*> stack(1, this);
+	while(!stack.empty()) {
+		CScriptVar *var = stack.back();
+		stack.pop_back();
+		if(var->getTemporaryMark() == ID) continue;
+		var->setTemporaryMark(ID);
+		var->getReferences(stack);
+		var->getWeakReferences(stack);
 	}
 }
 
+void CScriptVar::getReferences(vector<CScriptVar*> &Refs) {
+	for(SCRIPTVAR_CHILDS_it it = Childs.begin(); it != Childs.end(); ++it)
+		if(*it) Refs.push_back((*it)->getVarPtr().getVar());
+	if(elements) for(CScriptVarElements::iterator it(*elements); it; ++it)
+		Refs.push_back((*it)->getVarPtr().getVar());
+}
+void CScriptVar::getWeakReferences(vector<CScriptVar*> &Refs) {}
+void CScriptVar::removeWeakReferences(uint32_t Epoch) {}
+
+CScriptVarPtr CScriptVar::fork() { return clone(); }
+
+void CScriptVar::forkReferences(CScriptVarForker &Forker) {
+	for(SCRIPTVAR_CHILDS_it it = Childs.begin(); it != Childs.end(); ++it)
+		if(*it) (*it)->setVarPtr(Forker.getFork((*it)->getVarPtr().getVar()));
+	if(elements) for(CScriptVarElements::iterator it(*elements); it; ++it)
+		(*it)->setVarPtr(Forker.getFork((*it)->getVarPtr().getVar()));
+}
+
 
 //////////////////////////////////////////////////////////////////////////
 /// CScriptVarLink
 //////////////////////////////////////////////////////////////////////////
 
-CScriptVarLink::CScriptVarLink(const CScriptVarPtr &Var, const string &Name /*=TINYJS_TEMP_NAME*/, int Flags /*=SCRIPTVARLINK_DEFAULT*/) 
-	: name(Name), owner(0), flags(Flags), refs(0) {
+CScriptVarLink::CScriptVarLink(const CScriptVarPtr &Var, const CScriptAtom &Name /*=CScriptAtom()*/, int Flags /*=SCRIPTVARLINK_DEFAULT*/) 
+	: name(Name), owner(0), flags(Flags), elementIndex(uint32_t(-1)), refs(0) {
+#if DEBUG_MEMORY
+	mark_allocated(this);
+#endif
+	setVarPtr(Var);
+}
+CScriptVarLink::CScriptVarLink(const CScriptVarPtr &Var, uint32_t ElementIndex, int Flags /*=SCRIPTVARLINK_DEFAULT*/) 
+	: owner(0), flags(Flags), elementIndex(ElementIndex), refs(0) {
 #if DEBUG_MEMORY
 	mark_allocated(this);
 #endif
-	var = Var;
+	setVarPtr(Var);
 }
 
 CScriptVarLink::~CScriptVarLink() {
@@ -3506,12 +4399,13 @@ void CScriptVarLink::unref() {
 /// CScriptVarLinkPtr
 //////////////////////////////////////////////////////////////////////////
 
-CScriptVarLinkPtr & CScriptVarLinkPtr::operator()( const CScriptVarPtr &var, const string &name /*= TINYJS_TEMP_NAME*/, int flags /*= SCRIPTVARLINK_DEFAULT*/ ) {
+CScriptVarLinkPtr & CScriptVarLinkPtr::operator()( const CScriptVarPtr &var, const CScriptAtom &name /*= CScriptAtom()*/, int flags /*= SCRIPTVARLINK_DEFAULT*/ ) {
 	if(link && link->refs == 1) { // the link is only refered by this
 		link->name = name;
 		link->owner = 0;
 		link->flags = flags;
-		link->var = var;
+		link->elementIndex = uint32_t(-1);
+		link->setVarPtr(var);
 	} else {
 		if(link) link->unref();
 		link = (new CScriptVarLink(var, name, flags))->ref();
@@ -3535,20 +4429,6 @@ CScriptVarLinkWorkPtr CScriptVarLinkPtr::setter( CScriptResult &execute, const C
 	return CScriptVarLinkWorkPtr(*this).setter(execute, Var);
 }
 
-bool CScriptVarLinkPtr::operator <(const string &rhs) const {
-	uint32_t lhs_int = isArrayIndex(link->getName());
-	uint32_t rhs_int = isArrayIndex(rhs);
-	if(lhs_int==uint32_t(-1)) {
-		if(rhs_int==uint32_t(-1)) 
-			return link->getName() < rhs;
-		else 
-			return true;
-	} else if(rhs_int==uint32_t(-1)) 
-		return false;
-	return lhs_int < rhs_int;
-}
-
-
 //////////////////////////////////////////////////////////////////////////
 /// CScriptVarLinkWorkPtr
 //////////////////////////////////////////////////////////////////////////
@@ -3597,51 +4477,270 @@ CScriptVarLinkWorkPtr CScriptVarLinkWorkPtr::setter( CScriptResult &execute, con
 					ASSERT(getReferencedOwner());
 					setter->getVarPtr()->getContext()->callFunction(execute, setter->getVarPtr(), Params, getReferencedOwner());
 				}
+			} else if(isTypedArrayElement()) {
+				CScriptVarTypedArray *typedArray = static_cast<CScriptVarTypedArray*>(referencedOwner.getVar());
+				CNumber value = Var->toNumber(execute);
+				if(execute && link->getElementIndex() < typedArray->getLength())
+					typedArray->setElement(link->getElementIndex(), value);
+				link->setVarPtr(Var);
 			} else
 				link->setVarPtr(Var);
 		}
 	}
 	return *this;
 }
+bool CScriptVarLinkWorkPtr::isTypedArrayElement() const {
+	return link && !link->isOwned() && link->isElement() && referencedOwner && referencedOwner->isTypedArray();
+}
 
 
-////////////////////////////////////////////////////////////////////////// 
-/// CScriptVarPrimitive
+//////////////////////////////////////////////////////////////////////////
+/// CScriptVarElements
 //////////////////////////////////////////////////////////////////////////
 
-CScriptVarPrimitive::~CScriptVarPrimitive(){}
+CScriptVarLinkPtr CScriptVarElements::add(CScriptVar *Owner, uint32_t Idx, const CScriptVarPtr &Var, int Flags) {
+	ASSERT(!find(Idx));
+	CScriptVarLinkPtr link(Var, Idx, Flags);
+	link->setOwner(Owner);
+	if(Idx < dense.size())
+		dense[Idx] = link;
+	else if(Idx-dense.size() <= ELEMENTS_MAX_GAP || Idx < 2*dense.size()) {
+		dense.resize(Idx+1);
+		dense[Idx] = link;
+		// move the sparse elements into the dense part
+		while(!sparse.empty() && sparse.begin()->first < dense.size()) {
+			dense[sparse.begin()->first] = sparse.begin()->second;
+			sparse.erase(sparse.begin());
+		}
+	} else
+		sparse[Idx] = link;
+	return link;
+}
 
-bool CScriptVarPrimitive::isPrimitive() { return true; }
-CScriptVarPrimitivePtr CScriptVarPrimitive::getRawPrimitive() { return this; }
-bool CScriptVarPrimitive::toBoolean() { return false; }
-CScriptVarPtr CScriptVarPrimitive::toObject() { return this; }
-CScriptVarPtr CScriptVarPrimitive::toString_CallBack( CScriptResult &execute, int radix/*=0*/ ) {
-	return newScriptVar(toCString(radix));
+bool CScriptVarElements::remove(const CScriptVarLinkPtr &Link) {
+	uint32_t Idx = Link->getElementIndex();
+	if(Idx < dense.size()) {
+		if(!(dense[Idx] == Link)) return false;
+		dense[Idx].clear();
+		while(!dense.empty() && !dense.back()) dense.pop_back();
+	} else {
+		SPARSE_t::iterator it = sparse.find(Idx);
+		if(it == sparse.end() || !(it->second == Link)) return false;
+		sparse.erase(it);
+	}
+	Link->setOwner(0);
+	return true;
 }
 
+void CScriptVarElements::clear() {
+	for(iterator it(*this); it; ++it)
+		(*it)->setOwner(0);
+	dense.clear();
+	sparse.clear();
+}
 
-////////////////////////////////////////////////////////////////////////// 
-// CScriptVarUndefined
-//////////////////////////////////////////////////////////////////////////
+void CScriptVarElements::copy(const CScriptVarElements &Copy, CScriptVar *Owner) {
+	clear();
+	dense.resize(Copy.dense.size());
+	for(size_t idx=0; idx<Copy.dense.size(); ++idx) {
+		if(Copy.dense[idx]) {
+			dense[idx] = CScriptVarLinkPtr(Copy.dense[idx]->getVarPtr(), uint32_t(idx), Copy.dense[idx]->getFlags());
+			dense[idx]->setOwner(Owner);
+		}
+	}
+	for(SPARSE_t::const_iterator it = Copy.sparse.begin(); it != Copy.sparse.end(); ++it) {
+		CScriptVarLinkPtr &link = sparse[it->first];
+		link = CScriptVarLinkPtr(it->second->getVarPtr(), it->first, it->second->getFlags());
+		link->setOwner(Owner);
+	}
+}
 
-declare_dummy_t(Undefined);
-CScriptVarUndefined::CScriptVarUndefined(CTinyJS *Context) : CScriptVarPrimitive(Context, Context->objectPrototype) { }
-CScriptVarUndefined::~CScriptVarUndefined() {}
-CScriptVarPtr CScriptVarUndefined::clone() { return new CScriptVarUndefined(*this); }
-bool CScriptVarUndefined::isUndefined() { return true; }
 
-CNumber CScriptVarUndefined::toNumber_Callback() { return NaN; }
-string CScriptVarUndefined::toCString(int radix/*=0*/) { return "undefined"; }
-string CScriptVarUndefined::getVarType() { return "undefined"; }
+//////////////////////////////////////////////////////////////////////////
+/// CScriptVarForker
+//////////////////////////////////////////////////////////////////////////
 
+static inline size_t forkerHash(const void *P) {
+	uint64_t h = uint64_t(uintptr_t(P));
+	h ^= h >> 33; h *= 0xff51afd7ed558ccdULL;
+	return size_t(h ^ (h >> 33));
+}
+void *CScriptVarForker::CPointerMap::find(const void *Key) const {
+	if(table.empty()) return 0;
+	size_t mask = table.size()-1;
+	for(size_t i = forkerHash(Key) & mask; table[i].first; i = (i+1) & mask)
+		if(table[i].first == Key) return table[i].second;
+	return 0;
+}
+void *&CScriptVarForker::CPointerMap::operator[](const void *Key) {
+	if((count+1)*2 > table.size()) { // grow
+		vector<pair<const void *, void *> > old(max(table.size()*2, size_t(256)), pair<const void *, void *>(0, 0));
+		old.swap(table);
+		size_t mask = table.size()-1;
+		for(vector<pair<const void *, void *> >::iterator it = old.begin(); it != old.end(); ++it) {
+			if(!it->first) continue;
+			size_t i = forkerHash(it->first) & mask;
+			while(table[i].first) i = (i+1) & mask;
+			table[i] = *it;
+		}
+	}
+	size_t mask = table.size()-1;
+	size_t i = forkerHash(Key) & mask;
+	for(; table[i].first; i = (i+1) & mask)
+		if(table[i].first == Key) return table[i].second;
+	table[i].first = Key;
+	++count;
+	return table[i].second;
+}
 
-////////////////////////////////////////////////////////////////////////// 
-// CScriptVarNull
-//////////////////////////////////////////////////////////////////////////
+CScriptVarForker::CScriptVarForker(CTinyJS *From, CTinyJS *To) : from(From), to(To) {
+	to->rootShape->id = from->rootShape->id; // the copied shape-tree starts with the same (empty) shape
+	shapes[from->rootShape] = to->rootShape;
+}
 
-declare_dummy_t(Null);
-CScriptVarNull::CScriptVarNull(CTinyJS *Context) : CScriptVarPrimitive(Context, Context->objectPrototype) { }
-CScriptVarNull::~CScriptVarNull() {}
+void CScriptVarForker::fork() {
+	ASSERT(!from->t && !from->forker); // From must not execute a script
+	// find the reachable vars (with an explicit stack - no recursion)
+	vector<CScriptVar*> stack;
+	for(vector<CScriptVarPtr*>::iterator it = from->pseudo_refered.begin(); it!=from->pseudo_refered.end(); ++it)
+		if(**it) stack.push_back((*it)->getVar());
+	for(int i=Error; i<ERROR_COUNT; i++)
+		if(from->errorPrototypes[i]) stack.push_back(from->errorPrototypes[i].getVar());
+	stack.push_back(from->root.getVar());
+	while(stack.size()) {
+		CScriptVar *var = stack.back();
+		stack.pop_back();
+		if(!var) continue;
+		void *&found = vars[var];
+		if(found) continue;
+		found = var;
+		originals.push_back(var);
+		var->getReferences(stack);
+		var->getWeakReferences(stack);
+	}
+
+	// copy the vars - the copies refers the original vars
+	from->forker = this;
+	forks.reserve(originals.size());
+	for(vector<CScriptVar*>::iterator it = originals.begin(); it != originals.end(); ++it) {
+		forks.push_back((*it)->fork());
+		vars[*it] = forks.back().getVar();
+	}
+	from->forker = 0;
+
+	// and replace these references
+	for(vector<CScriptVarPtr>::iterator it = forks.begin(); it != forks.end(); ++it)
+		(*it)->forkReferences(*this);
+
+	// the roots
+	for(vector<CScriptVarPtr*>::iterator it = from->pseudo_refered.begin(); it!=from->pseudo_refered.end(); ++it) {
+		const char *member = (const char *)*it;
+		if(member < (const char *)from || member >= (const char *)(from+1)) continue; // an entry of intCache (see below)
+		CScriptVarPtr *fork = const_cast<CScriptVarPtr*>(forkMember(*it));
+		*fork = **it;
+		forkPtr(*fork);
+		to->pseudo_refered.push_back(fork);
+	}
+	for(size_t block=0; block<from->intCache.size(); ++block) {
+		if(from->intCache[block].empty()) continue;
+		to->intCache[block].resize(from->intCache[block].size());
+		for(size_t i=0; i<from->intCache[block].size(); ++i) {
+			if(!from->intCache[block][i]) continue;
+			to->intCache[block][i] = getFork(from->intCache[block][i].getVar());
+			to->pseudo_refered.push_back(&to->intCache[block][i]);
+		}
+	}
+	for(int i=Error; i<ERROR_COUNT; i++) {
+		to->errorPrototypes[i] = from->errorPrototypes[i];
+		forkPtr(to->errorPrototypes[i]);
+	}
+	to->root = CScriptVarScopePtr(getFork(from->root.getVar()));
+	to->scopes.push_back(to->root);
+	for(vector<pair<CScriptVar *, JSLazyNativesCallback> >::iterator it = from->lazyNatives.begin(); it != from->lazyNatives.end(); ++it) {
+		void *fork = vars.find(it->first);
+		if(fork) to->lazyNatives.push_back(make_pair(static_cast<CScriptVar*>(fork), it->second));
+	}
+
+	// the settings
+	to->useBytecode = from->useBytecode;
+	to->collectorBudget = from->collectorBudget;
+	to->native_require_read = from->native_require_read;
+#ifndef NO_REGEXP
+	to->regexCache = from->regexCache;
+	to->regexCache.resetStats();
+#endif /* NO_REGEXP */
+	to->collectThreshold = max(uint32_t(CYCLE_COLLECTOR_MIN_THRESHOLD), to->varCount*2);
+	forks.clear(); // the copies are referenced by the roots now
+}
+
+CScriptVar *CScriptVarForker::getFork(CScriptVar *Var) {
+	if(!Var) return 0;
+	void *fork = vars.find(Var);
+	ASSERT(fork && fork != Var); // Var is not reachable from the roots
+	return fork ? static_cast<CScriptVar*>(fork) : Var;
+}
+
+CScriptVarShape *CScriptVarForker::forkShape(CScriptVarShape *Shape) {
+	if(Shape->isDictionary()) return Shape->cloneDictionary(); // owned by the var
+	void *fork = shapes.find(Shape);
+	if(fork) return static_cast<CScriptVarShape*>(fork);
+	CScriptVarShape *parent = forkShape(Shape->parent);
+	CScriptVarShape *&next = parent->transitions[Shape->name];
+	if(!next) next = new CScriptVarShape(Shape, parent);
+	shapes[Shape] = next;
+	return next;
+}
+
+CScriptTokenData *CScriptVarForker::forkTokenData(CScriptTokenData *Data) {
+	void *&fork = tokenData[Data];
+	if(!fork) fork = Data->fork(*this); // the reference of fork is set by the caller
+	return static_cast<CScriptTokenData*>(fork);
+}
+
+const CScriptVarPtr *CScriptVarForker::forkMember(const CScriptVarPtr *Member) {
+	if(!Member) return 0;
+	ASSERT((const char *)Member >= (const char *)from && (const char *)Member < (const char *)(from+1));
+	return (const CScriptVarPtr *)((const char *)to + ((const char *)Member - (const char *)from));
+}
+
+
+////////////////////////////////////////////////////////////////////////// 
+/// CScriptVarPrimitive
+//////////////////////////////////////////////////////////////////////////
+
+CScriptVarPrimitive::~CScriptVarPrimitive(){}
+
+bool CScriptVarPrimitive::isPrimitive() { return true; }
+CScriptVarPrimitivePtr CScriptVarPrimitive::getRawPrimitive() { return this; }
+bool CScriptVarPrimitive::toBoolean() { return false; }
+CScriptVarPtr CScriptVarPrimitive::toObject() { return this; }
+CScriptVarPtr CScriptVarPrimitive::toString_CallBack( CScriptResult &execute, int radix/*=0*/ ) {
+	return newScriptVar(toCString(radix));
+}
+
+
+////////////////////////////////////////////////////////////////////////// 
+// CScriptVarUndefined
+//////////////////////////////////////////////////////////////////////////
+
+declare_dummy_t(Undefined);
+CScriptVarUndefined::CScriptVarUndefined(CTinyJS *Context) : CScriptVarPrimitive(Context, Context->objectPrototype) { }
+CScriptVarUndefined::~CScriptVarUndefined() {}
+CScriptVarPtr CScriptVarUndefined::clone() { return new CScriptVarUndefined(*this); }
+bool CScriptVarUndefined::isUndefined() { return true; }
+
+CNumber CScriptVarUndefined::toNumber_Callback() { return NaN; }
+string CScriptVarUndefined::toCString(int radix/*=0*/) { return "undefined"; }
+string CScriptVarUndefined::getVarType() { return "undefined"; }
+
+
+////////////////////////////////////////////////////////////////////////// 
+// CScriptVarNull
+//////////////////////////////////////////////////////////////////////////
+
+declare_dummy_t(Null);
+CScriptVarNull::CScriptVarNull(CTinyJS *Context) : CScriptVarPrimitive(Context, Context->objectPrototype) { }
+CScriptVarNull::~CScriptVarNull() {}
 CScriptVarPtr CScriptVarNull::clone() { return new CScriptVarNull(*this); }
 bool CScriptVarNull::isNull() { return true; }
 
@@ -3650,12 +4749,97 @@ string CScriptVarNull::toCString(int radix/*=0*/) { return "null"; }
 string CScriptVarNull::getVarType() { return "null"; }
 
 
+//////////////////////////////////////////////////////////////////////////
+/// CScriptStringRef
+//////////////////////////////////////////////////////////////////////////
+
+const size_t CScriptStringRef::npos;
+
+CScriptStringRef::CScriptStringRef(const string &Str) : buffer(0), offset(0), len(Str.size()) {
+	if(len) {
+		buffer = new Buffer;
+		buffer->str = Str;
+	}
+}
+CScriptStringRef::CScriptStringRef(const char *Str) : buffer(0), offset(0), len(strlen(Str)) {
+	if(len) {
+		buffer = new Buffer;
+		buffer->str.assign(Str, len);
+	}
+}
+CScriptStringRef &CScriptStringRef::operator=(const CScriptStringRef &Copy) {
+	if(Copy.buffer) ++Copy.buffer->refs;
+	release();
+	buffer = Copy.buffer;
+	offset = Copy.offset;
+	len = Copy.len;
+	return *this;
+}
+CScriptStringRef CScriptStringRef::take(string &Str) {
+	CScriptStringRef ret;
+	if(Str.size()) {
+		ret.buffer = new Buffer;
+		ret.buffer->str.swap(Str);
+		ret.len = ret.buffer->str.size();
+	}
+	return ret;
+}
+
+const string &CScriptStringRef::compact() {
+	if(!buffer) {
+		static const string empty;
+		return empty;
+	}
+	if(offset || len != buffer->str.size()) {
+		string part(data(), len);
+		*this = take(part);
+	}
+	return buffer->str;
+}
+
+CScriptStringRef CScriptStringRef::substr(size_t Pos, size_t Len/*=npos*/) const {
+	CScriptStringRef ret;
+	if(Pos > len) throw out_of_range("CScriptStringRef::substr");
+	if(Len > len-Pos) Len = len-Pos;
+	if(Len && Len < buffer->str.size()/STRING_VIEW_MIN_SHARE) { // a small slice must not keep a big buffer alive
+		ret.buffer = new Buffer;
+		ret.buffer->str.assign(data()+Pos, Len);
+		ret.len = Len;
+	} else if(Len) {
+		ret.buffer = buffer;
+		++buffer->refs;
+		ret.offset = offset+Pos;
+		ret.len = Len;
+	}
+	return ret;
+}
+
+size_t CScriptStringRef::find(const char *Str, size_t Pos, size_t Len) const {
+	if(Pos > len || Len > len-Pos) return npos;
+	const char *begin = data(), *it = search(begin+Pos, begin+len, Str, Str+Len);
+	return it == begin+len && Len ? npos : size_t(it-begin);
+}
+size_t CScriptStringRef::rfind(const char *Str, size_t Pos, size_t Len) const {
+	if(Len > len) return npos;
+	if(Pos > len-Len) Pos = len-Len;
+	const char *begin = data();
+	for(size_t at = Pos+1; at-- > 0; )
+		if(memcmp(begin+at, Str, Len) == 0) return at;
+	return npos;
+}
+int CScriptStringRef::compare(const char *Str, size_t Len) const {
+	int ret = memcmp(data(), Str, min(len, Len));
+	if(ret) return ret;
+	return len < Len ? -1 : len > Len ? 1 : 0;
+}
+
+
 //////////////////////////////////////////////////////////////////////////
 /// CScriptVarString
 //////////////////////////////////////////////////////////////////////////
 
-CScriptVarString::CScriptVarString(CTinyJS *Context, const string &Data) : CScriptVarPrimitive(Context, Context->stringPrototype), data(Data) {
-	addChild("length", newScriptVar(data.size()), SCRIPTVARLINK_CONSTANT);
+CScriptVarString::CScriptVarString(CTinyJS *Context, const CScriptStringRef &Data) : CScriptVarPrimitive(Context, Context->stringPrototype), data(Data), length(data.size()) {
+	addChild("length", newScriptVar(length), SCRIPTVARLINK_CONSTANT);
 /*
 	CScriptVarLinkPtr acc = addChild("length", newScriptVar(Accessor), 0);
 	CScriptVarFunctionPtr getter(::newScriptVar(Context, this, &CScriptVarString::native_Length, 0));
@@ -3663,20 +4847,26 @@ CScriptVarString::CScriptVarString(CTinyJS *Context, const string &Data) : CScri
 	acc->getVarPtr()->addChild(TINYJS_ACCESSOR_GET_VAR, getter, 0);
 */
 }
-CScriptVarString::~CScriptVarString() {}
+CScriptVarString::CScriptVarString(CTinyJS *Context, const CScriptVarStringPtr &Left, const CScriptVarStringPtr &Right)
+	: CScriptVarPrimitive(Context, Context->stringPrototype), length(Left->length+Right->length), left(Left), right(Right) {
+	addChild("length", newScriptVar(length), SCRIPTVARLINK_CONSTANT);
+}
+CScriptVarString::~CScriptVarString() {
+	if(left) releaseRope();
+}
 CScriptVarPtr CScriptVarString::clone() { return new CScriptVarString(*this); }
 bool CScriptVarString::isString() { return true; }
 
-bool CScriptVarString::toBoolean() { return data.length()!=0; }
-CNumber CScriptVarString::toNumber_Callback() { return data.c_str(); }
-string CScriptVarString::toCString(int radix/*=0*/) { return data; }
+bool CScriptVarString::toBoolean() { return length!=0; }
+CNumber CScriptVarString::toNumber_Callback() { return getString().str().c_str(); }
+string CScriptVarString::toCString(int radix/*=0*/) { return getString().str(); }
 
-string CScriptVarString::getParsableString(const string &indentString, const string &indent, uint32_t uniqueID, bool &hasRecursion) { return indentString+getJSString(data); }
+string CScriptVarString::getParsableString(const string &indentString, const string &indent, uint32_t uniqueID, bool &hasRecursion) { return indentString+getJSString(getString().str()); }
 string CScriptVarString::getVarType() { return "string"; }
 
 CScriptVarPtr CScriptVarString::toObject() { 
 	CScriptVarPtr ret = newScriptVar(CScriptVarPrimitivePtr(this), context->stringPrototype); 
-	ret->addChild("length", newScriptVar(data.size()), SCRIPTVARLINK_CONSTANT);
+	ret->addChild("length", newScriptVar(length), SCRIPTVARLINK_CONSTANT);
 	return ret;
 }
 
@@ -3684,11 +4874,83 @@ CScriptVarPtr CScriptVarString::toString_CallBack( CScriptResult &execute, int r
 	return this;
 }
 
+void CScriptVarString::getReferences(vector<CScriptVar*> &Refs) {
+	CScriptVar::getReferences(Refs);
+	if(left) {
+		Refs.push_back(left.getVar());
+		Refs.push_back(right.getVar());
+	}
+}
+void CScriptVarString::forkReferences(CScriptVarForker &Forker) {
+	CScriptVar::forkReferences(Forker);
+	Forker.forkPtr(left);
+	Forker.forkPtr(right);
+}
+
 int CScriptVarString::getChar(uint32_t Idx) {
-	if((string::size_type)Idx >= data.length())
+	if((string::size_type)Idx >= length)
 		return -1;
 	else
-		return (unsigned char)data[Idx];
+		return (unsigned char)getString()[Idx];
+}
+
+void CScriptVarString::flatten() {
+	// iterative - a rope built in a loop is a deep tree
+	string flat;
+	flat.reserve(length);
+	vector<CScriptVarString*> stack(1, this);
+	while(!stack.empty()) {
+		CScriptVarString *part = stack.back();
+		stack.pop_back();
+		if(part->left) {
+			stack.push_back(static_cast<CScriptVarString*>(part->right.getVar()));
+			stack.push_back(static_cast<CScriptVarString*>(part->left.getVar()));
+		} else
+			flat.append(part->data.data(), part->data.size());
+	}
+	data = CScriptStringRef::take(flat);
+	releaseRope();
+}
+
+void CScriptVarString::releaseRope() {
+	// releases the parts iterative - otherwise the destructors of a deep rope recurses once per piece
+	vector<CScriptVarStringPtr> parts;
+	parts.push_back(left); left.clear();
+	parts.push_back(right); right.clear();
+	while(!parts.empty()) {
+		CScriptVarPtr part = parts.back();
+		parts.pop_back();
+		CScriptVarString *str = static_cast<CScriptVarString*>(part.getVar());
+		if(str->getRefs() == 1 && str->left) { // our's is the last reference -> take over the parts
+			parts.push_back(str->left); str->left.clear();
+			parts.push_back(str->right); str->right.clear();
+		}
+	}
+}
+
+define_newScriptVar_Fnc(String, CTinyJS *Context, const string &Obj) {
+	if(Obj.size() == 1) return Context->cachedChar(Obj[0]);
+	return new CScriptVarString(Context, Obj);
+}
+define_newScriptVar_Fnc(String, CTinyJS *Context, const char *Obj) {
+	if(Obj[0] && !Obj[1]) return Context->cachedChar(Obj[0]);
+	return new CScriptVarString(Context, Obj);
+}
+define_newScriptVar_Fnc(String, CTinyJS *Context, const CScriptStringRef &Obj) {
+	if(Obj.size() == 1) return Context->cachedChar(Obj[0]);
+	return new CScriptVarString(Context, Obj);
+}
+
+define_newScriptVar_NamedFnc(StringConcat, CTinyJS *Context, const CScriptVarStringPtr &Left, const CScriptVarStringPtr &Right) {
+	CScriptVarString *left = static_cast<CScriptVarString*>(Left.getVar()), *right = static_cast<CScriptVarString*>(Right.getVar());
+	if(right->length == 0) return Left;
+	if(left->length == 0) return Right;
+	if(left->length+right->length < STRING_ROPE_MIN_LENGTH) {
+		string flat(left->getString().str());
+		flat.append(right->getString().data(), right->length);
+		return new CScriptVarString(Context, CScriptStringRef::take(flat));
+	}
+	return new CScriptVarString(Context, Left, Right);
 }
 
 
@@ -4232,6 +5494,20 @@ define_newScriptVar_Fnc(Number, CTinyJS *Context, const CNumber &Obj) {
 		if(Obj.isNaN()) return Context->constScriptVar(NaN);
 		if(Obj.isInfinity()) return Context->constScriptVar(Infinity(Obj.sign()));
 		if(Obj.isNegativeZero()) return Context->constScriptVar(NegativeZero);
+	} else if(Obj.isInt32()) {
+		int32_t Value = Obj.toInt32();
+		if(Value >= VALUE_CACHE_INT_MIN && Value <= VALUE_CACHE_INT_MAX) {
+			uint32_t idx = uint32_t(Value-VALUE_CACHE_INT_MIN);
+			vector<CScriptVarPtr> &block = Context->intCache[idx/VALUE_CACHE_INT_BLOCK];
+			if(block.empty()) block.resize(VALUE_CACHE_INT_BLOCK);
+			CScriptVarPtr &cached = block[idx%VALUE_CACHE_INT_BLOCK];
+			if(!cached) {
+				cached = new CScriptVarNumber(Context, Obj);
+				cached->setShared();
+				Context->pseudo_refered.push_back(&cached);
+			}
+			return cached;
+		}
 	}
 	return new CScriptVarNumber(Context, Obj); 
 }
@@ -4278,10 +5554,11 @@ string CScriptVarObject::getParsableString(const string &indentString, const str
 	const char *nl = indent.size() ? "\n" : " ";
 	const char *comma = "";
 	destination.append("{");
-	if(Childs.size()) {
+	installLazyNatives();
+	if(Childs.size() > shape->getHoleCount()) {
 		string new_indentString = indentString + indent;
 		for(SCRIPTVAR_CHILDS_it it = Childs.begin(); it != Childs.end(); ++it) {
-			if((*it)->isEnumerable()) {
+			if(*it && (*it)->isEnumerable()) {
 				destination.append(comma); comma=",";
 				destination.append(nl).append(new_indentString).append(getIDString((*it)->getName()));
 				destination.append(" : ");
@@ -4309,9 +5586,13 @@ CScriptVarPtr CScriptVarObject::toString_CallBack(CScriptResult &execute, int ra
 	return newScriptVar("[object "+getVarTypeTagName()+"]"); 
 };
 
-void CScriptVarObject::setTemporaryMark_recursive( uint32_t ID) {
-	CScriptVar::setTemporaryMark_recursive(ID);
-	if(value) value->setTemporaryMark_recursive(ID);
+void CScriptVarObject::getReferences(vector<CScriptVar*> &Refs) {
+	CScriptVar::getReferences(Refs);
+	if(value) Refs.push_back(value.getVar());
+}
+void CScriptVarObject::forkReferences(CScriptVarForker &Forker) {
+	CScriptVar::forkReferences(Forker);
+	Forker.forkPtr(value);
 }
 
 
@@ -4381,13 +5662,21 @@ CScriptException CScriptVarError::toCScriptException()
 
 declare_dummy_t(Array);
 CScriptVarArray::CScriptVarArray(CTinyJS *Context) : CScriptVarObject(Context, Context->arrayPrototype), toStringRecursion(false) {
+	elements = &arrayElements;
 	CScriptVarLinkPtr acc = addChild("length", newScriptVar(Accessor), 0);
 	CScriptVarFunctionPtr getter(::newScriptVar(Context, this, &CScriptVarArray::native_Length, 0));
 	getter->setFunctionData(new CScriptTokenDataFnc);
 	acc->getVarPtr()->addChild(TINYJS_ACCESSOR_GET_VAR, getter, 0);
 }
 
-CScriptVarArray::~CScriptVarArray() {}
+CScriptVarArray::CScriptVarArray(const CScriptVarArray &Copy) : CScriptVarObject(Copy), toStringRecursion(Copy.toStringRecursion) {
+	arrayElements.copy(Copy.arrayElements, this);
+	elements = &arrayElements;
+}
+CScriptVarArray::~CScriptVarArray() {
+	arrayElements.clear();
+	elements = 0; // the base-class must not access arrayElements
+}
 CScriptVarPtr CScriptVarArray::clone() { return new CScriptVarArray(*this); }
 bool CScriptVarArray::isArray() { return true; }
 string CScriptVarArray::getParsableString(const string &indentString, const string &indent, uint32_t uniqueID, bool &hasRecursion) {
@@ -4440,7 +5729,7 @@ void CScriptVarArray::native_Length(const CFunctionsScopePtr &c, void *data) {
 
 #ifndef NO_REGEXP
 
-CScriptVarRegExp::CScriptVarRegExp(CTinyJS *Context, const string &Regexp, const string &Flags) : CScriptVarObject(Context, Context->regexpPrototype), regexp(Regexp), flags(Flags) {
+CScriptVarRegExp::CScriptVarRegExp(CTinyJS *Context, const string &Regexp, const string &Flags) : CScriptVarObject(Context, Context->regexpPrototype), regexp(Regexp), flags(Flags), isCompiled(false) {
 	addChild("global", ::newScriptVarAccessor<CScriptVarRegExp>(Context, this, &CScriptVarRegExp::native_Global, 0, 0, 0), 0);
 	addChild("ignoreCase", ::newScriptVarAccessor<CScriptVarRegExp>(Context, this, &CScriptVarRegExp::native_IgnoreCase, 0, 0, 0), 0);
 	addChild("multiline", ::newScriptVarAccessor<CScriptVarRegExp>(Context, this, &CScriptVarRegExp::native_Multiline, 0, 0, 0), 0);
@@ -4479,11 +5768,16 @@ unsigned int CScriptVarRegExp::LastIndex() {
 	if(lastIndex) return lastIndex->toNumber().toInt32();
 	return 0;
 }
+const CScriptRegex &CScriptVarRegExp::getRegex() {
+	if(!isCompiled) {
+		compiled = context->getRegexCache().get(regexp, IgnoreCase(), Multiline());
+		isCompiled = true;
+	}
+	return compiled;
+}
 
 CScriptVarPtr CScriptVarRegExp::exec( const string &Input, bool Test /*= false*/ )
 {
-	regex::flag_type flags = regex_constants::ECMAScript;
-	if(IgnoreCase()) flags |= regex_constants::icase;
 	bool global = Global(), sticky = Sticky();
 	unsigned int lastIndex = LastIndex();
 	size_t offset = 0;
@@ -4492,18 +5786,20 @@ CScriptVarPtr CScriptVarRegExp::exec( const string &Input, bool Test /*= false*/
 		offset=lastIndex;
 	}
 	{
-		regex_constants::match_flag_type mflag = sticky?regex_constants::match_continuous:regex_constants::match_default;
-		if(offset) mflag |= regex_constants::match_prev_avail;
-		smatch match;
-		if(regex_search(Input.begin()+offset, Input.end(), match, regex(regexp, flags), mflag) ) {
-			addChildOrReplace("lastIndex", newScriptVar(offset+match.position()+match.str().length()));
+		CScriptRegexMatch match;
+		if(getRegex().search(Input, offset, sticky, match)) {
+			addChildOrReplace("lastIndex", newScriptVar(match.end()));
 			if(Test) return constScriptVar(true);
 
 			CScriptVarArrayPtr retVar = newScriptVar(Array);
 			retVar->addChild("input", newScriptVar(Input));
 			retVar->addChild("index", newScriptVar(match.position()));
-			for(smatch::size_type idx=0; idx<match.size(); idx++)
-				retVar->addChild(int2string(idx), newScriptVar(match[idx].str()));
+			for(size_t idx=0; idx<match.size(); idx++) {
+				if(match.matched(idx))
+					retVar->setArrayIndex(idx, newScriptVar(match.str(idx)));
+				else
+					retVar->setArrayIndex(idx, constScriptVar(Undefined));
+			}
 			return retVar;
 		}
 	}
@@ -4514,23 +5810,36 @@ failed:
 	return constScriptVar(Null);
 }
 
-const char * CScriptVarRegExp::ErrorStr( int Error )
-{
-	switch(Error) {
-	case regex_constants::error_badbrace: return "the expression contained an invalid count in a { } expression";
-	case regex_constants::error_badrepeat: return "a repeat expression (one of '*', '?', '+', '{' in most contexts) was not preceded by an expression";
-	case regex_constants::error_brace: return "the expression contained an unmatched '{' or '}'";
-	case regex_constants::error_brack: return "the expression contained an unmatched '[' or ']'";
-	case regex_constants::error_collate: return "the expression contained an invalid collating element name";
-	case regex_constants::error_complexity: return "an attempted match failed because it was too complex";
-	case regex_constants::error_ctype: return "the expression contained an invalid character class name";
-	case regex_constants::error_escape: return "the expression contained an invalid escape sequence";
-	case regex_constants::error_paren: return "the expression contained an unmatched '(' or ')'";
-	case regex_constants::error_range: return "the expression contained an invalid character range specifier";
-	case regex_constants::error_space: return "parsing a regular expression failed because there were not enough resources available";
-	case regex_constants::error_stack: return "an attempted match failed because there was not enough memory available";
-	case regex_constants::error_backref: return "the expression contained an invalid back reference";
-	default: return "";
+
+//////////////////////////////////////////////////////////////////////////
+/// CScriptRegexCache
+//////////////////////////////////////////////////////////////////////////
+
+CScriptRegex CScriptRegexCache::get(const string &Source, bool IgnoreCase, bool Multiline/*=false*/) {
+	string key(IgnoreCase ? "i" : "-");
+	key.append(1, Multiline ? 'm' : '-').append(Source);
+	INDEX_t::iterator it = index.find(key);
+	if(it != index.end()) {
+		stats.hits++;
+		lru.splice(lru.begin(), lru, it->second);
+		return it->second->second;
+	}
+	stats.misses++;
+	CScriptRegex compiled(Source, IgnoreCase, Multiline); // throws CScriptRegexError
+	if(capacity) {
+		lru.push_front(ENTRY_t(key, compiled));
+		index[key] = lru.begin();
+		setCapacity(capacity);
+	}
+	return compiled;
+}
+
+void CScriptRegexCache::setCapacity(size_t Capacity) {
+	capacity = Capacity;
+	while(index.size() > capacity) {
+		index.erase(lru.back().first);
+		lru.pop_back();
+		stats.evictions++;
 	}
 }
 
@@ -4551,6 +5860,14 @@ CScriptVarDefaultIterator::CScriptVarDefaultIterator(CTinyJS *Context, const CSc
 CScriptVarDefaultIterator::~CScriptVarDefaultIterator() {}
 CScriptVarPtr CScriptVarDefaultIterator::clone() { return new CScriptVarDefaultIterator(*this); }
 bool CScriptVarDefaultIterator::isIterator()		{return true;}
+void CScriptVarDefaultIterator::getReferences(vector<CScriptVar*> &Refs) {
+	CScriptVarObject::getReferences(Refs);
+	Refs.push_back(object.getVar());
+}
+void CScriptVarDefaultIterator::forkReferences(CScriptVarForker &Forker) {
+	CScriptVarObject::forkReferences(Forker);
+	Forker.forkPtr(object);
+}
 void CScriptVarDefaultIterator::native_next(const CFunctionsScopePtr &c, void *data) {
 	if(pos==keys.end()) throw constScriptVar(StopIteration);
 	CScriptVarPtr ret, ret0, ret1;
@@ -4582,6 +5899,8 @@ void CScriptVarDefaultIterator::native_next(const CFunctionsScopePtr &c, void *d
 CScriptVarGenerator::CScriptVarGenerator(CTinyJS *Context, const CScriptVarPtr &FunctionRoot, const CScriptVarFunctionPtr &Function) 
 	: CScriptVarObject(Context, Context->generatorPrototype), functionRoot(FunctionRoot), function(Function), 
 	closed(false), yieldVarIsException(false), coroutine(this) {
+	functionRoot->collectorShade();
+	function.getVar()->collectorShade();
 //		addChild("next", ::newScriptVar(context, this, &CScriptVarGenerator::native_send, 0, "Generator.next"));
 	//	addChild("send", ::newScriptVar(context, this, &CScriptVarGenerator::native_send, (void*)1, "Generator.send"));
 		//addChild("close", ::newScriptVar(context, this, &CScriptVarGenerator::native_throw, (void*)0, "Generator.close"));
@@ -4604,13 +5923,26 @@ bool CScriptVarGenerator::isGenerator()	{return true;}
 string CScriptVarGenerator::getVarType() { return "generator"; }
 string CScriptVarGenerator::getVarTypeTagName() { return "Generator"; }
 
-void CScriptVarGenerator::setTemporaryMark_recursive( uint32_t ID ) {
-	CScriptVarObject::setTemporaryMark_recursive(ID);
-	functionRoot->setTemporaryMark_recursive(ID);
-	function->setTemporaryMark_recursive(ID);
-	if(yieldVar) yieldVar->setTemporaryMark_recursive(ID);
+void CScriptVarGenerator::getReferences(vector<CScriptVar*> &Refs) {
+	CScriptVarObject::getReferences(Refs);
+	Refs.push_back(functionRoot.getVar());
+	Refs.push_back(function.getVar());
+	if(yieldVar) Refs.push_back(yieldVar.getVar());
 	for(vector<CScriptVarScopePtr>::iterator it=generatorScopes.begin(); it != generatorScopes.end(); ++it)
-		(*it)->setTemporaryMark_recursive(ID);
+		Refs.push_back(it->getVar());
+}
+void CScriptVarGenerator::forkReferences(CScriptVarForker &Forker) {
+	CScriptVarObject::forkReferences(Forker);
+	Forker.forkPtr(functionRoot);
+	Forker.forkPtr(function);
+	Forker.forkPtr(yieldVar);
+	for(vector<CScriptVarScopePtr>::iterator it=generatorScopes.begin(); it != generatorScopes.end(); ++it)
+		Forker.forkPtr(*it);
+}
+void CScriptVarGenerator::collectorShadeState() {
+	if(yieldVar) yieldVar->collectorShade();
+	for(vector<CScriptVarScopePtr>::iterator it=generatorScopes.begin(); it != generatorScopes.end(); ++it)
+		(*it).getVar()->collectorShade();
 }
 void CScriptVarGenerator::native_send(const CFunctionsScopePtr &c, void *data) {
 	// data == 0 ==> next()
@@ -4623,7 +5955,9 @@ void CScriptVarGenerator::native_send(const CFunctionsScopePtr &c, void *data) {
 
 	if(!coroutine.isStarted() && data && !yieldVar->isUndefined())
 		c->throwError(TypeError, "attempt to send value to newborn generator");
-	if(coroutine.next()) {
+	bool running = coroutine.next();
+	collectorShadeState(); // the state is changed without links
+	if(running) {
 		c->setReturnVar(yieldVar);
 		return;
 	}
@@ -4643,7 +5977,9 @@ void CScriptVarGenerator::native_throw(const CFunctionsScopePtr &c, void *data)
 	yieldVar = data ? c->getArgument(0) : CScriptVarPtr();
 	yieldVarIsException = true;
 	closed = data==0;
-	if(coroutine.next()) {
+	bool running = coroutine.next();
+	collectorShadeState(); // the state is changed without links
+	if(running) {
 		c->setReturnVar(yieldVar);
 		return;
 	}
@@ -4737,6 +6073,14 @@ void CScriptVarFunction::setFunctionData(CScriptTokenDataFnc *Data) {
 		//addChildNoDup("name", newScriptVar(data->name), 0);
 	}
 }
+void CScriptVarFunction::forkReferences(CScriptVarForker &Forker) {
+	CScriptVarObject::forkReferences(Forker);
+	if(!data) return;
+	CScriptTokenDataFnc *copy = static_cast<CScriptTokenDataFnc*>(Forker.forkTokenData(data)); // not by setFunctionData - the length is forked already
+	copy->ref();
+	data->unref();
+	data = copy;
+}
 
 
 ////////////////////////////////////////////////////////////////////////// 
@@ -4749,15 +6093,34 @@ CScriptVarFunctionBounded::CScriptVarFunctionBounded(CScriptVarFunctionPtr Bound
 	boundedThis(BoundedThis),
 	boundedArguments(BoundedArguments) {
 		getFunctionData()->name = BoundedFunction->getFunctionData()->name;
+		collectorShadeBounded();
+}
+CScriptVarFunctionBounded::CScriptVarFunctionBounded(const CScriptVarFunctionBounded &Copy) 
+	: CScriptVarFunction(Copy), boundedFunction(Copy.boundedFunction), boundedThis(Copy.boundedThis), boundedArguments(Copy.boundedArguments) {
+		collectorShadeBounded();
+}
+void CScriptVarFunctionBounded::collectorShadeBounded() {
+	boundedFunction.getVar()->collectorShade();
+	if(boundedThis) boundedThis->collectorShade();
+	for(vector<CScriptVarPtr>::iterator it=boundedArguments.begin(); it!=boundedArguments.end(); ++it)
+		(*it)->collectorShade();
 }
 CScriptVarFunctionBounded::~CScriptVarFunctionBounded(){}
 CScriptVarPtr CScriptVarFunctionBounded::clone() { return new CScriptVarFunctionBounded(*this); }
 bool CScriptVarFunctionBounded::isBounded() { return true; }
-void CScriptVarFunctionBounded::setTemporaryMark_recursive(uint32_t ID) {
-	CScriptVarFunction::setTemporaryMark_recursive(ID);
-	boundedThis->setTemporaryMark_recursive(ID);
+void CScriptVarFunctionBounded::getReferences(vector<CScriptVar*> &Refs) {
+	CScriptVarFunction::getReferences(Refs);
+	Refs.push_back(boundedFunction.getVar());
+	if(boundedThis) Refs.push_back(boundedThis.getVar());
+	for(vector<CScriptVarPtr>::iterator it=boundedArguments.begin(); it!=boundedArguments.end(); ++it)
+		Refs.push_back(it->getVar());
+}
+void CScriptVarFunctionBounded::forkReferences(CScriptVarForker &Forker) {
+	CScriptVarFunction::forkReferences(Forker);
+	Forker.forkPtr(boundedFunction);
+	Forker.forkPtr(boundedThis);
 	for(vector<CScriptVarPtr>::iterator it=boundedArguments.begin(); it!=boundedArguments.end(); ++it)
-		(*it)->setTemporaryMark_recursive(ID);
+		Forker.forkPtr(*it);
 }
 
 CScriptVarPtr CScriptVarFunctionBounded::callFunction( CScriptResult &execute, vector<CScriptVarPtr> &Arguments, const CScriptVarPtr &This, CScriptVarPtr *newThis/*=0*/ )
@@ -4774,6 +6137,7 @@ CScriptVarPtr CScriptVarFunctionBounded::callFunction( CScriptResult &execute, v
 
 CScriptVarFunctionNative::~CScriptVarFunctionNative() {}
 bool CScriptVarFunctionNative::isNative() { return true; }
+bool CScriptVarFunctionNative::isFastCall() { return false; }
 
 
 //////////////////////////////////////////////////////////////////////////
@@ -4785,6 +6149,22 @@ CScriptVarPtr CScriptVarFunctionNativeCallback::clone() { return new CScriptVarF
 void CScriptVarFunctionNativeCallback::callFunction(const CFunctionsScopePtr &c) { jsCallback(c, jsUserData); }
 
 
+//////////////////////////////////////////////////////////////////////////
+/// CScriptVarFunctionNativeFast
+//////////////////////////////////////////////////////////////////////////
+
+CScriptVarFunctionNativeFast::~CScriptVarFunctionNativeFast() {}
+CScriptVarPtr CScriptVarFunctionNativeFast::clone() { return new CScriptVarFunctionNativeFast(*this); }
+bool CScriptVarFunctionNativeFast::isFastCall() { return true; }
+void CScriptVarFunctionNativeFast::callFunction(const CFunctionsScopePtr &c) {
+	vector<CScriptVarPtr> Args;
+	for(int i=0, length=c->getArgumentsLength(); i<length; ++i)
+		Args.push_back(c->getArgument(i));
+	CScriptVarPtr ret = callFunction(c->getArgument("this"), Args.empty() ? 0 : &Args[0], Args.size());
+	if(ret) c->setReturnVar(ret);
+}
+
+
 ////////////////////////////////////////////////////////////////////////// 
 /// CScriptVarAccessor
 //////////////////////////////////////////////////////////////////////////
@@ -4824,10 +6204,11 @@ string CScriptVarAccessor::getVarType() { return "accessor"; }
 declare_dummy_t(Scope);
 CScriptVarScope::~CScriptVarScope() {}
 CScriptVarPtr CScriptVarScope::clone() { return CScriptVarPtr(); }
+CScriptVarPtr CScriptVarScope::fork() { return new CScriptVarScope(*this); }
 bool CScriptVarScope::isObject() { return false; }
 CScriptVarPtr CScriptVarScope::scopeVar() { return this; }	///< to create var like: var a = ...
 CScriptVarPtr CScriptVarScope::scopeLet() { return this; }	///< to create var like: let a = ...
-CScriptVarLinkWorkPtr CScriptVarScope::findInScopes(const string &childName) { 
+CScriptVarLinkWorkPtr CScriptVarScope::findInScopes(const CScriptAtom &childName) { 
 	return  CScriptVar::findChild(childName); 
 }
 CScriptVarScopePtr CScriptVarScope::getParent() { return CScriptVarScopePtr(); } ///< no Parent
@@ -4839,7 +6220,8 @@ CScriptVarScopePtr CScriptVarScope::getParent() { return CScriptVarScopePtr(); }
 
 declare_dummy_t(ScopeFnc);
 CScriptVarScopeFnc::~CScriptVarScopeFnc() {}
-CScriptVarLinkWorkPtr CScriptVarScopeFnc::findInScopes(const string &childName) { 
+CScriptVarPtr CScriptVarScopeFnc::fork() { return new CScriptVarScopeFnc(*this); }
+CScriptVarLinkWorkPtr CScriptVarScopeFnc::findInScopes(const CScriptAtom &childName) { 
 	CScriptVarLinkWorkPtr ret = findChild(childName); 
 	if( !ret ) {
 		if(closure) ret = CScriptVarScopePtr(closure)->findInScopes(childName);
@@ -4891,11 +6273,12 @@ CScriptVarScopeLet::CScriptVarScopeLet(const CScriptVarScopePtr &Parent) // cons
 	, letExpressionInitMode(false) {}
 
 CScriptVarScopeLet::~CScriptVarScopeLet() {}
+CScriptVarPtr CScriptVarScopeLet::fork() { return new CScriptVarScopeLet(*this); }
 CScriptVarPtr CScriptVarScopeLet::scopeVar() {						// to create var like: var a = ...
 	return getParent()->scopeVar(); 
 }
 CScriptVarScopePtr CScriptVarScopeLet::getParent() { return (CScriptVarPtr)parent; }
-CScriptVarLinkWorkPtr CScriptVarScopeLet::findInScopes(const string &childName) { 
+CScriptVarLinkWorkPtr CScriptVarScopeLet::findInScopes(const CScriptAtom &childName) { 
 	CScriptVarLinkWorkPtr ret;
 	if(letExpressionInitMode) {
 		return getParent()->findInScopes(childName);
@@ -4913,16 +6296,17 @@ CScriptVarLinkWorkPtr CScriptVarScopeLet::findInScopes(const string &childName)
 
 declare_dummy_t(ScopeWith);
 CScriptVarScopeWith::~CScriptVarScopeWith() {}
+CScriptVarPtr CScriptVarScopeWith::fork() { return new CScriptVarScopeWith(*this); }
 CScriptVarPtr CScriptVarScopeWith::scopeLet() { 							// to create var like: let a = ...
 	return getParent()->scopeLet();
 }
-CScriptVarLinkWorkPtr CScriptVarScopeWith::findInScopes(const string &childName) { 
-	if(childName == "this") return with;
+CScriptVarLinkWorkPtr CScriptVarScopeWith::findInScopes(const CScriptAtom &childName) { 
+	if(childName.getName() == "this") return with;
 	CScriptVarLinkWorkPtr ret = with->getVarPtr()->findChild(childName); 
 	if( !ret ) {
 		ret = with->getVarPtr()->findChildInPrototypeChain(childName);
 		if(ret) {
-			ret(ret->getVarPtr(), ret->getName()); // recreate ret
+			ret(ret->getVarPtr(), ret->getAtom()); // recreate ret
 			ret.setReferencedOwner(with->getVarPtr()); // fake referenced Owner
 		}
 	}
@@ -4931,6 +6315,358 @@ CScriptVarLinkWorkPtr CScriptVarScopeWith::findInScopes(const string &childName)
 }
 
 
+//////////////////////////////////////////////////////////////////////////
+/// CScriptBytecode
+//////////////////////////////////////////////////////////////////////////
+
+/// The bytecode is a flat list of register-instructions compiled from the tokens of a simple expression.
+/// The compiler follows the token-walker (execute_base ... execute_literals) step by step, so the
+/// VM (CTinyJS::execute_bytecode) does the same checks and calls in the same order.
+/// Object-, array-, function- and regexp-literals, new, typeof, void, delete, in, instanceof,
+/// yield and let-expressions are not supported - such expressions are executed by the token-walker.
+
+#define BYTECODE_REGISTERS 16
+
+enum BYTECODE_OPCODES {
+	BC_LOAD_ID,			///< r[a] = identifier atoms[k] (the scope-cache is caches[b])
+	BC_LOAD_INT,		///< r[a] = k
+	BC_LOAD_FLOAT,		///< r[a] = floats[k]
+	BC_LOAD_STRING,		///< r[a] = strings[k]
+	BC_LOAD_CONST,		///< r[a] = true, false or null (k = LEX_R_TRUE, LEX_R_FALSE or LEX_R_NULL)
+	BC_SWAP,				///< swaps r[a] and r[b]
+	BC_CHECK,			///< right-hand-check of r[a]
+	BC_CHECK_GET,		///< right-hand-check of r[a] and r[a] = getter of r[a]
+	BC_OBJECT,			///< parent r[a] = r[a+1] and r[a+1] = getter of r[a] (must not be undefined or null)
+	BC_MEMBER,			///< BC_OBJECT and r[a+1] = r[a+1].atoms[k] (the inline-cache is caches[b])
+	BC_SUBSCRIPT,		///< r[a+1] = r[a+1][r[a+2]]
+	BC_CALLEE,			///< r[a+1] = getter of r[a+1] (must be a function)
+	BC_CALL,				///< r[a+1] = r[a+1](r[a+2] ... r[a+1+b]) with this = parent r[a] if k < 0 otherwise "this" of the scope (the scope-cache is caches[k])
+	BC_MATHS_OP,		///< r[a] = r[a] op r[b] (op = k)
+	BC_UNARY,			///< r[a] = op r[a] (op = k)
+	BC_INCREMENT,		///< r[a]++ or r[a]-- (op = k) postfix if b is set
+	BC_ASSIGN,			///< r[a] = (r[a] op r[b]) (op = k)
+	BC_JUMP,				///< continue at k
+	BC_JUMP_TRUE,		///< continue at k if r[a] is true
+	BC_JUMP_FALSE,		///< continue at k if r[a] is false
+};
+
+class CScriptBytecode {
+public:
+	struct Instruction {
+		uint8_t op, a, b;
+		int32_t k;
+		uint16_t line, column; ///< for error-messages
+	};
+	/// compiles the expression at Begin - returns 0 if the expression is not compilable
+	static CScriptBytecode *compile(TOKEN_VECT_it Begin, TOKEN_VECT_it End);
+
+	std::vector<Instruction> code;
+	std::vector<CScriptAtom> atoms;
+	std::vector<double> floats;
+	std::vector<std::string> strings;
+	std::vector<CScriptInlineCache> caches;
+	const CScriptToken *begin; ///< the first token of the expression
+	int tokens; ///< count of compiled tokens
+};
+
+CScriptBytecodeSlot::~CScriptBytecodeSlot() { delete code; }
+
+namespace {
+struct bytecode_not_compilable {};
+
+class CScriptBytecodeCompiler {
+public:
+	CScriptBytecodeCompiler(CScriptBytecode &Code, TOKEN_VECT_it Begin, TOKEN_VECT_it End) : code(Code), it(Begin), last(Begin), end(End) {}
+	void compile() { base(0); }
+	int tk() { return it == end ? LEX_EOF : it->token; }
+	TOKEN_VECT_it pos() { return it; }
+private:
+	CScriptBytecode &code;
+	TOKEN_VECT_it it, last, end;
+
+	void next() { last = it++; }
+	void match(int Token) { if(tk() != Token) throw bytecode_not_compilable(); next(); }
+	static int reg(int r) { if(r >= BYTECODE_REGISTERS) throw bytecode_not_compilable(); return r; }
+	/// Pos is the token for error-messages - default the previous token
+	size_t emit(int op, int a, int b=0, int32_t k=0, const CScriptToken *Pos=0) {
+		CScriptBytecode::Instruction i;
+		i.op = uint8_t(op); i.a = uint8_t(a); i.b = uint8_t(b); i.k = k;
+		if(!Pos) Pos = &*last;
+		i.line = Pos->line; i.column = Pos->column;
+		code.code.push_back(i);
+		return code.code.size()-1;
+	}
+	void setTarget(size_t Jump) { code.code[Jump].k = int32_t(code.code.size()); }
+	/// adds an inline-cache (for BC_LOAD_ID, BC_MEMBER & BC_CALL) and returns its index
+	int cache() {
+		if(code.caches.size() > 0xff) throw bytecode_not_compilable();
+		code.caches.push_back(CScriptInlineCache());
+		return int(code.caches.size()-1);
+	}
+
+	// L->R: Precedence 17 (comma) ,
+	void base(int r) {
+		for(;;) {
+			assignment(r);
+			if(tk() != ',') break;
+			next();
+		}
+	}
+	// L<-R: Precedence 16 (assignment) = += -= *= /= %= <<= >>= >>>= &= |= ^=
+	void assignment(int r) {
+		condition(r);
+		int op = tk();
+		if(op=='=' || (op>=LEX_ASSIGNMENTS_BEGIN && op<=LEX_ASSIGNMENTS_END)) {
+			const CScriptToken *opToken = &*it;
+			next();
+			assignment(reg(r+1));
+			emit(BC_ASSIGN, r, r+1, op, opToken);
+		} else
+			emit(BC_CHECK_GET, r);
+	}
+	// L<-R: Precedence 15 (condition) ?: 
+	void condition(int r) {
+		logic(r, LEX_OROR, LEX_ANDAND);
+		if(tk() == '?') {
+			emit(BC_CHECK_GET, r);
+			size_t jumpElse = emit(BC_JUMP_FALSE, r);
+			next();
+			assignment(r);
+			size_t jumpEnd = emit(BC_JUMP, r);
+			match(':');
+			setTarget(jumpElse);
+			assignment(r);
+			setTarget(jumpEnd);
+		}
+	}
+	// L->R: Precedence 13 ==> (logical-and) &&
+	// L->R: Precedence 14 ==> (logical-or) ||
+	void logic(int r, int op, int op_n) {
+		if(op_n) logic(r, op_n, 0); else binary_logic(r, '|', '^', '&');
+		if(tk() == op) {
+			emit(BC_CHECK_GET, r);
+			std::vector<size_t> jumps;
+			while(tk() == op) {
+				jumps.push_back(emit(op==LEX_ANDAND ? BC_JUMP_FALSE : BC_JUMP_TRUE, r));
+				next();
+				if(op_n) logic(r, op_n, 0); else binary_logic(r, '|', '^', '&');
+				emit(BC_CHECK_GET, r);
+			}
+			for(std::vector<size_t>::iterator jump = jumps.begin(); jump != jumps.end(); ++jump)
+				setTarget(*jump);
+		}
+	}
+	// L->R: Precedence 10 (bitwise-and) &
+	// L->R: Precedence 11 (bitwise-xor) ^
+	// L->R: Precedence 12 (bitwise-or) |
+	void binary_logic(int r, int op, int op_n1, int op_n2) {
+		if(op_n1) binary_logic(r, op_n1, op_n2, 0); else relation(r, LEX_EQUAL, '<');
+		if(tk() == op) {
+			emit(BC_CHECK_GET, r);
+			while(tk() == op) {
+				next();
+				if(op_n1) binary_logic(reg(r+1), op_n1, op_n2, 0); else relation(reg(r+1), LEX_EQUAL, '<');
+				emit(BC_CHECK, r+1);
+				emit(BC_MATHS_OP, r, r+1, op);
+			}
+		}
+	}
+	// L->R: Precedence 8 (relational) < <= > <= in instanceof
+	// L->R: Precedence 9 (equality) == != === !===
+	static bool isRelation(int set, int tk) {
+		return (set==LEX_EQUAL && tk>=LEX_RELATIONS_1_BEGIN && tk<=LEX_RELATIONS_1_END)
+			|| (set=='<' && (tk==LEX_LEQUAL || tk==LEX_GEQUAL || tk=='<' || tk=='>' || tk==LEX_R_IN || tk==LEX_R_INSTANCEOF));
+	}
+	void relation(int r, int set, int set_n) {
+		if(set_n) relation(r, set_n, 0); else binary_shift(r);
+		if(isRelation(set, tk())) {
+			emit(BC_CHECK_GET, r);
+			while(isRelation(set, tk())) {
+				int op = tk();
+				if(op == LEX_R_IN || op == LEX_R_INSTANCEOF) throw bytecode_not_compilable();
+				next();
+				if(set_n) relation(reg(r+1), set_n, 0); else binary_shift(reg(r+1));
+				emit(BC_CHECK_GET, r+1);
+				emit(BC_MATHS_OP, r, r+1, op);
+			}
+		}
+	}
+	// L->R: Precedence 7 (bitwise shift) << >> >>>
+	void binary_shift(int r) {
+		expression(r);
+		if(tk()>=LEX_SHIFTS_BEGIN && tk()<=LEX_SHIFTS_END) {
+			emit(BC_CHECK, r);
+			while(tk()>=LEX_SHIFTS_BEGIN && tk()<=LEX_SHIFTS_END) {
+				int op = tk();
+				next();
+				expression(reg(r+1));
+				emit(BC_CHECK, r); // like the token-walker: a is checked not b
+				emit(BC_MATHS_OP, r, r+1, op);
+			}
+		}
+	}
+	// L->R: Precedence 6 (addition/subtraction) + -
+	void expression(int r) {
+		term(r);
+		if(tk()=='+' || tk()=='-') {
+			emit(BC_CHECK, r);
+			while(tk()=='+' || tk()=='-') {
+				int op = tk();
+				next();
+				term(reg(r+1));
+				emit(BC_CHECK, r+1);
+				emit(BC_MATHS_OP, r, r+1, op);
+			}
+		}
+	}
+	// L->R: Precedence 5 (term) * / %
+	void term(int r) {
+		unary(r);
+		if(tk()=='*' || tk()=='/' || tk()=='%') {
+			emit(BC_CHECK, r);
+			while(tk()=='*' || tk()=='/' || tk()=='%') {
+				int op = tk();
+				next();
+				unary(reg(r+1));
+				emit(BC_CHECK, r+1);
+				emit(BC_MATHS_OP, r, r+1, op);
+			}
+		}
+	}
+	// R->L: Precedence 3 (in-/decrement) ++ --
+	// R<-L: Precedence 4 (unary) ! ~ + - 
+	void unary(int r) {
+		int op = tk();
+		switch(op) {
+		case '-':
+		case '+':
+		case '!':
+		case '~':
+			next();
+			unary(r);
+			emit(BC_CHECK_GET, r);
+			emit(BC_UNARY, r, 0, op);
+			break;
+		case LEX_PLUSPLUS:
+		case LEX_MINUSMINUS:
+			{
+				next();
+				if(it == end) throw bytecode_not_compilable();
+				const CScriptToken *operand = &*it;
+				function_call(r);
+				emit(BC_INCREMENT, r, 0, op, operand);
+			}
+			break;
+		default:
+			function_call(r);
+			break;
+		}
+		// post increment/decrement
+		if(tk()==LEX_PLUSPLUS || tk()==LEX_MINUSMINUS) {
+			op = tk();
+			next();
+			emit(BC_INCREMENT, r, 1, op);
+		}
+	}
+	// member-access and function-calls. The value is in r+1 and the parent in r
+	void function_call(int r) {
+		literal(r);
+		bool chain = false, hasParent = false;
+		for(;;) {
+			int op = tk();
+			if(op != '.' && op != '[' && op != '(') break;
+			reg(r+2);
+			if(!chain) {
+				emit(BC_SWAP, r, r+1);
+				chain = true;
+			}
+			const CScriptToken *opToken = &*it;
+			next();
+			if(op == '.') {
+				if(tk() != LEX_ID) throw bytecode_not_compilable();
+				code.atoms.push_back(it->Atom());
+				emit(BC_MEMBER, r, cache(), int32_t(code.atoms.size()-1), opToken);
+				next();
+				hasParent = true;
+			} else if(op == '[') {
+				emit(BC_OBJECT, r, 0, 0, opToken);
+				base(reg(r+2));
+				match(']');
+				emit(BC_SUBSCRIPT, r);
+				hasParent = true;
+			} else {
+				emit(BC_CALLEE, r, 0, 0, opToken);
+				int argc = 0;
+				while(tk() != ')') {
+					assignment(reg(r+2+argc));
+					++argc;
+					if(tk() != ')') match(',');
+				}
+				next();
+				emit(BC_CALL, r, argc, hasParent ? -1 : cache());
+				hasParent = false;
+			}
+		}
+		if(chain) emit(BC_SWAP, r, r+1);
+	}
+	void literal(int r) {
+		switch(tk()) {
+		case LEX_ID:
+			code.atoms.push_back(it->Atom());
+			emit(BC_LOAD_ID, r, cache(), int32_t(code.atoms.size()-1), &*it);
+			next();
+			break;
+		case LEX_INT:
+			emit(BC_LOAD_INT, r, 0, it->Int(), &*it);
+			next();
+			break;
+		case LEX_FLOAT:
+			code.floats.push_back(it->Float());
+			emit(BC_LOAD_FLOAT, r, 0, int32_t(code.floats.size()-1), &*it);
+			next();
+			break;
+		case LEX_STR:
+			code.strings.push_back(it->String());
+			emit(BC_LOAD_STRING, r, 0, int32_t(code.strings.size()-1), &*it);
+			next();
+			break;
+		case LEX_R_TRUE:
+		case LEX_R_FALSE:
+		case LEX_R_NULL:
+			emit(BC_LOAD_CONST, r, 0, tk(), &*it);
+			next();
+			break;
+		case '(':
+			next();
+			base(r);
+			match(')');
+			break;
+		default:
+			throw bytecode_not_compilable();
+		}
+	}
+};
+} // namespace
+
+CScriptBytecode *CScriptBytecode::compile(TOKEN_VECT_it Begin, TOKEN_VECT_it End) {
+	if(Begin == End) return 0;
+	CScriptBytecode *Code = new CScriptBytecode;
+	CScriptBytecodeCompiler compiler(*Code, Begin, End);
+	try {
+		compiler.compile();
+		int tk = compiler.tk();
+		if(tk == LEX_EOF || tk == ';' || tk == LEX_T_END_EXPRESSION) {
+			Code->begin = &*Begin;
+			Code->tokens = int(compiler.pos() - Begin);
+			return Code;
+		}
+	} catch(bytecode_not_compilable &) {
+	}
+	delete Code;
+	return 0;
+}
+
+
 //////////////////////////////////////////////////////////////////////////
 /// CTinyJS
 //////////////////////////////////////////////////////////////////////////
@@ -4939,16 +6675,39 @@ extern "C" void _registerFunctions(CTinyJS *tinyJS);
 extern "C" void _registerStringFunctions(CTinyJS *tinyJS);
 extern "C" void _registerMathFunctions(CTinyJS *tinyJS);
 extern "C" void _registerDateFunctions(CTinyJS *tinyJS);
+extern "C" void _registerTypedArrayFunctions(CTinyJS *tinyJS);
+extern "C" void _registerVectorFunctions(CTinyJS *tinyJS);
+extern "C" void _registerCollectionFunctions(CTinyJS *tinyJS);
 
-CTinyJS::CTinyJS() {
-	CScriptVarPtr var;
+void CTinyJS::init() {
 	t = 0;
 	haveTry = false;
 	first = 0;
+	varCount = 0;
+	collectThreshold = CYCLE_COLLECTOR_MIN_THRESHOLD;
+	collectorPhase = COLLECTOR_IDLE;
+	collectorEpoch = 0;
+	collectorBudget = 0;
+	collectorNoRescue = false;
+	collectorScanCursor = 0;
+	collectorSweepPos = 0;
+	collectorAllocs = 0;
 	uniqueID = 0;
 	currentMarkSlot = -1;
 	stackBase = 0;
+	rootShape = new CScriptVarShape;
+	shapesInUse = 0;
+	shapePruneThreshold = SHAPE_PRUNE_MIN;
+	useBytecode = true;
+	hiddenLetScopes = 0;
+	if(VALUE_CACHE_INT_MAX >= VALUE_CACHE_INT_MIN) intCache.resize((VALUE_CACHE_INT_MAX-VALUE_CACHE_INT_MIN)/VALUE_CACHE_INT_BLOCK+1);
+	native_require_read = 0;
+	forker = 0;
+}
 
+CTinyJS::CTinyJS() {
+	CScriptVarPtr var;
+	init();
 	
 	//////////////////////////////////////////////////////////////////////////
 	// Object-Prototype
@@ -4976,19 +6735,7 @@ CTinyJS::CTinyJS() {
 	var = addNative("function Object()", this, &CTinyJS::native_Object, 0, SCRIPTVARLINK_CONSTANT);
 	objectPrototype = var->findChild(TINYJS_PROTOTYPE_CLASS);
 	objectPrototype->addChild(TINYJS_CONSTRUCTOR_VAR, var, SCRIPTVARLINK_BUILDINDEFAULT);
-	addNative("function Object.getPrototypeOf(obj)", this, &CTinyJS::native_Object_getPrototypeOf); 
-	addNative("function Object.preventExtensions(obj)", this, &CTinyJS::native_Object_setObjectSecure); 
-	addNative("function Object.isExtensible(obj)", this, &CTinyJS::native_Object_isSecureObject); 
-	addNative("function Object.seel(obj)", this, &CTinyJS::native_Object_setObjectSecure, (void*)1); 
-	addNative("function Object.isSealed(obj)", this, &CTinyJS::native_Object_isSecureObject, (void*)1); 
-	addNative("function Object.freeze(obj)", this, &CTinyJS::native_Object_setObjectSecure, (void*)2); 
-	addNative("function Object.isFrozen(obj)", this, &CTinyJS::native_Object_isSecureObject, (void*)2); 
-	addNative("function Object.keys(obj)", this, &CTinyJS::native_Object_keys); 
-	addNative("function Object.getOwnPropertyNames(obj)", this, &CTinyJS::native_Object_keys, (void*)1); 
-	addNative("function Object.getOwnPropertyDescriptor(obj,name)", this, &CTinyJS::native_Object_getOwnPropertyDescriptor); 
-	addNative("function Object.defineProperty(obj,name,attributes)", this, &CTinyJS::native_Object_defineProperty); 
-	addNative("function Object.defineProperties(obj,properties)", this, &CTinyJS::native_Object_defineProperties); 
-	addNative("function Object.create(obj,properties)", this, &CTinyJS::native_Object_defineProperties, (void*)1); 
+	addLazyNatives(var, installObjectNatives);
 
 	addNative("function Object.prototype.hasOwnProperty(prop)", this, &CTinyJS::native_Object_prototype_hasOwnProperty); 
 	objectPrototype_valueOf = addNative("function Object.prototype.valueOf()", this, &CTinyJS::native_Object_prototype_valueOf); 
@@ -5155,20 +6902,49 @@ CTinyJS::CTinyJS() {
 	//////////////////////////////////////////////////////////////////////////
 	// add global functions
 	addNative("function eval(jsCode)", this, &CTinyJS::native_eval);
-	native_require_read = 0;
 	addNative("function require(jsFile)", this, &CTinyJS::native_require);
 	addNative("function isNaN(objc)", this, &CTinyJS::native_isNAN);
 	addNative("function isFinite(objc)", this, &CTinyJS::native_isFinite);
 	addNative("function parseInt(string, radix)", this, &CTinyJS::native_parseInt);
 	addNative("function parseFloat(string)", this, &CTinyJS::native_parseFloat);
 	
-	root->addChild("JSON", newScriptVar(Object), SCRIPTVARLINK_BUILDINDEFAULT);
-	addNative("function JSON.parse(text, reviver)", this, &CTinyJS::native_JSON_parse);
+	addLazyNatives(root->addChild("JSON", newScriptVar(Object), SCRIPTVARLINK_BUILDINDEFAULT), installJSONNatives);
 	
 	_registerFunctions(this);
 	_registerStringFunctions(this);
 	_registerMathFunctions(this);
 	_registerDateFunctions(this);
+	pseudo_refered.push_back(&arrayBufferPrototype);
+	for(int i=0; i<TYPEDARRAY_KIND_COUNT; i++)
+		pseudo_refered.push_back(&typedArrayPrototypes[i]);
+	pseudo_refered.push_back(&dataViewPrototype);
+	_registerTypedArrayFunctions(this);
+	_registerVectorFunctions(this);
+	pseudo_refered.push_back(&mapPrototype);
+	pseudo_refered.push_back(&setPrototype);
+	pseudo_refered.push_back(&weakMapPrototype);
+	pseudo_refered.push_back(&mapIteratorPrototype);
+	_registerCollectionFunctions(this);
+}
+
+void CTinyJS::installObjectNatives(CTinyJS *tinyJS, const CScriptVarPtr &) {
+	tinyJS->addNative("function Object.getPrototypeOf(obj)", tinyJS, &CTinyJS::native_Object_getPrototypeOf); 
+	tinyJS->addNative("function Object.preventExtensions(obj)", tinyJS, &CTinyJS::native_Object_setObjectSecure); 
+	tinyJS->addNative("function Object.isExtensible(obj)", tinyJS, &CTinyJS::native_Object_isSecureObject); 
+	tinyJS->addNative("function Object.seel(obj)", tinyJS, &CTinyJS::native_Object_setObjectSecure, (void*)1); 
+	tinyJS->addNative("function Object.isSealed(obj)", tinyJS, &CTinyJS::native_Object_isSecureObject, (void*)1); 
+	tinyJS->addNative("function Object.freeze(obj)", tinyJS, &CTinyJS::native_Object_setObjectSecure, (void*)2); 
+	tinyJS->addNative("function Object.isFrozen(obj)", tinyJS, &CTinyJS::native_Object_isSecureObject, (void*)2); 
+	tinyJS->addNative("function Object.keys(obj)", tinyJS, &CTinyJS::native_Object_keys); 
+	tinyJS->addNative("function Object.getOwnPropertyNames(obj)", tinyJS, &CTinyJS::native_Object_keys, (void*)1); 
+	tinyJS->addNative("function Object.getOwnPropertyDescriptor(obj,name)", tinyJS, &CTinyJS::native_Object_getOwnPropertyDescriptor); 
+	tinyJS->addNative("function Object.defineProperty(obj,name,attributes)", tinyJS, &CTinyJS::native_Object_defineProperty); 
+	tinyJS->addNative("function Object.defineProperties(obj,properties)", tinyJS, &CTinyJS::native_Object_defineProperties); 
+	tinyJS->addNative("function Object.create(obj,properties)", tinyJS, &CTinyJS::native_Object_defineProperties, (void*)1); 
+}
+
+void CTinyJS::installJSONNatives(CTinyJS *tinyJS, const CScriptVarPtr &) {
+	tinyJS->addNative("function JSON.parse(text, reviver)", tinyJS, &CTinyJS::native_JSON_parse);
 }
 
 CTinyJS::~CTinyJS() {
@@ -5179,17 +6955,57 @@ CTinyJS::~CTinyJS() {
 		errorPrototypes[i] = CScriptVarPtr();
 	root->removeAllChildren();
 	scopes.clear();
+	collectorNoRescue = true;
 	ClearUnreferedVars();
 	root = CScriptVarPtr();
 #ifdef _DEBUG
 	for(CScriptVar *p = first; p; p=p->next)
 		printf("%p\n", p);
 #endif
+	delete rootShape;
 #if DEBUG_MEMORY
-	show_allocated();
+	show_allocated(this);
 #endif
 }
 
+CTinyJS::CTinyJS(const CScriptSnapshot &Snapshot) {
+	init();
+#ifndef NO_THREADING
+	CScriptUniqueLock lock(Snapshot.mutex);
+#endif
+	CScriptVarForker(Snapshot.context, this).fork();
+}
+
+CTinyJS::CTinyJS(CTinyJS *From) {
+	init();
+	CScriptVarForker(From, this).fork();
+}
+
+void CTinyJS::pruneShapes() {
+	// a prune costs the size of the tree - so the next prune waits until at least as many shapes gets used as shapes are used by vars now
+	shapePruneThreshold = max(uint32_t(SHAPE_PRUNE_MIN), rootShape->prune());
+	shapesInUse = 0;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+/// CScriptSnapshot
+//////////////////////////////////////////////////////////////////////////
+
+CScriptSnapshot::CScriptSnapshot(CTinyJS &Context) : context(new CTinyJS(&Context)) {}
+CScriptSnapshot::~CScriptSnapshot() { delete context; }
+uint32_t CScriptSnapshot::getVarCount() const { return context->getVarCount(); }
+
+const CScriptVarPtr &CTinyJS::cachedChar(unsigned char Char) {
+	CScriptVarPtr &cached = charCache[Char];
+	if(!cached) {
+		cached = new CScriptVarString(this, string(1, char(Char)));
+		cached->setShared();
+		pseudo_refered.push_back(&cached);
+	}
+	return cached;
+}
+
 //////////////////////////////////////////////////////////////////////////
 /// throws an Error & Exception
 //////////////////////////////////////////////////////////////////////////
@@ -5206,11 +7022,14 @@ void CTinyJS::throwException(ERROR_TYPES ErrorType, const string &message ) {
 }
 
 void CTinyJS::throwError(CScriptResult &execute, ERROR_TYPES ErrorType, const string &message, CScriptTokenizer::ScriptTokenPosition &Pos ){
+	throwError(execute, ErrorType, message, Pos.currentLine(), Pos.currentColumn());
+}
+void CTinyJS::throwError(CScriptResult &execute, ERROR_TYPES ErrorType, const string &message, int Line, int Column ){
 	if(execute && haveTry) {
-		execute.set(CScriptResult::Throw, newScriptVarError(this, ErrorType, message.c_str(), t->currentFile.c_str(), Pos.currentLine(), Pos.currentColumn()));
+		execute.set(CScriptResult::Throw, newScriptVarError(this, ErrorType, message.c_str(), t->currentFile.c_str(), Line, Column));
 		return;
 	}
-	throw CScriptException(ErrorType, message, t->currentFile, Pos.currentLine(), Pos.currentColumn());
+	throw CScriptException(ErrorType, message, t->currentFile, Line, Column);
 }
 void CTinyJS::throwException(ERROR_TYPES ErrorType, const string &message, CScriptTokenizer::ScriptTokenPosition &Pos ){
 	throw CScriptException(ErrorType, message, t->currentFile, Pos.currentLine(), Pos.currentColumn());
@@ -5248,17 +7067,8 @@ CScriptVarLinkPtr CTinyJS::evaluateComplex(CScriptTokenizer &Tokenizer) {
 		throw; // 
 	}
 	t=0;
-	ClearUnreferedVars(execute.value);
-
-	uint32_t UniqueID = allocUniqueID(); 
-	setTemporaryID_recursive(UniqueID);
-	if(execute.value) execute.value->setTemporaryMark_recursive(UniqueID);
-	for(CScriptVar *p = first; p; p=p->next)
-	{
-		if(p->getTemporaryMark() != UniqueID)
-			printf("%s %p\n", p->getVarType().c_str(), p);
-	}
-	freeUniqueID();
+	if(execute.value) execute.value->collectorShade();
+	collectorSafePoint();
 
 	if (execute.value)
 		return CScriptVarLinkPtr(execute.value);
@@ -5287,6 +7097,38 @@ string CTinyJS::evaluate(const string &Code, const string &File, int Line, int C
 CScriptVarFunctionNativePtr CTinyJS::addNative(const string &funcDesc, JSCallback ptr, void *userdata, int LinkFlags) {
 	return addNative(funcDesc, ::newScriptVar(this, ptr, userdata), LinkFlags);
 }
+CScriptVarFunctionNativePtr CTinyJS::addNative(const string &funcDesc, JSFastCallback ptr, void *userdata, int LinkFlags) {
+	return addNative(funcDesc, ::newScriptVar(this, ptr, userdata), LinkFlags);
+}
+
+void CTinyJS::addLazyNatives(const CScriptVarPtr &Object, JSLazyNativesCallback Installer) {
+	Object->lazyNatives = true;
+	lazyNatives.push_back(make_pair(Object.getVar(), Installer));
+}
+
+void CTinyJS::installLazyNatives(CScriptVar *Object) {
+	Object->lazyNatives = false; // the installers adds the natives with addChild
+	vector<JSLazyNativesCallback> installers;
+	for(size_t i=0; i<lazyNatives.size(); ) {
+		if(lazyNatives[i].first == Object) {
+			installers.push_back(lazyNatives[i].second);
+			lazyNatives.erase(lazyNatives.begin()+i);
+		} else
+			++i;
+	}
+	CScriptVarPtr object(Object);
+	for(vector<JSLazyNativesCallback>::iterator it = installers.begin(); it != installers.end(); ++it)
+		(*it)(this, object);
+}
+
+void CTinyJS::removeLazyNatives(CScriptVar *Object) {
+	for(size_t i=0; i<lazyNatives.size(); ) {
+		if(lazyNatives[i].first == Object)
+			lazyNatives.erase(lazyNatives.begin()+i);
+		else
+			++i;
+	}
+}
 
 CScriptVarFunctionNativePtr CTinyJS::addNative(const string &funcDesc, CScriptVarFunctionNativePtr Var, int LinkFlags) {
 	CScriptLex lex(funcDesc.c_str());
@@ -5306,21 +7148,34 @@ CScriptVarFunctionNativePtr CTinyJS::addNative(const string &funcDesc, CScriptVa
 		lex.match(LEX_ID);
 	}
 
-	auto_ptr<CScriptTokenDataFnc> pFunctionData(new CScriptTokenDataFnc);
-	pFunctionData->name = funcName;
+	STRING_VECTOR_t Arguments;
 	lex.match('(');
 	while (lex.tk!=')') {
-		pFunctionData->arguments.push_back(CScriptToken(LEX_T_DESTRUCTURING_VAR, lex.tkStr));
+		Arguments.push_back(lex.tkStr);
 		lex.match(LEX_ID);
 		if (lex.tk!=')') lex.match(',',')');
 	}
 	lex.match(')');
+	return addNative(base, funcName, Var, Arguments, LinkFlags);
+
+}
+CScriptVarFunctionNativePtr CTinyJS::addNative(const CScriptVarPtr &Object, const string &Name, CScriptVarFunctionNativePtr Var, int Arity, int LinkFlags) {
+	STRING_VECTOR_t Arguments;
+	for(int i=0; i<Arity; ++i)
+		Arguments.push_back(string(1, char('a'+i)));
+	return addNative(Object, Name, Var, Arguments, LinkFlags);
+}
+CScriptVarFunctionNativePtr CTinyJS::addNative(const CScriptVarPtr &Base, const string &Name, CScriptVarFunctionNativePtr Var, const STRING_VECTOR_t &Arguments, int LinkFlags) {
+	auto_ptr<CScriptTokenDataFnc> pFunctionData(new CScriptTokenDataFnc);
+	pFunctionData->name = Name;
+	for(STRING_VECTOR_cit it=Arguments.begin(); it!=Arguments.end(); ++it)
+		pFunctionData->arguments.push_back(CScriptToken(LEX_T_DESTRUCTURING_VAR, *it));
+	pFunctionData->hasSimpleArguments(); // checked here - the data of a native is never changed later (see CScriptTokenDataFnc::fork)
 	Var->setFunctionData(pFunctionData.release());
 	Var->addChild(TINYJS_PROTOTYPE_CLASS, newScriptVar(Object), SCRIPTVARLINK_WRITABLE);
 
-	base->addChild(funcName,  Var, LinkFlags);
+	Base->addChild(Name,  Var, LinkFlags);
 	return Var;
-
 }
 
 CScriptVarLinkWorkPtr CTinyJS::parseFunctionDefinition(const CScriptToken &FncToken) {
@@ -5345,60 +7200,115 @@ CScriptVarPtr CTinyJS::callFunction(const CScriptVarFunctionPtr &Function, vecto
 	return retVar;
 }
 
+void CTinyJS::nativeThrow(CScriptResult &execute, const CScriptVarPtr &Exception, const string &FunctionName) {
+	if(haveTry) {
+		execute.setThrow(Exception, "native function '"+FunctionName+"'");
+	} else if(Exception->isError()) {
+		CScriptException err = CScriptVarErrorPtr(Exception)->toCScriptException();
+		if(err.fileName.empty()) err.fileName = "native function '"+FunctionName+"'";
+		throw err;
+	}
+	else
+		throw CScriptException(Error, "uncaught exception: '"+Exception->toString(execute)+"' in native function '"+FunctionName+"'");
+}
+
+bool CTinyJS::iteratorNext(const CScriptVarPtr &Iterator, const CScriptVarFunctionPtr &Next, CScriptVarPtr &Value) {
+	CScriptResult execute;
+	vector<CScriptVarPtr> args;
+	bool old_haveTry = haveTry;
+	haveTry = true; // StopIteration is caught here
+	Value = callFunction(execute, Next, args, Iterator);
+	haveTry = old_haveTry;
+	if(execute.isThrow() && execute.value == constStopIteration) return false;
+	execute.cThrow();
+	return true;
+}
+
 CScriptVarPtr CTinyJS::callFunction(CScriptResult &execute, const CScriptVarFunctionPtr &Function, vector<CScriptVarPtr> &Arguments, const CScriptVarPtr &This, CScriptVarPtr *newThis) {
 	ASSERT(Function && Function->isFunction());
 
 	if(Function->isBounded()) return CScriptVarFunctionBoundedPtr(Function)->callFunction(execute, Arguments, This, newThis);
 
 	CScriptTokenDataFnc *Fnc = Function->getFunctionData();
+	if(Function->isNative() && static_cast<CScriptVarFunctionNative*>(Function.getVar())->isFastCall()) {
+		CScriptVarPtr fastThis = This;
+		const CScriptVarPtr *Args = Arguments.empty() ? 0 : &Arguments[0];
+		size_t Argc = Arguments.size();
+		if(Fnc->hasSimpleArguments() && Fnc->argumentAtoms.size() && Fnc->argumentAtoms.front() == atom_this) { // e.g. String.charAt(this,pos)
+			fastThis = Argc ? *Args++ : constScriptVar(Undefined);
+			if(Argc) --Argc;
+		}
+		try {
+			CScriptVarPtr ret = static_cast<CScriptVarFunctionNativeFast*>(Function.getVar())->callFunction(fastThis, Args, Argc);
+			if(newThis) *newThis = fastThis;
+			return ret ? ret : constScriptVar(Undefined);
+		} catch (CScriptVarPtr v) {
+			nativeThrow(execute, v, Fnc->name);
+		}
+		return constScriptVar(Undefined);
+	}
+
 	CScriptVarScopeFncPtr functionRoot(::newScriptVar(this, ScopeFnc, CScriptVarPtr(Function->findChild(TINYJS_FUNCTION_CLOSURE_VAR))));
 	if(Fnc->name.size()) functionRoot->addChild(Fnc->name, Function);
 	if(!Fnc->isArrowFunction)
 		functionRoot->addChild("this", This);
-	CScriptVarPtr arguments = functionRoot->addChild(TINYJS_ARGUMENTS_VAR, newScriptVar(Object));
 
-	CScopeControl ScopeControl(this);
-	CScriptVarPtr tmpArgsScope = ScopeControl.addLetScope();
-
-	CScriptResult function_execute;
 	size_t length_proto = Fnc->arguments.size();
 	size_t length_arguments = Arguments.size();
-	size_t length = max(length_proto, length_arguments);
+	bool simpleArguments = Fnc->hasSimpleArguments();
 
-	STRING_VECTOR_t arg_names;
-	for(size_t arguments_idx = 0; arguments_idx<length_proto; ++arguments_idx) {
-		ASSERT(Fnc->arguments[arguments_idx].token == LEX_T_DESTRUCTURING_VAR);
-		Fnc->arguments[arguments_idx].DestructuringVar().getVarNames(arg_names);
+	// the arguments-object is only created if it can be referenced (natives read their arguments from it)
+	if(Function->isNative() || Fnc->usesArguments || !simpleArguments) {
+		CScriptVarPtr arguments = functionRoot->addChild(TINYJS_ARGUMENTS_VAR, newScriptVar(Object));
+		for(size_t arguments_idx = 0; arguments_idx<length_arguments; ++arguments_idx)
+			arguments->addChild(int2string(arguments_idx), Arguments[arguments_idx]);
+		arguments->addChild("length", newScriptVar(length_arguments));
 	}
-	for(STRING_VECTOR_it it = arg_names.begin(); it != arg_names.end(); ++it)
-		tmpArgsScope->addChildOrReplace(*it, constUndefined);
 
-	for(size_t arguments_idx = 0; execute && arguments_idx<length; ++arguments_idx) {
-		string arguments_idx_str = int2string(arguments_idx);
-		CScriptVarLinkWorkPtr value;
-		if(arguments_idx < length_arguments)
-			value = arguments->addChild(arguments_idx_str, Arguments[arguments_idx]);
-		else
-			value = constUndefined;
+	CScopeControl ScopeControl(this);
+	CScriptResult function_execute;
+
+	if(simpleArguments) {
+		// plain identifiers - bind them directly. Each call adds the same names in the same order so all frames of a function share one shape
+		for(size_t arguments_idx = 0; arguments_idx<length_proto; ++arguments_idx)
+			functionRoot->addChildOrReplace(Fnc->argumentAtoms[arguments_idx], arguments_idx < length_arguments ? Arguments[arguments_idx] : constScriptVar(Undefined));
+	} else {
+		// default-values and destructuring are evaluated in a temporary scope
+		CScriptVarPtr tmpArgsScope = ScopeControl.addLetScope();
+
+		STRING_VECTOR_t arg_names;
+		for(size_t arguments_idx = 0; arguments_idx<length_proto; ++arguments_idx) {
+			ASSERT(Fnc->arguments[arguments_idx].token == LEX_T_DESTRUCTURING_VAR);
+			Fnc->arguments[arguments_idx].DestructuringVar().getVarNames(arg_names);
+		}
+		for(STRING_VECTOR_it it = arg_names.begin(); it != arg_names.end(); ++it)
+			tmpArgsScope->addChildOrReplace(*it, constUndefined);
+
+		for(size_t arguments_idx = 0; execute && arguments_idx<length_proto; ++arguments_idx) {
+			CScriptVarLinkWorkPtr value;
+			if(arguments_idx < length_arguments)
+				value = Arguments[arguments_idx];
+			else
+				value = constUndefined;
 
-		if(arguments_idx < length_proto) {
 			CScriptTokenDataDestructuringVar &DestructuringVar = Fnc->arguments[arguments_idx].DestructuringVar();
 			if(value->getVarPtr()->isUndefined()) {
 				if(DestructuringVar.assignment.size()) {
 					t->pushTokenScope(DestructuringVar.assignment);
-					assign_destructuring_var(execute, DestructuringVar, execute_assignment(execute), tmpArgsScope);
+					CScriptVarPtr defaultValue = execute_assignment(execute);
+					t->match(LEX_T_END_EXPRESSION); // eat LEX_T_END_EXPRESSION
+					assign_destructuring_var(execute, DestructuringVar, defaultValue, tmpArgsScope);
 				}
 			} else {
 				assign_destructuring_var(execute, DestructuringVar, value, tmpArgsScope);
 			}
 		}
+		if(!execute) return constUndefined;
+		// copy args from tmpArgsScope to functionRoot
+		for(STRING_VECTOR_it it = arg_names.begin(); it != arg_names.end(); ++it) {
+			functionRoot->addChildOrReplace(*it, tmpArgsScope->findChild(*it));
+		}
 	}
-	if(!execute) return constUndefined;
-	// copy args from tmpArgsScope to functionRoot
-	for(STRING_VECTOR_it it = arg_names.begin(); it != arg_names.end(); ++it) {
-		functionRoot->addChildOrReplace(*it, tmpArgsScope->findChild(*it));
-	}
-	arguments->addChild("length", newScriptVar(length_arguments));
 
 #ifndef NO_GENERATORS
 	if(Fnc->isGenerator) {
@@ -5415,15 +7325,7 @@ CScriptVarPtr CTinyJS::callFunction(CScriptResult &execute, const CScriptVarFunc
 			CScriptVarLinkPtr ret = functionRoot->findChild(TINYJS_RETURN_VAR);
 			function_execute.set(CScriptResult::Return, ret ? CScriptVarPtr(ret) : constUndefined);
 		} catch (CScriptVarPtr v) {
-			if(haveTry) {
-				function_execute.setThrow(v, "native function '"+Fnc->name+"'");
-			} else if(v->isError()) {
-				CScriptException err = CScriptVarErrorPtr(v)->toCScriptException();
-				if(err.fileName.empty()) err.fileName = "native function '"+Fnc->name+"'";
-				throw err;
-			}
-			else
-				throw CScriptException(Error, "uncaught exception: '"+v->toString(function_execute)+"' in native function '"+Fnc->name+"'");
+			nativeThrow(function_execute, v, Fnc->name);
 		}
 	} else {
 		/* we just want to execute the block, but something could
@@ -5460,7 +7362,7 @@ void CTinyJS::generator_start(CScriptVarGenerator *Generator)
 
 	// safe callers stackBase & set generators one	
 	Generator->callersStackBase = stackBase;
-	stackBase = 0;
+	stackBase = Generator->getStackLimit();
 
 	// safe callers ScopeSize
 	Generator->callersScopeSize = scopes.size();
@@ -5619,6 +7521,11 @@ CScriptVarPtr CTinyJS::generator_yield(CScriptResult &execute, CScriptVar *Yield
 
 CScriptVarPtr CTinyJS::mathsOp(CScriptResult &execute, const CScriptVarPtr &A, const CScriptVarPtr &B, int op) {
 	if(!execute) return constUndefined;
+	if(A->isNumber() && B->isNumber()) { // fast path - no conversions needed
+		if(op == LEX_TYPEEQUAL) op = LEX_EQUAL;
+		else if(op == LEX_NTYPEEQUAL) op = LEX_NEQUAL;
+		return mathsOp(static_cast<CScriptVarNumber*>(A.getVar())->toNumber_Callback(), static_cast<CScriptVarNumber*>(B.getVar())->toNumber_Callback(), op);
+	}
 	if (op == LEX_TYPEEQUAL || op == LEX_NTYPEEQUAL) {
 		// check type first
 		if( (A->getVarType() == B->getVarType()) ^ (op == LEX_TYPEEQUAL)) return constFalse;
@@ -5641,16 +7548,20 @@ CScriptVarPtr CTinyJS::mathsOp(CScriptResult &execute, const CScriptVarPtr &A, c
 	bool b_isString = b->isString();
 	// both a String or one a String and op='+'
 	if( (a_isString && b_isString) || ((a_isString || b_isString) && op == '+')) {
-		string da = a->isNull() ? "" : a->toString(execute);
-		string db = b->isNull() ? "" : b->toString(execute);
-		switch (op) {
-		case '+':
+		if(op == '+') { // concatenated as rope - the operands are not copied
+			CScriptVarStringPtr sa = a_isString ? a : newScriptVar(a->isNull() ? "" : a->toString(execute));
+			CScriptVarStringPtr sb = b_isString ? b : newScriptVar(b->isNull() ? "" : b->toString(execute));
 			try{
-				return newScriptVar(da+db);
+				return newScriptVarStringConcat(this, sa, sb);
 			} catch(exception& e) {
 				throwError(execute, Error, e.what());
 				return constUndefined;
 			}
+		}
+		// both strings -> compared without copies
+		const CScriptStringRef &da = static_cast<CScriptVarString*>(a.getVar())->getString();
+		const CScriptStringRef &db = static_cast<CScriptVarString*>(b.getVar())->getString();
+		switch (op) {
 		case LEX_EQUAL:	return constScriptVar(da==db);
 		case LEX_NEQUAL:	return constScriptVar(da!=db);
 		case '<':			return constScriptVar(da<db);
@@ -5670,27 +7581,28 @@ CScriptVarPtr CTinyJS::mathsOp(CScriptResult &execute, const CScriptVarPtr &A, c
 		case '>':			return constScriptVar(false);
 		}
 	} 
-	CNumber da = a->toNumber();
-	CNumber db = b->toNumber();
+	return mathsOp(a->toNumber(), b->toNumber(), op);
+}
+CScriptVarPtr CTinyJS::mathsOp(const CNumber &da, const CNumber &db, int op) {
 	switch (op) {
-	case '+':			return a->newScriptVar(da+db);
-	case '-':			return a->newScriptVar(da-db);
-	case '*':			return a->newScriptVar(da*db);
-	case '/':			return a->newScriptVar(da/db);
-	case '%':			return a->newScriptVar(da%db);
-	case '&':			return a->newScriptVar(da.toInt32()&db.toInt32());
-	case '|':			return a->newScriptVar(da.toInt32()|db.toInt32());
-	case '^':			return a->newScriptVar(da.toInt32()^db.toInt32());
-	case '~':			return a->newScriptVar(~da);
-	case LEX_LSHIFT:	return a->newScriptVar(da<<db);
-	case LEX_RSHIFT:	return a->newScriptVar(da>>db);
-	case LEX_RSHIFTU:	return a->newScriptVar(da.ushift(db));
-	case LEX_EQUAL:	return a->constScriptVar(da==db);
-	case LEX_NEQUAL:	return a->constScriptVar(da!=db);
-	case '<':			return a->constScriptVar(da<db);
-	case LEX_LEQUAL:	return a->constScriptVar(da<=db);
-	case '>':			return a->constScriptVar(da>db);
-	case LEX_GEQUAL:	return a->constScriptVar(da>=db);
+	case '+':			return newScriptVar(da+db);
+	case '-':			return newScriptVar(da-db);
+	case '*':			return newScriptVar(da*db);
+	case '/':			return newScriptVar(da/db);
+	case '%':			return newScriptVar(da%db);
+	case '&':			return newScriptVar(da.toInt32()&db.toInt32());
+	case '|':			return newScriptVar(da.toInt32()|db.toInt32());
+	case '^':			return newScriptVar(da.toInt32()^db.toInt32());
+	case '~':			return newScriptVar(~da);
+	case LEX_LSHIFT:	return newScriptVar(da<<db);
+	case LEX_RSHIFT:	return newScriptVar(da>>db);
+	case LEX_RSHIFTU:	return newScriptVar(da.ushift(db));
+	case LEX_EQUAL:	return constScriptVar(da==db);
+	case LEX_NEQUAL:	return constScriptVar(da!=db);
+	case '<':			return constScriptVar(da<db);
+	case LEX_LEQUAL:	return constScriptVar(da<=db);
+	case '>':			return constScriptVar(da>db);
+	case LEX_GEQUAL:	return constScriptVar(da>=db);
 	default: throw CScriptException("This operation not supported on the int datatype");
 	}	
 }
@@ -5754,9 +7666,9 @@ void CTinyJS::execute_var_init( CScriptResult &execute, bool hideLetScope ) {
 		t->match(LEX_T_DESTRUCTURING_VAR);
 		if(t->tk == '=') {
 			t->match('=');
-			if(hideLetScope) CScriptVarScopeLetPtr(scope())->setletExpressionInitMode(true);
+			if(hideLetScope) { CScriptVarScopeLetPtr(scope())->setletExpressionInitMode(true); ++hiddenLetScopes; }
 			CScriptVarPtr Val = execute_assignment(execute);
-			if(hideLetScope) CScriptVarScopeLetPtr(scope())->setletExpressionInitMode(false);
+			if(hideLetScope) { CScriptVarScopeLetPtr(scope())->setletExpressionInitMode(false); --hiddenLetScopes; }
 			assign_destructuring_var(execute, Objc, Val, 0);
 		}
 		if (t->tk == ',') 
@@ -5791,14 +7703,14 @@ void CTinyJS::execute_destructuring(CScriptResult &execute, CScriptTokenDataObje
 			CScriptVarLinkWorkPtr lhs = execute_condition(execute);
 			t->match(LEX_T_END_EXPRESSION); // eat LEX_T_END_EXPRESSION
 			if(lhs->isWritable()) {
-				if (!lhs->isOwned()) {
+				if (!lhs->isOwned() && !lhs.isTypedArrayElement()) {
 					CScriptVarPtr fakedOwner = lhs.getReferencedOwner();
 					if(fakedOwner) {
 						if(!fakedOwner->isExtensible())
 							continue;
-						lhs = fakedOwner->addChildOrReplace(lhs->getName(), lhs);
+						lhs = fakedOwner->addChildOrReplace(lhs->getAtom(), lhs);
 					} else
-						lhs = root->addChildOrReplace(lhs->getName(), lhs);
+						lhs = root->addChildOrReplace(lhs->getAtom(), lhs);
 				}
 				lhs.setter(execute, rhs);
 			}
@@ -5810,14 +7722,15 @@ CScriptVarLinkWorkPtr CTinyJS::execute_literals(CScriptResult &execute) {
 	switch(t->tk) {
 	case LEX_ID: 
 		if(execute) {
-			CScriptVarLinkWorkPtr a(findInScopes(t->tkStr()));
+			const CScriptAtom &id = t->getToken().Atom();
+			CScriptVarLinkWorkPtr a(findInScopes(id, t->getToken().StringData().getInlineCache()));
 			if (!a) {
 				/* Variable doesn't exist! JavaScript says we should create it
 				 * (we won't add it here. This is done in the assignment operator)*/
-				if(t->tkStr() == "this") 
+				if(id.getName() == "this") 
 					a = root; // fake this
 				else
-					a = CScriptVarLinkPtr(constScriptVar(Undefined), t->tkStr());
+					a = CScriptVarLinkPtr(constScriptVar(Undefined), id);
 			} 
 /*
 			prvention for assignment to this is now done by the tokenizer
@@ -5895,7 +7808,10 @@ CScriptVarLinkWorkPtr CTinyJS::execute_literals(CScriptResult &execute) {
 							}
 						} else {
 							t->pushTokenScope(it->value);
-							a->addChildOrReplace(it->id, execute_assignment(execute));
+							if(Objc.type == CScriptTokenDataObjectLiteral::ARRAY)
+								a->setArrayIndex(uint32_t(it-Objc.elements.begin()), execute_assignment(execute));
+							else
+								a->addChildOrReplace(it->id, execute_assignment(execute));
 							t->match(LEX_T_END_EXPRESSION); // eat LEX_T_END_EXPRESSION
 						}
 					}
@@ -5955,7 +7871,7 @@ CScriptVarLinkWorkPtr CTinyJS::execute_literals(CScriptResult &execute) {
 					CScriptVarLinkPtr prototype = Constructor->findChild(TINYJS_PROTOTYPE_CLASS);
 					if(!prototype || prototype->getVarPtr()->isUndefined() || prototype->getVarPtr()->isNull()) {
 						prototype = Constructor->addChild(TINYJS_PROTOTYPE_CLASS, newScriptVar(Object), SCRIPTVARLINK_WRITABLE);
-						obj->addChildOrReplace(TINYJS___PROTO___VAR, prototype, SCRIPTVARLINK_WRITABLE);
+						obj->addChildOrReplace(atom___proto__, prototype, SCRIPTVARLINK_WRITABLE);
 					}
 					CScriptVarLinkPtr __constructor__ = Constructor->findChild("__constructor__");
 					if(__constructor__ && __constructor__->getVarPtr()->isFunction())
@@ -6028,30 +7944,89 @@ CScriptVarLinkWorkPtr CTinyJS::execute_member(CScriptVarLinkWorkPtr &parent, CSc
 			if(execute && (a->getVarPtr()->isUndefined() || a->getVarPtr()->isNull())) {
 				throwError(execute, ReferenceError, a->getName() + " is " + a->toString(execute));
 			}
-			string name;
 			if(t->tk == '.') {
 				t->match('.');
-				name = t->tkStr();
+				CScriptTokenDataString &id = t->getToken().StringData();
 				t->match(LEX_ID);
+				if (execute) member_access(execute, a, id.getAtom(), id.getInlineCache());
 			} else {
 				if(execute) {
 					t->match('[');
-					name = execute_base(execute)->toString(execute);
+					CScriptVarPtr subscript = execute_base(execute);
 					t->match(']');
+					if(execute) member_subscript(execute, a, subscript);
 				} else
 					t->skip(t->getToken().Int());
 			}
-			if (execute) {
-				CScriptVarPtr aVar = a;
-				a = aVar->findChildWithPrototypeChain(name);
+		}
+	}
+	return a;
+}
+/// a = a.Name - a is the "getted" var
+void CTinyJS::member_access(CScriptResult &execute, CScriptVarLinkWorkPtr &a, const CScriptAtom &Name, CScriptInlineCache &Cache) {
+	CScriptVarPtr aVar = a;
+	uint32_t depth;
+	CScriptVarLink *link = Cache.lookup(aVar.getVar(), depth);
+	if(link) {
+		++inlineCacheStats.hits;
+		if(depth) {
+			a(link->getVarPtr(), link->getAtom(), link->getFlags()); // recreate implementation
+			a.setReferencedOwner(aVar); // fake referenced Owner
+		} else
+			a = link;
+	} else {
+		++inlineCacheStats.misses;
+		a = aVar->findChildWithPrototypeChain(Name);
+		if(a)
+			Cache.update(aVar.getVar(), Name);
+		else {
+			a(constScriptVar(Undefined), Name);
+			a.setReferencedOwner(aVar);
+		}
+	}
+}
+/// a = TypedArray[Idx] - the element is read from the buffer. The link is not owned, the setter
+/// writes through the referenced owner to the buffer (see CScriptVarLinkWorkPtr::isTypedArrayElement)
+static void member_typedArrayElement(CScriptVarLinkWorkPtr &a, const CScriptVarPtr &TypedArray, uint32_t Idx) {
+	CScriptVarTypedArray *typedArray = static_cast<CScriptVarTypedArray*>(TypedArray.getVar());
+	if(Idx < typedArray->getLength())
+		a = CScriptVarLinkPtr(::newScriptVar(typedArray->getContext(), typedArray->getElement(Idx)), Idx);
+	else
+		a = CScriptVarLinkPtr(typedArray->constScriptVar(Undefined), Idx);
+	a.setReferencedOwner(TypedArray);
+}
+/// a = a[Subscript] - a is the "getted" var
+void CTinyJS::member_subscript(CScriptResult &execute, CScriptVarLinkWorkPtr &a, const CScriptVarPtr &Subscript) {
+	CScriptVarPtr aVar = a;
+	if(Subscript->isInt()) {
+		int32_t idx = Subscript->toNumber().toInt32();
+		if(idx >= 0) {
+			if(aVar->getElements()) { // array[int] -> no string-conversion
+				a = aVar->findChildWithPrototypeChain(uint32_t(idx));
 				if(!a) {
-					a(constScriptVar(Undefined), name);
+					a = CScriptVarLinkPtr(constScriptVar(Undefined), uint32_t(idx));
 					a.setReferencedOwner(aVar);
 				}
+				return;
+			} else if(aVar->isTypedArray()) {
+				member_typedArrayElement(a, aVar, uint32_t(idx));
+				return;
 			}
 		}
 	}
-	return a;
+	string name = Subscript->toString(execute);
+	if (execute) {
+		uint32_t idx;
+		if(aVar->isTypedArray() && (idx = isArrayIndex(name)) != uint32_t(-1)) {
+			member_typedArrayElement(a, aVar, idx);
+			return;
+		}
+		a = aVar->findChildWithPrototypeChain(name);
+		if(!a) {
+			a(constScriptVar(Undefined), name);
+			a.setReferencedOwner(aVar);
+		}
+	}
 }
 
 CScriptVarLinkWorkPtr CTinyJS::execute_function_call(CScriptResult &execute) {
@@ -6087,7 +8062,7 @@ CScriptVarLinkWorkPtr CTinyJS::execute_function_call(CScriptResult &execute) {
 			CScriptVarLinkWorkPtr returnVar;
 			if(execute) {
 				if (!parent)
-					parent = findInScopes("this");
+					parent = findInScopes(atom_this);
 				// if no parent use the root-scope
 				CScriptVarPtr This(parent ? parent->getVarPtr() : (CScriptVarPtr )root);
 				a = callFunction(execute, fnc, arguments, This);
@@ -6160,20 +8135,7 @@ CScriptVarLinkWorkPtr CTinyJS::execute_unary(CScriptResult &execute) {
 			t->match(op); // pre increment/decrement
 			CScriptTokenizer::ScriptTokenPosition ErrorPos = t->getPos();
 			a = execute_function_call(execute);
-			if (execute) {
-				if(a->getName().empty())
-					throwError(execute, SyntaxError, string("invalid ")+(op==LEX_PLUSPLUS ? "increment" : "decrement")+" operand", ErrorPos);
-				else if(!a->isOwned() && !a.hasReferencedOwner() && !a->getName().empty())
-					throwError(execute, ReferenceError, a->getName() + " is not defined", ErrorPos);
-				CScriptVarPtr res = newScriptVar(a.getter(execute)->getVarPtr()->toNumber(execute).add(op==LEX_PLUSPLUS ? 1 : -1));
-				if(a->isWritable()) {
-					if(!a->isOwned() && a.hasReferencedOwner() && a.getReferencedOwner()->isExtensible())
-						a.getReferencedOwner()->addChildOrReplace(a->getName(), res);
-					else
-						a.setter(execute, res);
-				}
-				a = res;
-			}
+			if (execute) increment_var(execute, a, op, false, ErrorPos.currentLine(), ErrorPos.currentColumn());
 		}
 		break;
 	default:
@@ -6184,24 +8146,29 @@ CScriptVarLinkWorkPtr CTinyJS::execute_unary(CScriptResult &execute) {
 	if (t->tk==LEX_PLUSPLUS || t->tk==LEX_MINUSMINUS) {
 		int op = t->tk;
 		t->match(op);
-		if (execute) {
-			if(a->getName().empty())
-				throwError(execute, SyntaxError, string("invalid ")+(op==LEX_PLUSPLUS ? "increment" : "decrement")+" operand", t->getPrevPos());
-			else if(!a->isOwned() && !a.hasReferencedOwner() && !a->getName().empty())
-				throwError(execute, ReferenceError, a->getName() + " is not defined", t->getPrevPos());
-			CNumber num = a.getter(execute)->getVarPtr()->toNumber(execute);
-			CScriptVarPtr res = newScriptVar(num.add(op==LEX_PLUSPLUS ? 1 : -1));
-			if(a->isWritable()) {
-				if(!a->isOwned() && a.hasReferencedOwner() && a.getReferencedOwner()->isExtensible())
-					a.getReferencedOwner()->addChildOrReplace(a->getName(), res);
-				else
-					a.setter(execute, res);
-			}
-			a = newScriptVar(num);
-		}
+		if (execute) increment_var(execute, a, op, true, t->getPrevPos().currentLine(), t->getPrevPos().currentColumn());
 	}
 	return a;
 }
+/// a++, a--, ++a or --a - a is replaced by the result
+void CTinyJS::increment_var(CScriptResult &execute, CScriptVarLinkWorkPtr &a, int op, bool postfix, int Line, int Column) {
+	if(a->getName().empty())
+		throwError(execute, SyntaxError, string("invalid ")+(op==LEX_PLUSPLUS ? "increment" : "decrement")+" operand", Line, Column);
+	else if(!a->isOwned() && !a.hasReferencedOwner() && !a->getName().empty())
+		throwError(execute, ReferenceError, a->getName() + " is not defined", Line, Column);
+	CNumber num = a.getter(execute)->getVarPtr()->toNumber(execute);
+	CScriptVarPtr res = newScriptVar(num.add(op==LEX_PLUSPLUS ? 1 : -1));
+	if(a->isWritable()) {
+		if(!a->isOwned() && a.hasReferencedOwner() && a.getReferencedOwner()->isExtensible() && !a.isTypedArrayElement())
+			a.getReferencedOwner()->addChildOrReplace(a->getAtom(), res);
+		else
+			a.setter(execute, res);
+	}
+	if(postfix)
+		a = newScriptVar(num);
+	else
+		a = res;
+}
 
 // L->R: Precedence 5 (term) * / %
 CScriptVarLinkWorkPtr CTinyJS::execute_term(CScriptResult &execute) {
@@ -6278,17 +8245,23 @@ CScriptVarLinkWorkPtr CTinyJS::execute_relation(CScriptResult &execute, int set,
 				if(op == LEX_R_IN) {
 					if(!b->getVarPtr()->isObject())
 						throwError(execute, TypeError, "invalid 'in' operand "+nameOf_b);
-					a(constScriptVar( (bool)b->getVarPtr()->findChildWithPrototypeChain(a->toString(execute))));
+					CScriptVarPtr bVar = b->getVarPtr();
+					string name = a->toString(execute);
+					uint32_t idx;
+					if(bVar->isTypedArray() && (idx = isArrayIndex(name)) != uint32_t(-1))
+						a(constScriptVar(idx < static_cast<CScriptVarTypedArray*>(bVar.getVar())->getLength()));
+					else
+						a(constScriptVar( (bool)bVar->findChildWithPrototypeChain(name)));
 				} else if(op == LEX_R_INSTANCEOF) {
 					CScriptVarLinkPtr prototype = b->getVarPtr()->findChild(TINYJS_PROTOTYPE_CLASS);
 					if(!prototype)
 						throwError(execute, TypeError, "invalid 'instanceof' operand "+nameOf_b);
 					else {
 						unsigned int uniqueID = allocUniqueID();
-						CScriptVarPtr object = a->getVarPtr()->findChild(TINYJS___PROTO___VAR);
+						CScriptVarPtr object = a->getVarPtr()->findChild(atom___proto__);
 						while( object && object!=prototype->getVarPtr() && object->getTemporaryMark() != uniqueID) {
 							object->setTemporaryMark(uniqueID); // prevents recursions
-							object = object->findChild(TINYJS___PROTO___VAR);
+							object = object->findChild(atom___proto__);
 						}
 						freeUniqueID();
 						a(constScriptVar(object && object==prototype->getVarPtr()));
@@ -6383,42 +8356,48 @@ CScriptVarLinkPtr CTinyJS::execute_assignment(CScriptVarLinkWorkPtr lhs, CScript
 		CScriptTokenizer::ScriptTokenPosition leftHandPos = t->getPos();
 		t->match(t->tk);
 		CScriptVarLinkWorkPtr rhs = execute_assignment(execute).getter(execute); // L<-R
-		if (execute) {
-			if (!lhs->isOwned() && !lhs.hasReferencedOwner() && lhs->getName().empty()) {
-				throw CScriptException(ReferenceError, "invalid assignment left-hand side (at runtime)", t->currentFile, leftHandPos.currentLine(), leftHandPos.currentColumn());
-			} else if (op != '=' && !lhs->isOwned()) {
-				throwError(execute, ReferenceError, lhs->getName() + " is not defined");
-			}
-			else if(lhs->isWritable()) {
-				if (op=='=') {
-					if (!lhs->isOwned()) {
-						CScriptVarPtr fakedOwner = lhs.getReferencedOwner();
-						if(fakedOwner) {
-							if(!fakedOwner->isExtensible())
-								return rhs->getVarPtr();
-							lhs = fakedOwner->addChildOrReplace(lhs->getName(), lhs);
-						} else
-							lhs = root->addChildOrReplace(lhs->getName(), lhs);
-					}
-					lhs.setter(execute, rhs);
-					return rhs->getVarPtr();
-				} else {
-					CScriptVarPtr result;
-					static int assignments[] = {'+', '-', '*', '/', '%', LEX_LSHIFT, LEX_RSHIFT, LEX_RSHIFTU, '&', '|', '^'};
-					result = mathsOp(execute, lhs, rhs, assignments[op-LEX_PLUSEQUAL]);
-					lhs.setter(execute, result);
-					return result;
-				}
-			} else {
-				// lhs is not writable we ignore lhs & use rhs
-				return rhs->getVarPtr();
-			}
-		}
+		if (execute)
+			return assign_var(execute, lhs, rhs, op, leftHandPos.currentLine(), leftHandPos.currentColumn());
 	}
 	else 
 		CheckRightHandVar(execute, lhs);
 	return lhs.getter(execute);
 }
+/// lhs = rhs or lhs op= rhs - Line & Column is the position of the assignment-operator
+CScriptVarLinkPtr CTinyJS::assign_var(CScriptResult &execute, CScriptVarLinkWorkPtr &lhs, const CScriptVarLinkWorkPtr &rhs, int op, int Line, int Column) {
+	if (!lhs->isOwned() && !lhs.hasReferencedOwner() && lhs->getName().empty()) {
+		throw CScriptException(ReferenceError, "invalid assignment left-hand side (at runtime)", t->currentFile, Line, Column);
+	} else if (op != '=' && !lhs->isOwned() && !lhs.isTypedArrayElement()) {
+		throwError(execute, ReferenceError, lhs->getName() + " is not defined");
+		return lhs.getter(execute);
+	}
+	else if(lhs->isWritable()) {
+		if (op=='=') {
+			if (!lhs->isOwned() && !lhs.isTypedArrayElement()) {
+				CScriptVarPtr fakedOwner = lhs.getReferencedOwner();
+				if(fakedOwner) {
+					if(!fakedOwner->isExtensible())
+						return rhs->getVarPtr();
+					if(lhs->isElement())
+						lhs = fakedOwner->setArrayIndex(lhs->getElementIndex(), lhs);
+					else
+						lhs = fakedOwner->addChildOrReplace(lhs->getAtom(), lhs);
+				} else
+					lhs = root->addChildOrReplace(lhs->getAtom(), lhs);
+			}
+			lhs.setter(execute, rhs);
+			return rhs->getVarPtr();
+		} else {
+			CScriptVarPtr result;
+			static int assignments[] = {'+', '-', '*', '/', '%', LEX_LSHIFT, LEX_RSHIFT, LEX_RSHIFTU, '&', '|', '^'};
+			result = mathsOp(execute, lhs, rhs, assignments[op-LEX_PLUSEQUAL]);
+			lhs.setter(execute, result);
+			return result;
+		}
+	}
+	// lhs is not writable we ignore lhs & use rhs
+	return rhs->getVarPtr();
+}
 // L->R: Precedence 17 (comma) ,
 CScriptVarLinkPtr CTinyJS::execute_base(CScriptResult &execute) {
 	CScriptVarLinkPtr a;
@@ -6468,7 +8447,7 @@ void CTinyJS::execute_statement(CScriptResult &execute) {
 			CScriptTokenDataForwards::FNC_SET_t &functions = t->getToken().Forwarder().functions;
 			for(CScriptTokenDataForwards::FNC_SET_it it=functions.begin(); it!=functions.end(); ++it) {
 				CScriptVarLinkWorkPtr funcVar = parseFunctionDefinition(*it);
-				in_scope->addChildOrReplace(funcVar->getName(), funcVar, SCRIPTVARLINK_VARDEFAULT);
+				in_scope->addChildOrReplace(funcVar->getAtom(), funcVar, SCRIPTVARLINK_VARDEFAULT);
 			}
 			t->match(LEX_T_FORWARD);
 		}
@@ -6529,7 +8508,7 @@ void CTinyJS::execute_statement(CScriptResult &execute) {
 			if(!execute) break;
 	
 			t->pushTokenScope(IfData.condition);
-			bool cond = execute_base(execute)->toBoolean();
+			bool cond = execute_base(execute, IfData.conditionCode)->toBoolean();
 			t->match(LEX_T_END_EXPRESSION); // eat LEX_T_END_EXPRESSION
 			if(execute) {
 				if(cond) {
@@ -6567,6 +8546,7 @@ void CTinyJS::execute_statement(CScriptResult &execute) {
 			if(!execute) break;
 			CScriptResult tmp_execute;
 			for(;;) {
+				collectorSafePoint();
 				bool old_haveTry = haveTry;
 				haveTry = true;
 				tmp_execute.set(CScriptResult::Normal, Iterator);
@@ -6621,10 +8601,11 @@ void CTinyJS::execute_statement(CScriptResult &execute) {
 			bool loopCond = true;	// Empty Condition -->always true
 			if(LoopData.type != CScriptTokenDataLoop::DO && LoopData.condition.size()) {
 				t->pushTokenScope(LoopData.condition);
-				loopCond = execute_base(execute)->toBoolean();
+				loopCond = execute_base(execute, LoopData.conditionCode)->toBoolean();
 				if(!execute) break;
 			}
 			while (loopCond && execute) {
+				collectorSafePoint();
 				t->pushTokenScope(LoopData.body);
 				execute_statement(execute);
 				if(!execute) {
@@ -6639,11 +8620,11 @@ void CTinyJS::execute_statement(CScriptResult &execute) {
 				}
 				if(LoopData.type == CScriptTokenDataLoop::FOR && execute && LoopData.iter.size()) {
 					t->pushTokenScope(LoopData.iter);
-					execute_base(execute);
+					execute_base(execute, LoopData.iterCode);
 				}
 				if(execute && LoopData.condition.size()) {
 					t->pushTokenScope(LoopData.condition);
-					loopCond = execute_base(execute)->toBoolean();
+					loopCond = execute_base(execute, LoopData.conditionCode)->toBoolean();
 				}
 			}
 		}
@@ -6671,14 +8652,15 @@ void CTinyJS::execute_statement(CScriptResult &execute) {
 			if (t->tk != ';')
 				result = execute_base(execute);
 			t->match(';');
-			execute.set(CScriptResult::Return, result);
+			if(execute) // an exception thrown by the expression is not overwritten
+				execute.set(CScriptResult::Return, result);
 		} else
 			t->skip(t->getToken().Int());
 		break;
 	case LEX_R_FUNCTION:
 		if(execute) {
 			CScriptVarLinkWorkPtr funcVar = parseFunctionDefinition(t->getToken());
-			scope()->scopeVar()->addChildOrReplace(funcVar->getName(), funcVar, SCRIPTVARLINK_VARDEFAULT);
+			scope()->scopeVar()->addChildOrReplace(funcVar->getAtom(), funcVar, SCRIPTVARLINK_VARDEFAULT);
 		}
 	case LEX_T_FUNCTION_PLACEHOLDER:
 		t->match(t->tk);
@@ -6855,7 +8837,7 @@ end_while:
 		if(t->tk!=LEX_T_SKIP || execute) {
 			if(t->tk==LEX_T_SKIP) t->match(LEX_T_SKIP);
 			/* Execute a simple statement that only contains basic arithmetic... */
-			CScriptVarPtr ret = execute_base(execute);
+			CScriptVarPtr ret = t->tk==LEX_ID ? execute_base(execute, t->getToken().StringData().statementCode) : execute_base(execute);
 			if(execute) execute.set(CScriptResult::Normal, CScriptVarPtr(ret));
 			t->match(';');
 		} else
@@ -6864,11 +8846,176 @@ end_while:
 	}
 }
 
+/// executes the expression with the bytecode-VM if the expression is compilable - otherwise with the token-walker
+CScriptVarLinkPtr CTinyJS::execute_base(CScriptResult &execute, CScriptBytecodeSlot &Code) {
+	if(useBytecode && execute && !Code.notCompilable) {
+		CScriptTokenizer::ScriptTokenPosition &pos = t->getPos();
+		if(!Code.code && !(Code.code = CScriptBytecode::compile(pos.pos, pos.tokens->end())))
+			Code.notCompilable = true;
+		else if(Code.code->begin == &*pos.pos) { // a copy of the token with the slot can begin an other expression
+			CScriptVarLinkPtr ret = execute_bytecode(execute, *Code.code);
+			t->skip(Code.code->tokens);
+			return ret;
+		}
+	}
+	return execute_base(execute);
+}
+
+CScriptVarLinkWorkPtr CTinyJS::execute_bytecode(CScriptResult &execute, CScriptBytecode &Code) {
+	CScriptVarLinkWorkPtr r[BYTECODE_REGISTERS];
+	const CScriptBytecode::Instruction *code = &Code.code.front();
+	for(int32_t ip=0, end=int32_t(Code.code.size()); ip<end && execute; ++ip) {
+		const CScriptBytecode::Instruction &i = code[ip];
+		CScriptVarLinkWorkPtr &a = r[i.a];
+		switch(i.op) {
+		case BC_LOAD_ID:
+			a = findInScopes(Code.atoms[i.k], Code.caches[i.b]);
+			if(!a) {
+				/* Variable doesn't exist! JavaScript says we should create it
+				 * (we won't add it here. This is done in the assignment operator)*/
+				if(Code.atoms[i.k] == atom_this)
+					a = root; // fake this
+				else
+					a(constScriptVar(Undefined), Code.atoms[i.k]);
+			}
+			break;
+		case BC_LOAD_INT:
+			{
+				CScriptVarPtr var = newScriptVar(i.k);
+				var->setExtensible(false);
+				a(var);
+			}
+			break;
+		case BC_LOAD_FLOAT:
+			a(newScriptVar(Code.floats[i.k]));
+			break;
+		case BC_LOAD_STRING:
+			a(newScriptVar(Code.strings[i.k]));
+			break;
+		case BC_LOAD_CONST:
+			if(i.k == LEX_R_NULL)
+				a(constScriptVar(Null));
+			else
+				a(constScriptVar(i.k == LEX_R_TRUE));
+			break;
+		case BC_SWAP:
+			a.swap(r[i.b]);
+			break;
+		case BC_CHECK:
+		case BC_CHECK_GET:
+			if(a && !a->isOwned() && !a.hasReferencedOwner() && !a->getName().empty())
+				throwError(execute, ReferenceError, a->getName() + " is not defined", i.line, i.column);
+			else if(i.op == BC_CHECK_GET && a->getVarPtr()->isAccessor())
+				a = a.getter(execute);
+			break;
+		case BC_OBJECT:
+		case BC_MEMBER:
+			{
+				CScriptVarLinkWorkPtr &obj = r[i.a+1];
+				a.swap(obj);
+				obj = a.getter(execute); // obj is now the "getted" var
+				if(execute && (obj->getVarPtr()->isUndefined() || obj->getVarPtr()->isNull()))
+					throwError(execute, ReferenceError, obj->getName() + " is " + obj->toString(execute), i.line, i.column);
+				if(execute && i.op == BC_MEMBER)
+					member_access(execute, obj, Code.atoms[i.k], Code.caches[i.b]);
+			}
+			break;
+		case BC_SUBSCRIPT:
+			member_subscript(execute, r[i.a+1], r[i.a+2]);
+			break;
+		case BC_CALLEE:
+			{
+				CScriptVarLinkWorkPtr &fnc = r[i.a+1];
+				if(fnc->getVarPtr()->isUndefined() || fnc->getVarPtr()->isNull())
+					throwError(execute, ReferenceError, fnc->getName() + " is " + fnc->toString(execute), i.line, i.column);
+				CScriptVarPtr Fnc = fnc.getter(execute)->getVarPtr();
+				if (!Fnc->isFunction())
+					throwError(execute, TypeError, fnc->getName() + " is not a function", i.line, i.column);
+				if (stackBase) {
+					int dummy;
+					if(&dummy < stackBase)
+						throwError(execute, Error, "too much recursion", i.line, i.column);
+				}
+				fnc(Fnc);
+			}
+			break;
+		case BC_CALL:
+			{
+				vector<CScriptVarPtr> arguments;
+				arguments.reserve(i.b);
+				for(int arg=0; arg<i.b; ++arg)
+					arguments.push_back(r[i.a+2+arg]);
+				CScriptVarPtr This;
+				if(i.k < 0)
+					This = a->getVarPtr();
+				else {
+					CScriptVarLinkPtr parent = findInScopes(atom_this, Code.caches[i.k]);
+					This = parent ? parent->getVarPtr() : (CScriptVarPtr)root; // if no parent use the root-scope
+				}
+				CScriptVarLinkWorkPtr &fnc = r[i.a+1];
+				fnc = callFunction(execute, fnc->getVarPtr(), arguments, This);
+			}
+			break;
+		case BC_MATHS_OP:
+			{
+				CScriptVarLinkWorkPtr &b = r[i.b];
+				if(a->getVarPtr()->isAccessor()) a = a.getter(execute);
+				if(b->getVarPtr()->isAccessor()) b = b.getter(execute);
+				a(mathsOp(execute, a->getVarPtr(), b->getVarPtr(), i.k));
+			}
+			break;
+		case BC_UNARY:
+			switch(i.k) {
+			case '-': a(newScriptVar(-a->getVarPtr()->toNumber(execute))); break;
+			case '+': a(newScriptVar(a->getVarPtr()->toNumber(execute))); break;
+			case '!': a(constScriptVar(!a->getVarPtr()->toBoolean())); break;
+			case '~': a(newScriptVar(~a->getVarPtr()->toNumber(execute))); break;
+			}
+			break;
+		case BC_INCREMENT:
+			increment_var(execute, a, i.k, i.b != 0, i.line, i.column);
+			break;
+		case BC_ASSIGN:
+			a = assign_var(execute, a, r[i.b], i.k, i.line, i.column);
+			break;
+		case BC_JUMP:
+			ip = i.k-1;
+			break;
+		case BC_JUMP_TRUE:
+			if(a->getVarPtr()->toBoolean()) ip = i.k-1;
+			break;
+		case BC_JUMP_FALSE:
+			if(!a->getVarPtr()->toBoolean()) ip = i.k-1;
+			break;
+		}
+	}
+	if(!r[0]) // stopped by an exception before the result is set - like the token-walker a valid link is returned
+		return CScriptVarLinkWorkPtr(constScriptVar(Undefined));
+	return r[0];
+}
+
+
 
 /// Finds a child, looking recursively up the scopes
 CScriptVarLinkPtr CTinyJS::findInScopes(const string &childName) {
+	return scope()->findInScopes(CScriptAtom(childName));
+}
+CScriptVarLinkPtr CTinyJS::findInScopes(const CScriptAtom &childName) {
 	return scope()->findInScopes(childName);
 }
+CScriptVarLinkPtr CTinyJS::findInScopes(const CScriptAtom &childName, CScriptInlineCache &Cache) {
+	if(hiddenLetScopes) return scope()->findInScopes(childName);
+	CScriptVar *Scope = scope().getVar();
+	CScriptVarLink *link = Cache.lookupInScopes(Scope);
+	if(link) {
+		++inlineCacheStats.hits;
+		return link;
+	}
+	++inlineCacheStats.misses;
+	CScriptVarLinkPtr ret = scope()->findInScopes(childName);
+	if(ret) Cache.updateInScopes(Scope, childName);
+	return ret;
+}
 
 //////////////////////////////////////////////////////////////////////////
 /// Object
@@ -6986,6 +9133,9 @@ void CTinyJS::native_Object_prototype_hasOwnProperty(const CFunctionsScopePtr &c
 		if(This_asString) {
 			uint32_t Idx = isArrayIndex(PropStr);
 			res = Idx!=uint32_t(-1) && Idx<This_asString->stringLength();
+		} else if(This->isTypedArray()) {
+			uint32_t Idx = isArrayIndex(PropStr);
+			res = Idx!=uint32_t(-1) && Idx<static_cast<CScriptVarTypedArray*>(This.getVar())->getLength();
 		}
 	}
 	c->setReturnVar(c->constScriptVar(res));
@@ -7050,9 +9200,6 @@ void CTinyJS::native_RegExp(const CFunctionsScopePtr &c, void *data) {
 	string RegExp, Flags;
 	if(arglen>=1) {
 		RegExp = c->getArgument(0)->toString();
-		try { regex(RegExp, regex_constants::ECMAScript); } catch(regex_error e) {
-			c->throwError(SyntaxError, string(e.what())+" - "+CScriptVarRegExp::ErrorStr(e.code()));
-		}
 		if(arglen>=2) {
 			Flags = c->getArgument(1)->toString();
 			string::size_type pos = Flags.find_first_not_of("gimy");
@@ -7060,6 +9207,10 @@ void CTinyJS::native_RegExp(const CFunctionsScopePtr &c, void *data) {
 				c->throwError(SyntaxError, string("invalid regular expression flag ")+Flags[pos]);
 			}
 		} 
+		// checks the regexp and puts it in the cache
+		try { regexCache.get(RegExp, Flags.find('i')!=string::npos, Flags.find('m')!=string::npos); } catch(CScriptRegexError &e) {
+			c->throwError(SyntaxError, e.what());
+		}
 	}
 	c->setReturnVar(newScriptVar(RegExp, Flags));
 }
@@ -7172,7 +9323,7 @@ void CTinyJS::native_Function_prototype_apply(const CFunctionsScopePtr &c, void
 	}
 	vector<CScriptVarPtr> Args;
 	for(int i=0; i<length; i++) {
-		CScriptVarLinkPtr value = Array->findChild(int2string(i));
+		CScriptVarLinkPtr value = Array->getArrayIndexLink(i);
 		if(value) Args.push_back(value);
 		else Args.push_back(constScriptVar(Undefined));
 	}
@@ -7330,23 +9481,149 @@ void CTinyJS::setTemporaryID_recursive(uint32_t ID) {
 }
 
 void CTinyJS::ClearUnreferedVars(const CScriptVarPtr &extra/*=CScriptVarPtr()*/) {
+	if(collectorPhase != COLLECTOR_IDLE) { // finish the running collection - the vars unreferenced while it was running are found by the next one
+		if(extra) extra->collectorShade();
+		collectorStep(0);
+	}
+	collectorStart(extra);
+	collectorStep(0);
+}
+
+CScriptHeapReport CTinyJS::getHeapReport(bool Collect/*=true*/, uint32_t MaxSamples/*=8*/) {
+	if(Collect) ClearUnreferedVars();
+	CScriptHeapReport report;
 	uint32_t UniqueID = allocUniqueID(); 
 	setTemporaryID_recursive(UniqueID);
-	if(extra) extra->setTemporaryMark_recursive(UniqueID);
-	CScriptVar *p = first;
-
-	while(p)
-	{
-		if(p->getTemporaryMark() != UniqueID)
-		{
-			CScriptVarPtr var = p;
-			var->removeAllChildren();
-			p = var->next;
+	for(CScriptVar *p = first; p; p=p->next) {
+		CScriptVarObject *object = dynamic_cast<CScriptVarObject*>(p);
+		CScriptHeapReport::Type &type = report.types[object ? object->getVarTypeTagName() : p->getVarType()];
+		++report.count;
+		++type.count;
+		if(p->getTemporaryMark() != UniqueID) {
+			++report.unreachable;
+			++type.unreachable;
+			if(type.samples.size() < MaxSamples) type.samples.push_back(p);
 		}
-		else
-			p = p->next;
 	}
 	freeUniqueID();
+	return report;
+}
+
+void CTinyJS::collectorStart(const CScriptVarPtr &extra) {
+	ASSERT(collectorPhase == COLLECTOR_IDLE);
+	++collectorEpoch;
+	collectorAllocs = 0;
+	collectorPhase = COLLECTOR_MARK;
+	for(vector<CScriptVarPtr*>::iterator it = pseudo_refered.begin(); it!=pseudo_refered.end(); ++it)
+		if(**it) (**it)->collectorShade();
+	for(int i=Error; i<ERROR_COUNT; i++)
+		if(errorPrototypes[i]) errorPrototypes[i]->collectorShade();
+	if(root) root->collectorShade();
+	if(extra) extra->collectorShade();
+}
+
+bool CTinyJS::collectorStep(uint32_t Budget) {
+	for(uint32_t work=0; !Budget || work<Budget; ++work) {
+		if(collectorPhase == COLLECTOR_MARK) {
+			if(!collectorMarkNext() && !collectorMarkWeak()) {
+				collectorPhase = COLLECTOR_SCAN;
+				collectorScanCursor = first;
+			}
+		} else if(collectorPhase == COLLECTOR_SCAN) {
+			CScriptVar *p = collectorScanCursor;
+			if(!p) {
+				if(!collectorNoRescue) collectorRescue();
+				for(vector<CScriptVarPtr>::iterator it = collectorWeakHolders.begin(); it != collectorWeakHolders.end(); ++it)
+					(*it)->removeWeakReferences(collectorEpoch);
+				vector<CScriptVarPtr>().swap(collectorWeakHolders);
+				collectorPhase = COLLECTOR_SWEEP;
+				collectorSweepPos = 0;
+				continue;
+			}
+			if(p->collectorMark != collectorEpoch)
+				collectorCandidates.push_back(p);
+			collectorScanCursor = p->next;
+		} else if(collectorPhase == COLLECTOR_SWEEP) {
+			if(collectorSweepPos >= collectorCandidates.size()) {
+				collectorPhase = COLLECTOR_IDLE;
+				vector<CScriptVarPtr>().swap(collectorCandidates); // frees the garbage
+				collectThreshold = max(uint32_t(CYCLE_COLLECTOR_MIN_THRESHOLD), varCount*2);
+				break;
+			}
+			CScriptVarPtr &var = collectorCandidates[collectorSweepPos++];
+			if(var->collectorMark != collectorEpoch)
+				var->removeAllChildren();
+		} else
+			break;
+	}
+	return collectorPhase == COLLECTOR_IDLE;
+}
+
+bool CTinyJS::collectorMarkNext() {
+	if(collectorMarkStack.empty()) return false;
+	CScriptVarPtr var = collectorMarkStack.back();
+	collectorMarkStack.pop_back();
+	vector<CScriptVar*> refs;
+	var->getReferences(refs);
+	for(vector<CScriptVar*>::iterator it = refs.begin(); it != refs.end(); ++it)
+		(*it)->collectorShade();
+	refs.clear();
+	var->getWeakReferences(refs);
+	if(refs.size()) collectorWeakHolders.push_back(var);
+	return true;
+}
+
+bool CTinyJS::collectorMarkWeak() {
+	vector<CScriptVar*> pairs;
+	for(vector<CScriptVarPtr>::iterator it = collectorWeakHolders.begin(); it != collectorWeakHolders.end(); ++it) {
+		(*it)->getWeakReferences(pairs);
+		for(vector<CScriptVar*>::iterator pair = pairs.begin(); pair != pairs.end(); pair+=2)
+			if(pair[0]->collectorMark == collectorEpoch) pair[1]->collectorShade();
+		pairs.clear();
+	}
+	return !collectorMarkStack.empty();
+}
+
+typedef pair<CScriptVar*, int> COLLECTOR_COUNT_t;
+static bool collectorCountLess(const COLLECTOR_COUNT_t &a, CScriptVar *b) { return a.first < b; }
+static void collectorUncount(vector<COLLECTOR_COUNT_t> &counts, vector<CScriptVar*> &refs) {
+	for(vector<CScriptVar*>::iterator ref = refs.begin(); ref != refs.end(); ++ref) {
+		vector<COLLECTOR_COUNT_t>::iterator count = lower_bound(counts.begin(), counts.end(), *ref, collectorCountLess);
+		if(count != counts.end() && count->first == *ref) --count->second;
+	}
+	refs.clear();
+}
+void CTinyJS::collectorRescue() {
+	// counts the references of each candidate, that are not held by other candidates (nor by collectorCandidates itself)
+	// or by weak pairs (the pairs of a candidate are garbage, the pairs of a marked var are handled by collectorMarkWeak)
+	vector<COLLECTOR_COUNT_t> counts;
+	counts.reserve(collectorCandidates.size());
+	for(vector<CScriptVarPtr>::iterator it = collectorCandidates.begin(); it != collectorCandidates.end(); ++it)
+		counts.push_back(COLLECTOR_COUNT_t(it->getVar(), (*it)->getRefs()-1));
+	sort(counts.begin(), counts.end());
+	vector<CScriptVar*> refs;
+	for(vector<CScriptVarPtr>::iterator it = collectorCandidates.begin(); it != collectorCandidates.end(); ++it) {
+		(*it)->getReferences(refs);
+		(*it)->getWeakReferences(refs);
+		collectorUncount(counts, refs);
+	}
+	for(vector<CScriptVarPtr>::iterator it = collectorWeakHolders.begin(); it != collectorWeakHolders.end(); ++it) {
+		(*it)->getWeakReferences(refs);
+		collectorUncount(counts, refs);
+	}
+	// the candidates with references from outside are alive - and all vars reachable from them
+	collectorPhase = COLLECTOR_MARK;
+	for(vector<COLLECTOR_COUNT_t>::iterator it = counts.begin(); it != counts.end(); ++it)
+		if(it->second > 0) it->first->collectorShade();
+	do { while(collectorMarkNext()); } while(collectorMarkWeak());
+}
+
+void CTinyJS::collectorSlice() {
+	if(collectorPhase == COLLECTOR_IDLE) collectorStart(CScriptVarPtr());
+	uint32_t budget = collectorBudget;
+	if(budget) budget = max(budget, collectorAllocs*CYCLE_COLLECTOR_STEP_RATIO);
+	collectorAllocs = 0;
+	collectorStep(budget);
 }
 
 
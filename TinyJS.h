@@ -43,6 +43,7 @@
 #include <vector>
 #include <map>
 #include <set>
+#include <list>
 #include <stdint.h> // <cstdint> is C++11
 #include <cstring>
 #include <cassert>
@@ -59,6 +60,7 @@
 #	include "pool_allocator.h"
 #endif
 #include "TinyJS_Threading.h"
+#include "TinyJS_RegExp.h"
 
 
 #ifdef _MSC_VER
@@ -192,6 +194,7 @@ enum LEX_TYPES {
 
 };
 #define LEX_TOKEN_DATA_STRING(tk)							((LEX_TOKEN_STRING_BEGIN<= tk && tk <= LEX_TOKEN_STRING_END))
+#define LEX_TOKEN_DATA_ATOM(tk)								(tk==LEX_ID || tk==LEX_T_LABEL || tk==LEX_T_DUMMY_LABEL) /* string-data as CScriptAtom */
 #define LEX_TOKEN_DATA_FLOAT(tk)							(tk==LEX_FLOAT)
 #define LEX_TOKEN_DATA_LOOP(tk)								(LEX_TOKEN_FOR_BEGIN <= tk && tk <= LEX_TOKEN_FOR_END)
 #define LEX_TOKEN_DATA_FUNCTION(tk)							(LEX_TOKEN_FUNCTION_BEGIN <= tk && tk <= LEX_TOKEN_FUNCTION_END)
@@ -231,6 +234,21 @@ extern const char *ERROR_NAME[];
 
 #define TEMPORARY_MARK_SLOTS 5
 
+/// Vars without cycles are freed by the reference-counting. Cycles are collected by a
+/// mark & sweep (see CTinyJS::collectorStep) at the loop back-edges and at the end of evaluateComplex - but only if
+/// the number of vars has grown to twice the number of survivors of the last collection.
+/// So the costs of the collector are proportional to the live vars and not to the count of evaluations
+#define CYCLE_COLLECTOR_MIN_THRESHOLD 4096 ///< no collections below this number of vars
+#define CYCLE_COLLECTOR_STEP_RATIO 8 ///< a slice does at least this units of work for each var created since the last slice
+
+#ifndef VALUE_CACHE_INT_MIN
+#	define VALUE_CACHE_INT_MIN -1024 ///< see VALUE-CACHES in config.h
+#endif
+#ifndef VALUE_CACHE_INT_MAX
+#	define VALUE_CACHE_INT_MAX 65535
+#endif
+#define VALUE_CACHE_INT_BLOCK 256 ///< the integer-cache is allocated in blocks of this size
+
 #define TINYJS_RETURN_VAR					"return"
 #define TINYJS_LOKALE_VAR					"__locale__"
 #define TINYJS_ANONYMOUS_VAR				"__anonymous__"
@@ -266,6 +284,59 @@ std::string int2string(size_t intData);
 std::string float2string(const double &floatData);
 
 
+//////////////////////////////////////////////////////////////////////////
+/// CScriptAtom
+//////////////////////////////////////////////////////////////////////////
+
+/// An interned string used for property-names and identifiers.
+/// All atoms are stored in a global table, so two atoms are equal if and only if their IDs are equal.
+/// The atoms are reference-counted (thread-safe) - an atom is removed from the table with its
+/// last reference and its ID is reused, so the table holds the names in use only.
+/// The atom with ID 0 is the empty string (TINYJS_TEMP_NAME).
+class CScriptAtom {
+public:
+	CScriptAtom() : id(0) {}
+	explicit CScriptAtom(const std::string &Name) : id(intern(Name)) {}
+	explicit CScriptAtom(const char *Name) : id(intern(Name)) {}
+	CScriptAtom(const CScriptAtom &Copy) : id(Copy.id) { if(id) ref(id); }
+	~CScriptAtom() { if(id) release(id); }
+	CScriptAtom &operator=(const CScriptAtom &Copy) {
+		if(Copy.id) ref(Copy.id);
+		if(id) release(id);
+		id = Copy.id;
+		return *this;
+	}
+#ifdef HAVE_CXX11_RVALUE_REFERENCE
+	CScriptAtom(CScriptAtom &&Other) : id(Other.id) { Other.id = 0; }
+	CScriptAtom &operator=(CScriptAtom &&Other) {
+		if(this != &Other) {
+			uint32_t old = id;
+			id = Other.id; Other.id = 0;
+			if(old) release(old);
+		}
+		return *this;
+	}
+#endif
+	/// looks up Name without interning it. returns false if Name is not in use
+	static bool find(const std::string &Name, CScriptAtom &Atom);
+	static uint32_t getCount(); ///< the number of atoms in use
+
+	uint32_t getID() const { return id; }
+	const std::string &getName() const;
+	uint32_t getArrayIndex() const; ///< the array-index represented by the name or uint32_t(-1)
+	bool empty() const { return id == 0; }
+
+	bool operator==(const CScriptAtom &rhs) const { return id == rhs.id; }
+	bool operator!=(const CScriptAtom &rhs) const { return id != rhs.id; }
+	bool operator<(const CScriptAtom &rhs) const { return id < rhs.id; } ///< order of the IDs - not alphabetical
+private:
+	static uint32_t intern(const std::string &Name);
+	static void ref(uint32_t ID);
+	static void release(uint32_t ID);
+	uint32_t id;
+};
+
+
 //////////////////////////////////////////////////////////////////////////
 /// CScriptException
 //////////////////////////////////////////////////////////////////////////
@@ -331,23 +402,29 @@ private:
 //////////////////////////////////////////////////////////////////////////
 
 class CScriptToken;
+class CScriptVarForker;
 typedef  std::vector<CScriptToken> TOKEN_VECT;
 typedef  std::vector<CScriptToken>::iterator TOKEN_VECT_it;
 typedef  std::vector<CScriptToken>::const_iterator TOKEN_VECT_cit;
+/// The token-data is shared by the copies of a token - also by the contexts forked from a CScriptSnapshot
+/// (maybe in other threads), so the references are counted atomic. A forked context gets its own copy of the
+/// data changed while executing (inline-caches, bytecode) - see fork and CScriptVarForker::forkTokenData
 class CScriptTokenData
 {
 protected:
-	CScriptTokenData() : refs(0){}
+	CScriptTokenData() {}
+	CScriptTokenData(const CScriptTokenData &) {} ///< a copy is unreferenced
 	virtual ~CScriptTokenData() {}
 private:
-//	CScriptTokenData(const CScriptTokenData &noCopy);
-//	CScriptTokenData &operator=(const CScriptTokenData &noCopy);
+	CScriptTokenData &operator=(const CScriptTokenData &noCopy) MEMBER_DELETE;
 public:
-	void ref() { refs++; }
+	void ref() { ++refs; }
 	void unref() { if(--refs == 0) delete this; }
 	virtual void serialize(std::ostream &) const=0; 
+	/// the data for a forked context - a copy of the data changed while executing. The tokens of the copy are forked by Forker.forkTokens
+	virtual CScriptTokenData *fork(CScriptVarForker &Forker)=0;
 private:
-	int refs;
+	CScriptAtomicCounter refs;
 };
 template<typename C>
 class CScriptTokenDataPtr {
@@ -372,22 +449,101 @@ private:
 	C *ptr;
 };
 
+//////////////////////////////////////////////////////////////////////////
+/// CScriptInlineCache
+//////////////////////////////////////////////////////////////////////////
+
+/// A polymorphic inline cache for a member access (obj.name).
+/// Each entry remembers for a receiver-shape the slot of the property
+/// or the path through the prototype-chain to the holder of the property.
+/// The shapes are identified by their IDs (the pointers could be reused).
+/// For identifiers the same cache resolves the variable to a (depth, slot)
+/// address in the scope-chain - the path follows the parent-scopes and
+/// the shapes of all scopes on the path proves that no scope in between
+/// has declared the name since the address was recorded.
+#define INLINE_CACHE_ENTRIES 4		///< max. number of receiver-shapes per access site
+#define INLINE_CACHE_MAX_DEPTH 8	///< properties deeper in the prototype- or scope-chain are not cached
+
+class CScriptVar;
+class CScriptVarLink;
+class CScriptInlineCache : public fixed_size_object<CScriptInlineCache> {
+public:
+	CScriptInlineCache() : count(0), replace(0) {}
+	/// returns the link of the property or 0 if the shape of Receiver is not cached. Depth is set to 0 for own properties
+	CScriptVarLink *lookup(CScriptVar *Receiver, uint32_t &Depth);
+	/// records the path to the property Name for the shape of Receiver
+	void update(CScriptVar *Receiver, const CScriptAtom &Name);
+	/// returns the link of the variable or 0 if the scope-chain of Scope is not cached
+	CScriptVarLink *lookupInScopes(CScriptVar *Scope);
+	/// records the path to the variable Name for the scope-chain of Scope (with-scopes are never cached)
+	void updateInScopes(CScriptVar *Scope, const CScriptAtom &Name);
+private:
+	struct Entry {
+		uint64_t shapeIDs[INLINE_CACHE_MAX_DEPTH+1]; ///< receiver, __proto__, __proto__.__proto__ ... or the scopes
+		uint32_t protoSlots[INLINE_CACHE_MAX_DEPTH]; ///< slots of the __proto__ links or of the parent-scopes (SHAPE_NO_SLOT for the root-scope)
+		uint32_t slot; ///< slot of the property in the holder
+		uint32_t depth; ///< 0 == own property
+	};
+	void add(const Entry &entry);
+	Entry entries[INLINE_CACHE_ENTRIES];
+	uint32_t count;
+	uint32_t replace; ///< next entry to replace if all entries used
+};
+
+struct CScriptInlineCacheStats {
+	CScriptInlineCacheStats() : hits(0), misses(0) {}
+	uint64_t hits;
+	uint64_t misses;
+};
+
+//////////////////////////////////////////////////////////////////////////
+/// CScriptBytecodeSlot
+//////////////////////////////////////////////////////////////////////////
+
+class CScriptBytecode;
+/// holds the bytecode of an expression. The code is compiled on the first execution
+/// (see CTinyJS::setUseBytecode) and is never shared - a copied slot is uncompiled
+class CScriptBytecodeSlot {
+public:
+	CScriptBytecodeSlot() : code(0), notCompilable(false) {}
+	CScriptBytecodeSlot(const CScriptBytecodeSlot &) : code(0), notCompilable(false) {}
+	~CScriptBytecodeSlot();
+	CScriptBytecodeSlot &operator=(const CScriptBytecodeSlot &) { return *this; }
+	CScriptBytecode *code;
+	bool notCompilable; ///< the expression uses constructs not supported by the bytecode
+};
+
 class CScriptTokenDataString : public fixed_size_object<CScriptTokenDataString>, public CScriptTokenData {
 public:
-	CScriptTokenDataString() {}
-	CScriptTokenDataString(const std::string &String) : tokenStr(String) {}
+	CScriptTokenDataString() : inlineCache(0) {}
+	CScriptTokenDataString(const std::string &String) : tokenStr(String), inlineCache(0) {}
+	CScriptTokenDataString(const CScriptAtom &Atom) : atom(Atom), inlineCache(0) {} ///< for identifiers and labels
+	CScriptTokenDataString(const CScriptTokenDataString &Copy) : CScriptTokenData(), tokenStr(Copy.tokenStr), atom(Copy.atom), inlineCache(0) {}
 	CScriptTokenDataString(std::istream &in); 
+	virtual ~CScriptTokenDataString() { delete inlineCache; }
 	virtual void serialize(std::ostream &out) const; 
-	std::string tokenStr;
+	virtual CScriptTokenData *fork(CScriptVarForker &Forker);
+	CScriptInlineCache &getInlineCache() { if(!inlineCache) inlineCache = new CScriptInlineCache; return *inlineCache; }
+	const std::string &getString() const { return atom.empty() ? tokenStr : atom.getName(); }
+	const CScriptAtom &getAtom() const { return atom; } ///< the empty atom for string- and regexp-literals
+	std::string tokenStr; ///< only for string- and regexp-literals
+	CScriptAtom atom; ///< only for identifiers and labels (never empty)
+	CScriptBytecodeSlot statementCode; ///< for identifiers at the begin of an expression-statement
 private:
+	CScriptTokenDataString &operator=(const CScriptTokenDataString &Copy) MEMBER_DELETE;
+	CScriptInlineCache *inlineCache; ///< created on first execution of a member access (LEX_ID after '.') or of a variable lookup (other LEX_ID)
 };
 
 class CScriptTokenDataFnc : public fixed_size_object<CScriptTokenDataFnc>, public CScriptTokenData {
 public:
-	CScriptTokenDataFnc() : line(0),isGenerator(false), isArrowFunction(false) {}
+	CScriptTokenDataFnc() : line(0),isGenerator(false), isArrowFunction(false), usesArguments(false), argumentsKind(ARGUMENTS_UNCHECKED) {}
 	CScriptTokenDataFnc(std::istream &in);
 	virtual void serialize(std::ostream &out) const; 
+	virtual CScriptTokenData *fork(CScriptVarForker &Forker);
 	std::string getArgumentsString(bool forArrowFunction=false);
+	/// true if all arguments are plain identifiers without default-value.
+	/// Then the names are in argumentAtoms and callFunction binds the arguments without a temporary scope
+	bool hasSimpleArguments();
 
 	std::string file;
 	int32_t line;
@@ -396,7 +552,10 @@ public:
 	TOKEN_VECT body;
 	bool isGenerator;
 	bool isArrowFunction;
-
+	bool usesArguments; ///< the body references 'arguments' or 'eval' - the arguments-object is needed
+	std::vector<CScriptAtom> argumentAtoms;
+private:
+	enum { ARGUMENTS_UNCHECKED, ARGUMENTS_SIMPLE, ARGUMENTS_DESTRUCTURING } argumentsKind;
 };
 
 class CScriptTokenDataForwards : public fixed_size_object<CScriptTokenDataForwards>, public CScriptTokenData {
@@ -404,6 +563,7 @@ public:
 	CScriptTokenDataForwards() {}
 	CScriptTokenDataForwards(std::istream &in); 
 	virtual void serialize(std::ostream &out) const; 
+	virtual CScriptTokenData *fork(CScriptVarForker &Forker);
 
 	bool checkRedefinition(const std::string &Str, bool checkVars);
 	void addVars( STRING_VECTOR_t &Vars );
@@ -463,6 +623,7 @@ public:
 	CScriptTokenDataLoop() { type=FOR; }
 	CScriptTokenDataLoop(std::istream &in); 
 	virtual void serialize(std::ostream &out) const; 
+	virtual CScriptTokenData *fork(CScriptVarForker &Forker);
 
 	std::string getParsableString(const std::string &IndentString="", const std::string &Indent="");
 
@@ -472,6 +633,8 @@ public:
 	TOKEN_VECT condition;
 	TOKEN_VECT iter;
 	TOKEN_VECT body;
+	CScriptBytecodeSlot conditionCode;
+	CScriptBytecodeSlot iterCode;
 };
 
 class CScriptTokenDataIf : public fixed_size_object<CScriptTokenDataIf>, public CScriptTokenData {
@@ -479,10 +642,12 @@ public:
 	CScriptTokenDataIf() {} 
 	CScriptTokenDataIf(std::istream &in); 
 	virtual void serialize(std::ostream &out) const; 
+	virtual CScriptTokenData *fork(CScriptVarForker &Forker);
 	std::string getParsableString(const std::string &IndentString="", const std::string &Indent="");
 	TOKEN_VECT condition;
 	TOKEN_VECT if_body;
 	TOKEN_VECT else_body;
+	CScriptBytecodeSlot conditionCode;
 };
 
 typedef std::pair<std::string, std::string> DESTRUCTURING_VAR_t;
@@ -494,6 +659,7 @@ public:
 	CScriptTokenDataDestructuringVar() {} 
 	CScriptTokenDataDestructuringVar(std::istream &in); 
 	virtual void serialize(std::ostream &out) const; 
+	virtual CScriptTokenData *fork(CScriptVarForker &Forker);
 	std::string getParsableString();
 
 	void getVarNames(STRING_VECTOR_t &Names);
@@ -508,6 +674,7 @@ public:
 	CScriptTokenDataObjectLiteral() {} 
 	CScriptTokenDataObjectLiteral(std::istream &in); 
 	virtual void serialize(std::ostream &out) const; 
+	virtual CScriptTokenData *fork(CScriptVarForker &Forker);
 
 	std::string getParsableString();
 
@@ -534,6 +701,7 @@ public:
 	CScriptTokenDataArrayComprehensionsBody() {}
 	CScriptTokenDataArrayComprehensionsBody(std::istream &in);
 	virtual void serialize(std::ostream &out) const;
+	virtual CScriptTokenData *fork(CScriptVarForker &Forker);
 
 	TOKEN_VECT body;
 };
@@ -544,6 +712,7 @@ public:
 	CScriptTokenDataTry() {} 
 	CScriptTokenDataTry(std::istream &in); 
 	virtual void serialize(std::ostream &out) const; 
+	virtual CScriptTokenData *fork(CScriptVarForker &Forker);
 
 	std::string getParsableString(const std::string &IndentString="", const std::string &Indent="");
 
@@ -588,11 +757,14 @@ public:
 	CScriptToken &operator =(const CScriptToken &Copy);
 	CScriptToken(std::istream &in);
 	~CScriptToken() { clear(); }
+	void fork(CScriptVarForker &Forker); ///< replaces the token-data by its copy for a forked context
 
 	void serialize(std::ostream &out) const;
 
 	int32_t &Int() { ASSERT(LEX_TOKEN_DATA_SIMPLE(token)); return intData; }
-	std::string &String() { ASSERT(LEX_TOKEN_DATA_STRING(token)); return dynamic_cast<CScriptTokenDataString*>(tokenData)->tokenStr; }
+	const std::string &String() const { ASSERT(LEX_TOKEN_DATA_STRING(token)); return static_cast<CScriptTokenDataString*>(tokenData)->getString(); }
+	const CScriptAtom &Atom() const { ASSERT(LEX_TOKEN_DATA_STRING(token)); return static_cast<CScriptTokenDataString*>(tokenData)->getAtom(); }
+	CScriptTokenDataString &StringData() { ASSERT(LEX_TOKEN_DATA_STRING(token)); return *static_cast<CScriptTokenDataString*>(tokenData); }
 	double &Float() { ASSERT(LEX_TOKEN_DATA_FLOAT(token)); return *floatData; }
 	CScriptTokenDataFnc &Fnc() { ASSERT(LEX_TOKEN_DATA_FUNCTION(token)); return *dynamic_cast<CScriptTokenDataFnc*>(tokenData); }
 	const CScriptTokenDataFnc &Fnc() const { ASSERT(LEX_TOKEN_DATA_FUNCTION(token)); return *dynamic_cast<CScriptTokenDataFnc*>(tokenData); }
@@ -627,6 +799,8 @@ public:
 	}
 	static void serialize(const std::string &value, std::ostream &out);
 	static std::string &unserialize(std::string &value, std::istream &in);
+	static void serialize(const CScriptAtom &value, std::ostream &out); ///< as index into the atom-table of the stream (see CScriptTokenizer::serialize)
+	static CScriptAtom &unserialize(CScriptAtom &value, std::istream &in);
 
 	static void serialize(const STRING_VECTOR_t &value, std::ostream &out);
 	static STRING_VECTOR_t &unserialize(STRING_VECTOR_t &value, std::istream &in);
@@ -666,7 +840,7 @@ public:
 		int currentColumn()	{ return pos->column; }
 	};
 	struct ScriptTokenState {
-		ScriptTokenState() : LeftHand(false), FunctionIsGenerator(false), HaveReturnValue(false) {}
+		ScriptTokenState() : LeftHand(false), FunctionIsGenerator(false), HaveReturnValue(false), FunctionUsesArguments(false) {}
 		TOKEN_VECT Tokens;
 		FORWARDER_VECTOR_t Forwarders;
 		MARKS_t Marks;
@@ -678,6 +852,7 @@ public:
 		std::vector<bool> States;
 		bool FunctionIsGenerator;
 		bool HaveReturnValue;
+		bool FunctionUsesArguments;
 	};
 	CScriptTokenizer();
 	CScriptTokenizer(CScriptLex &Lexer);
@@ -772,7 +947,104 @@ typedef CScriptVarPointer<CScriptVarScopeFnc> CFunctionsScopePtr;
 typedef void (*JSCallback)(const CFunctionsScopePtr &var, void *userdata);
 
 class CTinyJS;
+/// the fast calling-convention for natives - the arguments are passed as a span and the result is returned (no scope is created)
+typedef CScriptVarPtr (*JSFastCallback)(CTinyJS *Context, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *userdata);
+/// adds the natives of Object on first access (see CTinyJS::addLazyNatives)
+typedef void (*JSLazyNativesCallback)(CTinyJS *Context, const CScriptVarPtr &Object);
 class CScriptResult;
+class CScriptVarElements;
+class CScriptVarForker;
+class CScriptSnapshot;
+
+//////////////////////////////////////////////////////////////////////////
+/// CScriptVarShape
+//////////////////////////////////////////////////////////////////////////
+
+/// A shape (hidden class) describes the layout of CScriptVar::Childs.
+/// Vars with the same sequence of added properties share the same shape,
+/// the shape maps the name of a property to its slot in Childs.
+/// Shapes forms a tree. The root-shape is owned by CTinyJS and owns the tree. A shape counts the vars
+/// and the transitions using it. Unused shapes are removed by prune (see CTinyJS::shapeInUse) -
+/// but only if they are not used since the last prune, so the shapes of short-living vars
+/// (e.g. function-scopes) keeps their IDs and the inline-caches stays valid.
+/// A var with many properties (or after deleting a property far from the end)
+/// gets an own dictionary-shape instead - it is not part of the tree, is changed
+/// in place by addProperty/removeProperty and owned (deleted) by the var.
+/// A dictionary-shape gets a new ID on each change, so the inline-caches stays valid.
+/// Removing a property from a dictionary-shape leaves a hole (an empty name and an empty link in
+/// Childs) - the holes are removed by compact when more than the half of the slots are holes.
+/// A forked context (see CScriptSnapshot) gets a copy of the shape-tree with the same IDs.
+#define SHAPE_NO_SLOT uint32_t(-1)
+#define SHAPE_LINEAR_SEARCH_MAX 8	///< shapes with more slots uses a lookup-table
+#define SHAPE_DICTIONARY_MIN_SLOTS 128	///< adding more properties switches to a dictionary-shape
+#define SHAPE_PRUNE_MIN 1024	///< the shape-tree is pruned after this number (or the number of shapes if greater) of shapes gets used
+
+class CScriptVarShape : public fixed_size_object<CScriptVarShape> {
+public:
+	CScriptVarShape(); ///< creates a root-shape
+	~CScriptVarShape();
+
+	uint64_t getID() const { return id; } ///< the same ID means the same layout (also in forked contexts) - 64 bit, because IDs are never reused
+	uint32_t getSlotCount() const { return slotCount; } ///< the holes of a dictionary-shape included
+	uint32_t getHoleCount() const { return dictionary ? dictionary->holes : 0; }
+	uint32_t getArrayLength() const { return arrayLength; } ///< highest array-index + 1 of all properties
+	const CScriptAtom &getName() const { return name; } ///< the name of the last added property
+	CScriptVarShape *getParent() const { return parent; }
+	CScriptVarShape *getRoot();
+	uint32_t getTreeSize(); ///< the number of shapes in the tree below this (this included)
+
+	bool ref() { used = true; return refs++ == 0; } ///< a var uses this shape - returns true if the shape was unused before
+	bool release() { ASSERT(refs); return --refs == 0; } ///< the reverse of ref - returns true if the shape is unused now
+	uint32_t prune(); ///< removes the unused shapes of the tree, that are not used since the last prune - returns the number of shapes used by vars
+
+	uint32_t findSlot(const CScriptAtom &Name); ///< returns the slot of Name or SHAPE_NO_SLOT
+	CScriptVarShape *findTransition(const CScriptAtom &Name) { ///< returns the shape after adding Name or 0 if not yet created
+		TRANSITIONS_it it = transitions.find(Name);
+		return it != transitions.end() ? it->second : 0;
+	}
+	CScriptVarShape *addProperty(const CScriptAtom &Name); ///< returns the shape after adding Name (Name must not exists)
+	CScriptVarShape *removeProperty(uint32_t Slot); ///< returns the shape without the property in Slot - a dictionary-shape leaves a hole in Slot
+	void getNames(STRING_VECTOR_t &Names); ///< all property-names in slot order (holes are empty)
+
+	bool isDictionary() const { return dictionary != 0; }
+	CScriptVarShape *cloneDictionary() const; ///< a copy of a dictionary-shape for a copied var
+	bool needsCompaction() const { return dictionary && dictionary->holes*2 > slotCount; }
+	void compact(); ///< removes the holes of a dictionary-shape - the slots behind a hole moves down (like the Childs of the var)
+private:
+	CScriptVarShape(CScriptVarShape *Parent, const CScriptAtom &Name);
+	CScriptVarShape(CScriptVarShape *From, uint32_t RemoveSlot); ///< creates a dictionary-shape with the properties of From
+	CScriptVarShape(const CScriptVarShape *Original, CScriptVarShape *Parent); ///< the copy of a tree-shape in a forked context (same ID)
+	CScriptVarShape(const CScriptVarShape &Copy) MEMBER_DELETE;
+	CScriptVarShape & operator=(const CScriptVarShape &Copy) MEMBER_DELETE;
+	static uint64_t allocID();
+
+	typedef std::map<CScriptAtom, CScriptVarShape*> TRANSITIONS_t;
+	typedef TRANSITIONS_t::iterator TRANSITIONS_it;
+	typedef std::map<CScriptAtom, uint32_t> TABLE_t;
+	typedef TABLE_t::iterator TABLE_it;
+
+	CScriptVarShape *parent;
+	CScriptAtom name;
+	uint32_t refs; ///< the vars and the transitions using this shape
+	bool used; ///< referenced since the last prune
+	uint32_t slotCount;
+	uint32_t arrayLength;
+	uint64_t id;
+	TRANSITIONS_t transitions;
+	TABLE_t *table; ///< lazy created name -> slot; handed over to the next added shape
+
+	struct DICTIONARY_t {
+		DICTIONARY_t() : holes(0) {}
+		std::vector<CScriptAtom> names; ///< the names in slot order - empty for holes
+		uint32_t holes; ///< the number of removed slots
+		std::vector<uint32_t> index; ///< open-addressing hash-table (linear probing) of slot+1 or 0 for empty - the size is a power of 2
+	};
+	DICTIONARY_t *dictionary; ///< only set for dictionary-shapes
+	uint32_t dictionaryFind(const CScriptAtom &Name, uint32_t *Pos=0);
+	void dictionaryInsert(uint32_t Slot);
+	void dictionaryRemove(uint32_t Slot);
+	friend class CScriptVarForker;
+};
 
 //////////////////////////////////////////////////////////////////////////
 /// CScriptVar
@@ -791,6 +1063,7 @@ private:
 public:
 	virtual ~CScriptVar();
 	virtual CScriptVarPtr clone()=0;
+	virtual CScriptVarPtr fork(); ///< the copy for a forked context (see CScriptVarForker) - by default clone()
 
 	/// Type
 	virtual bool isObject();	///< is an Object
@@ -798,6 +1071,8 @@ public:
 	virtual bool isDate();		///< is a Date-Object
 	virtual bool isError();		///< is an ErrorObject
 	virtual bool isRegExp();	///< is a RegExpObject
+	virtual bool isArrayBuffer();	///< is an ArrayBuffer
+	virtual bool isTypedArray();	///< is an Int8Array ... Float64Array
 	virtual bool isAccessor();	///< is an Accessor
 	virtual bool isNull();		///< is Null
 	virtual bool isUndefined();///< is Undefined
@@ -866,12 +1141,9 @@ public:
 
 
 //	virtual std::string getParsableString(const std::string &indentString, const std::string &indent, bool &hasRecursion); ///< get Data as a parsable javascript string
-#define getParsableStringRecursionsCheck() do{		\
-		if(uniqueID) { \
-			if(uniqueID==getTemporaryMark()) { hasRecursion=true; return "recursion"; } \
-			setTemporaryMark(uniqueID); \
-		} \
-	} while(0)
+#define getParsableStringRecursionsCheck() \
+	CScriptVarPathMark pathMark(this, uniqueID); \
+	if(pathMark.isOnPath()) { hasRecursion=true; return "recursion"; }
 
 	std::string getParsableString(); ///< get Data as a parsable javascript string
 	virtual std::string getParsableString(const std::string &indentString, const std::string &indent, uint32_t uniqueID, bool &hasRecursion); ///< get Data as a parsable javascript string
@@ -902,27 +1174,36 @@ public:
 
 	/// find 
 	CScriptVarLinkPtr findChild(const std::string &childName); ///< Tries to find a child with the given name, may return 0
+	CScriptVarLinkPtr findChild(const CScriptAtom &childName);
 	CScriptVarLinkWorkPtr findChildWithStringChars(const std::string &childName);
+	CScriptVarLinkWorkPtr findChildWithStringChars(const CScriptAtom &childName);
 	CScriptVarLinkPtr findChildInPrototypeChain(const std::string &childName);
+	CScriptVarLinkPtr findChildInPrototypeChain(const CScriptAtom &childName);
 	CScriptVarLinkWorkPtr findChildWithPrototypeChain(const std::string &childName);
+	CScriptVarLinkWorkPtr findChildWithPrototypeChain(const CScriptAtom &childName);
 	CScriptVarLinkPtr findChildByPath(const std::string &path); ///< Tries to find a child with the given path (separated by dots)
 	CScriptVarLinkPtr findChildOrCreate(const std::string &childName/*, int varFlags=SCRIPTVAR_UNDEFINED*/); ///< Tries to find a child with the given name, or will create it with the given flags
 	CScriptVarLinkPtr findChildOrCreateByPath(const std::string &path); ///< Tries to find a child with the given path (separated by dots)
 	void keys(STRING_SET_t &Keys, bool OnlyEnumerable=true, uint32_t ID=0);
 	/// add & remove
 	CScriptVarLinkPtr addChild(const std::string &childName, const CScriptVarPtr &child, int linkFlags = SCRIPTVARLINK_DEFAULT);
+	CScriptVarLinkPtr addChild(const CScriptAtom &childName, const CScriptVarPtr &child, int linkFlags = SCRIPTVARLINK_DEFAULT);
 	CScriptVarLinkPtr DEPRECATED("addChildNoDup is deprecated use addChildOrReplace instead!") addChildNoDup(const std::string &childName, const CScriptVarPtr &child, int linkFlags = SCRIPTVARLINK_DEFAULT);
 	CScriptVarLinkPtr addChildOrReplace(const std::string &childName, const CScriptVarPtr &child, int linkFlags = SCRIPTVARLINK_DEFAULT); ///< add a child overwriting any with the same name
+	CScriptVarLinkPtr addChildOrReplace(const CScriptAtom &childName, const CScriptVarPtr &child, int linkFlags = SCRIPTVARLINK_DEFAULT);
 	bool removeLink(CScriptVarLinkPtr &link); ///< Remove a specific link (this is faster than finding via a child)
 	virtual void removeAllChildren();
 
 	/// ARRAY
 	CScriptVarPtr getArrayIndex(uint32_t idx); ///< The the value at an array index
-	void setArrayIndex(uint32_t idx, const CScriptVarPtr &value); ///< Set the value at an array index
+	CScriptVarLinkPtr getArrayIndexLink(uint32_t idx); ///< The link at an array index, may return 0
+	CScriptVarLinkPtr setArrayIndex(uint32_t idx, const CScriptVarPtr &value); ///< Set the value at an array index
 	uint32_t getArrayLength(); ///< If this is an array, return the number of items in it (else 0)
+	CScriptVarLinkWorkPtr findChildWithPrototypeChain(uint32_t idx); ///< like findChildWithPrototypeChain(int2string(idx)) but without string-conversion for arrays
+	CScriptVarElements *getElements() { return elements; } ///< the element-storage of arrays (else 0)
 	
 	//////////////////////////////////////////////////////////////////////////
-	size_t getChildren() { return Childs.size(); } ///< Get the number of children
+	size_t getChildren(); ///< Get the number of children
 	CTinyJS *getContext() { return context; }
 	CScriptVarPtr mathsOp(const CScriptVarPtr &b, int op); ///< do a maths op with another script variable
 
@@ -931,7 +1212,14 @@ public:
 	std::string getFlagsAsString(); ///< For debugging - just dump a string version of the flags
 //	void getJSON(std::ostringstream &destination, const std::string linePrefix=""); ///< Write out all the JS code needed to recreate this script variable to the stream (as JSON)
 
-	SCRIPTVAR_CHILDS_t Childs;
+	SCRIPTVAR_CHILDS_t Childs; ///< the properties in insertion order - the slots of the shape (empty for the holes of a dictionary-shape)
+	CScriptVarShape *getShape() { return shape; }
+	void setShape(CScriptVarShape *Shape); ///< replaces the shape and releases the old one
+	bool hasLazyPrototype() const { return lazyPrototype != 0; } ///< __proto__ is not yet added (see CScriptVarPrimitive)
+	bool hasLazyNatives() const { return lazyNatives; } ///< the natives are not yet added (see CTinyJS::addLazyNatives)
+	void setShared() { shared = true; } ///< this is handed out to every user (see CTinyJS::cachedChar) - the lazy __proto__-link becomes read-only
+	bool isShared() const { return shared; }
+	void installLazyNatives(); ///< adds the natives now
 
 	/// For memory management/garbage collection
 private:
@@ -949,18 +1237,30 @@ public:
 	template<typename T1, typename T2>	CScriptVarPtr newScriptVar(T1 t1, T2 t2); // { return ::newScriptVar(context, t); }
 	template<typename T>	const CScriptVarPtr &constScriptVar(T t); // { return ::newScriptVar(context, t); }
 	void setTemporaryMark(uint32_t ID); // defined as inline at end of this file { temporaryMark[context->getCurrentMarkSlot()] = ID; }
-	virtual void setTemporaryMark_recursive(uint32_t ID);
+	void setTemporaryMark_recursive(uint32_t ID); ///< marks this and all reachable vars (with an explicit stack - no recursion)
 	uint32_t getTemporaryMark(); // defined as inline at end of this file { return temporaryMark[context->getCurrentMarkSlot()]; }
+	virtual void getReferences(std::vector<CScriptVar*> &Refs); ///< appends the vars referenced by this (Childs, elements and internal pointers)
+	virtual void getWeakReferences(std::vector<CScriptVar*> &Refs); ///< appends key/value pairs (ephemerons) - the value is reachable only while the key is
+	virtual void removeWeakReferences(uint32_t Epoch); ///< removes the pairs whose key is not marked with Epoch by the collector
+	virtual void forkReferences(CScriptVarForker &Forker); ///< replaces the references to the original vars by the forks (a fork refers the originals after copying)
+	void collectorShade(); // defined as inline at end of this file - write-barrier: marks this as reachable while the collector is marking
 protected:
 	bool extensible;
+	bool lazyNatives;
+	bool shared;
 	CTinyJS *context;
+	CScriptVarShape *shape; ///< maps the names of the Childs to the slots
+	CScriptVarElements *elements; ///< points to the element-storage of arrays
+	const CScriptVarPtr *lazyPrototype; ///< if set the __proto__-link is added on first access
 	int refs; ///< The number of references held to this - used for garbage collection
 	CScriptVar *prev;
 public:
 	CScriptVar *next;
 	uint32_t temporaryMark[TEMPORARY_MARK_SLOTS];
+	uint32_t collectorMark; ///< epoch of the last collection that has reached this var (see CTinyJS::collectorStep)
 
 	friend class CScriptVarPtr;
+	friend class CTinyJS; // lazyNatives
 };
 
 
@@ -983,6 +1283,18 @@ public:
 		} 
 		return *this; 
 	}
+#ifdef HAVE_CXX11_RVALUE_REFERENCE
+	// move - takes over the reference of a temporary without ref/unref
+	CScriptVarPtr(CScriptVarPtr &&Other) : var(Other.var) { Other.var = 0; }
+	CScriptVarPtr& operator=(CScriptVarPtr &&Other) { 
+		if(this != &Other) { 
+			CScriptVar *old = var;
+			var = Other.var; Other.var = 0;
+			if(old) old->unref();
+		} 
+		return *this; 
+	}
+#endif
 	// deconstruct 
 	~CScriptVarPtr() { if(var) var->unref(); } 
 
@@ -1022,17 +1334,21 @@ public:
 class CScriptVarLink : public fixed_size_object<CScriptVarLink>
 {
 private: // prevent gloabal creating
-	CScriptVarLink(const CScriptVarPtr &var, const std::string &name = TINYJS_TEMP_NAME, int flags = SCRIPTVARLINK_DEFAULT);
+	CScriptVarLink(const CScriptVarPtr &var, const CScriptAtom &name = CScriptAtom(), int flags = SCRIPTVARLINK_DEFAULT);
+	CScriptVarLink(const CScriptVarPtr &var, uint32_t elementIndex, int flags = SCRIPTVARLINK_DEFAULT); ///< an array-element - the name is created on demand
 private: // prevent Copy
 	CScriptVarLink(const CScriptVarLink &link) MEMBER_DELETE; ///< Copy constructor
 public:
 	~CScriptVarLink();
 
-	const std::string &getName() const { return name; }
+	const std::string &getName() const { return getAtom().getName(); }
+	const CScriptAtom &getAtom() const { if(elementIndex != uint32_t(-1) && name.empty()) name = CScriptAtom(int2string(elementIndex)); return name; }
+	bool isElement() const { return elementIndex != uint32_t(-1); } ///< link to an array-element (see CScriptVarElements)
+	uint32_t getElementIndex() const { return elementIndex; }
 
 	int getFlags() { return flags; }
 	const CScriptVarPtr &getVarPtr() const { return var; }
-	const CScriptVarPtr &setVarPtr(const CScriptVarPtr &Var) { return var = Var; } ///< simple Replace the Variable pointed to
+	const CScriptVarPtr &setVarPtr(const CScriptVarPtr &Var) { if(Var) Var->collectorShade(); return var = Var; } ///< simple Replace the Variable pointed to
 
 
 	bool isOwned() const { return owner!=0; }
@@ -1072,9 +1388,10 @@ public:
 	CScriptVarPtr toObject() { return var->toObject(); };
 
 private:
-	std::string name;
+	mutable CScriptAtom name;
 	CScriptVar *owner; // pointer to the owner CScriptVar
 	uint32_t flags;
+	uint32_t elementIndex; ///< uint32_t(-1) if not an array-element
 	CScriptVarPtr var;
 #ifdef _DEBUG
 	char dummy[24];
@@ -1095,11 +1412,14 @@ class CScriptVarLinkPtr {
 public: 
 	// construct
 	CScriptVarLinkPtr() : link(0) {} ///< 0-Pointer 
-	CScriptVarLinkPtr(const CScriptVarPtr &var, const std::string &name = TINYJS_TEMP_NAME, int flags = SCRIPTVARLINK_DEFAULT) { link=(new CScriptVarLink(var, name, flags))->ref(); }
+	CScriptVarLinkPtr(const CScriptVarPtr &var, const CScriptAtom &name = CScriptAtom(), int flags = SCRIPTVARLINK_DEFAULT) { link=(new CScriptVarLink(var, name, flags))->ref(); }
+	CScriptVarLinkPtr(const CScriptVarPtr &var, const std::string &name, int flags = SCRIPTVARLINK_DEFAULT) { link=(new CScriptVarLink(var, CScriptAtom(name), flags))->ref(); }
+	CScriptVarLinkPtr(const CScriptVarPtr &var, uint32_t elementIndex, int flags = SCRIPTVARLINK_DEFAULT) { link=(new CScriptVarLink(var, elementIndex, flags))->ref(); }
 	CScriptVarLinkPtr(CScriptVarLink *Link) : link(Link) { if(link) link->ref(); } // creates a new CScriptVarLink (from new);
 
 	// reconstruct
-	CScriptVarLinkPtr &operator()(const CScriptVarPtr &var, const std::string &name = TINYJS_TEMP_NAME, int flags = SCRIPTVARLINK_DEFAULT);
+	CScriptVarLinkPtr &operator()(const CScriptVarPtr &var, const CScriptAtom &name = CScriptAtom(), int flags = SCRIPTVARLINK_DEFAULT);
+	CScriptVarLinkPtr &operator()(const CScriptVarPtr &var, const std::string &name, int flags = SCRIPTVARLINK_DEFAULT) { return operator()(var, CScriptAtom(name), flags); }
 	CScriptVarLinkPtr &operator=(const CScriptVarPtr &var) { return operator()(var); } 
 	// deconstruct 
 	~CScriptVarLinkPtr() { if(link) link->unref(); } 
@@ -1113,6 +1433,18 @@ public:
 		} 
 		return *this; 
 	}
+#ifdef HAVE_CXX11_RVALUE_REFERENCE
+	// move - takes over the reference of a temporary without ref/unref
+	CScriptVarLinkPtr(CScriptVarLinkPtr &&Other) : link(Other.link) { Other.link = 0; }
+	CScriptVarLinkPtr &operator=(CScriptVarLinkPtr &&Other) { 
+		if(this != &Other) { 
+			CScriptVarLink *old = link;
+			link = Other.link; Other.link = 0;
+			if(old) old->unref(); 
+		} 
+		return *this; 
+	}
+#endif
 
 	// getter & setter
 	CScriptVarLinkWorkPtr getter();
@@ -1123,8 +1455,6 @@ public:
 	// if
 	operator bool() const { return link!=0; } 
 
-	// for sorting in child-list
-	bool operator <(const std::string &rhs) const;
 	bool operator ==(const CScriptVarLinkPtr &rhs) const { return link==rhs.link; }
 	// access to CScriptVarLink
 	CScriptVarLink *operator ->() const { return link; } 
@@ -1145,16 +1475,23 @@ class CScriptVarLinkWorkPtr : public CScriptVarLinkPtr {
 public:
 	// construct
 	CScriptVarLinkWorkPtr() {}
-	CScriptVarLinkWorkPtr(const CScriptVarPtr &var, const std::string &name = TINYJS_TEMP_NAME, int flags = SCRIPTVARLINK_DEFAULT) : CScriptVarLinkPtr(var, name, flags) {}
+	CScriptVarLinkWorkPtr(const CScriptVarPtr &var, const CScriptAtom &name = CScriptAtom(), int flags = SCRIPTVARLINK_DEFAULT) : CScriptVarLinkPtr(var, name, flags) {}
+	CScriptVarLinkWorkPtr(const CScriptVarPtr &var, const std::string &name, int flags = SCRIPTVARLINK_DEFAULT) : CScriptVarLinkPtr(var, name, flags) {}
 	CScriptVarLinkWorkPtr(CScriptVarLink *Link) : CScriptVarLinkPtr(Link) { if(link) referencedOwner = link->getOwner(); } // creates a new CScriptVarLink (from new);
 	CScriptVarLinkWorkPtr(const CScriptVarLinkPtr &Copy) : CScriptVarLinkPtr(Copy) { if(link) referencedOwner = link->getOwner(); } 
 
 	// reconstruct
-	CScriptVarLinkWorkPtr &operator()(const CScriptVarPtr &var, const std::string &name = TINYJS_TEMP_NAME, int flags = SCRIPTVARLINK_DEFAULT) {CScriptVarLinkPtr::operator()(var, name, flags); referencedOwner.clear(); return *this; }
+	CScriptVarLinkWorkPtr &operator()(const CScriptVarPtr &var, const CScriptAtom &name = CScriptAtom(), int flags = SCRIPTVARLINK_DEFAULT) {CScriptVarLinkPtr::operator()(var, name, flags); referencedOwner.clear(); return *this; }
+	CScriptVarLinkWorkPtr &operator()(const CScriptVarPtr &var, const std::string &name, int flags = SCRIPTVARLINK_DEFAULT) {CScriptVarLinkPtr::operator()(var, name, flags); referencedOwner.clear(); return *this; }
 
 	// copy
 	CScriptVarLinkWorkPtr(const CScriptVarLinkWorkPtr &Copy) : CScriptVarLinkPtr(Copy), referencedOwner(Copy.referencedOwner) {} 
 	CScriptVarLinkWorkPtr &operator=(const CScriptVarLinkWorkPtr &Copy) { CScriptVarLinkPtr::operator=(Copy); referencedOwner = Copy.referencedOwner; return *this; } 
+#ifdef HAVE_CXX11_RVALUE_REFERENCE
+	// move
+	CScriptVarLinkWorkPtr(CScriptVarLinkWorkPtr &&Other) : CScriptVarLinkPtr(static_cast<CScriptVarLinkPtr&&>(Other)), referencedOwner(static_cast<CScriptVarPtr&&>(Other.referencedOwner)) {} 
+	CScriptVarLinkWorkPtr &operator=(CScriptVarLinkWorkPtr &&Other) { CScriptVarLinkPtr::operator=(static_cast<CScriptVarLinkPtr&&>(Other)); referencedOwner = static_cast<CScriptVarPtr&&>(Other.referencedOwner); return *this; } 
+#endif
 
 	// getter & setter
 	CScriptVarLinkWorkPtr getter();
@@ -1172,11 +1509,116 @@ public:
 	void setReferencedOwner(const CScriptVarPtr &Owner) { referencedOwner = Owner; }
 	const CScriptVarPtr &getReferencedOwner() const { return referencedOwner; }
 	bool hasReferencedOwner() const { return referencedOwner; }
+	/// an element of a typed array - the link is not owned, the setter writes to the buffer of the referenced owner
+	bool isTypedArrayElement() const;
 private:
 	CScriptVarPtr referencedOwner;
 };
 
 
+//////////////////////////////////////////////////////////////////////////
+/// CScriptVarElements
+//////////////////////////////////////////////////////////////////////////
+
+/// The element-storage of arrays. Elements are stored in a dense vector
+/// indexed by the array-index. Elements far behind the end of the dense part
+/// (holey arrays like a[1000000]=1) are stored in a sparse map.
+/// The links of the elements are created with the index only, the name
+/// of a link is created on demand.
+#define ELEMENTS_MAX_GAP 64 ///< max. number of holes added to the dense part by one element
+
+class CScriptVarElements {
+public:
+	typedef std::vector<CScriptVarLinkPtr> DENSE_t;
+	typedef std::map<uint32_t, CScriptVarLinkPtr> SPARSE_t;
+
+	CScriptVarElements() {}
+	~CScriptVarElements() { clear(); }
+
+	uint32_t getLength() const { ///< highest index + 1
+		if(sparse.empty()) return (uint32_t)dense.size();
+		return sparse.rbegin()->first+1;
+	}
+	CScriptVarLink *find(uint32_t Idx) const { ///< returns the link of the element or 0
+		if(Idx < dense.size()) return dense[Idx].operator->();
+		if(sparse.empty()) return 0;
+		SPARSE_t::const_iterator it = sparse.find(Idx);
+		return it != sparse.end() ? it->second.operator->() : 0;
+	}
+	CScriptVarLinkPtr add(CScriptVar *Owner, uint32_t Idx, const CScriptVarPtr &Var, int Flags); ///< the element must not exist
+	bool remove(const CScriptVarLinkPtr &Link);
+	void clear();
+	void copy(const CScriptVarElements &Copy, CScriptVar *Owner);
+
+	/// iterates over all existing elements in ascending order
+	class iterator {
+	public:
+		iterator(CScriptVarElements &Elements) : elements(Elements), idx(0), sparse_it(Elements.sparse.begin()) { skipHoles(); }
+		operator bool() const { return idx < elements.dense.size() || sparse_it != elements.sparse.end(); }
+		const CScriptVarLinkPtr &operator*() const { return idx < elements.dense.size() ? elements.dense[idx] : sparse_it->second; }
+		iterator &operator++() { if(idx < elements.dense.size()) ++idx, skipHoles(); else ++sparse_it; return *this; }
+	private:
+		void skipHoles() { while(idx < elements.dense.size() && !elements.dense[idx]) ++idx; }
+		CScriptVarElements &elements;
+		size_t idx;
+		SPARSE_t::iterator sparse_it;
+	};
+private:
+	CScriptVarElements(const CScriptVarElements &Copy) MEMBER_DELETE;
+	CScriptVarElements &operator=(const CScriptVarElements &Copy) MEMBER_DELETE;
+	DENSE_t dense; ///< the last element is never a hole
+	SPARSE_t sparse; ///< only indices behind dense
+	friend class iterator;
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+/// CScriptVarForker
+//////////////////////////////////////////////////////////////////////////
+
+/// Copies the vars reachable from the roots of a context (root-scope, errorPrototypes & pseudo_refered)
+/// into another context (see CScriptSnapshot). The vars are copied with fork() - the copies refers the
+/// original vars until forkReferences() replaces these references by the copies.
+/// The shape-tree is copied with the same IDs. Function-bodies (incl. bytecode and inline-caches),
+/// string-data and compiled regexps are shared by the copies.
+class CScriptVarForker {
+public:
+	CScriptVarForker(CTinyJS *From, CTinyJS *To);
+	void fork(); ///< copies the vars and sets the roots of the target
+	CTinyJS *getTarget() { return to; }
+
+	CScriptVar *getFork(CScriptVar *Var); ///< the copy of Var (Var must be reachable)
+	void forkPtr(CScriptVarPtr &Var) { if(Var) Var = getFork(Var.getVar()); } ///< replaces Var by its copy
+	CScriptVarShape *forkShape(CScriptVarShape *Shape);
+	const CScriptVarPtr *forkMember(const CScriptVarPtr *Member); ///< a member of the source (e.g. &numberPrototype) -> the same member of the target
+	CTinyJS *forkObject(CTinyJS *Context) { return Context == from ? to : Context; }
+	template<class C> C *forkObject(C *Object) { return forkObject(Object, Object); } ///< the copy of a var - other objects are shared
+	/// the copy of token-data for the target (see CScriptTokenData::fork) - data shared by more tokens is copied once
+	CScriptTokenData *forkTokenData(CScriptTokenData *Data);
+	void forkTokens(TOKEN_VECT &Tokens) { for(TOKEN_VECT_it it = Tokens.begin(); it != Tokens.end(); ++it) it->fork(*this); }
+private:
+	template<class C> C *forkObject(C *, CScriptVar *Var) { return dynamic_cast<C*>(getFork(Var)); }
+	template<class C> C *forkObject(C *Object, const void *) { return Object; }
+
+	/// open-addressing hash-table (linear probing) of pointers - the size is a power of 2
+	class CPointerMap {
+	public:
+		CPointerMap() : count(0) {}
+		void *find(const void *Key) const; ///< 0 if Key not exists
+		void *&operator[](const void *Key); ///< inserts Key with 0 if not exists
+	private:
+		std::vector<std::pair<const void *, void *> > table;
+		size_t count;
+	};
+	CTinyJS *from, *to;
+	CPointerMap vars; ///< original -> copy (the original itself while discovering)
+	CPointerMap shapes; ///< original -> copy
+	CPointerMap tokenData; ///< original -> copy
+	std::vector<CScriptVar *> originals; ///< the reachable vars of the source
+	std::vector<CScriptVarPtr> forks; ///< the copies (in the order of originals)
+};
+
+
 //////////////////////////////////////////////////////////////////////////
 #define define_dummy_t(t1) struct t1##_t{}; extern t1##_t t1
 #define declare_dummy_t(t1) t1##_t t1
@@ -1194,7 +1636,9 @@ private:
 define_ScriptVarPtr_Type(Primitive);
 class CScriptVarPrimitive : public CScriptVar {
 protected:
-	CScriptVarPrimitive(CTinyJS *Context, const CScriptVarPtr &Prototype) : CScriptVar(Context, Prototype) { setExtensible(false); }
+	/// Prototype must be a member of Context (e.g. Context->numberPrototype).
+	/// Most primitives are short living temporaries, so the __proto__-link is added on first access only
+	CScriptVarPrimitive(CTinyJS *Context, const CScriptVarPtr &Prototype) : CScriptVar(Context, CScriptVarPtr()) { lazyPrototype = &Prototype; setExtensible(false); }
 	CScriptVarPrimitive(const CScriptVarPrimitive &Copy) : CScriptVar(Copy) { } ///< Copy protected -> use clone for public
 public:
 	virtual ~CScriptVarPrimitive();
@@ -1267,15 +1711,84 @@ inline define_DEPRECATED_newScriptVar_Fnc(Null, CTinyJS *Context, Null_t) { retu
 inline define_newScriptVar_NamedFnc(Null, CTinyJS *Context) { return new CScriptVarNull(Context); }
 
 
+//////////////////////////////////////////////////////////////////////////
+/// CScriptStringRef
+//////////////////////////////////////////////////////////////////////////
+
+#define STRING_VIEW_MIN_SHARE 4 ///< substr copies slices shorter than 1/4 of the buffer - so the waste of views is bounded
+
+/// A view (offset & length) of an immutable, reference counted string-buffer.
+/// Copies and substrings shares the buffer - only small substrings of a big buffer are copied.
+/// CScriptVarString stores its content in a CScriptStringRef, natives borrows it by CScriptVarString::getString
+
+class CScriptStringRef {
+public:
+	typedef const char *const_iterator;
+	static const size_t npos = size_t(-1);
+
+	CScriptStringRef() : buffer(0), offset(0), len(0) {}
+	CScriptStringRef(const std::string &Str);
+	CScriptStringRef(const char *Str);
+	CScriptStringRef(const CScriptStringRef &Copy) : buffer(Copy.buffer), offset(Copy.offset), len(Copy.len) { if(buffer) ++buffer->refs; }
+	CScriptStringRef &operator=(const CScriptStringRef &Copy);
+	~CScriptStringRef() { release(); }
+	/// takes over the content of Str (Str is empty after this)
+	static CScriptStringRef take(std::string &Str);
+
+	size_t size() const { return len; }
+	size_t length() const { return len; }
+	bool empty() const { return len == 0; }
+	const char *data() const { return buffer ? buffer->str.data()+offset : ""; }
+	const_iterator begin() const { return data(); }
+	const_iterator end() const { return data()+len; }
+	char operator[](size_t Pos) const { return data()[Pos]; }
+	std::string str() const { return std::string(data(), len); } ///< a copy of the content
+	/// the content as std::string - if this is a part of a buffer, the part is copied once to an own buffer
+	const std::string &compact();
+
+	CScriptStringRef substr(size_t Pos, size_t Len=npos) const; ///< a view of the same buffer - or a copy if it is shorter than 1/STRING_VIEW_MIN_SHARE of the buffer
+	size_t find(const char *Str, size_t Pos, size_t Len) const;
+	size_t find(const std::string &Str, size_t Pos=0) const { return find(Str.data(), Pos, Str.size()); }
+	size_t rfind(const char *Str, size_t Pos, size_t Len) const;
+	size_t rfind(const std::string &Str, size_t Pos=npos) const { return rfind(Str.data(), Pos, Str.size()); }
+	int compare(const char *Str, size_t Len) const;
+	int compare(const CScriptStringRef &Other) const { return compare(Other.data(), Other.len); }
+	int compare(const std::string &Other) const { return compare(Other.data(), Other.size()); }
+
+	bool operator==(const CScriptStringRef &Other) const { return len == Other.len && compare(Other) == 0; }
+	bool operator!=(const CScriptStringRef &Other) const { return !(*this == Other); }
+	bool operator<(const CScriptStringRef &Other) const { return compare(Other) < 0; }
+	bool operator<=(const CScriptStringRef &Other) const { return compare(Other) <= 0; }
+	bool operator>(const CScriptStringRef &Other) const { return compare(Other) > 0; }
+	bool operator>=(const CScriptStringRef &Other) const { return compare(Other) >= 0; }
+private:
+	struct Buffer {
+		Buffer() : refs(1) {}
+		CScriptAtomicCounter refs; ///< the strings of a snapshot are shared by its forks (maybe in other threads)
+		std::string str;
+	};
+	void release() { if(buffer && --buffer->refs == 0) delete buffer; }
+	Buffer *buffer;
+	size_t offset, len;
+};
+
+
 ////////////////////////////////////////////////////////////////////////// 
 /// CScriptVarString
 //////////////////////////////////////////////////////////////////////////
 
 define_ScriptVarPtr_Type(String);
+
+#define STRING_ROPE_MIN_LENGTH 64 ///< shorter concatenations are copied at once
+
+/// A string is either flat (data) or a rope: the concatenation of two strings (left & right).
+/// '+' creates ropes - so appending in a loop costs O(1) per piece and not a copy of the whole string.
+/// A rope is flattened on first access of the content. The content of a flat string is shared with its copies and substrings
 class CScriptVarString : public CScriptVarPrimitive {
 protected:
-	CScriptVarString(CTinyJS *Context, const std::string &Data);
-	CScriptVarString(const CScriptVarString &Copy) : CScriptVarPrimitive(Copy), data(Copy.data) {} ///< Copy protected -> use clone for public
+	CScriptVarString(CTinyJS *Context, const CScriptStringRef &Data);
+	CScriptVarString(CTinyJS *Context, const CScriptVarStringPtr &Left, const CScriptVarStringPtr &Right); ///< creates a rope
+	CScriptVarString(const CScriptVarString &Copy) : CScriptVarPrimitive(Copy), data(Copy.data), length(Copy.length), left(Copy.left), right(Copy.right) {} ///< Copy protected -> use clone for public
 public:
 	virtual ~CScriptVarString();
 	virtual CScriptVarPtr clone();
@@ -1291,18 +1804,33 @@ public:
 	virtual CScriptVarPtr toObject();
 	virtual CScriptVarPtr toString_CallBack(CScriptResult &execute, int radix=0);
 
-	size_t stringLength() { return data.size(); }
+	virtual void getReferences(std::vector<CScriptVar*> &Refs);
+	virtual void forkReferences(CScriptVarForker &Forker);
+
+	size_t stringLength() { return length; }
 	int getChar(uint32_t Idx);
+	bool isRope() { return left; }
+	const CScriptStringRef &getString() { if(left) flatten(); return data; } ///< the content (borrowed, not copied) - flattens a rope
 protected:
-	std::string data;
+	CScriptStringRef data;
+	size_t length;
+	CScriptVarStringPtr left, right; ///< the parts of a rope - empty if flat
 private:
+	void flatten();
+	void releaseRope();
 	friend define_newScriptVar_Fnc(String, CTinyJS *Context, const std::string &);
 	friend define_newScriptVar_Fnc(String, CTinyJS *Context, const char *);
-	friend define_newScriptVar_Fnc(String, CTinyJS *Context, char *);
+	friend define_newScriptVar_Fnc(String, CTinyJS *Context, const CScriptStringRef &);
+	friend define_newScriptVar_NamedFnc(StringConcat, CTinyJS *Context, const CScriptVarStringPtr &Left, const CScriptVarStringPtr &Right);
+	friend class CTinyJS; // cachedChar
 };
-inline define_newScriptVar_Fnc(String, CTinyJS *Context, const std::string &Obj) { return new CScriptVarString(Context, Obj); }
-inline define_newScriptVar_Fnc(String, CTinyJS *Context, const char *Obj) { return new CScriptVarString(Context, Obj); }
-inline define_newScriptVar_Fnc(String, CTinyJS *Context, char *Obj) { return new CScriptVarString(Context, Obj); }
+/// single-char strings are shared (see VALUE-CACHES in config.h)
+define_newScriptVar_Fnc(String, CTinyJS *Context, const std::string &Obj);
+define_newScriptVar_Fnc(String, CTinyJS *Context, const char *Obj);
+inline define_newScriptVar_Fnc(String, CTinyJS *Context, char *Obj) { return newScriptVar(Context, (const char *)Obj); }
+define_newScriptVar_Fnc(String, CTinyJS *Context, const CScriptStringRef &Obj);
+/// Left+Right - a rope if the result is not shorter than STRING_ROPE_MIN_LENGTH
+define_newScriptVar_NamedFnc(StringConcat, CTinyJS *Context, const CScriptVarStringPtr &Left, const CScriptVarStringPtr &Right);
 
 
 //////////////////////////////////////////////////////////////////////////
@@ -1474,14 +2002,15 @@ private:
 	friend define_newScriptVar_Fnc(Number, CTinyJS *Context, const CNumber &);
 	friend define_newScriptVar_NamedFnc(Number, CTinyJS *Context, const CNumber &);
 };
+/// small integers are shared (see VALUE-CACHES in config.h)
 define_newScriptVar_Fnc(Number, CTinyJS *Context, const CNumber &Obj);
 inline define_newScriptVar_NamedFnc(Number, CTinyJS *Context, const CNumber &Obj) { return new CScriptVarNumber(Context, Obj); }
-inline define_newScriptVar_Fnc(Number, CTinyJS *Context, char Obj) { return newScriptVarNumber(Context, CNumber(Obj)); }
-inline define_newScriptVar_Fnc(Number, CTinyJS *Context, int32_t Obj) { return newScriptVarNumber(Context, CNumber(Obj)); }
-inline define_newScriptVar_Fnc(Number, CTinyJS *Context, uint32_t Obj) { return newScriptVarNumber(Context, CNumber(Obj)); }
-inline define_newScriptVar_Fnc(Number, CTinyJS *Context, int64_t Obj) { return newScriptVarNumber(Context, CNumber((int32_t)Obj)); }
-inline define_newScriptVar_Fnc(Number, CTinyJS *Context, uint64_t Obj) { return newScriptVarNumber(Context, CNumber(Obj)); }
-inline define_newScriptVar_Fnc(Number, CTinyJS *Context, double Obj) { return newScriptVarNumber(Context, CNumber(Obj)); }
+inline define_newScriptVar_Fnc(Number, CTinyJS *Context, char Obj) { return newScriptVar(Context, CNumber(Obj)); }
+inline define_newScriptVar_Fnc(Number, CTinyJS *Context, int32_t Obj) { return newScriptVar(Context, CNumber(Obj)); }
+inline define_newScriptVar_Fnc(Number, CTinyJS *Context, uint32_t Obj) { return newScriptVar(Context, CNumber(Obj)); }
+inline define_newScriptVar_Fnc(Number, CTinyJS *Context, int64_t Obj) { return newScriptVar(Context, CNumber((int32_t)Obj)); }
+inline define_newScriptVar_Fnc(Number, CTinyJS *Context, uint64_t Obj) { return newScriptVar(Context, CNumber(Obj)); }
+inline define_newScriptVar_Fnc(Number, CTinyJS *Context, double Obj) { return newScriptVar(Context, CNumber(Obj)); }
 inline define_DEPRECATED_newScriptVar_Fnc(NaN, CTinyJS *Context, NaN_t) { return newScriptVarNumber(Context, CNumber(NaN)); }
 inline define_DEPRECATED_newScriptVar_Fnc(Infinity, CTinyJS *Context, Infinity Obj) { return newScriptVarNumber(Context, CNumber(Obj)); } 
 
@@ -1528,8 +2057,8 @@ class CScriptVarObject : public CScriptVar {
 protected:
 	CScriptVarObject(CTinyJS *Context);
 	CScriptVarObject(CTinyJS *Context, const CScriptVarPtr &Prototype) : CScriptVar(Context, Prototype) {}
-	CScriptVarObject(CTinyJS *Context, const CScriptVarPrimitivePtr &Value, const CScriptVarPtr &Prototype) : CScriptVar(Context, Prototype), value(Value) {}
-	CScriptVarObject(const CScriptVarObject &Copy) : CScriptVar(Copy) {} ///< Copy protected -> use clone for public
+	CScriptVarObject(CTinyJS *Context, const CScriptVarPrimitivePtr &Value, const CScriptVarPtr &Prototype) : CScriptVar(Context, Prototype), value(Value) { if(value) value.getVar()->collectorShade(); }
+	CScriptVarObject(const CScriptVarObject &Copy) : CScriptVar(Copy), value(Copy.value) {} ///< Copy protected -> use clone for public
 public:
 	virtual ~CScriptVarObject();
 	virtual CScriptVarPtr clone();
@@ -1546,7 +2075,8 @@ public:
 
 	virtual CScriptVarPtr valueOf_CallBack();
 	virtual CScriptVarPtr toString_CallBack(CScriptResult &execute, int radix=0);
-	virtual void setTemporaryMark_recursive(uint32_t ID);
+	virtual void getReferences(std::vector<CScriptVar*> &Refs);
+	virtual void forkReferences(CScriptVarForker &Forker);
 protected:
 private:
 	CScriptVarPrimitivePtr value;
@@ -1622,7 +2152,7 @@ define_ScriptVarPtr_Type(Array);
 class CScriptVarArray : public CScriptVarObject {
 protected:
 	CScriptVarArray(CTinyJS *Context);
-	CScriptVarArray(const CScriptVarArray &Copy) : CScriptVarObject(Copy), toStringRecursion(Copy.toStringRecursion) {} ///< Copy protected -> use clone for public
+	CScriptVarArray(const CScriptVarArray &Copy); ///< Copy protected -> use clone for public
 public:
 	virtual ~CScriptVarArray();
 	virtual CScriptVarPtr clone();
@@ -1636,6 +2166,7 @@ public:
 private:
 	void native_Length(const CFunctionsScopePtr &c, void *data);
 	bool toStringRecursion;
+	CScriptVarElements arrayElements;
 };
 inline define_newScriptVar_Fnc(Array, CTinyJS *Context, Array_t) { return new CScriptVarArray(Context); } 
 
@@ -1649,7 +2180,7 @@ define_ScriptVarPtr_Type(RegExp);
 class CScriptVarRegExp : public CScriptVarObject {
 protected:
 	CScriptVarRegExp(CTinyJS *Context, const std::string &Source, const std::string &Flags);
-	CScriptVarRegExp(const CScriptVarRegExp &Copy) : CScriptVarObject(Copy), regexp(Copy.regexp), flags(Copy.flags) {} ///< Copy protected -> use clone for public
+	CScriptVarRegExp(const CScriptVarRegExp &Copy) : CScriptVarObject(Copy), regexp(Copy.regexp), flags(Copy.flags), compiled(Copy.compiled), isCompiled(Copy.isCompiled) {} ///< Copy protected -> use clone for public
 public:
 	virtual ~CScriptVarRegExp();
 	virtual CScriptVarPtr clone();
@@ -1660,15 +2191,18 @@ public:
 
 	bool Global() { return flags.find('g')!=std::string::npos; }
 	bool IgnoreCase() { return flags.find('i')!=std::string::npos; }
-	bool Multiline() { return true; /* currently always true -- flags.find('m')!=std::string::npos;*/ }
+	bool Multiline() { return flags.find('m')!=std::string::npos; }
 	bool Sticky() { return flags.find('y')!=std::string::npos; }
 	const std::string &Regexp() { return regexp; }
 	unsigned int LastIndex();
-
-	static const char *ErrorStr(int Error);
+	/// the compiled regexp - compiled on first use (by the regex-cache of the context) and stored with the RegExp.
+	/// throws CScriptRegexError if the regexp is invalid
+	const CScriptRegex &getRegex();
 protected:
 	std::string regexp;
 	std::string flags;
+	CScriptRegex compiled;
+	bool isCompiled;
 private:
 	void native_Global(const CFunctionsScopePtr &c, void *data);
 	void native_IgnoreCase(const CFunctionsScopePtr &c, void *data);
@@ -1684,6 +2218,258 @@ inline define_newScriptVar_Fnc(RegExp, CTinyJS *Context, const std::string &Obj,
 #endif /* NO_REGEXP */
 
 
+////////////////////////////////////////////////////////////////////////// 
+/// CScriptVarArrayBuffer
+//////////////////////////////////////////////////////////////////////////
+
+/// called when an ArrayBuffer that wraps a native buffer of the host is destroyed
+typedef void (*ArrayBufferRelease)(void *Data, uint32_t ByteLength, void *Userdata);
+
+define_ScriptVarPtr_Type(ArrayBuffer);
+class CScriptVarArrayBuffer : public CScriptVarObject {
+protected:
+	CScriptVarArrayBuffer(CTinyJS *Context, uint32_t ByteLength); ///< allocates ByteLength zero-filled bytes
+	CScriptVarArrayBuffer(CTinyJS *Context, void *Data, uint32_t ByteLength, ArrayBufferRelease Release, void *Userdata); ///< wraps the buffer of the host - no copy
+	CScriptVarArrayBuffer(const CScriptVarArrayBuffer &Copy); ///< Copy protected -> use clone for public
+public:
+	virtual ~CScriptVarArrayBuffer();
+	virtual CScriptVarPtr clone();
+	virtual bool isArrayBuffer(); // { return true; }
+
+	uint8_t *getData() { return data; }
+	uint32_t getByteLength() { return byteLength; }
+private:
+	void init();
+	uint8_t *data;
+	uint32_t byteLength;
+	ArrayBufferRelease release; ///< 0 if the data is allocated by this
+	void *releaseUserdata;
+
+	friend define_newScriptVar_NamedFnc(ArrayBuffer, CTinyJS *Context, uint32_t ByteLength);
+	friend define_newScriptVar_NamedFnc(ArrayBuffer, CTinyJS *Context, void *Data, uint32_t ByteLength, ArrayBufferRelease Release, void *Userdata);
+};
+inline define_newScriptVar_NamedFnc(ArrayBuffer, CTinyJS *Context, uint32_t ByteLength) { return new CScriptVarArrayBuffer(Context, ByteLength); }
+/// wraps Data without copying. Release (if set) is called when the ArrayBuffer is destroyed
+inline define_newScriptVar_NamedFnc(ArrayBuffer, CTinyJS *Context, void *Data, uint32_t ByteLength, ArrayBufferRelease Release=0, void *Userdata=0) { return new CScriptVarArrayBuffer(Context, Data, ByteLength, Release, Userdata); }
+
+
+////////////////////////////////////////////////////////////////////////// 
+/// CScriptVarTypedArray
+//////////////////////////////////////////////////////////////////////////
+
+enum TYPEDARRAY_KIND {
+	TypedArrayInt8 = 0,
+	TypedArrayUint8,
+	TypedArrayUint8Clamped,
+	TypedArrayInt16,
+	TypedArrayUint16,
+	TypedArrayInt32,
+	TypedArrayUint32,
+	TypedArrayFloat32,
+	TypedArrayFloat64
+};
+#define TYPEDARRAY_KIND_MAX TypedArrayFloat64
+#define TYPEDARRAY_KIND_COUNT (TYPEDARRAY_KIND_MAX+1)
+extern const char *TYPEDARRAY_NAME[];
+extern const uint32_t TYPEDARRAY_ELEMENT_SIZE[];
+
+/// ToUint32 of ECMA-262 (modulo 2^32) - CNumber::toUInt32 is undefined for values out of range
+uint32_t typedArrayToUint32(const CNumber &Value);
+/// ToUint8Clamp of ECMA-262 (clamped to 0..255 rounded half to even)
+uint8_t typedArrayToUint8Clamped(const CNumber &Value);
+
+/// Int8Array ... Float64Array - a view of Length elements at ByteOffset of an ArrayBuffer.
+/// The elements are not stored as Childs but read and written directly from/to the
+/// buffer (see CTinyJS::member_subscript and CScriptVarLinkWorkPtr::setter)
+define_ScriptVarPtr_Type(TypedArray);
+class CScriptVarTypedArray : public CScriptVarObject {
+protected:
+	CScriptVarTypedArray(CTinyJS *Context, TYPEDARRAY_KIND Kind, const CScriptVarArrayBufferPtr &Buffer, uint32_t ByteOffset, uint32_t Length);
+	CScriptVarTypedArray(const CScriptVarTypedArray &Copy); ///< Copy protected -> use clone for public
+public:
+	virtual ~CScriptVarTypedArray();
+	virtual CScriptVarPtr clone();
+	virtual bool isTypedArray(); // { return true; }
+
+	virtual std::string getParsableString(const std::string &indentString, const std::string &indent, uint32_t uniqueID, bool &hasRecursion);
+	virtual CScriptVarPtr toString_CallBack(CScriptResult &execute, int radix=0);
+	virtual void getReferences(std::vector<CScriptVar*> &Refs);
+	virtual void forkReferences(CScriptVarForker &Forker);
+
+	TYPEDARRAY_KIND getKind() { return kind; }
+	uint32_t getLength() { return length; }
+	uint32_t getByteOffset() { return byteOffset; }
+	uint32_t getElementSize() { return TYPEDARRAY_ELEMENT_SIZE[kind]; }
+	const CScriptVarArrayBufferPtr &getBuffer() { return buffer; }
+	void *getData() { return data; } ///< the first element
+
+	/// Idx must be less than getLength()
+	CNumber getElement(uint32_t Idx) {
+		switch(kind) {
+		case TypedArrayInt8:			return int32_t(((int8_t*)data)[Idx]);
+		case TypedArrayUint8:
+		case TypedArrayUint8Clamped:	return int32_t(((uint8_t*)data)[Idx]);
+		case TypedArrayInt16:			return int32_t(((int16_t*)data)[Idx]);
+		case TypedArrayUint16:			return int32_t(((uint16_t*)data)[Idx]);
+		case TypedArrayInt32:			return ((int32_t*)data)[Idx];
+		case TypedArrayUint32:			return ((uint32_t*)data)[Idx];
+		case TypedArrayFloat32:			return double(((float*)data)[Idx]);
+		default:							return ((double*)data)[Idx];
+		}
+	}
+	/// Idx must be less than getLength()
+	void setElement(uint32_t Idx, const CNumber &Value) {
+		switch(kind) {
+		case TypedArrayInt8:
+		case TypedArrayUint8:			((uint8_t*)data)[Idx] = uint8_t(Value.isInt32() ? Value.toInt32() : typedArrayToUint32(Value)); break;
+		case TypedArrayUint8Clamped:	((uint8_t*)data)[Idx] = typedArrayToUint8Clamped(Value); break;
+		case TypedArrayInt16:
+		case TypedArrayUint16:			((uint16_t*)data)[Idx] = uint16_t(Value.isInt32() ? Value.toInt32() : typedArrayToUint32(Value)); break;
+		case TypedArrayInt32:
+		case TypedArrayUint32:			((uint32_t*)data)[Idx] = Value.isInt32() ? uint32_t(Value.toInt32()) : typedArrayToUint32(Value); break;
+		case TypedArrayFloat32:			((float*)data)[Idx] = float(Value.toDouble()); break;
+		default:							((double*)data)[Idx] = Value.toDouble(); break;
+		}
+	}
+private:
+	TYPEDARRAY_KIND kind;
+	CScriptVarArrayBufferPtr buffer;
+	uint32_t byteOffset;
+	uint32_t length;
+	uint8_t *data;
+
+	friend define_newScriptVar_NamedFnc(TypedArray, CTinyJS *Context, TYPEDARRAY_KIND Kind, const CScriptVarArrayBufferPtr &Buffer, uint32_t ByteOffset, uint32_t Length);
+};
+/// ByteOffset must be a multiple of the element-size and ByteOffset+Length*element-size must fit into the Buffer
+inline define_newScriptVar_NamedFnc(TypedArray, CTinyJS *Context, TYPEDARRAY_KIND Kind, const CScriptVarArrayBufferPtr &Buffer, uint32_t ByteOffset, uint32_t Length) { return new CScriptVarTypedArray(Context, Kind, Buffer, ByteOffset, Length); }
+
+
+////////////////////////////////////////////////////////////////////////// 
+/// CScriptVarDataView
+//////////////////////////////////////////////////////////////////////////
+
+define_ScriptVarPtr_Type(DataView);
+class CScriptVarDataView : public CScriptVarObject {
+protected:
+	CScriptVarDataView(CTinyJS *Context, const CScriptVarArrayBufferPtr &Buffer, uint32_t ByteOffset, uint32_t ByteLength);
+	CScriptVarDataView(const CScriptVarDataView &Copy); ///< Copy protected -> use clone for public
+public:
+	virtual ~CScriptVarDataView();
+	virtual CScriptVarPtr clone();
+	virtual void getReferences(std::vector<CScriptVar*> &Refs);
+	virtual void forkReferences(CScriptVarForker &Forker);
+
+	uint32_t getByteOffset() { return byteOffset; }
+	uint32_t getByteLength() { return byteLength; }
+	const CScriptVarArrayBufferPtr &getBuffer() { return buffer; }
+	uint8_t *getData() { return buffer->getData() + byteOffset; }
+private:
+	CScriptVarArrayBufferPtr buffer;
+	uint32_t byteOffset;
+	uint32_t byteLength;
+
+	friend define_newScriptVar_NamedFnc(DataView, CTinyJS *Context, const CScriptVarArrayBufferPtr &Buffer, uint32_t ByteOffset, uint32_t ByteLength);
+};
+inline define_newScriptVar_NamedFnc(DataView, CTinyJS *Context, const CScriptVarArrayBufferPtr &Buffer, uint32_t ByteOffset, uint32_t ByteLength) { return new CScriptVarDataView(Context, Buffer, ByteOffset, ByteLength); }
+
+
+////////////////////////////////////////////////////////////////////////// 
+/// CScriptVarMap
+//////////////////////////////////////////////////////////////////////////
+
+enum MAP_KIND {
+	MapKindMap = 0,
+	MapKindSet,
+	MapKindWeakMap
+};
+
+class CScriptVarMapIterator;
+
+/// Map, Set and WeakMap - the entries are stored in insertion-order and found by an open-addressing
+/// hash-table (linear probing) of entry-indexes. Keys are compared by SameValueZero (objects by identity).
+/// A deleted entry leaves a hole until the next rehash compacts the entries (the running iterators are moved)
+/// The entries of a WeakMap are ephemerons (see getWeakReferences) - the collector removes the entries
+/// whose key is not reachable otherwise. A rehash drops the entries whose key is referenced only by the WeakMap
+define_ScriptVarPtr_Type(Map);
+class CScriptVarMap : public CScriptVarObject {
+protected:
+	CScriptVarMap(CTinyJS *Context, MAP_KIND Kind);
+	CScriptVarMap(const CScriptVarMap &Copy); ///< Copy protected -> use clone for public
+public:
+	virtual ~CScriptVarMap();
+	virtual CScriptVarPtr clone();
+	virtual void removeAllChildren();
+	virtual std::string getVarTypeTagName(); // { return "Map", "Set" or "WeakMap"; }
+	virtual void getReferences(std::vector<CScriptVar*> &Refs);
+	virtual void getWeakReferences(std::vector<CScriptVar*> &Refs);
+	virtual void removeWeakReferences(uint32_t Epoch);
+	virtual void forkReferences(CScriptVarForker &Forker);
+
+	MAP_KIND getKind() { return kind; }
+	uint32_t size() { return count; }
+	CScriptVarPtr get(const CScriptVarPtr &Key); ///< empty if Key not found
+	bool has(const CScriptVarPtr &Key) { return find(Key, hashKey(Key)) != NOT_FOUND; }
+	void set(const CScriptVarPtr &Key, const CScriptVarPtr &Value);
+	bool remove(const CScriptVarPtr &Key);
+	void clear();
+
+	static uint32_t hashKey(const CScriptVarPtr &Key);
+	static bool sameValueZero(const CScriptVarPtr &A, const CScriptVarPtr &B);
+private:
+	enum { NOT_FOUND = 0xffffffff, MIN_SLOTS = 8 };
+	struct Entry {
+		CScriptVarPtr key, value; ///< key is empty for a deleted entry
+		uint32_t hash;
+	};
+	uint32_t find(const CScriptVarPtr &Key, uint32_t Hash);
+	void insertSlot(uint32_t Idx);
+	void rehash(uint32_t Count);
+
+	MAP_KIND kind;
+	std::vector<Entry> entries;
+	std::vector<uint32_t> slots; ///< entry-index+1 or 0 for an empty slot - the size is 0 or a power of 2
+	uint32_t count; ///< the entries that are not deleted
+	std::vector<CScriptVarMapIterator*> iterators; ///< the running iterators (not referenced)
+
+	friend class CScriptVarMapIterator;
+	friend define_newScriptVar_NamedFnc(Map, CTinyJS *Context, MAP_KIND Kind);
+};
+inline define_newScriptVar_NamedFnc(Map, CTinyJS *Context, MAP_KIND Kind) { return new CScriptVarMap(Context, Kind); }
+
+
+////////////////////////////////////////////////////////////////////////// 
+/// CScriptVarMapIterator
+//////////////////////////////////////////////////////////////////////////
+
+/// iterates the entries of a Map or Set in insertion-order - entries added while iterating are visited
+/// Mode: 1 keys, 2 values, 3 [key, value]
+define_ScriptVarPtr_Type(MapIterator);
+class CScriptVarMapIterator : public CScriptVarObject {
+protected:
+	CScriptVarMapIterator(CTinyJS *Context, const CScriptVarMapPtr &Map, int Mode);
+	CScriptVarMapIterator(const CScriptVarMapIterator &Copy); ///< Copy protected -> use clone for public
+public:
+	virtual ~CScriptVarMapIterator();
+	virtual CScriptVarPtr clone();
+	virtual bool isIterator(); // { return true; }
+	virtual void removeAllChildren();
+	virtual void getReferences(std::vector<CScriptVar*> &Refs);
+	virtual void forkReferences(CScriptVarForker &Forker);
+
+	bool next(CScriptVarPtr &Key, CScriptVarPtr &Value); ///< false if the end is reached
+	int getMode() { return mode; }
+private:
+	void detach();
+	CScriptVarMapPtr map;
+	uint32_t pos;
+	int mode;
+
+	friend class CScriptVarMap;
+	friend define_newScriptVar_NamedFnc(MapIterator, CTinyJS *Context, const CScriptVarMapPtr &Map, int Mode);
+};
+inline define_newScriptVar_NamedFnc(MapIterator, CTinyJS *Context, const CScriptVarMapPtr &Map, int Mode) { return new CScriptVarMapIterator(Context, Map, Mode); }
+
+
 ////////////////////////////////////////////////////////////////////////// 
 /// CScriptVarFunction
 //////////////////////////////////////////////////////////////////////////
@@ -1705,6 +2491,7 @@ public:
 	virtual CScriptVarPtr toString_CallBack(CScriptResult &execute, int radix=0);
 	virtual CScriptTokenDataFnc *getFunctionData();
 	void setFunctionData(CScriptTokenDataFnc *Data);
+	virtual void forkReferences(CScriptVarForker &Forker);
 private:
 	CScriptTokenDataFnc *data;
 
@@ -1721,15 +2508,17 @@ define_ScriptVarPtr_Type(FunctionBounded);
 class CScriptVarFunctionBounded : public CScriptVarFunction {
 protected:
 	CScriptVarFunctionBounded(CScriptVarFunctionPtr BoundedFunction, CScriptVarPtr BoundedThis, const std::vector<CScriptVarPtr> &BoundedArguments);
-	CScriptVarFunctionBounded(const CScriptVarFunctionBounded &Copy) : CScriptVarFunction(Copy), boundedThis(Copy.boundedThis), boundedArguments(Copy.boundedArguments)  { } ///< Copy protected -> use clone for public
+	CScriptVarFunctionBounded(const CScriptVarFunctionBounded &Copy); ///< Copy protected -> use clone for public
 public:
 	virtual ~CScriptVarFunctionBounded();
 	virtual CScriptVarPtr clone();
 	virtual bool isBounded();	///< is CScriptVarFunctionBounded
-	virtual void setTemporaryMark_recursive(uint32_t ID);
+	virtual void getReferences(std::vector<CScriptVar*> &Refs);
+	virtual void forkReferences(CScriptVarForker &Forker);
 	CScriptVarPtr callFunction(CScriptResult &execute, std::vector<CScriptVarPtr> &Arguments, const CScriptVarPtr &This, CScriptVarPtr *newThis=0);
 protected:
 private:
+	void collectorShadeBounded(); ///< write-barrier for the bounded vars
 	CScriptVarFunctionPtr boundedFunction;
 	CScriptVarPtr boundedThis;
 	std::vector<CScriptVarPtr> boundedArguments;
@@ -1754,6 +2543,7 @@ public:
 	virtual ~CScriptVarFunctionNative();
 	virtual CScriptVarPtr clone()=0;
 	virtual bool isNative(); // { return true; }
+	virtual bool isFastCall(); ///< is CScriptVarFunctionNativeFast - called without a scope
 
 	virtual void callFunction(const CFunctionsScopePtr &c)=0;// { jsCallback(c, jsCallbackUserData); }
 protected:
@@ -1781,6 +2571,124 @@ private:
 inline define_newScriptVar_Fnc(FunctionNativeCallback, CTinyJS *Context, JSCallback Callback, void *Userdata, const char *Name=0) { return new CScriptVarFunctionNativeCallback(Context, Callback, Userdata, Name); }
 
 
+////////////////////////////////////////////////////////////////////////// 
+/// CScriptVarFunctionNativeFast
+//////////////////////////////////////////////////////////////////////////
+
+/// A native with the fast calling-convention (JSFastCallback).
+/// CTinyJS::callFunction passes the arguments directly and creates no scope, no arguments-object and no "return"-child.
+/// If the first parameter of the function-description is named "this" (e.g. "function String.charAt(this,pos)")
+/// the first argument is passed as This.
+define_ScriptVarPtr_Type(FunctionNativeFast);
+class CScriptVarFunctionNativeFast : public CScriptVarFunctionNative {
+protected:
+	CScriptVarFunctionNativeFast(CTinyJS *Context, JSFastCallback Callback, void *Userdata, const char *Name) : CScriptVarFunctionNative(Context, Userdata, Name), jsFastCallback(Callback) { }
+	CScriptVarFunctionNativeFast(const CScriptVarFunctionNativeFast &Copy) : CScriptVarFunctionNative(Copy), jsFastCallback(Copy.jsFastCallback) { } ///< Copy protected -> use clone for public
+public:
+	virtual ~CScriptVarFunctionNativeFast();
+	virtual CScriptVarPtr clone();
+	virtual bool isFastCall(); // { return true; }
+	virtual void callFunction(const CFunctionsScopePtr &c); ///< calls the callback with the arguments of the scope
+	virtual CScriptVarPtr callFunction(const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc) { return jsFastCallback(context, This, Args, Argc, jsUserData); }
+private:
+	JSFastCallback jsFastCallback; ///< Callback for native functions
+	friend define_newScriptVar_Fnc(FunctionNativeFast, CTinyJS *Context, JSFastCallback Callback, void*, const char*);
+};
+inline define_newScriptVar_Fnc(FunctionNativeFast, CTinyJS *Context, JSFastCallback Callback, void *Userdata, const char *Name=0) { return new CScriptVarFunctionNativeFast(Context, Callback, Userdata, Name); }
+
+
+////////////////////////////////////////////////////////////////////////// 
+/// CScriptVarFunctionNativeTyped
+//////////////////////////////////////////////////////////////////////////
+
+/// CScriptNativeArg<T>::get converts an argument to the parameter-type T of a typed native.
+/// Specialize it for further types.
+template<typename T> struct CScriptNativeArg;
+template<typename T> struct CScriptNativeArg<const T &> : CScriptNativeArg<T> {};
+template<> struct CScriptNativeArg<CScriptVarPtr> { static CScriptVarPtr get(const CScriptVarPtr &Arg) { return Arg; } };
+template<> struct CScriptNativeArg<CNumber> { static CNumber get(const CScriptVarPtr &Arg) { return Arg->toNumber(); } };
+template<> struct CScriptNativeArg<double> { static double get(const CScriptVarPtr &Arg) { return Arg->toNumber().toDouble(); } };
+template<> struct CScriptNativeArg<float> { static float get(const CScriptVarPtr &Arg) { return float(Arg->toNumber().toDouble()); } };
+// ToInt32 and ToUint32 of ECMA-262 - the values wraps modulo 2^32
+template<> struct CScriptNativeArg<int32_t> { static int32_t get(const CScriptVarPtr &Arg) { return int32_t(typedArrayToUint32(Arg->toNumber())); } };
+template<> struct CScriptNativeArg<uint32_t> { static uint32_t get(const CScriptVarPtr &Arg) { return typedArrayToUint32(Arg->toNumber()); } };
+template<> struct CScriptNativeArg<bool> { static bool get(const CScriptVarPtr &Arg) { return Arg->toBoolean(); } };
+template<> struct CScriptNativeArg<std::string> { static std::string get(const CScriptVarPtr &Arg) { return Arg->toString(); } };
+
+/// CScriptNativeResult<T>::box converts the result of a typed native to a var
+template<typename T> struct CScriptNativeResult { static CScriptVarPtr box(CScriptVar *Fnc, const T &Value) { return Fnc->newScriptVar(Value); } };
+template<> struct CScriptNativeResult<bool> { static CScriptVarPtr box(CScriptVar *Fnc, bool Value) { return Fnc->constScriptVar(Value); } };
+template<> struct CScriptNativeResult<CScriptVarPtr> { static CScriptVarPtr box(CScriptVar *, const CScriptVarPtr &Value) { return Value; } };
+
+/// CScriptNativeSignature<Sig>::call converts the arguments, calls the function and boxes the result.
+/// Missing arguments are converted from undefined, additional arguments are ignored.
+/// Specialized for functions with 0 up to 4 parameters.
+template<typename Sig> struct CScriptNativeSignature;
+#define NATIVE_ARG(A,n) CScriptNativeArg<A>::get(n<Argc ? Args[n] : Fnc->constScriptVar(Undefined))
+template<typename R> struct CScriptNativeSignature<R()> {
+	enum { arity = 0 };
+	static CScriptVarPtr call(CScriptVar *Fnc, R (*fnc)(), const CScriptVarPtr *, size_t) { return CScriptNativeResult<R>::box(Fnc, fnc()); }
+};
+template<typename R, typename A0> struct CScriptNativeSignature<R(A0)> {
+	enum { arity = 1 };
+	static CScriptVarPtr call(CScriptVar *Fnc, R (*fnc)(A0), const CScriptVarPtr *Args, size_t Argc) { return CScriptNativeResult<R>::box(Fnc, fnc(NATIVE_ARG(A0,0))); }
+};
+template<typename R, typename A0, typename A1> struct CScriptNativeSignature<R(A0,A1)> {
+	enum { arity = 2 };
+	static CScriptVarPtr call(CScriptVar *Fnc, R (*fnc)(A0,A1), const CScriptVarPtr *Args, size_t Argc) { return CScriptNativeResult<R>::box(Fnc, fnc(NATIVE_ARG(A0,0), NATIVE_ARG(A1,1))); }
+};
+template<typename R, typename A0, typename A1, typename A2> struct CScriptNativeSignature<R(A0,A1,A2)> {
+	enum { arity = 3 };
+	static CScriptVarPtr call(CScriptVar *Fnc, R (*fnc)(A0,A1,A2), const CScriptVarPtr *Args, size_t Argc) { return CScriptNativeResult<R>::box(Fnc, fnc(NATIVE_ARG(A0,0), NATIVE_ARG(A1,1), NATIVE_ARG(A2,2))); }
+};
+template<typename R, typename A0, typename A1, typename A2, typename A3> struct CScriptNativeSignature<R(A0,A1,A2,A3)> {
+	enum { arity = 4 };
+	static CScriptVarPtr call(CScriptVar *Fnc, R (*fnc)(A0,A1,A2,A3), const CScriptVarPtr *Args, size_t Argc) { return CScriptNativeResult<R>::box(Fnc, fnc(NATIVE_ARG(A0,0), NATIVE_ARG(A1,1), NATIVE_ARG(A2,2), NATIVE_ARG(A3,3))); }
+};
+// void-functions returns undefined
+template<> struct CScriptNativeSignature<void()> {
+	enum { arity = 0 };
+	static CScriptVarPtr call(CScriptVar *, void (*fnc)(), const CScriptVarPtr *, size_t) { fnc(); return CScriptVarPtr(); }
+};
+template<typename A0> struct CScriptNativeSignature<void(A0)> {
+	enum { arity = 1 };
+	static CScriptVarPtr call(CScriptVar *Fnc, void (*fnc)(A0), const CScriptVarPtr *Args, size_t Argc) { fnc(NATIVE_ARG(A0,0)); return CScriptVarPtr(); }
+};
+template<typename A0, typename A1> struct CScriptNativeSignature<void(A0,A1)> {
+	enum { arity = 2 };
+	static CScriptVarPtr call(CScriptVar *Fnc, void (*fnc)(A0,A1), const CScriptVarPtr *Args, size_t Argc) { fnc(NATIVE_ARG(A0,0), NATIVE_ARG(A1,1)); return CScriptVarPtr(); }
+};
+template<typename A0, typename A1, typename A2> struct CScriptNativeSignature<void(A0,A1,A2)> {
+	enum { arity = 3 };
+	static CScriptVarPtr call(CScriptVar *Fnc, void (*fnc)(A0,A1,A2), const CScriptVarPtr *Args, size_t Argc) { fnc(NATIVE_ARG(A0,0), NATIVE_ARG(A1,1), NATIVE_ARG(A2,2)); return CScriptVarPtr(); }
+};
+template<typename A0, typename A1, typename A2, typename A3> struct CScriptNativeSignature<void(A0,A1,A2,A3)> {
+	enum { arity = 4 };
+	static CScriptVarPtr call(CScriptVar *Fnc, void (*fnc)(A0,A1,A2,A3), const CScriptVarPtr *Args, size_t Argc) { fnc(NATIVE_ARG(A0,0), NATIVE_ARG(A1,1), NATIVE_ARG(A2,2), NATIVE_ARG(A3,3)); return CScriptVarPtr(); }
+};
+#undef NATIVE_ARG
+
+/// A native bound to a plain C++-function (see CTinyJS::bindNative).
+/// The conversion of the arguments and the result is generated at compile-time from the signature Sig
+/// and it is called with the fast calling-convention.
+template<typename Sig>
+class CScriptVarFunctionNativeTyped : public CScriptVarFunctionNativeFast {
+protected:
+	CScriptVarFunctionNativeTyped(CTinyJS *Context, Sig *Fnc, const char *Name) : CScriptVarFunctionNativeFast(Context, 0, 0, Name), fnc(Fnc) { }
+	CScriptVarFunctionNativeTyped(const CScriptVarFunctionNativeTyped &Copy) : CScriptVarFunctionNativeFast(Copy), fnc(Copy.fnc) { } ///< Copy protected -> use clone for public
+public:
+	virtual CScriptVarPtr clone() { return new CScriptVarFunctionNativeTyped(*this); }
+	using CScriptVarFunctionNativeFast::callFunction;
+	virtual CScriptVarPtr callFunction(const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc) { return CScriptNativeSignature<Sig>::call(this, fnc, Args, Argc); }
+private:
+	Sig *fnc;
+	template<typename Sig2>
+	friend define_newScriptVar_NamedFnc(FunctionNativeTyped, CTinyJS*, Sig2 *, const char *);
+};
+template<typename Sig>
+define_newScriptVar_NamedFnc(FunctionNativeTyped, CTinyJS *Context, Sig *Fnc, const char *Name=0) { return new CScriptVarFunctionNativeTyped<Sig>(Context, Fnc, Name); }
+
+
 ////////////////////////////////////////////////////////////////////////// 
 /// CScriptVarFunctionNativeClass
 //////////////////////////////////////////////////////////////////////////
@@ -1792,6 +2700,7 @@ protected:
 	CScriptVarFunctionNativeClass(const CScriptVarFunctionNativeClass &Copy) : CScriptVarFunctionNative(Copy), classPtr(Copy.classPtr), classFnc(Copy.classFnc) { } ///< Copy protected -> use clone for public
 public:
 	virtual CScriptVarPtr clone() { return new CScriptVarFunctionNativeClass(*this); }
+	virtual void forkReferences(CScriptVarForker &Forker) { CScriptVarFunctionNative::forkReferences(Forker); classPtr = Forker.forkObject(classPtr); }
 
 	virtual void callFunction(const CFunctionsScopePtr &c) { (classPtr->*classFnc)(c, jsUserData); }
 private:
@@ -1869,13 +2778,15 @@ class CScriptVarScope : public CScriptVarObject {
 protected: // only derived classes or friends can be created
 	CScriptVarScope(CTinyJS *Context) // constructor for rootScope
 		: CScriptVarObject(Context) {}
+	CScriptVarScope(const CScriptVarScope &Copy) : CScriptVarObject(Copy) {} ///< Copy protected -> scopes are only copied by fork
 	virtual CScriptVarPtr clone();
 	virtual bool isObject(); // { return false; }
 public:
 	virtual ~CScriptVarScope();
+	virtual CScriptVarPtr fork();
 	virtual CScriptVarPtr scopeVar(); ///< to create var like: var a = ...
 	virtual CScriptVarPtr scopeLet(); ///< to create var like: let a = ...
-	virtual CScriptVarLinkWorkPtr findInScopes(const std::string &childName);
+	virtual CScriptVarLinkWorkPtr findInScopes(const CScriptAtom &childName);
 	virtual CScriptVarScopePtr getParent();
 	friend define_newScriptVar_Fnc(Scope, CTinyJS *Context, Scope_t);
 };
@@ -1892,9 +2803,12 @@ class CScriptVarScopeFnc : public CScriptVarScope {
 protected: // only derived classes or friends can be created
 	CScriptVarScopeFnc(CTinyJS *Context, const CScriptVarScopePtr &Closure) // constructor for FncScope
 		: CScriptVarScope(Context), closure(Closure ? addChild(TINYJS_FUNCTION_CLOSURE_VAR, Closure, 0) : CScriptVarLinkPtr()) {}
+	CScriptVarScopeFnc(const CScriptVarScopeFnc &Copy)
+		: CScriptVarScope(Copy), closure(Copy.closure ? findChild(TINYJS_FUNCTION_CLOSURE_VAR) : CScriptVarLinkPtr()) {} ///< Copy protected -> scopes are only copied by fork
 public:
 	virtual ~CScriptVarScopeFnc();
-	virtual CScriptVarLinkWorkPtr findInScopes(const std::string &childName);
+	virtual CScriptVarPtr fork();
+	virtual CScriptVarLinkWorkPtr findInScopes(const CScriptAtom &childName);
 	
 	void setReturnVar(const CScriptVarPtr &var); ///< Set the result value. Use this when setting complex return data as it avoids a deepCopy()
 	
@@ -1925,9 +2839,12 @@ class CScriptVarScopeLet : public CScriptVarScope {
 protected: // only derived classes or friends can be created
 	CScriptVarScopeLet(const CScriptVarScopePtr &Parent); // constructor for LetScope
 //		: CScriptVarScope(Parent->getContext()), parent( context->getRoot() != Parent ? addChild(TINYJS_SCOPE_PARENT_VAR, Parent, 0) : 0) {}
+	CScriptVarScopeLet(const CScriptVarScopeLet &Copy)
+		: CScriptVarScope(Copy), parent(findChild(TINYJS_SCOPE_PARENT_VAR)), letExpressionInitMode(Copy.letExpressionInitMode) {} ///< Copy protected -> scopes are only copied by fork
 public:
 	virtual ~CScriptVarScopeLet();
-	virtual CScriptVarLinkWorkPtr findInScopes(const std::string &childName);
+	virtual CScriptVarPtr fork();
+	virtual CScriptVarLinkWorkPtr findInScopes(const CScriptAtom &childName);
 	virtual CScriptVarPtr scopeVar(); ///< to create var like: var a = ...
 	virtual CScriptVarScopePtr getParent();
 	void setletExpressionInitMode(bool Mode) { letExpressionInitMode = Mode; }
@@ -1949,11 +2866,14 @@ class CScriptVarScopeWith : public CScriptVarScopeLet {
 protected:
 	CScriptVarScopeWith(const CScriptVarScopePtr &Parent, const CScriptVarPtr &With) 
 		: CScriptVarScopeLet(Parent), with(addChild(TINYJS_SCOPE_WITH_VAR, With, 0)) {}
+	CScriptVarScopeWith(const CScriptVarScopeWith &Copy)
+		: CScriptVarScopeLet(Copy), with(findChild(TINYJS_SCOPE_WITH_VAR)) {} ///< Copy protected -> scopes are only copied by fork
 
 public:
 	virtual ~CScriptVarScopeWith();
+	virtual CScriptVarPtr fork();
 	virtual CScriptVarPtr scopeLet(); ///< to create var like: let a = ...
-	virtual CScriptVarLinkWorkPtr findInScopes(const std::string &childName);
+	virtual CScriptVarLinkWorkPtr findInScopes(const CScriptAtom &childName);
 private:
 	CScriptVarLinkPtr with;
 	friend define_newScriptVar_Fnc(ScopeWith, CTinyJS *Context, ScopeWith_t, const CScriptVarScopePtr &Parent, const CScriptVarPtr &With);
@@ -1974,11 +2894,13 @@ protected:
 	CScriptVarDefaultIterator(const CScriptVarDefaultIterator &Copy) 
 		: 
 		CScriptVarObject(Copy), mode(Copy.mode), object(Copy.object),
-		keys(Copy.keys), pos(keys.begin()){} ///< Copy protected -> use clone for public
+		keys(Copy.keys), pos(Copy.pos == Copy.keys.end() ? keys.end() : keys.find(*Copy.pos)){} ///< Copy protected -> use clone for public
 public:
 	virtual ~CScriptVarDefaultIterator();
 	virtual CScriptVarPtr clone();
 	virtual bool isIterator();
+	virtual void getReferences(std::vector<CScriptVar*> &Refs);
+	virtual void forkReferences(CScriptVarForker &Forker);
 
 	void native_next(const CFunctionsScopePtr &c, void *data);
 private:
@@ -2010,7 +2932,8 @@ protected:
 #endif
 	CScriptVarGenerator(const CScriptVarGenerator &Copy) 
 		: 
-		CScriptVarObject(Copy), functionRoot(Copy.functionRoot), function(Copy.function), coroutine(this) {} ///< Copy protected -> use clone for public
+		CScriptVarObject(Copy), functionRoot(Copy.functionRoot), function(Copy.function),
+		closed(Copy.closed || const_cast<CScriptVarGenerator&>(Copy).coroutine.isStarted()), yieldVarIsException(false), coroutine(this) {} ///< Copy protected -> use clone for public - the copy of a started generator is closed
 #if _MSC_VER == 1600
 #pragma warning(pop)
 #endif
@@ -2025,7 +2948,8 @@ public:
 	CScriptVarPtr getFunctionRoot() { return functionRoot; }
 	CScriptVarFunctionPtr getFunction() { return function; }
 
-	virtual void setTemporaryMark_recursive(uint32_t ID);
+	virtual void getReferences(std::vector<CScriptVar*> &Refs);
+	virtual void forkReferences(CScriptVarForker &Forker);
 
 	void native_send(const CFunctionsScopePtr &c, void *data);
 	void native_throw(const CFunctionsScopePtr &c, void *data);
@@ -2037,6 +2961,7 @@ public:
 	bool isClosed() { return closed; }
 	CScriptVarPtr yield(CScriptResult &execute, CScriptVar *YieldIn);
 private:
+	void collectorShadeState(); ///< write-barrier for yieldVar & generatorScopes
 	CScriptVarPtr functionRoot;
 	CScriptVarFunctionPtr function;
 	bool closed;
@@ -2052,6 +2977,7 @@ private:
 	friend class CCooroutine;
 
 public:
+	void *getStackLimit() { return coroutine.getStackLimit(); } ///< lowest usable address of the generators stack or 0
 	void *callersStackBase;
 	size_t callersScopeSize;
 	CScriptTokenizer *callersTokenizer;
@@ -2118,6 +3044,66 @@ public:
 
 
 
+#ifndef NO_REGEXP
+//////////////////////////////////////////////////////////////////////////
+/// CScriptRegexCache
+//////////////////////////////////////////////////////////////////////////
+
+#define REGEX_CACHE_DEFAULT_CAPACITY 64
+
+/// LRU-cache of compiled regexps keyed by source, ignoreCase and multiline (the other flags does not change the automaton).
+/// Each context has one - used by RegExp-objects and the String-natives for string-patterns
+class CScriptRegexCache {
+public:
+	struct Stats {
+		Stats() : hits(0), misses(0), evictions(0) {}
+		uint64_t hits;
+		uint64_t misses; ///< each miss is a compilation
+		uint64_t evictions;
+	};
+	CScriptRegexCache(size_t Capacity=REGEX_CACHE_DEFAULT_CAPACITY) : capacity(Capacity) {}
+	/// returns the compiled regexp - a copy of a CScriptRegex shares the automaton.
+	/// throws CScriptRegexError if Source is invalid (failed compilations are not cached)
+	CScriptRegex get(const std::string &Source, bool IgnoreCase, bool Multiline=false);
+	void setCapacity(size_t Capacity);
+	size_t getCapacity() const { return capacity; }
+	size_t size() const { return index.size(); }
+	void clear() { index.clear(); lru.clear(); }
+	const Stats &getStats() const { return stats; }
+	void resetStats() { stats = Stats(); }
+private:
+	typedef std::pair<std::string, CScriptRegex> ENTRY_t;
+	typedef std::list<ENTRY_t> LRU_t; ///< the most recently used is at front
+	typedef std::map<std::string, LRU_t::iterator> INDEX_t;
+	LRU_t lru;
+	INDEX_t index;
+	size_t capacity;
+	Stats stats;
+};
+
+#endif /* NO_REGEXP */
+
+//////////////////////////////////////////////////////////////////////////
+/// CScriptHeapReport
+//////////////////////////////////////////////////////////////////////////
+
+/// result of CTinyJS::getHeapReport. The vars are counted by type - the type-tag of
+/// objects ("Object", "Array", "Function" ...) or getVarType() of the other vars ("number", "string" ...)
+struct CScriptHeapReport {
+	struct Type {
+		Type() : count(0), unreachable(0) {}
+		uint32_t count; ///< all vars of this type
+		uint32_t unreachable; ///< vars of this type not reachable from the roots
+		std::vector<const void *> samples; ///< addresses of some unreachable vars
+	};
+	typedef std::map<std::string, Type> TYPES_t;
+	CScriptHeapReport() : count(0), unreachable(0) {}
+	uint32_t count; ///< all vars of the context
+	uint32_t unreachable; ///< vars not reachable from the roots - after a collection these are leaks (held by C++ code only)
+	TYPES_t types;
+};
+
+
 //////////////////////////////////////////////////////////////////////////
 /// CTinyJS
 //////////////////////////////////////////////////////////////////////////
@@ -2127,6 +3113,7 @@ typedef int (*native_require_read_fnc)(const std::string &Fname, std::string &Da
 class CTinyJS {
 public:
 	CTinyJS();
+	explicit CTinyJS(const CScriptSnapshot &Snapshot); ///< a fork of the snapshot - much faster than CTinyJS() and the init-scripts
 	~CTinyJS();
 
 	void execute(CScriptTokenizer &Tokenizer);
@@ -2190,15 +3177,54 @@ public:
 			Class Instanz;
 			tinyJS->addNative("function String.substring(lo, hi)", &Instanz, &Class::*scSubstring, 0);
 		\endcode
+
+		or with the fast calling-convention (the parameter-names are only used for Function.toString)
+
+		\code
+			CScriptVarPtr scMathAbs(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *userdata) { ... }
+			tinyJS->addNative("function Math.abs(a)", scMathAbs, 0);
+		\endcode
 	*/
 
 	CScriptVarFunctionNativePtr addNative(const std::string &funcDesc, JSCallback ptr, void *userdata=0, int LinkFlags=SCRIPTVARLINK_BUILDINDEFAULT);
+	CScriptVarFunctionNativePtr addNative(const std::string &funcDesc, JSFastCallback ptr, void *userdata=0, int LinkFlags=SCRIPTVARLINK_BUILDINDEFAULT);
 	template<class C>
 	CScriptVarFunctionNativePtr addNative(const std::string &funcDesc, C *class_ptr, void(C::*class_fnc)(const CFunctionsScopePtr &, void *), void *userdata=0, int LinkFlags=SCRIPTVARLINK_BUILDINDEFAULT)
 	{
 		return addNative(funcDesc, ::newScriptVar<C>(this, class_ptr, class_fnc, userdata), LinkFlags);
 	}
 
+	/// add a plain C++-function as native - the conversion of the arguments and the result is generated
+	/// at compile-time from its signature (see CScriptNativeArg and CScriptNativeResult for the supported types)
+	/** example:
+		\code
+			tinyJS->bindNative<double(double, double)>(Math, "pow", pow);
+			static int32_t imul(int32_t a, int32_t b) { ... }
+			tinyJS->bindNative(Math, "imul", imul);
+		\endcode
+		The function is added as Name to Object. Its parameters (a, b, ...) are taken from the signature,
+		so the length of the function always matches the number of parameters of fnc.
+	*/
+	template<typename Sig>
+	CScriptVarFunctionNativePtr bindNative(const CScriptVarPtr &Object, const std::string &Name, Sig *fnc, int LinkFlags=SCRIPTVARLINK_BUILDINDEFAULT)
+	{
+		return addNative(Object, Name, ::newScriptVarFunctionNativeTyped(this, fnc), CScriptNativeSignature<Sig>::arity, LinkFlags);
+	}
+
+	/// let Installer add the natives of Object on the first access to a property that Object not already has
+	/** Object (e.g. Math or String.prototype) must exist. Installer is called once (more installers per
+		Object are called in the order of adding) and it adds the natives as usual with addNative.
+		example:
+		\code
+			static void installMath(CTinyJS *tinyJS, const CScriptVarPtr &Math) {
+				tinyJS->addNative("function Math.abs(a)", scMathAbs, 0);
+				...
+			}
+			tinyJS->addLazyNatives(tinyJS->getRoot()->addChild("Math", tinyJS->newScriptVar(Object)), installMath);
+		\endcode
+	*/
+	void addLazyNatives(const CScriptVarPtr &Object, JSLazyNativesCallback Installer);
+
 	/// Send all variables to stdout
 	void trace();
 
@@ -2219,6 +3245,12 @@ public:
 	const CScriptVarPtr &constScriptVar(StopIteration_t)	{ return constStopIteration; }
 
 private:
+	explicit CTinyJS(CTinyJS *From); ///< a fork of From (see CScriptSnapshot)
+	void init(); ///< the members of an empty context
+	CScriptVarForker *forker; ///< set while this is forked - the copies of the vars are created in forker->getTarget()
+	friend class CScriptVarForker;
+	friend class CScriptSnapshot;
+
 	CScriptTokenizer *t;       /// current tokenizer
 	bool haveTry;
 	std::vector<CScriptVarScopePtr>scopes;
@@ -2248,6 +3280,13 @@ public:
 	CScriptVarPtr arrayPrototype; /// Built in array class
 	CScriptVarPtr stringPrototype; /// Built in string class
 	CScriptVarPtr regexpPrototype; /// Built in string class
+	CScriptVarPtr arrayBufferPrototype; /// Built in ArrayBuffer class
+	CScriptVarPtr typedArrayPrototypes[TYPEDARRAY_KIND_COUNT]; /// Built in Int8Array ... Float64Array classes
+	CScriptVarPtr dataViewPrototype; /// Built in DataView class
+	CScriptVarPtr mapPrototype; /// Built in Map class
+	CScriptVarPtr setPrototype; /// Built in Set class
+	CScriptVarPtr weakMapPrototype; /// Built in WeakMap class
+	CScriptVarPtr mapIteratorPrototype; /// Built in iterator class of Map and Set
 	CScriptVarPtr numberPrototype; /// Built in number class
 	CScriptVarPtr booleanPrototype; /// Built in boolean class
 	CScriptVarPtr iteratorPrototype; /// Built in iterator class
@@ -2256,7 +3295,39 @@ public:
 #endif /*NO_GENERATORS*/
 	CScriptVarPtr functionPrototype; /// Built in function class
 	const CScriptVarPtr &getErrorPrototype(ERROR_TYPES Type) { return errorPrototypes[Type]; }
+	CScriptVarShape *getRootShape() { return rootShape; }
+	uint32_t getShapeCount() { return rootShape->getTreeSize(); } ///< the number of shapes in the shape-tree (without the dictionary-shapes)
+	void shapeInUse() { if(++shapesInUse >= shapePruneThreshold) pruneShapes(); } ///< called if an unused (or new) shape of the tree gets used
+	void pruneShapes(); ///< removes the unused shapes from the shape-tree
+	const CScriptInlineCacheStats &getInlineCacheStats() const { return inlineCacheStats; } ///< hits & misses of the member-access caches
+	void resetInlineCacheStats() { inlineCacheStats = CScriptInlineCacheStats(); }
+	/// simple expressions (conditions, iterations and expression-statements) are compiled to
+	/// bytecode and executed by a register-VM. Set to false to use the token-walker only
+	void setUseBytecode(bool Use) { useBytecode = Use; }
+	bool getUseBytecode() const { return useBytecode; }
+	/// the cycle-collector works in slices at the loop back-edges and at the end of evaluateComplex. Budget is the number
+	/// of vars marked, scanned or swept per slice - but at least CYCLE_COLLECTOR_STEP_RATIO for each var created since
+	/// the last slice, so the collector keeps pace with the script. 0 (the default) means a collection is done in one slice
+	void setCollectorBudget(uint32_t Budget) { collectorBudget = Budget; }
+	uint32_t getCollectorBudget() const { return collectorBudget; }
+	bool isCollecting() const { return collectorPhase != COLLECTOR_IDLE; } ///< a collection is started and not finished
+	/// walks the heap and reports all vars and the vars not reachable from the roots (root-scope and built-in prototypes).
+	/// With Collect set a complete collection is done before. Only for debugging - the costs are two full heap walks.
+	/// Must not be called while a script is executed
+	CScriptHeapReport getHeapReport(bool Collect=true, uint32_t MaxSamples=8);
+#ifndef NO_REGEXP
+	CScriptRegexCache &getRegexCache() { return regexCache; } ///< compiled regexps - see getStats() for hits & misses
+#endif /* NO_REGEXP */
 private:
+	CScriptVarShape *rootShape; /// the empty shape - owns the shape-tree of all vars in this context
+	uint32_t shapesInUse; ///< the shapes gets used since the last prune
+	uint32_t shapePruneThreshold;
+	CScriptInlineCacheStats inlineCacheStats;
+	bool useBytecode;
+	int hiddenLetScopes; /// >0 while a let-scope is in letExpressionInitMode - the scope-caches are bypassed
+#ifndef NO_REGEXP
+	CScriptRegexCache regexCache;
+#endif /* NO_REGEXP */
 	CScriptVarPtr errorPrototypes[ERROR_COUNT]; /// Built in error class
 	CScriptVarPtr constUndefined;
 	CScriptVarPtr constNull;
@@ -2268,6 +3339,15 @@ private:
 	CScriptVarPtr constFalse;
 	CScriptVarPtr constStopIteration;
 
+	/// VALUE-CACHES (see config.h) - the entries are created on first use and added to pseudo_refered
+	CScriptVarPtr charCache[256];
+	std::vector<std::vector<CScriptVarPtr> > intCache; ///< blocks of VALUE_CACHE_INT_BLOCK entries - allocated on first use
+	friend define_newScriptVar_Fnc(String, CTinyJS *Context, const std::string &Obj);
+	friend define_newScriptVar_Fnc(String, CTinyJS *Context, const char *Obj);
+	friend define_newScriptVar_Fnc(String, CTinyJS *Context, const CScriptStringRef &Obj);
+	friend define_newScriptVar_Fnc(Number, CTinyJS *Context, const CNumber &Obj);
+	const CScriptVarPtr &cachedChar(unsigned char Char);
+
 	std::vector<CScriptVarPtr *> pseudo_refered;
 
 	void CheckRightHandVar(CScriptResult &execute, CScriptVarLinkWorkPtr &link)
@@ -2281,11 +3361,15 @@ private:
 		if(execute && link && !link->isOwned() && !link.hasReferencedOwner() && !link->getName().empty())
 			throwError(execute, ReferenceError, link->getName() + " is not defined", Pos);
 	}
+	/// an exception thrown by a native function - set to execute if we are in a try-block otherwise thrown as CScriptException
+	void nativeThrow(CScriptResult &execute, const CScriptVarPtr &Exception, const std::string &FunctionName);
 
 public:
 	// function call
 	CScriptVarPtr callFunction(const CScriptVarFunctionPtr &Function, std::vector<CScriptVarPtr> &Arguments, const CScriptVarPtr &This, CScriptVarPtr *newThis=0);
 	CScriptVarPtr callFunction(CScriptResult &execute, const CScriptVarFunctionPtr &Function, std::vector<CScriptVarPtr> &Arguments, const CScriptVarPtr &This, CScriptVarPtr *newThis=0);
+	/// calls Next of Iterator (e.g. from toIterator) - returns false on StopIteration, other exceptions are thrown
+	bool iteratorNext(const CScriptVarPtr &Iterator, const CScriptVarFunctionPtr &Next, CScriptVarPtr &Value);
 	//////////////////////////////////////////////////////////////////////////
 #ifndef NO_GENERATORS
 	std::vector<CScriptVarGenerator *> generatorStack;
@@ -2296,6 +3380,7 @@ public:
 
 	// parsing - in order of precedence
 	CScriptVarPtr mathsOp(CScriptResult &execute, const CScriptVarPtr &a, const CScriptVarPtr &b, int op);
+	CScriptVarPtr mathsOp(const CNumber &a, const CNumber &b, int op); ///< the numeric part of mathsOp
 private:
 	void assign_destructuring_var(CScriptResult &execute, const CScriptTokenDataDestructuringVar &Objc, const CScriptVarPtr &Val, const CScriptVarPtr &Scope);
 	void execute_var_init(CScriptResult &execute, bool hideLetScope);
@@ -2315,17 +3400,28 @@ private:
 	CScriptVarLinkPtr execute_assignment(CScriptVarLinkWorkPtr Lhs, CScriptResult &execute);
 	CScriptVarLinkPtr execute_assignment(CScriptResult &execute);
 	CScriptVarLinkPtr execute_base(CScriptResult &execute);
+	CScriptVarLinkPtr execute_base(CScriptResult &execute, CScriptBytecodeSlot &Code); ///< uses the bytecode if possible
 	void execute_block(CScriptResult &execute);
 	void execute_statement(CScriptResult &execute);
+	CScriptVarLinkWorkPtr execute_bytecode(CScriptResult &execute, CScriptBytecode &Code);
+	// helpers shared by the token-walker and the bytecode
+	void member_access(CScriptResult &execute, CScriptVarLinkWorkPtr &a, const CScriptAtom &Name, CScriptInlineCache &Cache);
+	void member_subscript(CScriptResult &execute, CScriptVarLinkWorkPtr &a, const CScriptVarPtr &Subscript);
+	void increment_var(CScriptResult &execute, CScriptVarLinkWorkPtr &a, int op, bool postfix, int Line, int Column);
+	CScriptVarLinkPtr assign_var(CScriptResult &execute, CScriptVarLinkWorkPtr &lhs, const CScriptVarLinkWorkPtr &rhs, int op, int Line, int Column);
 	// parsing utility functions
 	CScriptVarLinkWorkPtr parseFunctionDefinition(const CScriptToken &FncToken);
 	CScriptVarLinkWorkPtr parseFunctionsBodyFromString(const std::string &ArgumentList, const std::string &FncBody);
 public:
 	CScriptVarLinkPtr findInScopes(const std::string &childName); ///< Finds a child, looking recursively up the scopes
+	CScriptVarLinkPtr findInScopes(const CScriptAtom &childName);
+	CScriptVarLinkPtr findInScopes(const CScriptAtom &childName, CScriptInlineCache &Cache); ///< like findInScopes but the (depth, slot) of the variable is cached
 private:
 	//////////////////////////////////////////////////////////////////////////
 	/// addNative-helper
 	CScriptVarFunctionNativePtr addNative(const std::string &funcDesc, CScriptVarFunctionNativePtr Var, int LinkFlags);
+	CScriptVarFunctionNativePtr addNative(const CScriptVarPtr &Object, const std::string &Name, CScriptVarFunctionNativePtr Var, int Arity, int LinkFlags); ///< for bindNative - the parameters are named a, b, ...
+	CScriptVarFunctionNativePtr addNative(const CScriptVarPtr &Base, const std::string &Name, CScriptVarFunctionNativePtr Var, const STRING_VECTOR_t &Arguments, int LinkFlags);
 
 	//////////////////////////////////////////////////////////////////////////
 	/// throws an Error & Exception
@@ -2333,6 +3429,7 @@ public:
 	void throwError(CScriptResult &execute, ERROR_TYPES ErrorType, const std::string &message);
 	void throwException(ERROR_TYPES ErrorType, const std::string &message);
 	void throwError(CScriptResult &execute, ERROR_TYPES ErrorType, const std::string &message, CScriptTokenizer::ScriptTokenPosition &Pos);
+	void throwError(CScriptResult &execute, ERROR_TYPES ErrorType, const std::string &message, int Line, int Column);
 	void throwException(ERROR_TYPES ErrorType, const std::string &message, CScriptTokenizer::ScriptTokenPosition &Pos);
 private:
 	//////////////////////////////////////////////////////////////////////////
@@ -2400,6 +3497,15 @@ private:
 
 	void native_JSON_parse(const CFunctionsScopePtr &c, void *data);
 
+	static void installObjectNatives(CTinyJS *tinyJS, const CScriptVarPtr &Object);
+	static void installJSONNatives(CTinyJS *tinyJS, const CScriptVarPtr &JSON);
+
+	/// the lazy natives (see addLazyNatives) - the entries are removed on install or if the object is deleted
+	std::vector<std::pair<CScriptVar *, JSLazyNativesCallback> > lazyNatives;
+	void installLazyNatives(CScriptVar *Object);
+	void removeLazyNatives(CScriptVar *Object);
+	friend class CScriptVar;
+
 
 	uint32_t uniqueID;
 	int32_t currentMarkSlot;
@@ -2419,13 +3525,88 @@ public:
 		--currentMarkSlot;
 	}
 	CScriptVar *first;
+	uint32_t varCount; ///< number of vars in the list first->next...
+	uint32_t collectThreshold; ///< varCount that triggers the next collection in evaluateComplex
 	void setTemporaryID_recursive(uint32_t ID);
-	void ClearUnreferedVars(const CScriptVarPtr &extra=CScriptVarPtr());
+	void ClearUnreferedVars(const CScriptVarPtr &extra=CScriptVarPtr()); ///< finishes a running collection and makes a complete collection
+
+	//////////////////////////////////////////////////////////////////////////
+	/// incremental cycle-collector
+	/// Marking starts at the roots (root, pseudo_refered & errorPrototypes) and uses collectorMarkStack.
+	/// Between the slices the script may change the references. A link pointing to a var shades the var
+	/// (Dijkstra write-barrier) and vars created while collecting are already marked, so the marked vars
+	/// never refer to unmarked ones. The scan collects all unmarked vars behind collectorScanCursor.
+	/// A slice may run while a script is executed (at the loop back-edges), so unmarked vars can be alive -
+	/// referenced from the C++-stack (temporaries, scopes of running functions, natives) or from a marked var.
+	/// Before the sweep collectorRescue marks all candidates with more references than the references
+	/// from other candidates and all vars reachable from them (like trial-deletion). The sweep removes the
+	/// childs of the remaining candidates
+	/// The values of weak pairs (see CScriptVar::getWeakReferences) are marked when the mark-stack is empty and
+	/// the key is marked (repeated until nothing more is marked). Before the sweep the pairs with an unmarked key are removed
+	enum COLLECTOR_PHASE { COLLECTOR_IDLE, COLLECTOR_MARK, COLLECTOR_SCAN, COLLECTOR_SWEEP };
+	COLLECTOR_PHASE collectorPhase;
+	uint32_t collectorEpoch; ///< incremented on each start of a collection
+	uint32_t collectorBudget;
+	bool collectorNoRescue; ///< set by ~CTinyJS - all vars not reachable from the roots are removed
+	std::vector<CScriptVarPtr> collectorMarkStack; ///< marked but not scanned vars
+	CScriptVar *collectorScanCursor; ///< next var to scan (moved on if the var is deleted)
+	std::vector<CScriptVarPtr> collectorCandidates; ///< the unmarked vars found by the scan - freed at the end of the sweep
+	std::vector<CScriptVarPtr> collectorWeakHolders; ///< the marked vars with weak pairs
+	size_t collectorSweepPos; ///< next candidate to sweep
+	uint32_t collectorAllocs; ///< vars created since the last slice
+	void collectorStart(const CScriptVarPtr &extra);
+	bool collectorStep(uint32_t Budget); ///< returns true if the collection is finished
+	bool collectorMarkNext(); ///< scans the next var of the mark-stack - returns false if the mark-stack is empty
+	bool collectorMarkWeak(); ///< marks the values of the weak pairs with a marked key - returns false if nothing is marked
+	void collectorRescue();
+	void collectorSlice(); ///< starts a collection if needed and runs a slice
+	void collectorSafePoint() { if(collectorPhase != COLLECTOR_IDLE || varCount >= collectThreshold) collectorSlice(); } ///< called at the loop back-edges
+	uint32_t getVarCount() const { return varCount; }
 	void setStackBase(void * StackBase) { stackBase = StackBase; }
 	void setStackBase(uint32_t StackSize) { char dummy; stackBase = StackSize ? &dummy-StackSize : 0; }
 };
 
 
+//////////////////////////////////////////////////////////////////////////
+/// CScriptSnapshot
+//////////////////////////////////////////////////////////////////////////
+
+/// A frozen copy of a fully initialized context (built-ins, installed natives and everything the
+/// init-scripts has added to the root-scope) to create clean contexts for each request.
+/** The vars can't be shared copy-on-write (each var belongs to one context and its references are
+	not thread-safe), so a fork copies the reachable vars - but without parsing, without re-adding
+	the natives and with the same shapes. So the inline-caches warmed by the init-scripts stays valid.
+	Natives not installed in the snapshot (see CTinyJS::addLazyNatives) are installed lazily in each fork.
+	The forks of a snapshot can run in different threads at the same time: the forks are created one at a time
+	(the copying changes the reference-counts of the originals), each fork gets its own copy of the function-bodies
+	(the inline-caches and the bytecode are changed while executing) and of the scratch of the regexps. Only data
+	never changed is shared - string-data, compiled regexps and natives - with atomic reference-counts.
+	example:
+	\code
+		CTinyJS init;
+		init.execute(libraryCode);
+		CScriptSnapshot snapshot(init);
+		...
+		CTinyJS request(snapshot); // each request gets its own globals
+		request.execute(requestCode);
+	\endcode
+*/
+class CScriptSnapshot {
+public:
+	explicit CScriptSnapshot(CTinyJS &Context); ///< Context must not execute a script
+	~CScriptSnapshot();
+	uint32_t getVarCount() const; ///< the number of vars copied by each fork
+private:
+	CScriptSnapshot(const CScriptSnapshot &Copy) MEMBER_DELETE;
+	CScriptSnapshot &operator=(const CScriptSnapshot &Copy) MEMBER_DELETE;
+	CTinyJS *context; ///< the frozen copy - never executes a script
+#ifndef NO_THREADING
+	mutable CScriptMutex mutex; ///< locked while a fork is created
+#endif
+	friend class CTinyJS;
+};
+
+
 //////////////////////////////////////////////////////////////////////////
 template<typename T>
 inline const CScriptVarPtr &CScriptVar::constScriptVar(T t) { return context->constScriptVar(t); }
@@ -2436,6 +3617,32 @@ inline CNumber CScriptVarLink::toNumber(CScriptResult &execute) { return var->to
 inline void CScriptVar::setTemporaryMark(uint32_t ID) { temporaryMark[context->getCurrentMarkSlot()] = ID; }
 inline uint32_t CScriptVar::getTemporaryMark() { return temporaryMark[context->getCurrentMarkSlot()]; }
 
+// marks a var while it is on the current path of getParsableString - a var reached twice on
+// different paths (e.g. a shared object or a cached number) is not a recursion
+class CScriptVarPathMark {
+public:
+	CScriptVarPathMark(CScriptVar *Var, uint32_t ID) : var(0), oldMark(0), onPath(false) {
+		if(!ID) return;
+		if(Var->getTemporaryMark() == ID) { onPath = true; return; }
+		var = Var;
+		oldMark = Var->getTemporaryMark();
+		Var->setTemporaryMark(ID);
+	}
+	~CScriptVarPathMark() { if(var) var->setTemporaryMark(oldMark); }
+	bool isOnPath() const { return onPath; }
+private:
+	CScriptVar *var;
+	uint32_t oldMark;
+	bool onPath;
+};
+
+inline void CScriptVar::collectorShade() {
+	if(context->collectorPhase == CTinyJS::COLLECTOR_MARK && collectorMark != context->collectorEpoch) {
+		collectorMark = context->collectorEpoch;
+		context->collectorMarkStack.push_back(this);
+	}
+}
+
 
 #endif
 
@@ -0,0 +1,436 @@
+/*
+ * 42TinyJS
+ *
+ * A fork of TinyJS with the goal to makes a more JavaScript/ECMA compliant engine
+ *
+ * Authored By Armin Diedering <armin@diedering.de>
+ *
+ * Copyright (C) 2010-2015 ardisoft
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "TinyJS.h"
+
+using namespace std;
+
+static const char *MAP_KIND_NAME[] = { "Map", "Set", "WeakMap" };
+
+
+//////////////////////////////////////////////////////////////////////////
+/// CScriptVarMap
+//////////////////////////////////////////////////////////////////////////
+
+static CScriptVarPtr &mapPrototype(CTinyJS *Context, MAP_KIND Kind) {
+	return Kind == MapKindMap ? Context->mapPrototype : Kind == MapKindSet ? Context->setPrototype : Context->weakMapPrototype;
+}
+
+CScriptVarMap::CScriptVarMap(CTinyJS *Context, MAP_KIND Kind)
+	: CScriptVarObject(Context, mapPrototype(Context, Kind)), kind(Kind), count(0) {}
+CScriptVarMap::CScriptVarMap(const CScriptVarMap &Copy)
+	: CScriptVarObject(Copy), kind(Copy.kind), entries(Copy.entries), slots(Copy.slots), count(Copy.count) {}
+CScriptVarMap::~CScriptVarMap() {
+	ASSERT(iterators.empty()); // an iterator references its map
+}
+CScriptVarPtr CScriptVarMap::clone() { return new CScriptVarMap(*this); }
+void CScriptVarMap::removeAllChildren() {
+	CScriptVarObject::removeAllChildren();
+	clear();
+}
+string CScriptVarMap::getVarTypeTagName() { return MAP_KIND_NAME[kind]; }
+void CScriptVarMap::getReferences(vector<CScriptVar*> &Refs) {
+	CScriptVarObject::getReferences(Refs);
+	if(kind == MapKindWeakMap) return; // see getWeakReferences
+	for(vector<Entry>::iterator it = entries.begin(); it != entries.end(); ++it) {
+		if(!it->key) continue;
+		Refs.push_back(it->key.getVar());
+		if(it->value) Refs.push_back(it->value.getVar());
+	}
+}
+void CScriptVarMap::getWeakReferences(vector<CScriptVar*> &Refs) {
+	if(kind != MapKindWeakMap) return;
+	for(vector<Entry>::iterator it = entries.begin(); it != entries.end(); ++it) {
+		if(!it->key) continue;
+		Refs.push_back(it->key.getVar());
+		Refs.push_back(it->value.getVar());
+	}
+}
+void CScriptVarMap::removeWeakReferences(uint32_t Epoch) {
+	if(kind != MapKindWeakMap) return;
+	vector<Entry> removed; // released at the end - releasing a key or value can destroy an iterator of this map
+	for(vector<Entry>::iterator it = entries.begin(); it != entries.end(); ++it) {
+		if(it->key && it->key->collectorMark != Epoch) {
+			removed.push_back(Entry());
+			swap(removed.back(), *it);
+			it->hash = removed.back().hash; // the slot stays occupied until the next rehash
+			--count;
+		}
+	}
+	if(count*8 < slots.size() && slots.size() > MIN_SLOTS) rehash(count);
+}
+void CScriptVarMap::forkReferences(CScriptVarForker &Forker) {
+	CScriptVarObject::forkReferences(Forker);
+	for(vector<Entry>::iterator it = entries.begin(); it != entries.end(); ++it) {
+		if(!it->key) continue;
+		Forker.forkPtr(it->key);
+		Forker.forkPtr(it->value);
+		it->hash = hashKey(it->key); // objects are hashed by identity
+	}
+	if(slots.empty()) return;
+	slots.assign(slots.size(), 0);
+	for(uint32_t i=0; i<entries.size(); ++i) insertSlot(i);
+}
+
+static inline uint32_t mapHashMix(uint32_t h) {
+	h ^= h >> 16; h *= 0x85ebca6b;
+	h ^= h >> 13; h *= 0xc2b2ae35;
+	return h ^ (h >> 16);
+}
+uint32_t CScriptVarMap::hashKey(const CScriptVarPtr &Key) {
+	if(Key->isString()) {
+		const CScriptStringRef &str = CScriptVarStringPtr(Key)->getString();
+		uint32_t h = 2166136261u; // FNV-1a
+		for(CScriptStringRef::const_iterator it = str.begin(); it != str.end(); ++it)
+			h = (h ^ uint8_t(*it)) * 16777619u;
+		return h;
+	}
+	if(Key->isNumber()) {
+		CNumber n = Key->toNumber();
+		if(n.isNaN()) return 0x7ff80000;
+		if(n.isZero()) return mapHashMix(0); // +0 and -0 are the same key
+		if(n.isInt32()) return mapHashMix(uint32_t(n.toInt32()));
+		double d = n.toDouble();
+		if(d == floor(d) && d >= -2147483648.0 && d <= 2147483647.0) return mapHashMix(uint32_t(int32_t(d)));
+		uint32_t bits[2];
+		memcpy(bits, &d, sizeof(d));
+		return mapHashMix(bits[0] ^ mapHashMix(bits[1]));
+	}
+	if(Key->isUndefined()) return 1;
+	if(Key->isNull()) return 2;
+	if(Key->isBool()) return Key->toBoolean() ? 4 : 3;
+	return mapHashMix(uint32_t(uintptr_t(Key.getVar())) ^ uint32_t(uint64_t(uintptr_t(Key.getVar())) >> 32)); // objects by identity
+}
+bool CScriptVarMap::sameValueZero(const CScriptVarPtr &A, const CScriptVarPtr &B) {
+	if(A.getVar() == B.getVar()) return true;
+	if(A->isString()) return B->isString() && CScriptVarStringPtr(A)->getString() == CScriptVarStringPtr(B)->getString();
+	if(A->isNumber()) {
+		if(!B->isNumber()) return false;
+		CNumber a = A->toNumber(), b = B->toNumber();
+		return a.isNaN() ? b.isNaN() : a.toDouble() == b.toDouble();
+	}
+	if(A->isUndefined()) return B->isUndefined();
+	if(A->isNull()) return B->isNull();
+	if(A->isBool()) return B->isBool() && A->toBoolean() == B->toBoolean();
+	return false;
+}
+
+uint32_t CScriptVarMap::find(const CScriptVarPtr &Key, uint32_t Hash) {
+	if(slots.empty()) return NOT_FOUND;
+	uint32_t mask = uint32_t(slots.size()) - 1;
+	for(uint32_t i = Hash & mask; slots[i]; i = (i+1) & mask) {
+		Entry &entry = entries[slots[i]-1];
+		if(entry.hash == Hash && entry.key && sameValueZero(entry.key, Key)) return slots[i]-1;
+	}
+	return NOT_FOUND;
+}
+void CScriptVarMap::insertSlot(uint32_t Idx) {
+	uint32_t mask = uint32_t(slots.size()) - 1;
+	uint32_t i = entries[Idx].hash & mask;
+	while(slots[i]) i = (i+1) & mask;
+	slots[i] = Idx+1;
+}
+void CScriptVarMap::rehash(uint32_t Count) {
+	vector<Entry> dropped; // released at the end - releasing a key or value can destroy an iterator of this map
+	if(kind == MapKindWeakMap) {
+		for(vector<Entry>::iterator it = entries.begin(); it != entries.end(); ++it) {
+			if(it->key && it->key->getRefs() == 1) { // only referenced by this WeakMap
+				dropped.push_back(Entry());
+				swap(dropped.back(), *it);
+				--count;
+			}
+		}
+	}
+	if(count != entries.size()) {
+		// compact the entries and move the iterators to the next living entry
+		vector<uint32_t> newPos(iterators.empty() ? 0 : entries.size()+1);
+		uint32_t n = 0;
+		for(uint32_t i=0; i<entries.size(); ++i) {
+			if(!newPos.empty()) newPos[i] = n;
+			if(entries[i].key) {
+				if(n != i) swap(entries[n], entries[i]);
+				++n;
+			}
+		}
+		if(!newPos.empty()) {
+			newPos[entries.size()] = n;
+			for(vector<CScriptVarMapIterator*>::iterator it = iterators.begin(); it != iterators.end(); ++it)
+				(*it)->pos = newPos[min((*it)->pos, uint32_t(entries.size()))];
+		}
+		entries.resize(n);
+	}
+	size_t size = MIN_SLOTS;
+	while(size < size_t(max(Count, count))*2) size <<= 1;
+	slots.assign(size, 0);
+	for(uint32_t i=0; i<entries.size(); ++i) insertSlot(i);
+}
+
+CScriptVarPtr CScriptVarMap::get(const CScriptVarPtr &Key) {
+	uint32_t idx = find(Key, hashKey(Key));
+	if(idx == NOT_FOUND) return CScriptVarPtr();
+	return entries[idx].value ? entries[idx].value : entries[idx].key;
+}
+void CScriptVarMap::set(const CScriptVarPtr &Key, const CScriptVarPtr &Value) {
+	uint32_t hash = hashKey(Key);
+	uint32_t idx = find(Key, hash);
+	if(Value) Value->collectorShade(); // write-barrier
+	if(idx != NOT_FOUND) {
+		if(kind != MapKindSet) entries[idx].value = Value;
+		return;
+	}
+	Key->collectorShade();
+	if((entries.size()+1)*4 > slots.size()*3) rehash(count+1);
+	entries.push_back(Entry());
+	Entry &entry = entries.back();
+	entry.key = Key;
+	if(kind != MapKindSet) entry.value = Value;
+	entry.hash = hash;
+	insertSlot(uint32_t(entries.size())-1);
+	++count;
+}
+bool CScriptVarMap::remove(const CScriptVarPtr &Key) {
+	uint32_t idx = find(Key, hashKey(Key));
+	if(idx == NOT_FOUND) return false;
+	Entry removed;
+	swap(removed, entries[idx]);
+	entries[idx].hash = removed.hash; // the slot stays occupied until the next rehash
+	--count;
+	if(count*8 < slots.size() && slots.size() > MIN_SLOTS) rehash(count);
+	return true;
+}
+void CScriptVarMap::clear() {
+	vector<Entry> removed;
+	swap(removed, entries);
+	slots.clear();
+	count = 0;
+	for(vector<CScriptVarMapIterator*>::iterator it = iterators.begin(); it != iterators.end(); ++it)
+		(*it)->pos = 0;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+/// CScriptVarMapIterator
+//////////////////////////////////////////////////////////////////////////
+
+CScriptVarMapIterator::CScriptVarMapIterator(CTinyJS *Context, const CScriptVarMapPtr &Map, int Mode)
+	: CScriptVarObject(Context, Context->mapIteratorPrototype), map(Map), pos(0), mode(Mode) {
+	map->iterators.push_back(this);
+}
+CScriptVarMapIterator::CScriptVarMapIterator(const CScriptVarMapIterator &Copy)
+	: CScriptVarObject(Copy), map(Copy.map), pos(Copy.pos), mode(Copy.mode) {
+	if(map) map->iterators.push_back(this);
+}
+CScriptVarMapIterator::~CScriptVarMapIterator() { detach(); }
+CScriptVarPtr CScriptVarMapIterator::clone() { return new CScriptVarMapIterator(*this); }
+bool CScriptVarMapIterator::isIterator() { return true; }
+void CScriptVarMapIterator::removeAllChildren() {
+	CScriptVarObject::removeAllChildren();
+	CScriptVarMapPtr keep = map; // the map can be destroyed by map.clear() - after detach
+	detach();
+	map.clear();
+}
+void CScriptVarMapIterator::getReferences(vector<CScriptVar*> &Refs) {
+	CScriptVarObject::getReferences(Refs);
+	if(map) Refs.push_back(map.getVar());
+}
+void CScriptVarMapIterator::forkReferences(CScriptVarForker &Forker) {
+	CScriptVarObject::forkReferences(Forker);
+	detach(); // the copy-constructor has added this to the iterators of the original map
+	Forker.forkPtr(map);
+	if(map) map->iterators.push_back(this);
+}
+void CScriptVarMapIterator::detach() {
+	if(!map) return;
+	vector<CScriptVarMapIterator*> &iterators = map->iterators;
+	vector<CScriptVarMapIterator*>::iterator it = std::find(iterators.begin(), iterators.end(), this);
+	if(it != iterators.end()) iterators.erase(it);
+}
+bool CScriptVarMapIterator::next(CScriptVarPtr &Key, CScriptVarPtr &Value) {
+	if(!map) return false;
+	while(pos < map->entries.size()) {
+		CScriptVarMap::Entry &entry = map->entries[pos++];
+		if(entry.key) {
+			Key = entry.key;
+			Value = entry.value ? entry.value : entry.key;
+			return true;
+		}
+	}
+	return false;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+/// Map, Set, WeakMap
+//////////////////////////////////////////////////////////////////////////
+
+static void scConstructorCalledAsFunction(const CFunctionsScopePtr &c, void *data) {
+	c->throwError(TypeError, string("calling a builtin ") + MAP_KIND_NAME[(intptr_t)data] + " constructor without new is forbidden");
+}
+
+static CScriptVarMapPtr scThis(const CFunctionsScopePtr &c, MAP_KIND Kind, const char *Fnc) {
+	CScriptVarMapPtr This(c->getArgument("this"));
+	if(!This || This->getKind() != Kind)
+		c->throwError(TypeError, string(MAP_KIND_NAME[Kind]) + ".prototype." + Fnc + " called on incompatible Object");
+	return This;
+}
+static CScriptVarPtr scKey(const CFunctionsScopePtr &c, MAP_KIND Kind, const CScriptVarPtr &Key) {
+	if(Kind == MapKindWeakMap && !Key->isObject())
+		c->throwError(TypeError, "invalid value used as weak map key");
+	if(Key->isNumber() && Key->toNumber().isNegativeZero()) return c->newScriptVar(0); // -0 is stored as +0
+	return Key;
+}
+
+/// new Map(iterable), new Set(iterable), new WeakMap(iterable) - Map & WeakMap needs [key, value] entries
+static void scMap_Constructor(const CFunctionsScopePtr &c, void *data) {
+	MAP_KIND kind = MAP_KIND((intptr_t)data);
+	CScriptVarMapPtr map = ::newScriptVarMap(c->getContext(), kind);
+	CScriptVarPtr iterable = c->getArgument(0);
+	if(!iterable->isUndefined() && !iterable->isNull()) {
+		CScriptVarPtr iterator = iterable->toIterator(2);
+		CScriptVarFunctionPtr next(iterator->findChildWithPrototypeChain("next").getter());
+		if(!next) c->throwError(TypeError, "'" + iterable->toString() + "' is not iterable");
+		CScriptVarPtr value;
+		while(c->getContext()->iteratorNext(iterator, next, value)) {
+			if(kind == MapKindSet)
+				map->set(scKey(c, kind, value), CScriptVarPtr());
+			else {
+				if(!value->isObject()) c->throwError(TypeError, "iterator value " + value->toString() + " is not an entry object");
+				map->set(scKey(c, kind, value->findChildWithPrototypeChain(0).getter()->getVarPtr()),
+					value->findChildWithPrototypeChain(1).getter()->getVarPtr());
+			}
+		}
+	}
+	c->setReturnVar(map);
+}
+
+static void scMap_prototype_size(const CFunctionsScopePtr &c, void *data) {
+	c->setReturnVar(c->newScriptVar(scThis(c, MAP_KIND((intptr_t)data), "size")->size()));
+}
+static void scMap_prototype_get(const CFunctionsScopePtr &c, void *data) {
+	CScriptVarPtr value = scThis(c, MAP_KIND((intptr_t)data), "get")->get(c->getArgument(0));
+	c->setReturnVar(value ? value : c->constScriptVar(Undefined));
+}
+static void scMap_prototype_set(const CFunctionsScopePtr &c, void *data) {
+	MAP_KIND kind = MAP_KIND((intptr_t)data);
+	CScriptVarMapPtr This = scThis(c, kind, "set");
+	This->set(scKey(c, kind, c->getArgument(0)), c->getArgument(1));
+	c->setReturnVar(This);
+}
+static void scSet_prototype_add(const CFunctionsScopePtr &c, void *data) {
+	CScriptVarMapPtr This = scThis(c, MapKindSet, "add");
+	This->set(scKey(c, MapKindSet, c->getArgument(0)), CScriptVarPtr());
+	c->setReturnVar(This);
+}
+static void scMap_prototype_has(const CFunctionsScopePtr &c, void *data) {
+	c->setReturnVar(c->constScriptVar(scThis(c, MAP_KIND((intptr_t)data), "has")->has(c->getArgument(0))));
+}
+static void scMap_prototype_delete(const CFunctionsScopePtr &c, void *data) {
+	c->setReturnVar(c->constScriptVar(scThis(c, MAP_KIND((intptr_t)data), "delete")->remove(c->getArgument(0))));
+}
+static void scMap_prototype_clear(const CFunctionsScopePtr &c, void *data) {
+	scThis(c, MAP_KIND((intptr_t)data), "clear")->clear();
+}
+/// Map: callback(value, key, map) Set: callback(value, value, set)
+static void scMap_prototype_forEach(const CFunctionsScopePtr &c, void *data) {
+	CScriptVarMapPtr This = scThis(c, MAP_KIND((intptr_t)data), "forEach");
+	CScriptVarFunctionPtr callback(c->getArgument(0));
+	if(!callback) c->throwError(TypeError, c->getArgument(0)->toString() + " is not a function");
+	CScriptVarPtr thisArg = c->getArgument(1);
+	CScriptVarMapIteratorPtr iterator = ::newScriptVarMapIterator(c->getContext(), This, 3);
+	CScriptVarPtr key, value;
+	vector<CScriptVarPtr> args(3);
+	while(iterator->next(key, value)) {
+		args[0] = value; args[1] = key; args[2] = This;
+		c->getContext()->callFunction(callback, args, thisArg);
+	}
+}
+/// keys (Mode 1), values (Mode 2) and entries (Mode 3)
+static void scMap_prototype_iterator(const CFunctionsScopePtr &c, void *data) {
+	intptr_t kindAndMode = (intptr_t)data;
+	CScriptVarMapPtr This = scThis(c, MAP_KIND(kindAndMode & 0xff), "iterator");
+	c->setReturnVar(::newScriptVarMapIterator(c->getContext(), This, int(kindAndMode >> 8)));
+}
+
+static void scMapIterator_next(const CFunctionsScopePtr &c, void *data) {
+	CScriptVarMapIteratorPtr This(c->getArgument("this"));
+	if(!This) c->throwError(TypeError, "MapIterator.prototype.next called on incompatible Object");
+	CScriptVarPtr key, value;
+	if(!This->next(key, value)) throw c->constScriptVar(StopIteration);
+	if(This->getMode() == 1)
+		c->setReturnVar(key);
+	else if(This->getMode() == 2)
+		c->setReturnVar(value);
+	else {
+		CScriptVarPtr entry = c->newScriptVar(Array);
+		entry->setArrayIndex(0, key);
+		entry->setArrayIndex(1, value);
+		c->setReturnVar(entry);
+	}
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+/// Register Functions
+//////////////////////////////////////////////////////////////////////////
+
+#define MAP_ITERATOR(KIND, MODE) (void*)(intptr_t)((KIND) | (MODE)<<8)
+
+extern "C" void _registerCollectionFunctions(CTinyJS *tinyJS) {
+	tinyJS->mapIteratorPrototype = tinyJS->newScriptVar(Object);
+	tinyJS->mapIteratorPrototype->addChild("next", ::newScriptVar(tinyJS, scMapIterator_next, 0, "MapIterator.next"), SCRIPTVARLINK_BUILDINDEFAULT);
+
+	for(int kind=MapKindMap; kind<=MapKindWeakMap; ++kind) {
+		string name = MAP_KIND_NAME[kind];
+		void *data = (void*)(intptr_t)kind;
+		CScriptVarPtr var = tinyJS->addNative("function "+name+"(iterable)", scConstructorCalledAsFunction, data, SCRIPTVARLINK_CONSTANT);
+		CScriptVarPtr prototype = mapPrototype(tinyJS, MAP_KIND(kind)) = var->findChild(TINYJS_PROTOTYPE_CLASS);
+		prototype->addChild(TINYJS_CONSTRUCTOR_VAR, var, SCRIPTVARLINK_BUILDINDEFAULT);
+		tinyJS->addNative("function "+name+".__constructor__(iterable)", scMap_Constructor, data, SCRIPTVARLINK_CONSTANT);
+		if(kind == MapKindSet)
+			tinyJS->addNative("function Set.prototype.add(value)", scSet_prototype_add, data, SCRIPTVARLINK_BUILDINDEFAULT);
+		else {
+			tinyJS->addNative("function "+name+".prototype.get(key)", scMap_prototype_get, data, SCRIPTVARLINK_BUILDINDEFAULT);
+			tinyJS->addNative("function "+name+".prototype.set(key, value)", scMap_prototype_set, data, SCRIPTVARLINK_BUILDINDEFAULT);
+		}
+		tinyJS->addNative("function "+name+".prototype.has(key)", scMap_prototype_has, data, SCRIPTVARLINK_BUILDINDEFAULT);
+		prototype->addChild("delete", ::newScriptVar(tinyJS, scMap_prototype_delete, data, (name+".delete").c_str()), SCRIPTVARLINK_BUILDINDEFAULT); // "delete" is not parsable by addNative
+		if(kind == MapKindWeakMap) continue; // a WeakMap is not enumerable
+		tinyJS->addNative("function "+name+".prototype.clear()", scMap_prototype_clear, data, SCRIPTVARLINK_BUILDINDEFAULT);
+		tinyJS->addNative("function "+name+".prototype.forEach(callback, thisArg)", scMap_prototype_forEach, data, SCRIPTVARLINK_BUILDINDEFAULT);
+		prototype->addChild("size", ::newScriptVarAccessor(tinyJS, scMap_prototype_size, data, 0, 0), 0);
+		// Set: keys() and values() are the same - the default iterator of Map is entries(), of Set values()
+		tinyJS->addNative("function "+name+".prototype.keys()", scMap_prototype_iterator, MAP_ITERATOR(kind, 1), SCRIPTVARLINK_BUILDINDEFAULT);
+		tinyJS->addNative("function "+name+".prototype.values()", scMap_prototype_iterator, MAP_ITERATOR(kind, 2), SCRIPTVARLINK_BUILDINDEFAULT);
+		tinyJS->addNative("function "+name+".prototype.entries()", scMap_prototype_iterator, MAP_ITERATOR(kind, 3), SCRIPTVARLINK_BUILDINDEFAULT);
+		tinyJS->addNative("function "+name+".prototype.__iterator__()", scMap_prototype_iterator, MAP_ITERATOR(kind, kind == MapKindSet ? 2 : 3), SCRIPTVARLINK_BUILDINDEFAULT);
+	}
+}
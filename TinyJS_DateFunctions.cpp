@@ -759,7 +759,7 @@ define_ScriptVarPtr_Type(Date);
 class CScriptVarDate : public CScriptVarObject, public CScriptTime {
 protected:
 	CScriptVarDate(CTinyJS *Context);
-	CScriptVarDate(const CScriptVarDate &Copy) : CScriptVarObject(Copy) {} ///< Copy protected -> use clone for public
+	CScriptVarDate(const CScriptVarDate &Copy) : CScriptVarObject(Copy), CScriptTime(Copy) {} ///< Copy protected -> use clone for public
 public:
 	virtual ~CScriptVarDate();
 	virtual CScriptVarPtr clone();
@@ -1020,15 +1020,15 @@ DATE_PROTOTYPE_GET(getTime)
 DATE_PROTOTYPE_GET(getTimezoneOffset)
 
 // ----------------------------------------------- Register Functions
-extern "C" void _registerDateFunctions(CTinyJS *tinyJS) {
-	CScriptVarPtr var = tinyJS->addNative("function Date(year, month, day, hour, minute, second, millisecond)", scDate, 0, SCRIPTVARLINK_CONSTANT); 
-	CScriptVarPtr datePrototype = var->findChild(TINYJS_PROTOTYPE_CLASS);
-	datePrototype->addChild("valueOf", tinyJS->objectPrototype_valueOf, SCRIPTVARLINK_BUILDINDEFAULT);
-	datePrototype->addChild("toString", tinyJS->objectPrototype_toString, SCRIPTVARLINK_BUILDINDEFAULT);
-	tinyJS->addNative("function Date.__constructor__()", scDate_Constructor, 0, SCRIPTVARLINK_CONSTANT);
+// added on first access of Date
+static void installDateFunctions(CTinyJS *tinyJS, const CScriptVarPtr &) {
 	tinyJS->addNative("function Date.UTC()", scDate_UTC, 0, SCRIPTVARLINK_CONSTANT);
 	tinyJS->addNative("function Date.now()", scDate_now, 0, SCRIPTVARLINK_CONSTANT);
 	tinyJS->addNative("function Date.parse()", scDate_parse, 0, SCRIPTVARLINK_CONSTANT);
+}
+
+// added on first access of Date.prototype
+static void installDatePrototype(CTinyJS *tinyJS, const CScriptVarPtr &) {
 #define DATE_PROTOTYPE_NATIVE(FNC) tinyJS->addNative("function Date.prototype."#FNC"()", scDate_prototype_##FNC, 0, SCRIPTVARLINK_CONSTANT)
 	DATE_PROTOTYPE_NATIVE(setDate);
 	DATE_PROTOTYPE_NATIVE(getDate);
@@ -1065,6 +1065,16 @@ extern "C" void _registerDateFunctions(CTinyJS *tinyJS) {
 	DATE_PROTOTYPE_NATIVE(setTime);
 	DATE_PROTOTYPE_NATIVE(getTime);
 	DATE_PROTOTYPE_NATIVE(getTimezoneOffset);
+#undef DATE_PROTOTYPE_NATIVE
+}
 
+extern "C" void _registerDateFunctions(CTinyJS *tinyJS) {
+	CScriptVarPtr var = tinyJS->addNative("function Date(year, month, day, hour, minute, second, millisecond)", scDate, 0, SCRIPTVARLINK_CONSTANT); 
+	CScriptVarPtr datePrototype = var->findChild(TINYJS_PROTOTYPE_CLASS);
+	datePrototype->addChild("valueOf", tinyJS->objectPrototype_valueOf, SCRIPTVARLINK_BUILDINDEFAULT);
+	datePrototype->addChild("toString", tinyJS->objectPrototype_toString, SCRIPTVARLINK_BUILDINDEFAULT);
+	tinyJS->addNative("function Date.__constructor__()", scDate_Constructor, 0, SCRIPTVARLINK_CONSTANT);
+	tinyJS->addLazyNatives(var, installDateFunctions);
+	tinyJS->addLazyNatives(datePrototype, installDatePrototype);
 }
 
@@ -116,7 +116,7 @@ static void scArrayRemove(const CFunctionsScopePtr &c, void *data) {
 		int next_insert = *remove_it++;
 		for (i=next_remove;i<l;i++) {
 
-			CScriptVarLinkPtr link = arr->findChild(int2string(i));
+			CScriptVarLinkPtr link = arr->getArrayIndexLink(i);
 			if(i == next_remove) {
 				if(link) arr->removeLink(link);
 				if(remove_it != removedIndices.end())
@@ -154,6 +154,11 @@ static void scArrayPush(const CFunctionsScopePtr &c, void *data) {
 }
 
 // ----------------------------------------------- Register Functions
+// added on first access of JSON (JSON.parse is added by CTinyJS)
+static void installJSONStringify(CTinyJS *tinyJS, const CScriptVarPtr &) {
+	tinyJS->addNative("function JSON.stringify(obj, replacer)", scJSONStringify, 0, SCRIPTVARLINK_BUILDINDEFAULT); // convert to JSON. replacer is ignored at the moment
+}
+
 void registerFunctions(CTinyJS *tinyJS) {
 }
 extern "C" void _registerFunctions(CTinyJS *tinyJS) {
@@ -162,7 +167,7 @@ extern "C" void _registerFunctions(CTinyJS *tinyJS) {
 	tinyJS->addNative("function Object.prototype.clone()", scObjectClone, 0, SCRIPTVARLINK_BUILDINDEFAULT);
 
 //	tinyJS->addNative("function Integer.valueOf(str)", scIntegerValueOf, 0, SCRIPTVARLINK_BUILDINDEFAULT); // value of a single character
-	tinyJS->addNative("function JSON.stringify(obj, replacer)", scJSONStringify, 0, SCRIPTVARLINK_BUILDINDEFAULT); // convert to JSON. replacer is ignored at the moment
+	tinyJS->addLazyNatives(tinyJS->getRoot()->findChild("JSON"), installJSONStringify);
 	tinyJS->addNative("function Array.prototype.contains(obj)", scArrayContains, 0, SCRIPTVARLINK_BUILDINDEFAULT);
 	tinyJS->addNative("function Array.prototype.remove(obj)", scArrayRemove, 0, SCRIPTVARLINK_BUILDINDEFAULT);
 	tinyJS->addNative("function Array.prototype.join(separator)", scArrayJoin, 0, SCRIPTVARLINK_BUILDINDEFAULT);
@@ -99,43 +99,43 @@ namespace
 }
 #endif
 
-#define PARAMETER_TO_NUMBER(v,n) CNumber v = c->getArgument(n)->toNumber()
-#define RETURN_NAN_IS_NAN(v) do{ if(v.isNaN()) { c->setReturnVar(c->newScriptVar(v)); return; } }while(0)
-#define RETURN_NAN_IS_NAN_OR_INFINITY(v) do{ if(v.isNaN() || v.isInfinity()) { c->setReturnVar(c->newScriptVar(v)); return; } }while(0)
-#define RETURN_INFINITY_IS_INFINITY(v) do{ if(v.isInfinity()) { c->setReturnVar(c->newScriptVar(v)); return; } }while(0)
-#define RETURN_ZERO_IS_ZERO(v) do{ if(v.isZero()) { c->setReturnVar(c->newScriptVar(v)); return; } }while(0)
-#define RETURN(a)	do{ c->setReturnVar(c->newScriptVar(a)); return; }while(0)
-#define RETURNconst(a)	c->setReturnVar(c->constScriptVar(a))
+// the natives of Math uses the fast calling-convention - the parameters are accessed by position
+#define PARAMETER_TO_NUMBER(v,n) CNumber v = (size_t(n)<Argc ? Args[n] : tinyJS->constScriptVar(Undefined))->toNumber()
+#define RETURN_NAN_IS_NAN(v) do{ if(v.isNaN()) return tinyJS->newScriptVar(v); }while(0)
+#define RETURN_NAN_IS_NAN_OR_INFINITY(v) do{ if(v.isNaN() || v.isInfinity()) return tinyJS->newScriptVar(v); }while(0)
+#define RETURN_INFINITY_IS_INFINITY(v) do{ if(v.isInfinity()) return tinyJS->newScriptVar(v); }while(0)
+#define RETURN_ZERO_IS_ZERO(v) do{ if(v.isZero()) return tinyJS->newScriptVar(v); }while(0)
+#define RETURN(a)	return tinyJS->newScriptVar(a)
+#define RETURNconst(a)	return tinyJS->constScriptVar(a)
 
 //Math.abs(x) - returns absolute of given value
-static void scMathAbs(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); 
+static CScriptVarPtr scMathAbs(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	PARAMETER_TO_NUMBER(a,0); 
 	RETURN(a.sign()<0?-a:a);
 }
 
 //Math.round(a) - returns nearest round of given value
-static void scMathRound(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a");
+static CScriptVarPtr scMathRound(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	PARAMETER_TO_NUMBER(a,0);
 	RETURN(a.round());
 }
 
 //Math.ceil(a) - returns nearest round of given value
-static void scMathCeil(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN(a); RETURN_INFINITY_IS_INFINITY(a);
+static CScriptVarPtr scMathCeil(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN(a); RETURN_INFINITY_IS_INFINITY(a);
 	RETURN(a.ceil());
 }
 
 //Math.floor(a) - returns nearest round of given value
-static void scMathFloor(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); 
+static CScriptVarPtr scMathFloor(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	PARAMETER_TO_NUMBER(a,0); 
 	RETURN(a.floor());
 }
 
 //Math.min(a,b) - returns minimum of two given values 
-static void scMathMin(const CFunctionsScopePtr &c, void *userdata) {
-	int length = c->getArgumentsLength();
+static CScriptVarPtr scMathMin(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
 	CNumber ret(InfinityPositive);
-	for(int i=0; i<length; i++)
+	for(size_t i=0; i<Argc; i++)
 	{
 		PARAMETER_TO_NUMBER(a,i); RETURN_NAN_IS_NAN(a);
 		if(ret>a) ret=a;
@@ -144,10 +144,9 @@ static void scMathMin(const CFunctionsScopePtr &c, void *userdata) {
 }
 
 //Math.max(a,b) - returns maximum of two given values  
-static void scMathMax(const CFunctionsScopePtr &c, void *userdata) {
-	int length = c->getArgumentsLength();
+static CScriptVarPtr scMathMax(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
 	CNumber ret(InfinityNegative);
-	for(int i=0; i<length; i++)
+	for(size_t i=0; i<Argc; i++)
 	{
 		PARAMETER_TO_NUMBER(a,i); RETURN_NAN_IS_NAN(a);
 		if(ret<a) ret=a;
@@ -156,10 +155,10 @@ static void scMathMax(const CFunctionsScopePtr &c, void *userdata) {
 }
 
 //Math.range(x,a,b) - returns value limited between two given values  
-static void scMathRange(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(x,"x"); RETURN_NAN_IS_NAN(x); 
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN(a); 
-	PARAMETER_TO_NUMBER(b,"b"); RETURN_NAN_IS_NAN(b);
+static CScriptVarPtr scMathRange(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	PARAMETER_TO_NUMBER(x,0); RETURN_NAN_IS_NAN(x); 
+	PARAMETER_TO_NUMBER(a,1); RETURN_NAN_IS_NAN(a); 
+	PARAMETER_TO_NUMBER(b,2); RETURN_NAN_IS_NAN(b);
 
 	if(a>b) RETURNconst(NaN);
 	if(x<a) RETURN(a);
@@ -168,11 +167,11 @@ static void scMathRange(const CFunctionsScopePtr &c, void *userdata) {
 }
 
 //Math.sign(a) - returns sign of given value (-1==negative,0=zero,1=positive)
-static void scMathSign(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN(a); 
+static CScriptVarPtr scMathSign(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN(a); 
 	RETURN(a.isZero() ? 0 : a.sign());
 }
-static void scMathRandom(const CFunctionsScopePtr &c, void *) {
+static CScriptVarPtr scMathRandom(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
 	static int inited=0;
 	if(!inited) {
 		inited = 1;
@@ -182,63 +181,63 @@ static void scMathRandom(const CFunctionsScopePtr &c, void *) {
 }
 
 //Math.toDegrees(a) - returns degree value of a given angle in radians
-static void scMathToDegrees(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN(a); RETURN_INFINITY_IS_INFINITY(a); 
+static CScriptVarPtr scMathToDegrees(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN(a); RETURN_INFINITY_IS_INFINITY(a); 
 	RETURN( (180.0/k_PI)*a );
 }
 
 //Math.toRadians(a) - returns radians value of a given angle in degrees
-static void scMathToRadians(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN(a); RETURN_INFINITY_IS_INFINITY(a); 
+static CScriptVarPtr scMathToRadians(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN(a); RETURN_INFINITY_IS_INFINITY(a); 
 	RETURN( (k_PI/180.0)*a );
 }
 
 //Math.sin(a) - returns trig. sine of given angle in radians
-static void scMathSin(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN_OR_INFINITY(a); RETURN_ZERO_IS_ZERO(a);
+static CScriptVarPtr scMathSin(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN_OR_INFINITY(a); RETURN_ZERO_IS_ZERO(a);
 	RETURN( sin(a.toDouble()) );
 }
 
 //Math.asin(a) - returns trig. arcsine of given angle in radians
-static void scMathASin(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN(a); RETURN_ZERO_IS_ZERO(a);
+static CScriptVarPtr scMathASin(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN(a); RETURN_ZERO_IS_ZERO(a);
 	if(abs(a)>1) RETURNconst(NaN);
 	RETURN( asin(a.toDouble()) );
 }
 
 //Math.cos(a) - returns trig. cosine of given angle in radians
-static void scMathCos(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN_OR_INFINITY(a); 
+static CScriptVarPtr scMathCos(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN_OR_INFINITY(a); 
 	if(a.isZero()) RETURN(1);
 	RETURN( cos(a.toDouble()) );
 }
 
 //Math.acos(a) - returns trig. arccosine of given angle in radians
-static void scMathACos(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN_OR_INFINITY(a); 
+static CScriptVarPtr scMathACos(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN_OR_INFINITY(a); 
 	if(abs(a)>1) RETURNconst(NaN);
 	else if(a==1) RETURN(0);
 	RETURN( acos(a.toDouble()) );
 }
 
 //Math.tan(a) - returns trig. tangent of given angle in radians
-static void scMathTan(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN_OR_INFINITY(a); RETURN_ZERO_IS_ZERO(a);
+static CScriptVarPtr scMathTan(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN_OR_INFINITY(a); RETURN_ZERO_IS_ZERO(a);
 	RETURN( tan(a.toDouble()) );
 }
 
 //Math.atan(a) - returns trig. arctangent of given angle in radians
-static void scMathATan(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN(a); RETURN_ZERO_IS_ZERO(a);
+static CScriptVarPtr scMathATan(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN(a); RETURN_ZERO_IS_ZERO(a);
 	int infinity=a.isInfinity();
 	if(infinity) RETURN(k_PI/(infinity*2));
 	RETURN( atan(a.toDouble()) );
 }
 
 //Math.atan2(a,b) - returns trig. arctangent of given angle in radians
-static void scMathATan2(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN(a);
-	PARAMETER_TO_NUMBER(b,"b"); RETURN_NAN_IS_NAN(b);
+static CScriptVarPtr scMathATan2(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN(a);
+	PARAMETER_TO_NUMBER(b,1); RETURN_NAN_IS_NAN(b);
 	int sign_a = a.sign();
 	int sign_b = b.sign();
 	if(a.isZero())
@@ -260,47 +259,47 @@ static void scMathATan2(const CFunctionsScopePtr &c, void *userdata) {
 
 
 //Math.sinh(a) - returns trig. hyperbolic sine of given angle in radians
-static void scMathSinh(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN(a); 
+static CScriptVarPtr scMathSinh(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN(a); 
 	RETURN_ZERO_IS_ZERO(a);
 	if(abs(a)>1) RETURNconst(NaN);
 	RETURN( sinh(a.toDouble()) );
 }
 
 //Math.asinh(a) - returns trig. hyperbolic arcsine of given angle in radians
-static void scMathASinh(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN(a); 
+static CScriptVarPtr scMathASinh(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN(a); 
 	RETURN_INFINITY_IS_INFINITY(a);
 	RETURN_ZERO_IS_ZERO(a);
 	RETURN( asinh(a.toDouble()) );
 }
 
 //Math.cosh(a) - returns trig. hyperbolic cosine of given angle in radians
-static void scMathCosh(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN(a); 
+static CScriptVarPtr scMathCosh(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN(a); 
 	if(a.isInfinity()) RETURNconst(InfinityPositive);
 	RETURN( cosh(a.toDouble()) );
 }
 
 //Math.acosh(a) - returns trig. hyperbolic arccosine of given angle in radians
-static void scMathACosh(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN(a); 
+static CScriptVarPtr scMathACosh(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN(a); 
 	RETURN_INFINITY_IS_INFINITY(a);
 	if(abs(a)<1) RETURNconst(NaN);
 	RETURN( acosh(a.toDouble()) );
 }
 
 //Math.tanh(a) - returns trig. hyperbolic tangent of given angle in radians
-static void scMathTanh(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN(a); 
+static CScriptVarPtr scMathTanh(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN(a); 
 	RETURN_ZERO_IS_ZERO(a);
 	if(a.isInfinity()) RETURN(a.sign());
 	RETURN( tanh(a.toDouble()) );
 }
 
 //Math.atanh(a) - returns trig. hyperbolic arctangent of given angle in radians
-static void scMathATanh(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN(a); 
+static CScriptVarPtr scMathATanh(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN(a); 
 	RETURN_ZERO_IS_ZERO(a);
 	CNumber abs_a = abs(a);
 	if(abs_a > 1) RETURNconst(NaN);
@@ -309,8 +308,8 @@ static void scMathATanh(const CFunctionsScopePtr &c, void *userdata) {
 }
 
 //Math.log(a) - returns natural logaritm (base E) of given value
-static void scMathLog(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN(a); 
+static CScriptVarPtr scMathLog(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN(a); 
 	if(a.isZero()) RETURNconst(InfinityNegative);
 	if(a.sign()<0) RETURNconst(NaN);
 	if(a.isInfinity()) RETURNconst(InfinityPositive);
@@ -318,8 +317,8 @@ static void scMathLog(const CFunctionsScopePtr &c, void *userdata) {
 }
 
 //Math.log10(a) - returns logaritm(base 10) of given value
-static void scMathLog10(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN(a); 
+static CScriptVarPtr scMathLog10(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN(a); 
 	if(a.isZero()) RETURNconst(InfinityNegative);
 	if(a.sign()<0) RETURNconst(NaN);
 	if(a.isInfinity()) RETURNconst(InfinityPositive);
@@ -327,8 +326,8 @@ static void scMathLog10(const CFunctionsScopePtr &c, void *userdata) {
 }
 
 //Math.exp(a) - returns e raised to the power of a given number
-static void scMathExp(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN(a);
+static CScriptVarPtr scMathExp(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN(a);
 	if(a.isZero()) RETURN(1);
 	int a_i = a.isInfinity();
 	if(a_i>0) RETURNconst(InfinityPositive);
@@ -337,9 +336,9 @@ static void scMathExp(const CFunctionsScopePtr &c, void *userdata) {
 }
 
 //Math.pow(a,b) - returns the result of a number raised to a power (a)^(b)
-static void scMathPow(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a");
-	PARAMETER_TO_NUMBER(b,"b"); RETURN_NAN_IS_NAN(b); 
+static CScriptVarPtr scMathPow(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	PARAMETER_TO_NUMBER(a,0);
+	PARAMETER_TO_NUMBER(b,1); RETURN_NAN_IS_NAN(b); 
 	if(b.isZero()) RETURN(1);
 	RETURN_NAN_IS_NAN(a);
 	if(b==1) RETURN(a);
@@ -371,26 +370,41 @@ static void scMathPow(const CFunctionsScopePtr &c, void *userdata) {
 }
 
 //Math.sqr(a) - returns square of given value
-static void scMathSqr(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a");
+static CScriptVarPtr scMathSqr(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	PARAMETER_TO_NUMBER(a,0);
 	RETURN( a*a );
 }
 
 //Math.sqrt(a) - returns square root of given value
-static void scMathSqrt(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN(a); 
+static CScriptVarPtr scMathSqrt(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN(a); 
 	RETURN_ZERO_IS_ZERO(a);
 	if(a.sign()<0) RETURNconst(NaN);
 	RETURN_INFINITY_IS_INFINITY(a); 
 	RETURN( sqrt(a.toDouble()) );
 }
 
-// ----------------------------------------------- Register Functions
-void registerMathFunctions(CTinyJS *tinyJS) {}
-extern "C" void _registerMathFunctions(CTinyJS *tinyJS) {
+// the following natives are plain C++-functions bound with CTinyJS::bindNative
+
+//Math.trunc(a) - returns the integral part of given value
+static double mathTrunc(double a) { return a<0 ? ceil(a) : floor(a); }
 
-	 CScriptVarPtr Math = tinyJS->getRoot()->addChild("Math", tinyJS->newScriptVar(Object), SCRIPTVARLINK_CONSTANT);
+//Math.fround(a) - returns the nearest single precision float of given value
+static float mathFround(float a) { return a; }
+
+//Math.imul(a,b) - returns the 32-bit multiplication of a and b
+static int32_t mathImul(int32_t a, int32_t b) { return int32_t(uint32_t(a) * uint32_t(b)); }
+
+//Math.clz32(a) - returns the number of leading zero bits in the 32-bit representation of given value
+static int32_t mathClz32(uint32_t a) {
+	int32_t n = 32;
+	for(; a; a>>=1) --n;
+	return n;
+}
 
+// ----------------------------------------------- Register Functions
+// the natives and constants of Math are added on first access
+static void installMathFunctions(CTinyJS *tinyJS, const CScriptVarPtr &Math) {
 	 // --- Math and Trigonometry functions ---
 	 tinyJS->addNative("function Math.abs(a)", scMathAbs, 0, SCRIPTVARLINK_BUILDINDEFAULT);
 	 tinyJS->addNative("function Math.round(a)", scMathRound, 0, SCRIPTVARLINK_BUILDINDEFAULT);
@@ -437,5 +451,15 @@ extern "C" void _registerMathFunctions(CTinyJS *tinyJS) {
 	 
 	 tinyJS->addNative("function Math.sqr(a)", scMathSqr, 0, SCRIPTVARLINK_BUILDINDEFAULT);
 	 tinyJS->addNative("function Math.sqrt(a)", scMathSqrt, 0, SCRIPTVARLINK_BUILDINDEFAULT);    
+
+	 tinyJS->bindNative(Math, "trunc", mathTrunc);
+	 tinyJS->bindNative(Math, "fround", mathFround);
+	 tinyJS->bindNative(Math, "imul", mathImul);
+	 tinyJS->bindNative(Math, "clz32", mathClz32);
+}
+
+void registerMathFunctions(CTinyJS *tinyJS) {}
+extern "C" void _registerMathFunctions(CTinyJS *tinyJS) {
+	 tinyJS->addLazyNatives(tinyJS->getRoot()->addChild("Math", tinyJS->newScriptVar(Object), SCRIPTVARLINK_CONSTANT), installMathFunctions);
   
 }
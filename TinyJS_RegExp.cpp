@@ -0,0 +1,1088 @@
+/*
+ * 42TinyJS
+ *
+ * A fork of TinyJS with the goal to makes a more JavaScript/ECMA compliant engine
+ *
+ * Authored By Armin Diedering <armin@diedering.de>
+ *
+ * Copyright (C) 2010-2015 ardisoft
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "TinyJS_RegExp.h"
+#include "TinyJS_Threading.h"
+
+#ifndef NO_REGEXP
+
+#include <cstring>
+#include <climits>
+#include <algorithm>
+#include <stdint.h>
+
+using namespace std;
+
+//////////////////////////////////////////////////////////////////////////
+/// CScriptRegexMatch
+//////////////////////////////////////////////////////////////////////////
+
+string CScriptRegexMatch::format(const string &Replacement) const {
+	string ret;
+	string::size_type last = 0, pos;
+	while((pos = Replacement.find('$', last)) != string::npos) {
+		ret.append(Replacement, last, pos-last);
+		last = pos+1;
+		if(last >= Replacement.size()) {
+			ret.append(1, '$');
+			break;
+		}
+		char c = Replacement[last];
+		if(c == '$') {
+			ret.append(1, '$'); last++;
+		} else if(c == '&') {
+			ret.append(*input, position(), length()); last++;
+		} else if(c == '`') {
+			ret.append(*input, 0, position()); last++;
+		} else if(c == '\'') {
+			ret.append(*input, end(), string::npos); last++;
+		} else if(c >= '0' && c <= '9') {
+			size_t group = c-'0', len = 1;
+			if(last+1 < Replacement.size() && Replacement[last+1] >= '0' && Replacement[last+1] <= '9') {
+				size_t group2 = group*10 + Replacement[last+1]-'0';
+				if(group2 >= 1 && group2 < size()) { group = group2; len = 2; }
+			}
+			if(group >= 1 && group < size()) {
+				if(matched(group)) ret.append(*input, position(group), length(group));
+				last += len;
+			} else
+				ret.append(1, '$');
+		} else
+			ret.append(1, '$');
+	}
+	ret.append(Replacement, last, string::npos);
+	return ret;
+}
+
+#ifdef HAVE_NATIVE_REGEX
+
+//////////////////////////////////////////////////////////////////////////
+/// native regex-engine
+//////////////////////////////////////////////////////////////////////////
+
+#define REGEX_MAX_PROGRAM_SIZE 100000 ///< max. number of instructions (counted repetitions are expanded)
+#define REGEX_INFINITE -1
+
+enum REGEX_OPCODES {
+	RX_CHAR,		///< c or c2 (the other case with ignoreCase)
+	RX_ANY,			///< any char except line-terminators
+	RX_CLASS,		///< x = index of the class
+	RX_MATCH,
+	RX_JMP,			///< x = target
+	RX_SPLIT,		///< x = preferred target, y = other target
+	RX_SAVE,		///< x = slot - saves the position (captures and loop-marks)
+	RX_CHECK,		///< x = slot - fails if the position is not moved since RX_SAVE (empty loop-iteration)
+	RX_RESET,		///< x = first slot, y = number of slots - unsets the captures of a group at the begin of each iteration
+	RX_BOL,
+	RX_EOL,
+	RX_WORDB,
+	RX_NWORDB,
+	RX_BACKREF,		///< x = group
+	RX_LOOK,		///< x = instruction behind RX_LOOKEND - neg for (?!...)
+	RX_LOOKEND
+};
+
+static inline bool regexIsLineTerminator(unsigned char c) { return c=='\n' || c=='\r'; }
+static inline bool regexIsWordChar(unsigned char c) { return (c>='a' && c<='z') || (c>='A' && c<='Z') || (c>='0' && c<='9') || c=='_'; }
+static inline unsigned char regexToLower(unsigned char c) { return (c>='A' && c<='Z') ? c+('a'-'A') : c; }
+static inline unsigned char regexToUpper(unsigned char c) { return (c>='a' && c<='z') ? c-('a'-'A') : c; }
+
+/// a set of chars (bytes)
+struct CScriptRegexClass {
+	CScriptRegexClass() { memset(bits, 0, sizeof(bits)); }
+	bool has(unsigned char c) const { return (bits[c>>5] >> (c&31)) & 1; }
+	void add(unsigned char c) { bits[c>>5] |= 1u << (c&31); }
+	void add(unsigned char From, unsigned char To) { for(unsigned int c=From; c<=To; c++) add((unsigned char)c); }
+	void add(const CScriptRegexClass &Class) { for(int i=0; i<8; i++) bits[i] |= Class.bits[i]; }
+	void invert() { for(int i=0; i<8; i++) bits[i] = ~bits[i]; }
+	void addOtherCase() { for(unsigned int c='a'; c<='z'; c++) if(has(c) || has(regexToUpper(c))) { add(c); add(regexToUpper(c)); } }
+	uint32_t bits[8];
+};
+
+struct CScriptRegexInst {
+	CScriptRegexInst(int Op, int X=0, int Y=0) : op(Op), c(0), c2(0), neg(false), x(X), y(Y) {}
+	int op;
+	unsigned char c, c2;
+	bool neg;
+	int x, y;
+};
+
+struct CScriptRegexThreads {
+	std::vector<int> pcs;
+	std::vector<size_t> slots; ///< slotCount slots per thread
+	void clear() { pcs.clear(); slots.clear(); }
+};
+
+/// scratch of the Pike-VM - each CScriptRegex has its own, so the programs are never changed after compiling
+struct CScriptRegexScratch {
+	CScriptRegexScratch() : generation(0), sub(0) {}
+	~CScriptRegexScratch() { delete sub; }
+	std::vector<uint32_t> onList;
+	uint32_t generation;
+	std::vector<std::pair<int, uint32_t> > visited; ///< instructions visited in a loop-state other than 0 (see loopMarks)
+	CScriptRegexThreads lists[2];
+	std::vector<size_t> work;
+	std::vector<size_t> saved; ///< the slots unset by RX_RESET - restored on return from addThread
+	CScriptRegexScratch *sub; ///< for the sub-matches of lookaheads - created on first use
+	void nextGeneration() {
+		visited.clear();
+		if(++generation == 0) { // overflow
+			onList.assign(onList.size(), 0);
+			generation = 1;
+		}
+	}
+private:
+	CScriptRegexScratch(const CScriptRegexScratch &);
+	CScriptRegexScratch &operator=(const CScriptRegexScratch &);
+};
+
+/// a compiled program - shared by the copies of a CScriptRegex (also by copies in other threads)
+struct CScriptRegexProgram {
+	CScriptRegexProgram() : refs(1), groups(0), slotCount(2), ignoreCase(false), multiline(false), backtrack(false),
+		anchored(false), useFirst(false) {}
+	CScriptAtomicCounter refs;
+	std::vector<CScriptRegexInst> code;
+	std::vector<CScriptRegexClass> classes;
+	size_t groups;
+	size_t slotCount; ///< 2 per group (incl. group 0) + the loop-marks
+	bool ignoreCase;
+	bool multiline;
+	bool backtrack; ///< has back-references -> runs on the backtracking-VM
+	/// the marks of the loops with a nullable body around each instruction (empty if there is no such loop).
+	/// Whether a mark is at the current position decides the empty-iteration checks ahead, so it is a part
+	/// of the state of a thread - a loop re-entered at the same position is not merged with the running one
+	std::vector<std::vector<int> > loopMarks;
+
+	// prefilter
+	bool anchored; ///< starts with ^ (not multiline) - can only match at 0
+	std::string prefix; ///< each match starts with prefix
+	bool useFirst;
+	CScriptRegexClass first; ///< each match starts with one of this chars
+
+	void analyze();
+	size_t nextCandidate(const string &Input, size_t Pos);
+	bool atBol(const string &Input, size_t Pos) { return Pos==0 || (multiline && regexIsLineTerminator(Input[Pos-1])); }
+	bool atEol(const string &Input, size_t Pos) { return Pos==Input.size() || (multiline && regexIsLineTerminator(Input[Pos])); }
+	bool atWordBoundary(const string &Input, size_t Pos) {
+		return (Pos>0 && regexIsWordChar(Input[Pos-1])) != (Pos<Input.size() && regexIsWordChar(Input[Pos]));
+	}
+	bool step(const CScriptRegexInst &Inst, const string &Input, size_t Pos) {
+		if(Pos >= Input.size()) return false;
+		unsigned char c = Input[Pos];
+		switch(Inst.op) {
+		case RX_CHAR: return c == Inst.c || c == Inst.c2;
+		case RX_ANY: return !regexIsLineTerminator(c);
+		case RX_CLASS: return classes[Inst.x].has(c);
+		}
+		return false;
+	}
+	void addThread(CScriptRegexScratch &S, CScriptRegexThreads &List, int Pc, const string &Input, size_t Pos);
+	bool runPike(CScriptRegexScratch &S, const string &Input, size_t Start, bool Sticky, std::vector<size_t> &Slots, int Pc=0, const std::vector<size_t> *Init=0);
+	bool runBacktrack(const string &Input, int Pc, size_t Pos, std::vector<size_t> &Slots, size_t &Steps);
+	bool backtrackSearch(const string &Input, size_t Start, bool Sticky, std::vector<size_t> &Slots);
+};
+
+//////////////////////////////////////////////////////////////////////////
+/// compiler
+
+struct CScriptRegexNode {
+	enum TYPE { CHAR, ANY, CLASS, EMPTY, BOL, EOL, WORDB, NWORDB, BACKREF, GROUP, LOOK, CAT, ALT, REPEAT };
+	CScriptRegexNode(TYPE Type) : type(Type), c(0), c2(0), index(-1), min(0), max(0), greedy(true), neg(false) {}
+	TYPE type;
+	unsigned char c, c2;
+	int index; ///< class-index, group (-1 non-capturing) or back-reference
+	int min, max;
+	bool greedy, neg;
+	std::vector<int> kids;
+};
+
+class CScriptRegexCompiler {
+public:
+	CScriptRegexCompiler(const string &Source, bool IgnoreCase, bool Multiline) :
+		src(Source), pos(0), ignoreCase(IgnoreCase), multiline(Multiline), totalGroups(0), nextGroup(0), program(0) {}
+	CScriptRegexProgram *compile();
+private:
+	const string &src;
+	size_t pos;
+	bool ignoreCase, multiline;
+	int totalGroups, nextGroup;
+	std::vector<CScriptRegexNode> nodes;
+	std::vector<int> markRanges; ///< save-pc, check-pc and slot of each empty-iteration check
+	CScriptRegexProgram *program;
+
+	void error(const string &What) { throw CScriptRegexError("invalid regular expression: " + What); }
+	int node(CScriptRegexNode::TYPE Type) { nodes.push_back(CScriptRegexNode(Type)); return int(nodes.size()-1); }
+	int charNode(unsigned char c);
+	int classNode(const CScriptRegexClass &Class);
+	void countGroups();
+	int parseAlternative();
+	int parseSequence();
+	int parseAtom();
+	int parseQuantifier(int Atom);
+	bool parseNumber(int &Number);
+	int parseCharEscape(CScriptRegexClass *Class);
+	int parseClass();
+	bool nullable(int Node);
+	void groupRange(int Node, int &First, int &Last);
+	int emit(int Op, int X=0, int Y=0);
+	void emitIteration(int Kid, int First, int Last);
+	void addMarkRange(int Save, int Check, int Mark) { markRanges.push_back(Save); markRanges.push_back(Check); markRanges.push_back(Mark); }
+	void emitNode(int Node);
+};
+
+int CScriptRegexCompiler::charNode(unsigned char c) {
+	int n = node(CScriptRegexNode::CHAR);
+	nodes[n].c = nodes[n].c2 = c;
+	if(ignoreCase) { nodes[n].c = regexToLower(c); nodes[n].c2 = regexToUpper(c); }
+	return n;
+}
+int CScriptRegexCompiler::classNode(const CScriptRegexClass &Class) {
+	int n = node(CScriptRegexNode::CLASS);
+	nodes[n].index = int(program->classes.size());
+	program->classes.push_back(Class);
+	if(ignoreCase) program->classes.back().addOtherCase();
+	return n;
+}
+
+// the number of capturing groups is needed to detect back-references
+void CScriptRegexCompiler::countGroups() {
+	bool inClass = false;
+	for(size_t i=0; i<src.size(); ++i) {
+		if(src[i] == '\\') ++i;
+		else if(inClass) inClass = src[i] != ']';
+		else if(src[i] == '[') inClass = true;
+		else if(src[i] == '(' && (i+1 >= src.size() || src[i+1] != '?')) ++totalGroups;
+	}
+}
+
+int CScriptRegexCompiler::parseAlternative() {
+	int first = parseSequence();
+	if(pos >= src.size() || src[pos] != '|') return first;
+	int alt = node(CScriptRegexNode::ALT);
+	nodes[alt].kids.push_back(first);
+	while(pos < src.size() && src[pos] == '|') {
+		++pos;
+		int next = parseSequence();
+		nodes[alt].kids.push_back(next);
+	}
+	return alt;
+}
+
+int CScriptRegexCompiler::parseSequence() {
+	int cat = node(CScriptRegexNode::CAT);
+	while(pos < src.size() && src[pos] != '|' && src[pos] != ')') {
+		int atom = parseQuantifier(parseAtom());
+		nodes[cat].kids.push_back(atom);
+	}
+	return cat;
+}
+
+int CScriptRegexCompiler::parseAtom() {
+	char c = src[pos++];
+	switch(c) {
+	case '^': return node(CScriptRegexNode::BOL);
+	case '$': return node(CScriptRegexNode::EOL);
+	case '.': return node(CScriptRegexNode::ANY);
+	case '[': return parseClass();
+	case '*': case '+': case '?':
+		error("nothing to repeat"); // throws
+	case '{': {
+		size_t start = --pos;
+		parseQuantifier(-1); // a valid quantifier throws "nothing to repeat"
+		pos = start+1;
+		return charNode('{');
+	}
+	case '(': {
+		int group;
+		if(pos < src.size() && src[pos] == '?') {
+			char k = pos+1 < src.size() ? src[pos+1] : 0;
+			if(k == ':') {
+				group = node(CScriptRegexNode::GROUP);
+			} else if(k == '=' || k == '!') {
+				group = node(CScriptRegexNode::LOOK);
+				nodes[group].neg = k == '!';
+			} else
+				error("invalid group");
+			pos += 2;
+		} else {
+			group = node(CScriptRegexNode::GROUP);
+			nodes[group].index = ++nextGroup;
+		}
+		int body = parseAlternative();
+		if(pos >= src.size() || src[pos] != ')') error("missing )");
+		++pos;
+		nodes[group].kids.push_back(body);
+		return group;
+	}
+	case '\\': {
+		if(pos >= src.size()) error("\\ at end of pattern");
+		c = src[pos];
+		if(c == 'b' || c == 'B') {
+			++pos;
+			return node(c == 'b' ? CScriptRegexNode::WORDB : CScriptRegexNode::NWORDB);
+		}
+		if(c >= '1' && c <= '9') {
+			int group;
+			parseNumber(group);
+			if(group > totalGroups) error("invalid back reference");
+			int n = node(CScriptRegexNode::BACKREF);
+			nodes[n].index = group;
+			return n;
+		}
+		CScriptRegexClass Class;
+		int ch = parseCharEscape(&Class);
+		if(ch < 0) return classNode(Class);
+		if(ch < 256) return charNode((unsigned char)ch);
+		// \uXXXX beyond latin-1 -> utf-8 sequence
+		int cat = node(CScriptRegexNode::CAT);
+		char utf8[4]; int len;
+		if(ch < 0x800) { utf8[0] = char(0xC0|(ch>>6)); utf8[1] = char(0x80|(ch&0x3F)); len = 2; }
+		else { utf8[0] = char(0xE0|(ch>>12)); utf8[1] = char(0x80|((ch>>6)&0x3F)); utf8[2] = char(0x80|(ch&0x3F)); len = 3; }
+		for(int i=0; i<len; i++) {
+			int n = charNode((unsigned char)utf8[i]);
+			nodes[cat].kids.push_back(n);
+		}
+		return cat;
+	}
+	case ')':
+		error("unmatched )");
+	}
+	return charNode((unsigned char)c);
+}
+
+bool CScriptRegexCompiler::parseNumber(int &Number) {
+	if(pos >= src.size() || src[pos] < '0' || src[pos] > '9') return false;
+	Number = 0;
+	while(pos < src.size() && src[pos] >= '0' && src[pos] <= '9') {
+		if(Number < 1000000) Number = Number*10 + src[pos]-'0';
+		++pos;
+	}
+	return true;
+}
+
+int CScriptRegexCompiler::parseQuantifier(int Atom) {
+	if(pos >= src.size()) return Atom;
+	int min, max;
+	size_t start = pos;
+	switch(src[pos]) {
+	case '*': min = 0; max = REGEX_INFINITE; ++pos; break;
+	case '+': min = 1; max = REGEX_INFINITE; ++pos; break;
+	case '?': min = 0; max = 1; ++pos; break;
+	case '{':
+		++pos;
+		if(!parseNumber(min)) { pos = start; return Atom; } // not a quantifier -> '{' is a literal
+		max = min;
+		if(pos < src.size() && src[pos] == ',') {
+			++pos;
+			if(!parseNumber(max)) max = REGEX_INFINITE;
+		}
+		if(pos >= src.size() || src[pos] != '}') { pos = start; return Atom; }
+		++pos;
+		if(max != REGEX_INFINITE && max < min) error("numbers out of order in {} quantifier");
+		break;
+	default:
+		return Atom;
+	}
+	if(Atom < 0) error("nothing to repeat");
+	CScriptRegexNode::TYPE type = nodes[Atom].type;
+	if(type == CScriptRegexNode::BOL || type == CScriptRegexNode::EOL || type == CScriptRegexNode::WORDB || type == CScriptRegexNode::NWORDB)
+		error("nothing to repeat");
+	int repeat = node(CScriptRegexNode::REPEAT);
+	nodes[repeat].min = min;
+	nodes[repeat].max = max;
+	if(pos < src.size() && src[pos] == '?') {
+		nodes[repeat].greedy = false;
+		++pos;
+	}
+	nodes[repeat].kids.push_back(Atom);
+	return repeat;
+}
+
+static int regexHexValue(char c) {
+	if(c >= '0' && c <= '9') return c-'0';
+	if(c >= 'a' && c <= 'f') return c-'a'+10;
+	if(c >= 'A' && c <= 'F') return c-'A'+10;
+	return -1;
+}
+
+// returns the char or -1 if a class-escape (\d \D \w \W \s \S) is added to Class
+int CScriptRegexCompiler::parseCharEscape(CScriptRegexClass *Class) {
+	if(pos >= src.size()) error("\\ at end of pattern");
+	char c = src[pos++];
+	CScriptRegexClass escape;
+	switch(c) {
+	case 'd': case 'D':
+		escape.add('0', '9');
+		break;
+	case 'w': case 'W':
+		escape.add('a', 'z'); escape.add('A', 'Z'); escape.add('0', '9'); escape.add('_');
+		break;
+	case 's': case 'S':
+		escape.add(' '); escape.add('\t', '\r'); escape.add(0xA0);
+		break;
+	case 'n': return '\n';
+	case 'r': return '\r';
+	case 't': return '\t';
+	case 'v': return '\v';
+	case 'f': return '\f';
+	case '0': {
+		int value = 0;
+		for(int i=0; i<2 && pos < src.size() && src[pos] >= '0' && src[pos] <= '7'; i++) // legacy octal
+			value = value*8 + src[pos++]-'0';
+		return value;
+	}
+	case 'x': case 'u': {
+		int len = c == 'x' ? 2 : 4, value = 0;
+		if(pos+len > src.size()) return c;
+		for(int i=0; i<len; i++) {
+			int digit = regexHexValue(src[pos+i]);
+			if(digit < 0) return c;
+			value = value*16 + digit;
+		}
+		pos += len;
+		return value;
+	}
+	case 'c':
+		if(pos < src.size() && ((src[pos] >= 'a' && src[pos] <= 'z') || (src[pos] >= 'A' && src[pos] <= 'Z')))
+			return src[pos++] % 32;
+		return c;
+	default:
+		return (unsigned char)c;
+	}
+	if(c >= 'A' && c <= 'Z') escape.invert();
+	Class->add(escape);
+	return -1;
+}
+
+int CScriptRegexCompiler::parseClass() {
+	CScriptRegexClass Class;
+	bool negate = pos < src.size() && src[pos] == '^';
+	if(negate) ++pos;
+	for(;;) {
+		if(pos >= src.size()) error("missing ]");
+		if(src[pos] == ']') { ++pos; break; }
+		int from;
+		if(src[pos] == '\\') {
+			++pos;
+			if(pos < src.size() && src[pos] == 'b') { ++pos; from = '\b'; }
+			else from = parseCharEscape(&Class);
+		} else
+			from = (unsigned char)src[pos++];
+		if(from > 255) error("character beyond \\u00FF in a character class");
+		if(from < 0) continue;
+		if(pos+1 < src.size() && src[pos] == '-' && src[pos+1] != ']') {
+			++pos;
+			int to;
+			if(src[pos] == '\\') {
+				++pos;
+				if(pos < src.size() && src[pos] == 'b') { ++pos; to = '\b'; }
+				else to = parseCharEscape(&Class);
+			} else
+				to = (unsigned char)src[pos++];
+			if(to > 255) error("character beyond \\u00FF in a character class");
+			if(to < 0) { // e.g. [a-\d] -> 'a', '-' and the digits
+				Class.add((unsigned char)from);
+				Class.add('-');
+				continue;
+			}
+			if(to < from) error("range out of order in character class");
+			Class.add((unsigned char)from, (unsigned char)to);
+		} else
+			Class.add((unsigned char)from);
+	}
+	if(negate) {
+		if(ignoreCase) Class.addOtherCase(); // [^a] with /i excludes 'A' too - fold before inverting
+		Class.invert();
+	}
+	return classNode(Class);
+}
+
+bool CScriptRegexCompiler::nullable(int Node) {
+	const CScriptRegexNode &n = nodes[Node];
+	switch(n.type) {
+	case CScriptRegexNode::CHAR:
+	case CScriptRegexNode::ANY:
+	case CScriptRegexNode::CLASS:
+		return false;
+	case CScriptRegexNode::CAT:
+		for(size_t i=0; i<n.kids.size(); i++) if(!nullable(n.kids[i])) return false;
+		return true;
+	case CScriptRegexNode::ALT:
+		for(size_t i=0; i<n.kids.size(); i++) if(nullable(n.kids[i])) return true;
+		return false;
+	case CScriptRegexNode::GROUP:
+		return nullable(n.kids[0]);
+	case CScriptRegexNode::REPEAT:
+		return n.min == 0 || nullable(n.kids[0]);
+	default:
+		return true;
+	}
+}
+
+// the first and the last capturing group in Node - First > Last if there is none
+void CScriptRegexCompiler::groupRange(int Node, int &First, int &Last) {
+	const CScriptRegexNode &n = nodes[Node];
+	if(n.type == CScriptRegexNode::GROUP && n.index >= 0) {
+		if(n.index < First) First = n.index;
+		if(n.index > Last) Last = n.index;
+	}
+	for(size_t i=0; i<n.kids.size(); i++) groupRange(n.kids[i], First, Last);
+}
+
+int CScriptRegexCompiler::emit(int Op, int X, int Y) {
+	if(program->code.size() >= REGEX_MAX_PROGRAM_SIZE) error("regular expression too big");
+	program->code.push_back(CScriptRegexInst(Op, X, Y));
+	return int(program->code.size()-1);
+}
+
+// one iteration of a quantifier - the captures of the previous iteration are unset first (like ECMAScript does)
+void CScriptRegexCompiler::emitIteration(int Kid, int First, int Last) {
+	if(First <= Last) emit(RX_RESET, First*2, (Last-First+1)*2);
+	emitNode(Kid);
+}
+
+void CScriptRegexCompiler::emitNode(int Node) {
+	// NOTE: no references in nodes - emitNode is recursive but nodes is not changed
+	const CScriptRegexNode &n = nodes[Node];
+	std::vector<CScriptRegexInst> &code = program->code;
+	switch(n.type) {
+	case CScriptRegexNode::CHAR: {
+		int i = emit(RX_CHAR);
+		code[i].c = n.c; code[i].c2 = n.c2;
+		break;
+	}
+	case CScriptRegexNode::ANY: emit(RX_ANY); break;
+	case CScriptRegexNode::CLASS: emit(RX_CLASS, n.index); break;
+	case CScriptRegexNode::EMPTY: break;
+	case CScriptRegexNode::BOL: emit(RX_BOL); break;
+	case CScriptRegexNode::EOL: emit(RX_EOL); break;
+	case CScriptRegexNode::WORDB: emit(RX_WORDB); break;
+	case CScriptRegexNode::NWORDB: emit(RX_NWORDB); break;
+	case CScriptRegexNode::BACKREF:
+		program->backtrack = true;
+		emit(RX_BACKREF, n.index);
+		break;
+	case CScriptRegexNode::GROUP:
+		if(n.index >= 0) emit(RX_SAVE, n.index*2);
+		emitNode(n.kids[0]);
+		if(n.index >= 0) emit(RX_SAVE, n.index*2+1);
+		break;
+	case CScriptRegexNode::LOOK: {
+		int look = emit(RX_LOOK);
+		code[look].neg = n.neg;
+		emitNode(n.kids[0]);
+		emit(RX_LOOKEND);
+		code[look].x = int(code.size());
+		break;
+	}
+	case CScriptRegexNode::CAT:
+		for(size_t i=0; i<n.kids.size(); i++) emitNode(n.kids[i]);
+		break;
+	case CScriptRegexNode::ALT: {
+		std::vector<int> jumps;
+		for(size_t i=0; i<n.kids.size()-1; i++) {
+			int split = emit(RX_SPLIT, 0, 0);
+			code[split].x = split+1;
+			emitNode(n.kids[i]);
+			jumps.push_back(emit(RX_JMP));
+			code[split].y = int(code.size());
+		}
+		emitNode(n.kids.back());
+		for(size_t i=0; i<jumps.size(); i++) code[jumps[i]].x = int(code.size());
+		break;
+	}
+	case CScriptRegexNode::REPEAT: {
+		int kid = n.kids[0];
+		bool kidNullable = nullable(kid);
+		int first = INT_MAX, last = -1;
+		groupRange(kid, first, last);
+		if(n.max == REGEX_INFINITE && n.min >= 1 && !kidNullable) {
+			// x{n,} -> x{n-1} L: x split(L, out)
+			for(int i=1; i<n.min; i++) emitIteration(kid, first, last);
+			int loop = int(code.size());
+			emitIteration(kid, first, last);
+			int split = emit(RX_SPLIT);
+			code[split].x = n.greedy ? loop : split+1;
+			code[split].y = n.greedy ? split+1 : loop;
+		} else if(n.max == REGEX_INFINITE) {
+			// x{n} L: split(body, out) body: [save mark] x [check mark] jmp L
+			for(int i=0; i<n.min; i++) emitIteration(kid, first, last);
+			int split = emit(RX_SPLIT);
+			int mark = -1, save = -1;
+			if(kidNullable) {
+				mark = int(program->slotCount++);
+				save = emit(RX_SAVE, mark);
+			}
+			emitIteration(kid, first, last);
+			if(kidNullable) addMarkRange(save, emit(RX_CHECK, mark), mark);
+			emit(RX_JMP, split);
+			code[split].x = n.greedy ? split+1 : int(code.size());
+			code[split].y = n.greedy ? int(code.size()) : split+1;
+		} else {
+			// x{n,m} -> x{n} split([save mark] x [check mark] split(..., out), out)
+			// the optional iterations must not be empty - like the loop above
+			for(int i=0; i<n.min; i++) emitIteration(kid, first, last);
+			int mark = kidNullable && n.min < n.max ? int(program->slotCount++) : -1;
+			std::vector<int> splits;
+			for(int i=n.min; i<n.max; i++) {
+				splits.push_back(emit(RX_SPLIT));
+				int save = mark >= 0 ? emit(RX_SAVE, mark) : -1;
+				emitIteration(kid, first, last);
+				if(mark >= 0) addMarkRange(save, emit(RX_CHECK, mark), mark);
+			}
+			for(size_t i=0; i<splits.size(); i++) {
+				code[splits[i]].x = n.greedy ? splits[i]+1 : int(code.size());
+				code[splits[i]].y = n.greedy ? int(code.size()) : splits[i]+1;
+			}
+		}
+		break;
+	}
+	}
+}
+
+CScriptRegexProgram *CScriptRegexCompiler::compile() {
+	program = new CScriptRegexProgram;
+	try {
+		program->ignoreCase = ignoreCase;
+		program->multiline = multiline;
+		countGroups();
+		int root = parseAlternative();
+		if(pos < src.size()) error("unmatched )");
+		program->groups = totalGroups;
+		program->slotCount = (totalGroups+1)*2;
+		emit(RX_SAVE, 0);
+		emitNode(root);
+		emit(RX_SAVE, 1);
+		emit(RX_MATCH);
+		if(!markRanges.empty()) {
+			program->loopMarks.resize(program->code.size());
+			for(size_t i=0; i<markRanges.size(); i+=3)
+				for(int pc=markRanges[i]+1; pc<=markRanges[i+1]; pc++)
+					program->loopMarks[pc].push_back(markRanges[i+2]);
+		}
+		program->analyze();
+	} catch(...) {
+		delete program;
+		throw;
+	}
+	return program;
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// prefilter
+
+void CScriptRegexProgram::analyze() {
+	size_t pc = 1; // behind SAVE 0
+	while(code[pc].op == RX_SAVE || code[pc].op == RX_RESET) pc++;
+	anchored = code[pc].op == RX_BOL && !multiline;
+	for(; code[pc].op == RX_CHAR && code[pc].c == code[pc].c2; pc++)
+		prefix.append(1, char(code[pc].c));
+	if(!prefix.empty() || anchored) return;
+
+	// the first chars of all paths - if a path can match without a char, there is no prefilter
+	std::vector<bool> visited(code.size(), false);
+	std::vector<int> todo(1, 0);
+	while(!todo.empty()) {
+		int at = todo.back(); todo.pop_back();
+		if(visited[at]) continue;
+		visited[at] = true;
+		const CScriptRegexInst &inst = code[at];
+		switch(inst.op) {
+		case RX_CHAR: first.add(inst.c); first.add(inst.c2); break;
+		case RX_ANY: { CScriptRegexClass any; any.add('\n'); any.add('\r'); any.invert(); first.add(any); break; }
+		case RX_CLASS: first.add(classes[inst.x]); break;
+		case RX_JMP: todo.push_back(inst.x); break;
+		case RX_SPLIT: todo.push_back(inst.x); todo.push_back(inst.y); break;
+		case RX_SAVE: case RX_CHECK: case RX_RESET: case RX_BOL: case RX_EOL: case RX_WORDB: case RX_NWORDB:
+			todo.push_back(at+1); break;
+		default: // MATCH, BACKREF, LOOK
+			return;
+		}
+	}
+	useFirst = true;
+}
+
+size_t CScriptRegexProgram::nextCandidate(const string &Input, size_t Pos) {
+	if(anchored) return Pos == 0 ? 0 : string::npos;
+	if(!prefix.empty()) return Input.find(prefix, Pos);
+	if(useFirst) {
+		size_t len = Input.size();
+		while(Pos < len && !first.has((unsigned char)Input[Pos])) ++Pos;
+		return Pos < len ? Pos : string::npos;
+	}
+	return Pos;
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// Pike-VM - all threads runs in lockstep over the input, threads in the same state are merged.
+/// The threads are ordered by priority, so the result is the same as of a backtracking-VM.
+/// A lookahead is a sticky sub-match on its own scratch
+
+void CScriptRegexProgram::addThread(CScriptRegexScratch &S, CScriptRegexThreads &List, int Pc, const string &Input, size_t Pos) {
+	const CScriptRegexInst &inst = code[Pc];
+	uint32_t state = 0; // the loop-marks at Pos - not needed for the instructions that consumes a char or ends
+	if(!loopMarks.empty() && inst.op != RX_CHAR && inst.op != RX_ANY && inst.op != RX_CLASS && inst.op != RX_MATCH && inst.op != RX_LOOKEND) {
+		const std::vector<int> &marks = loopMarks[Pc];
+		for(size_t i=0; i<marks.size() && i<32; i++)
+			if(S.work[marks[i]] == Pos) state |= 1u << i;
+	}
+	if(state) {
+		std::pair<int, uint32_t> key(Pc, state);
+		if(std::find(S.visited.begin(), S.visited.end(), key) != S.visited.end()) return;
+		S.visited.push_back(key);
+	} else {
+		if(S.onList[Pc] == S.generation) return;
+		S.onList[Pc] = S.generation;
+	}
+	switch(inst.op) {
+	case RX_JMP:
+		addThread(S, List, inst.x, Input, Pos);
+		break;
+	case RX_SPLIT:
+		addThread(S, List, inst.x, Input, Pos);
+		addThread(S, List, inst.y, Input, Pos);
+		break;
+	case RX_SAVE: {
+		size_t old = S.work[inst.x];
+		S.work[inst.x] = Pos;
+		addThread(S, List, Pc+1, Input, Pos);
+		S.work[inst.x] = old;
+		break;
+	}
+	case RX_CHECK: if(S.work[inst.x] != Pos) addThread(S, List, Pc+1, Input, Pos); break;
+	case RX_RESET: {
+		size_t base = S.saved.size();
+		std::vector<size_t>::iterator slots = S.work.begin()+inst.x;
+		S.saved.insert(S.saved.end(), slots, slots+inst.y);
+		std::fill(slots, slots+inst.y, string::npos);
+		addThread(S, List, Pc+1, Input, Pos);
+		std::copy(S.saved.begin()+base, S.saved.end(), S.work.begin()+inst.x);
+		S.saved.resize(base);
+		break;
+	}
+	case RX_BOL: if(atBol(Input, Pos)) addThread(S, List, Pc+1, Input, Pos); break;
+	case RX_EOL: if(atEol(Input, Pos)) addThread(S, List, Pc+1, Input, Pos); break;
+	case RX_WORDB: if(atWordBoundary(Input, Pos)) addThread(S, List, Pc+1, Input, Pos); break;
+	case RX_NWORDB: if(!atWordBoundary(Input, Pos)) addThread(S, List, Pc+1, Input, Pos); break;
+	case RX_LOOK: {
+		if(!S.sub) S.sub = new CScriptRegexScratch;
+		std::vector<size_t> found;
+		bool matched = runPike(*S.sub, Input, Pos, true, found, Pc+1, &S.work);
+		if(matched == inst.neg) break;
+		if(matched) { // the captures of the lookahead are kept
+			S.work.swap(found);
+			addThread(S, List, inst.x, Input, Pos);
+			S.work.swap(found);
+		} else
+			addThread(S, List, inst.x, Input, Pos);
+		break;
+	}
+	default:
+		List.pcs.push_back(Pc);
+		List.slots.insert(List.slots.end(), S.work.begin(), S.work.end());
+	}
+}
+
+// runs the program from Pc - a sub-match from the begin of a lookahead ends at RX_LOOKEND and starts with the slots Init
+bool CScriptRegexProgram::runPike(CScriptRegexScratch &S, const string &Input, size_t Start, bool Sticky, std::vector<size_t> &Slots, int Pc/*=0*/, const std::vector<size_t> *Init/*=0*/) {
+	size_t len = Input.size();
+	if(S.onList.size() != code.size()) S.onList.assign(code.size(), 0);
+	CScriptRegexThreads *clist = &S.lists[0], *nlist = &S.lists[1];
+	clist->clear();
+	bool matched = false;
+	S.nextGeneration();
+	for(size_t pos = Start; ; ++pos) {
+		if(!matched && (pos == Start || !Sticky)) {
+			if(clist->pcs.empty() && !Sticky) { // skip to the next possible start
+				size_t next = nextCandidate(Input, pos);
+				if(next == string::npos) break;
+				if(next != pos) S.nextGeneration();
+				pos = next;
+			}
+			if(Init) S.work = *Init;
+			else S.work.assign(slotCount, string::npos);
+			addThread(S, *clist, Pc, Input, pos);
+		}
+		if(clist->pcs.empty()) {
+			// all threads failed (e.g. a zero-width assertion at the seeded position) - try the next position
+			if(matched || Sticky || pos >= len) break;
+			S.nextGeneration();
+			continue;
+		}
+		S.nextGeneration();
+		nlist->clear();
+		for(size_t t=0, n=clist->pcs.size(); t<n; ++t) {
+			int pc = clist->pcs[t];
+			const CScriptRegexInst &inst = code[pc];
+			const size_t *slots = &clist->slots[t*slotCount];
+			if(inst.op == RX_MATCH || inst.op == RX_LOOKEND) { // the threads behind have a lower priority
+				matched = true;
+				Slots.assign(slots, slots+slotCount);
+				break;
+			}
+			if(step(inst, Input, pos)) {
+				S.work.assign(slots, slots+slotCount);
+				addThread(S, *nlist, pc+1, Input, pos+1);
+			}
+		}
+		std::swap(clist, nlist);
+		if(pos >= len) break;
+	}
+	return matched;
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// backtracking-VM - only used for back-references
+
+#ifndef REGEX_BACKTRACK_LIMIT
+#	define REGEX_BACKTRACK_LIMIT 10000000 ///< see REGEXP-SUPPORT in config.h
+#endif
+
+struct CScriptRegexFrame {
+	CScriptRegexFrame(int Pc, size_t Pos, int Slot=-1, size_t Old=0) : pc(Pc), slot(Slot), pos(Pos), old(Old) {}
+	int pc, slot; ///< slot>=0 -> restore slot to old
+	size_t pos, old;
+};
+
+bool CScriptRegexProgram::runBacktrack(const string &Input, int Pc, size_t Pos, std::vector<size_t> &Slots, size_t &Steps) {
+	typedef CScriptRegexFrame Frame;
+	size_t len = Input.size();
+	std::vector<Frame> stack(1, Frame(Pc, Pos));
+	while(!stack.empty()) {
+		Frame f = stack.back();
+		stack.pop_back();
+		if(f.slot >= 0) {
+			Slots[f.slot] = f.old;
+			continue;
+		}
+		int pc = f.pc;
+		size_t pos = f.pos;
+		for(;;) {
+			if(++Steps > REGEX_BACKTRACK_LIMIT)
+				throw CScriptRegexError("regular expression too complex - the search needs too many backtracking steps");
+			const CScriptRegexInst &inst = code[pc];
+			switch(inst.op) {
+			case RX_CHAR: case RX_ANY: case RX_CLASS:
+				if(!step(inst, Input, pos)) goto fail;
+				++pc; ++pos;
+				continue;
+			case RX_MATCH:
+			case RX_LOOKEND:
+				return true;
+			case RX_JMP:
+				pc = inst.x;
+				continue;
+			case RX_SPLIT:
+				stack.push_back(Frame(inst.y, pos));
+				pc = inst.x;
+				continue;
+			case RX_SAVE:
+				stack.push_back(Frame(0, 0, inst.x, Slots[inst.x]));
+				Slots[inst.x] = pos;
+				++pc;
+				continue;
+			case RX_CHECK: if(Slots[inst.x] == pos) goto fail; ++pc; continue;
+			case RX_RESET:
+				for(int i=inst.x; i<inst.x+inst.y; i++) {
+					if(Slots[i] == string::npos) continue;
+					stack.push_back(Frame(0, 0, i, Slots[i]));
+					Slots[i] = string::npos;
+				}
+				++pc;
+				continue;
+			case RX_BOL: if(!atBol(Input, pos)) goto fail; ++pc; continue;
+			case RX_EOL: if(!atEol(Input, pos)) goto fail; ++pc; continue;
+			case RX_WORDB: if(!atWordBoundary(Input, pos)) goto fail; ++pc; continue;
+			case RX_NWORDB: if(atWordBoundary(Input, pos)) goto fail; ++pc; continue;
+			case RX_BACKREF: {
+				size_t begin = Slots[inst.x*2], end = Slots[inst.x*2+1];
+				if(begin != string::npos && end != string::npos && begin <= end) { // a not matched group matches the empty string
+					size_t l = end-begin;
+					if(pos+l > len) goto fail;
+					for(size_t i=0; i<l; i++) {
+						unsigned char a = Input[begin+i], b = Input[pos+i];
+						if(a != b && !(ignoreCase && regexToLower(a) == regexToLower(b))) goto fail;
+					}
+					pos += l;
+				}
+				++pc;
+				continue;
+			}
+			case RX_LOOK: {
+				std::vector<size_t> saved(Slots);
+				bool found = runBacktrack(Input, pc+1, pos, Slots, Steps);
+				if(found == inst.neg) {
+					Slots.swap(saved);
+					goto fail;
+				}
+				if(inst.neg)
+					Slots.swap(saved);
+				else { // keep the captures of the lookahead - but restore them on backtracking
+					for(size_t i=0; i<Slots.size(); i++)
+						if(Slots[i] != saved[i]) stack.push_back(Frame(0, 0, int(i), saved[i]));
+				}
+				pc = inst.x;
+				continue;
+			}
+			}
+fail:
+			break;
+		}
+	}
+	return false;
+}
+
+bool CScriptRegexProgram::backtrackSearch(const string &Input, size_t Start, bool Sticky, std::vector<size_t> &Slots) {
+	size_t steps = 0; // counted over all start positions
+	for(size_t pos = Start; pos <= Input.size(); ++pos) {
+		if(!Sticky) {
+			pos = nextCandidate(Input, pos);
+			if(pos == string::npos) break;
+		}
+		Slots.assign(slotCount, string::npos);
+		if(runBacktrack(Input, 0, pos, Slots, steps)) return true;
+		if(Sticky) break;
+	}
+	return false;
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// CScriptRegex
+//////////////////////////////////////////////////////////////////////////
+
+CScriptRegex::CScriptRegex() : groupCount(0), program(0), scratch(0) {}
+CScriptRegex::CScriptRegex(const string &Source, bool IgnoreCase/*=false*/, bool Multiline/*=false*/) : groupCount(0), program(0), scratch(0) {
+	CScriptRegexCompiler compiler(Source, IgnoreCase, Multiline);
+	program = compiler.compile();
+	groupCount = program->groups;
+}
+CScriptRegex::CScriptRegex(const CScriptRegex &Copy) : groupCount(Copy.groupCount), program(Copy.program), scratch(0) {
+	if(program) ++program->refs;
+}
+CScriptRegex &CScriptRegex::operator=(const CScriptRegex &Copy) {
+	if(Copy.program) ++Copy.program->refs;
+	if(program && --program->refs == 0) delete program;
+	program = Copy.program;
+	groupCount = Copy.groupCount;
+	return *this;
+}
+CScriptRegex::~CScriptRegex() {
+	if(program && --program->refs == 0) delete program;
+	delete scratch;
+}
+
+bool CScriptRegex::search(const string &Input, size_t Start, bool Sticky, CScriptRegexMatch &Match) const {
+	if(!program || Start > Input.size()) return false;
+	bool found;
+	if(program->backtrack)
+		found = program->backtrackSearch(Input, Start, Sticky, Match.slots);
+	else {
+		if(!scratch) scratch = new CScriptRegexScratch;
+		found = program->runPike(*scratch, Input, Start, Sticky, Match.slots);
+	}
+	if(!found) return false;
+	Match.input = &Input;
+	Match.slots.resize((groupCount+1)*2); // remove the loop-marks
+	return true;
+}
+
+#else /* HAVE_NATIVE_REGEX */
+
+//////////////////////////////////////////////////////////////////////////
+/// CScriptRegex (std::regex, std::tr1::regex or boost::regex)
+//////////////////////////////////////////////////////////////////////////
+
+#	if defined HAVE_TR1_REGEX
+	using namespace std::tr1;
+#	elif defined HAVE_BOOST_REGEX
+	using namespace boost;
+#	endif
+
+static const char *regexErrorStr(int Error) {
+	switch(Error) {
+	case regex_constants::error_badbrace: return "the expression contained an invalid count in a { } expression";
+	case regex_constants::error_badrepeat: return "a repeat expression (one of '*', '?', '+', '{' in most contexts) was not preceded by an expression";
+	case regex_constants::error_brace: return "the expression contained an unmatched '{' or '}'";
+	case regex_constants::error_brack: return "the expression contained an unmatched '[' or ']'";
+	case regex_constants::error_collate: return "the expression contained an invalid collating element name";
+	case regex_constants::error_complexity: return "an attempted match failed because it was too complex";
+	case regex_constants::error_ctype: return "the expression contained an invalid character class name";
+	case regex_constants::error_escape: return "the expression contained an invalid escape sequence";
+	case regex_constants::error_paren: return "the expression contained an unmatched '(' or ')'";
+	case regex_constants::error_range: return "the expression contained an invalid character range specifier";
+	case regex_constants::error_space: return "parsing a regular expression failed because there were not enough resources available";
+	case regex_constants::error_stack: return "an attempted match failed because there was not enough memory available";
+	case regex_constants::error_backref: return "the expression contained an invalid back reference";
+	default: return "";
+	}
+}
+
+CScriptRegex::CScriptRegex() : groupCount(0) {}
+CScriptRegex::CScriptRegex(const string &Source, bool IgnoreCase/*=false*/, bool Multiline/*=false*/) : groupCount(0) {
+	regex::flag_type flags = regex_constants::ECMAScript;
+	if(IgnoreCase) flags |= regex_constants::icase;
+	try {
+		re.assign(Source, flags);
+	} catch(regex_error &e) {
+		throw CScriptRegexError(string(e.what())+" - "+regexErrorStr(e.code()));
+	}
+	groupCount = re.mark_count();
+}
+CScriptRegex::CScriptRegex(const CScriptRegex &Copy) : groupCount(Copy.groupCount), re(Copy.re) {}
+CScriptRegex &CScriptRegex::operator=(const CScriptRegex &Copy) {
+	groupCount = Copy.groupCount;
+	re = Copy.re;
+	return *this;
+}
+CScriptRegex::~CScriptRegex() {}
+
+bool CScriptRegex::search(const string &Input, size_t Start, bool Sticky, CScriptRegexMatch &Match) const {
+	if(Start > Input.size()) return false;
+	regex_constants::match_flag_type mflag = Sticky ? regex_constants::match_continuous : regex_constants::match_default;
+	if(Start) mflag |= regex_constants::match_prev_avail;
+	smatch match;
+	if(!regex_search(Input.begin()+Start, Input.end(), match, re, mflag)) return false;
+	Match.input = &Input;
+	Match.slots.assign(match.size()*2, string::npos);
+	for(smatch::size_type i=0; i<match.size(); i++) {
+		if(!match[i].matched) continue;
+		Match.slots[i*2] = match[i].first - Input.begin();
+		Match.slots[i*2+1] = match[i].second - Input.begin();
+	}
+	return true;
+}
+
+#endif /* HAVE_NATIVE_REGEX */
+
+bool CScriptRegex::search(const string &Input, size_t Start/*=0*/, bool Sticky/*=false*/) const {
+	CScriptRegexMatch match;
+	return search(Input, Start, Sticky, match);
+}
+
+#endif /* NO_REGEXP */
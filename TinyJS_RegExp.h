@@ -0,0 +1,125 @@
+#ifndef TinyJS_RegExp_h__
+#define TinyJS_RegExp_h__
+#include "config.h"
+#ifndef NO_REGEXP
+/*
+ * 42TinyJS
+ *
+ * A fork of TinyJS with the goal to makes a more JavaScript/ECMA compliant engine
+ *
+ * Authored By Armin Diedering <armin@diedering.de>
+ *
+ * Copyright (C) 2010-2015 ardisoft
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#ifndef HAVE_NATIVE_REGEX
+#	if defined HAVE_TR1_REGEX
+#		include <tr1/regex>
+#	elif defined HAVE_BOOST_REGEX
+#		include <boost/regex.hpp>
+#	else
+#		include <regex>
+#	endif
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+/// CScriptRegexError
+//////////////////////////////////////////////////////////////////////////
+
+/// thrown by CScriptRegex for invalid regular expressions and by a search that exceeds REGEX_BACKTRACK_LIMIT
+class CScriptRegexError : public std::runtime_error {
+public:
+	CScriptRegexError(const std::string &What) : std::runtime_error(What) {}
+};
+
+//////////////////////////////////////////////////////////////////////////
+/// CScriptRegexMatch
+//////////////////////////////////////////////////////////////////////////
+
+/// result of CScriptRegex::search. Group 0 is the whole match, the positions are offsets in the input
+class CScriptRegexMatch {
+public:
+	CScriptRegexMatch() : input(0) {}
+	size_t size() const { return slots.size()/2; } ///< number of groups incl. group 0
+	bool matched(size_t Group=0) const { return slots[Group*2] != std::string::npos; }
+	size_t position(size_t Group=0) const { return slots[Group*2]; }
+	size_t end(size_t Group=0) const { return slots[Group*2+1]; }
+	size_t length(size_t Group=0) const { return slots[Group*2+1]-slots[Group*2]; }
+	std::string str(size_t Group=0) const { return matched(Group) ? input->substr(position(Group), length(Group)) : std::string(); }
+	/// expands the replacement-patterns of String.prototype.replace ($$, $&, $`, $' and $n/$nn)
+	std::string format(const std::string &Replacement) const;
+private:
+	const std::string *input;
+	std::vector<size_t> slots; ///< begin & end of each group - npos if not matched
+	friend class CScriptRegex;
+};
+
+//////////////////////////////////////////////////////////////////////////
+/// CScriptRegex
+//////////////////////////////////////////////////////////////////////////
+
+struct CScriptRegexProgram;
+struct CScriptRegexScratch;
+
+/// a compiled ECMAScript regular expression.
+/// With HAVE_NATIVE_REGEX (the default) the built-in engine is used: The pattern is compiled to a program that runs
+/// on a Pike-VM - the time is linear in the length of the input, there is no exponential backtracking (a lookahead
+/// adds a sub-match per position). Only patterns with back-references runs on a backtracking-VM (limited to
+/// REGEX_BACKTRACK_LIMIT steps per search). A literal prefix or the set of the possible first
+/// chars is used to skip the positions where no match can start.
+/// Otherwise std::regex, std::tr1::regex or boost::regex is used (see config.h)
+/// Copies shares the compiled program (it is never changed), but each copy has its own scratch - a CScriptRegex must
+/// not be used by more than one thread at a time, its copies can
+class CScriptRegex {
+public:
+	CScriptRegex();
+	/// throws CScriptRegexError if Source is not a valid regular expression
+	CScriptRegex(const std::string &Source, bool IgnoreCase=false, bool Multiline=false);
+	CScriptRegex(const CScriptRegex &Copy);
+	CScriptRegex &operator=(const CScriptRegex &Copy);
+	~CScriptRegex();
+
+	/// searches the first match at or behind Start - with Sticky the match must begin at Start.
+	/// Start is an offset in Input, so "^" and "\b" sees the chars before Start
+	bool search(const std::string &Input, size_t Start, bool Sticky, CScriptRegexMatch &Match) const;
+	bool search(const std::string &Input, size_t Start=0, bool Sticky=false) const;
+	size_t groups() const { return groupCount; } ///< number of capturing groups
+private:
+	size_t groupCount;
+#ifdef HAVE_NATIVE_REGEX
+	CScriptRegexProgram *program;
+	mutable CScriptRegexScratch *scratch; ///< created on first search by the Pike-VM
+#elif defined HAVE_TR1_REGEX
+	std::tr1::regex re;
+#elif defined HAVE_BOOST_REGEX
+	boost::regex re;
+#else
+	std::regex re;
+#endif
+};
+
+#endif /* NO_REGEXP */
+#endif // TinyJS_RegExp_h__
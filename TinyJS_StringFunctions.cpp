@@ -30,23 +30,15 @@
 #include <algorithm>
 #include "TinyJS.h"
 
-#ifndef NO_REGEXP 
-#	if defined HAVE_TR1_REGEX
-#		include <tr1/regex>
-		using namespace std::tr1;
-#	elif defined HAVE_BOOST_REGEX
-#		include <boost/regex.hpp>
-		using namespace boost;
-#	else
-#		include <regex>
-#	endif
-#endif
 using namespace std;
 // ----------------------------------------------- Actual Functions
 
+// the natives of String and RegExp uses the fast calling-convention - the parameters are accessed by position
+#define ARGUMENT(n) (size_t(n)<Argc ? Args[n] : tinyJS->constScriptVar(Undefined))
+
 #define CheckObjectCoercible(var) do { \
 		if(var->isUndefined() || var->isNull())\
-			c->throwError(TypeError, "can't convert undefined to object");\
+			throw newScriptVarError(tinyJS, TypeError, "can't convert undefined to object");\
 	}while(0) 
 
 #if PTRDIFF_MAX == INT32_MAX
@@ -54,42 +46,42 @@ using namespace std;
 #else
 #	define ptr2int32(p) ((int32_t)((ptrdiff_t)p) & 0x7FFF)
 #endif
-static string this2string(const CFunctionsScopePtr &c) {
-	CScriptVarPtr This = c->getArgument("this");
+// the string-value of this - a string-primitive is borrowed not copied
+static CScriptStringRef this2string(CTinyJS *tinyJS, const CScriptVarPtr &This) {
 	CheckObjectCoercible(This);
+	if(This->isString()) return static_cast<CScriptVarString*>(This.getVar())->getString();
 	return This->toString();
 }
 
-static void scStringCharAt(const CFunctionsScopePtr &c, void *) {
-	string str = this2string(c);
-	int p = c->getArgument("pos")->toNumber().toInt32();
+static CScriptVarPtr scStringCharAt(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	CScriptStringRef str = this2string(tinyJS, This);
+	int p = ARGUMENT(0)->toNumber().toInt32();
 	if (p>=0 && p<(int)str.length())
-		c->setReturnVar(c->newScriptVar(str.substr(p, 1)));
+		return tinyJS->newScriptVar(str.substr(p, 1));
 	else
-		c->setReturnVar(c->newScriptVar(""));
+		return tinyJS->newScriptVar("");
 }
 
-static void scStringCharCodeAt(const CFunctionsScopePtr &c, void *) {
-	string str = this2string(c);
-	int p = c->getArgument("pos")->toNumber().toInt32();
+static CScriptVarPtr scStringCharCodeAt(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	CScriptStringRef str = this2string(tinyJS, This);
+	int p = ARGUMENT(0)->toNumber().toInt32();
 	if (p>=0 && p<(int)str.length())
-		c->setReturnVar(c->newScriptVar((unsigned char)str.at(p)));
+		return tinyJS->newScriptVar((unsigned char)str[p]);
 	else
-		c->setReturnVar(c->constScriptVar(NaN));
+		return tinyJS->constScriptVar(NaN);
 }
 
-static void scStringConcat(const CFunctionsScopePtr &c, void *userdata) {
-	int length = c->getArgumentsLength();
-	string str = this2string(c);
-	for(int32_t i=ptr2int32(userdata); i<length; i++)
-		str.append(c->getArgument(i)->toString());
-	c->setReturnVar(c->newScriptVar(str));
+static CScriptVarPtr scStringConcat(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *userdata) {
+	string str = this2string(tinyJS, This).str();
+	for(size_t i=0; i<Argc; i++)
+		str.append(Args[i]->toString());
+	return tinyJS->newScriptVar(str);
 }
 
-static void scStringIndexOf(const CFunctionsScopePtr &c, void *userdata) {
-	string str = this2string(c);
-	string search = c->getArgument("search")->toString();
-	CNumber pos_n = c->getArgument("pos")->toNumber();
+static CScriptVarPtr scStringIndexOf(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *userdata) {
+	CScriptStringRef str = this2string(tinyJS, This);
+	string search = ARGUMENT(0)->toString();
+	CNumber pos_n = ARGUMENT(1)->toNumber();
 	string::size_type pos;
 	pos = (userdata) ? string::npos : 0;
 	if(pos_n.sign()<0) pos = 0;
@@ -97,42 +89,41 @@ static void scStringIndexOf(const CFunctionsScopePtr &c, void *userdata) {
 	else if(pos_n.isFinite()) pos = pos_n.toInt32();
 	string::size_type p = (userdata==0) ? str.find(search, pos) : str.rfind(search, pos);
 	if(p==string::npos)
-		c->setReturnVar(c->newScriptVar(-1));
+		return tinyJS->newScriptVar(-1);
 	else
-		c->setReturnVar(c->newScriptVar(p));
+		return tinyJS->newScriptVar(p);
 }
 
-static void scStringLocaleCompare(const CFunctionsScopePtr &c, void *userdata) {
-	string str = this2string(c);
-	string compareString = c->getArgument("compareString")->toString();
-	int32_t val = 0;
-	if(str<compareString) val = -1;
-	else if(str>compareString) val = 1;
-	c->setReturnVar(c->newScriptVar(val));
+static CScriptVarPtr scStringLocaleCompare(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *userdata) {
+	CScriptStringRef str = this2string(tinyJS, This);
+	string compareString = ARGUMENT(0)->toString();
+	int32_t val = str.compare(compareString);
+	return tinyJS->newScriptVar(val<0 ? -1 : val>0 ? 1 : 0);
 }
 
-static void scStringQuote(const CFunctionsScopePtr &c, void *userdata) {
-	string str = this2string(c);
-	c->setReturnVar(c->newScriptVar(getJSString(str)));
+static CScriptVarPtr scStringQuote(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *userdata) {
+	string str = this2string(tinyJS, This).str();
+	return tinyJS->newScriptVar(getJSString(str));
 }
 
 #ifndef NO_REGEXP
 // helper-function for replace search
-static bool regex_search(const string &str, const string::const_iterator &search_begin, const string &substr, bool ignoreCase, bool sticky, string::const_iterator &match_begin, string::const_iterator &match_end, smatch &match) {
-	regex::flag_type flags = regex_constants::ECMAScript;
-	if(ignoreCase) flags |= regex_constants::icase;
-	regex_constants::match_flag_type mflag = sticky?regex_constants::match_continuous:regex_constants::format_default;
-	if(str.begin() != search_begin) mflag |= regex_constants::match_prev_avail;
-	if(regex_search(search_begin, str.end(), match, regex(substr, flags), mflag)) {
-		match_begin = match[0].first;
-		match_end = match[0].second;
+static bool regex_search(const string &str, const string::const_iterator &search_begin, const CScriptRegex &regex, bool sticky, string::const_iterator &match_begin, string::const_iterator &match_end, CScriptRegexMatch &match) {
+	if(regex.search(str, search_begin-str.begin(), sticky, match)) {
+		match_begin = str.begin()+match.position();
+		match_end = str.begin()+match.end();
 		return true;
 	}
 	return false;
 }
-static bool regex_search(const string &str, const string::const_iterator &search_begin, const string &substr, bool ignoreCase, bool sticky, string::const_iterator &match_begin, string::const_iterator &match_end) {
-	smatch match;
-	return regex_search(str, search_begin, substr, ignoreCase, sticky, match_begin, match_end, match);
+static bool regex_search(const string &str, const string::const_iterator &search_begin, const CScriptRegex &regex, bool sticky, string::const_iterator &match_begin, string::const_iterator &match_end) {
+	CScriptRegexMatch match;
+	return regex_search(str, search_begin, regex, sticky, match_begin, match_end, match);
+}
+// returns the compiled regexp of the RegExp-object or of a string-pattern from the regex-cache of the context
+static CScriptRegex getRegex(CTinyJS *tinyJS, const CScriptVarRegExpPtr &RegExp, const string &substr, bool ignoreCase) {
+	if(RegExp) return RegExp->getRegex();
+	return tinyJS->getRegexCache().get(substr, ignoreCase);
 }
 #endif /* NO_REGEXP */
 
@@ -159,17 +150,16 @@ static bool string_search(const string &str, const string::const_iterator &searc
 // Access:    public static 
 // Returns:   bool true if regexp-param=RegExp-Object / other false
 // Qualifier:
-// Parameter: const CFunctionsScopePtr & c
-// Parameter: const string & regexp - parameter name of the regexp
+// Parameter: CTinyJS * tinyJS
+// Parameter: const CScriptVarPtr & regexpVar - the regexp-argument
 // Parameter: bool noUndefined - true an undefined regexp aims in "" else in "undefined"
-// Parameter: const string & flags - parameter name of the flags
+// Parameter: const CScriptVarPtr & flagVar - the flags-argument or null for no flags
 // Parameter: string & substr - rgexp.source
 // Parameter: bool & global
 // Parameter: bool & ignoreCase
 // Parameter: bool & sticky
 //************************************
-static CScriptVarPtr getRegExpData(const CFunctionsScopePtr &c, const string &regexp, bool noUndefined, const char *flags_argument, string &substr, bool &global, bool &ignoreCase, bool &sticky) {
-	CScriptVarPtr regexpVar = c->getArgument(regexp);
+static CScriptVarPtr getRegExpData(CTinyJS *tinyJS, const CScriptVarPtr &regexpVar, bool noUndefined, const CScriptVarPtr &flagVar, string &substr, bool &global, bool &ignoreCase, bool &sticky) {
 	if(regexpVar->isRegExp()) {
 #ifndef NO_REGEXP
 		CScriptVarRegExpPtr RegExp(regexpVar);
@@ -182,12 +172,11 @@ static CScriptVarPtr getRegExpData(const CFunctionsScopePtr &c, const string &re
 	} else {
 		substr.clear();
 		if(!noUndefined || !regexpVar->isUndefined()) substr = regexpVar->toString();
-		CScriptVarPtr flagVar;
-		if(flags_argument && (flagVar = c->getArgument(flags_argument)) && !flagVar->isUndefined()) {
+		if(flagVar && !flagVar->isUndefined()) {
 			string flags = flagVar->toString();
 			string::size_type pos = flags.find_first_not_of("gimy");
 			if(pos != string::npos) {
-				c->throwError(SyntaxError, string("invalid regular expression flag ")+flags[pos]);
+				throw newScriptVarError(tinyJS, SyntaxError, (string("invalid regular expression flag ")+flags[pos]).c_str());
 			}
 			global = flags.find_first_of('g')!=string::npos;
 			ignoreCase = flags.find_first_of('i')!=string::npos;
@@ -198,279 +187,288 @@ static CScriptVarPtr getRegExpData(const CFunctionsScopePtr &c, const string &re
 	return CScriptVarPtr();
 }
 
-static void scStringReplace(const CFunctionsScopePtr &c, void *) {
-	const string str = this2string(c);
-	CScriptVarPtr newsubstrVar = c->getArgument("newsubstr");
+static CScriptVarPtr scStringReplace(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	CScriptStringRef str_ref = this2string(tinyJS, This);
+	const string &str = str_ref.compact();
+	CScriptVarPtr newsubstrVar = ARGUMENT(1);
 	string substr, ret_str;
 	bool global, ignoreCase, sticky;
-	bool isRegExp = getRegExpData(c, "substr", false, "flags", substr, global, ignoreCase, sticky);
-	if(isRegExp && !newsubstrVar->isFunction()) {
+	CScriptVarPtr isRegExp = getRegExpData(tinyJS, ARGUMENT(0), false, ARGUMENT(2), substr, global, ignoreCase, sticky);
 #ifndef NO_REGEXP
-		regex::flag_type flags = regex_constants::ECMAScript;
-		if(ignoreCase) flags |= regex_constants::icase;
-		regex_constants::match_flag_type mflags = regex_constants::match_default;
-		if(!global) mflags |= regex_constants::format_first_only;
-		if(sticky) mflags |= regex_constants::match_continuous;
-		ret_str = regex_replace(str, regex(substr, flags), newsubstrVar->toString(), mflags);
+	CScriptRegex regex;
+	CScriptRegexMatch match;
+	if(isRegExp) 
+		regex = CScriptVarRegExpPtr(isRegExp)->getRegex();
 #endif /* NO_REGEXP */
-	} else {
-		bool (*search)(const string &, const string::const_iterator &, const string &, bool, bool, string::const_iterator &, string::const_iterator &);
+	string newsubstr;
+	vector<CScriptVarPtr> arguments;
+	if(!newsubstrVar->isFunction()) 
+		newsubstr = newsubstrVar->toString();
+	global = global && (isRegExp || substr.length()); // an empty RegExp like new RegExp("", "g") matches between every char
+	string::const_iterator search_begin=str.begin(), match_begin, match_end;
+	for(;;) {
+		bool found;
 #ifndef NO_REGEXP
-		if(isRegExp) 
-			search = regex_search;
-		else
+		if(isRegExp) {
+			try {
+				found = regex_search(str, search_begin, regex, sticky, match_begin, match_end, match);
+			} catch(CScriptRegexError &e) {
+				throw newScriptVarError(tinyJS, SyntaxError, e.what());
+			}
+		} else
 #endif /* NO_REGEXP */
-			search = string_search;
-		string newsubstr;
-		vector<CScriptVarPtr> arguments;
-		if(!newsubstrVar->isFunction()) 
-			newsubstr = newsubstrVar->toString();
-		global = global && substr.length();
-		string::const_iterator search_begin=str.begin(), match_begin, match_end;
-		if(search(str, search_begin, substr, ignoreCase, sticky, match_begin, match_end)) {
-			do {
-				ret_str.append(search_begin, match_begin);
-				if(newsubstrVar->isFunction()) {
-					arguments.push_back(c->newScriptVar(string(match_begin, match_end)));
-					newsubstr = c->getContext()->callFunction(newsubstrVar, arguments, c)->toString();
-					arguments.pop_back();
-				}
-				ret_str.append(newsubstr);
-#if 1 /* Fix from "vcmpeq" (see Issue 14) currently untested */
-				if (match_begin == match_end) {
-					if (search_begin != str.end())
-						++search_begin;
-					else
-						break;
-				} else {
-					search_begin = match_end;
-				}
-#else
-				search_begin = match_end;
-#endif
-			} while(global && search(str, search_begin, substr, ignoreCase, sticky, match_begin, match_end));
+			found = string_search(str, search_begin, substr, ignoreCase, sticky, match_begin, match_end);
+		if(!found) break;
+		ret_str.append(search_begin, match_begin);
+		if(newsubstrVar->isFunction()) {
+			arguments.push_back(tinyJS->newScriptVar(string(match_begin, match_end)));
+			ret_str.append(tinyJS->callFunction(newsubstrVar, arguments, tinyJS->constScriptVar(Undefined))->toString());
+			arguments.pop_back();
+		}
+#ifndef NO_REGEXP
+		else if(isRegExp)
+			ret_str.append(match.format(newsubstr));
+#endif /* NO_REGEXP */
+		else
+			ret_str.append(newsubstr);
+		search_begin = match_end;
+		if (match_begin == match_end) { // empty match -> copy the next char and search behind it
+			if (search_begin == str.end()) break;
+			ret_str.append(1, *search_begin++);
 		}
-		ret_str.append(search_begin, str.end());
+		if(!global) break;
 	}
-	c->setReturnVar(c->newScriptVar(ret_str));
+	ret_str.append(search_begin, str.end());
+	return tinyJS->newScriptVar(ret_str);
 }
 #ifndef NO_REGEXP
-static void scStringMatch(const CFunctionsScopePtr &c, void *) {
-	string str = this2string(c);
+static CScriptVarPtr scStringMatch(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	CScriptStringRef str_ref = this2string(tinyJS, This);
+	const string &str = str_ref.compact();
 
 	string flags="flags", substr, newsubstr, match;
 	bool global, ignoreCase, sticky;
-	CScriptVarRegExpPtr RegExp = getRegExpData(c, "regexp", true, "flags", substr, global, ignoreCase, sticky);
+	CScriptVarRegExpPtr RegExp = getRegExpData(tinyJS, ARGUMENT(0), true, ARGUMENT(1), substr, global, ignoreCase, sticky);
 	if(!global) {
 		if(!RegExp)
-			RegExp = ::newScriptVar(c->getContext(), substr, flags);
+			RegExp = ::newScriptVar(tinyJS, substr, flags);
 		if(RegExp) {
 			try {
-				c->setReturnVar(RegExp->exec(str));
-			} catch(regex_error e) {
-				c->throwError(SyntaxError, string(e.what())+" - "+CScriptVarRegExp::ErrorStr(e.code()));
+				return RegExp->exec(str);
+			} catch(CScriptRegexError &e) {
+				throw newScriptVarError(tinyJS, SyntaxError, e.what());
 			}
 		}
 	} else {
 		try { 
-			CScriptVarArrayPtr retVar = c->newScriptVar(Array);
+			CScriptVarArrayPtr retVar = tinyJS->newScriptVar(Array);
 			int idx=0;
 			string::size_type offset=0;
-			global = global && substr.length();
+			global = global && (RegExp || substr.length());
+			CScriptRegex regex = getRegex(tinyJS, RegExp, substr, ignoreCase);
 			string::const_iterator search_begin=str.begin(), match_begin, match_end;
-			if(regex_search(str, search_begin, substr, ignoreCase, sticky, match_begin, match_end)) {
-				do {
-					offset = match_begin-str.begin();
-					retVar->addChild(int2string(idx++), c->newScriptVar(string(match_begin, match_end)));
-#if 1 /* Fix from "vcmpeq" (see Issue 14) currently untested */
-					if (match_begin == match_end) {
-						if (search_begin != str.end())
-							++search_begin;
-						else
-							break;
-					} else {
-						search_begin = match_end;
-					}
-#else
-					search_begin = match_end;
-#endif
-				} while(global && regex_search(str, search_begin, substr, ignoreCase, sticky, match_begin, match_end));
+			while(regex_search(str, search_begin, regex, sticky, match_begin, match_end)) {
+				offset = match_begin-str.begin();
+				retVar->setArrayIndex(idx++, tinyJS->newScriptVar(str_ref.substr(match_begin-str.begin(), match_end-match_begin)));
+				search_begin = match_end;
+				if (match_begin == match_end) { // empty match -> search behind the next char
+					if (search_begin == str.end()) break;
+					++search_begin;
+				}
+				if(!global) break;
 			}
 			if(idx) {
-				retVar->addChild("input", c->newScriptVar(str));
-				retVar->addChild("index", c->newScriptVar((int)offset));
-				c->setReturnVar(retVar);
+				retVar->addChild("input", tinyJS->newScriptVar(str_ref));
+				retVar->addChild("index", tinyJS->newScriptVar((int)offset));
+				return retVar;
 			} else
-				c->setReturnVar(c->constScriptVar(Null));
-		} catch(regex_error e) {
-			c->throwError(SyntaxError, string(e.what())+" - "+CScriptVarRegExp::ErrorStr(e.code()));
+				return tinyJS->constScriptVar(Null);
+		} catch(CScriptRegexError &e) {
+			throw newScriptVarError(tinyJS, SyntaxError, e.what());
 		}
 	}
+	return tinyJS->constScriptVar(Undefined);
 }
 #endif /* NO_REGEXP */
 
-static void scStringSearch(const CFunctionsScopePtr &c, void *userdata) {
-	string str = this2string(c);
+static CScriptVarPtr scStringSearch(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *userdata) {
+	CScriptStringRef str_ref = this2string(tinyJS, This);
+	const string &str = str_ref.compact();
 
 	string substr;
 	bool global, ignoreCase, sticky;
-	getRegExpData(c, "regexp", true, "flags", substr, global, ignoreCase, sticky);
+#ifndef NO_REGEXP
+	CScriptVarRegExpPtr RegExp = getRegExpData(tinyJS, ARGUMENT(0), true, ARGUMENT(1), substr, global, ignoreCase, sticky);
+#else 
+	getRegExpData(tinyJS, ARGUMENT(0), true, ARGUMENT(1), substr, global, ignoreCase, sticky);
+#endif
 	string::const_iterator search_begin=str.begin(), match_begin, match_end;
 #ifndef NO_REGEXP
 	try { 
-		c->setReturnVar(c->newScriptVar(regex_search(str, search_begin, substr, ignoreCase, sticky, match_begin, match_end)?match_begin-search_begin:-1));
-	} catch(regex_error e) {
-		c->throwError(SyntaxError, string(e.what())+" - "+CScriptVarRegExp::ErrorStr(e.code()));
+		return tinyJS->newScriptVar(regex_search(str, search_begin, getRegex(tinyJS, RegExp, substr, ignoreCase), sticky, match_begin, match_end)?match_begin-search_begin:-1);
+	} catch(CScriptRegexError &e) {
+		throw newScriptVarError(tinyJS, SyntaxError, e.what());
 	}
 #else /* NO_REGEXP */
-	c->setReturnVar(c->newScriptVar(string_search(str, search_begin, substr, ignoreCase, sticky, match_begin, match_end)?match_begin-search_begin:-1));
+	return tinyJS->newScriptVar(string_search(str, search_begin, substr, ignoreCase, sticky, match_begin, match_end)?match_begin-search_begin:-1);
 #endif /* NO_REGEXP */ 
 }
 
-static void scStringSlice(const CFunctionsScopePtr &c, void *userdata) {
-	string str = this2string(c);
-	int32_t length = c->getArgumentsLength()-(ptr2int32(userdata) & 1);
+static CScriptVarPtr scStringSlice(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *userdata) {
+	CScriptStringRef str = this2string(tinyJS, This);
 	bool slice = (ptr2int32(userdata) & 2) == 0;
-	int32_t start = c->getArgument("start")->toNumber().toInt32();
+	int32_t start = ARGUMENT(0)->toNumber().toInt32();
 	int32_t end = (int32_t)str.size();
 	if(slice && start<0) start = (int32_t)(str.size())+start;
-	if(length>1) {
-		end = c->getArgument("end")->toNumber().toInt32();
+	if(Argc>1) {
+		end = Args[1]->toNumber().toInt32();
 		if(slice && end<0) end = (int32_t)(str.size())+end;
 	}
 	if(!slice && end < start) { end^=start; start^=end; end^=start; }
 	if(start<0) start = 0;
 	if(start>=(int)str.size()) 
-		c->setReturnVar(c->newScriptVar(""));
+		return tinyJS->newScriptVar("");
 	else if(end <= start)
-		c->setReturnVar(c->newScriptVar(""));
+		return tinyJS->newScriptVar("");
 	else
-		c->setReturnVar(c->newScriptVar(str.substr(start, end-start)));
+		return tinyJS->newScriptVar(str.substr(start, end-start));
 }
 
-static void scStringSplit(const CFunctionsScopePtr &c, void *) {
-	const string str = this2string(c);
+static CScriptVarPtr scStringSplit(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	CScriptStringRef str_ref = this2string(tinyJS, This);
+	const string &str = str_ref.compact(); // the pieces are views of str_ref
 
 	string seperator;
 	bool global, ignoreCase, sticky;
 #ifndef NO_REGEXP
-	CScriptVarRegExpPtr RegExp = getRegExpData(c, "separator", true, 0, seperator, global, ignoreCase, sticky);
+	CScriptVarRegExpPtr RegExp = getRegExpData(tinyJS, ARGUMENT(0), true, CScriptVarPtr(), seperator, global, ignoreCase, sticky);
 #else 
-	getRegExpData(c, "separator", true, 0, seperator, global, ignoreCase, sticky);
+	getRegExpData(tinyJS, ARGUMENT(0), true, CScriptVarPtr(), seperator, global, ignoreCase, sticky);
 #endif
 		
-	CScriptVarPtr sep_var = c->getArgument("separator");
-	CScriptVarPtr limit_var = c->getArgument("limit");
+	CScriptVarPtr sep_var = ARGUMENT(0);
+	CScriptVarPtr limit_var = ARGUMENT(1);
 	int limit = limit_var->isUndefined() ? 0x7fffffff : limit_var->toNumber().toInt32();
 
-	CScriptVarPtr result(newScriptVar(c->getContext(), Array));
-	c->setReturnVar(result);
+	CScriptVarPtr result(newScriptVar(tinyJS, Array));
 	if(limit == 0)
-		return;
-	else if(!str.size() || sep_var->isUndefined()) {
-		result->setArrayIndex(0, c->newScriptVar(str));
-		return;
+		return result;
+	else if(sep_var->isUndefined()) {
+		result->setArrayIndex(0, tinyJS->newScriptVar(str_ref));
+		return result;
+	} else if(!str.size()) { // an empty string gives [] when the separator matches it
+		bool matchesEmpty = seperator.size() == 0;
+#ifndef NO_REGEXP
+		string::const_iterator match_begin, match_end;
+		if(RegExp) {
+			try { 
+				matchesEmpty = regex_search(str, str.begin(), RegExp->getRegex(), true, match_begin, match_end);
+			} catch(CScriptRegexError &e) {
+				throw newScriptVarError(tinyJS, SyntaxError, e.what());
+			}
+		}
+#endif
+		if(!matchesEmpty) result->setArrayIndex(0, tinyJS->newScriptVar(str_ref));
+		return result;
 	}
 	if(seperator.size() == 0) {
 		for(int i=0; i<min((int)str.size(), limit); ++i)
-			result->setArrayIndex(i, c->newScriptVar(str.substr(i,1)));
-		return;
+			result->setArrayIndex(i, tinyJS->newScriptVar(str_ref.substr(i,1)));
+		return result;
 	}
 	int length = 0;
-	string::const_iterator search_begin=str.begin(), match_begin, match_end;
+	string::const_iterator search_begin=str.begin(), next_search=str.begin(), match_begin, match_end;
 #ifndef NO_REGEXP
-	smatch match;
+	CScriptRegexMatch match;
 #endif
-	bool found=true;
-	while(found) {
+	while(next_search != str.end()) {
+		bool found = false;
 #ifndef NO_REGEXP
 		if(RegExp) {
 			try { 
-				found = regex_search(str, search_begin, seperator, ignoreCase, sticky, match_begin, match_end, match);
-			} catch(regex_error e) {
-				c->throwError(SyntaxError, string(e.what())+" - "+CScriptVarRegExp::ErrorStr(e.code()));
+				found = regex_search(str, next_search, RegExp->getRegex(), sticky, match_begin, match_end, match);
+			} catch(CScriptRegexError &e) {
+				throw newScriptVarError(tinyJS, SyntaxError, e.what());
 			}
 		} else /* NO_REGEXP */
 #endif
-			found = string_search(str, search_begin, seperator, ignoreCase, sticky, match_begin, match_end);
-		string f;
-		if(found) {
-			result->setArrayIndex(length++, c->newScriptVar(string(search_begin, match_begin)));
-			if(length>=limit) break;
+			found = string_search(str, next_search, seperator, ignoreCase, sticky, match_begin, match_end);
+		if(!found || match_begin == str.end()) break;
+		if(match_end == search_begin) { // empty match at the begin of the piece -> search behind
+			next_search = match_begin+1;
+			continue;
+		}
+		result->setArrayIndex(length++, tinyJS->newScriptVar(str_ref.substr(search_begin-str.begin(), match_begin-search_begin)));
+		if(length>=limit) return result;
 #ifndef NO_REGEXP
-			for(uint32_t i=1; i<match.size(); i++) {
-				if(match[i].matched) 
-					result->setArrayIndex(length++, c->newScriptVar(string(match[i].first, match[i].second)));
-				else
-					result->setArrayIndex(length++, c->constScriptVar(Undefined));
-				if(length>=limit) break;
-			}
-			if(length>=limit) break;
-#endif
-			search_begin = match_end;
-		} else {
-			result->setArrayIndex(length++, c->newScriptVar(string(search_begin,str.end())));
-			if(length>=limit) break;
+		for(size_t i=1; i<match.size(); i++) {
+			if(match.matched(i)) 
+				result->setArrayIndex(length++, tinyJS->newScriptVar(str_ref.substr(match.position(i), match.length(i))));
+			else
+				result->setArrayIndex(length++, tinyJS->constScriptVar(Undefined));
+			if(length>=limit) return result;
 		}
+#endif
+		search_begin = next_search = match_end;
 	}
+	result->setArrayIndex(length++, tinyJS->newScriptVar(str_ref.substr(search_begin-str.begin())));
+	return result;
 }
 
-static void scStringSubstr(const CFunctionsScopePtr &c, void *userdata) {
-	string str = this2string(c);
-	int32_t length = c->getArgumentsLength()-ptr2int32(userdata);
-	int32_t start = c->getArgument("start")->toNumber().toInt32();
+static CScriptVarPtr scStringSubstr(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *userdata) {
+	CScriptStringRef str = this2string(tinyJS, This);
+	int32_t start = ARGUMENT(0)->toNumber().toInt32();
 	if(start<0 || start>=(int)str.size()) 
-		c->setReturnVar(c->newScriptVar(""));
-	else if(length>1) {
-		int length = c->getArgument("length")->toNumber().toInt32();
-		c->setReturnVar(c->newScriptVar(str.substr(start, length)));
+		return tinyJS->newScriptVar("");
+	else if(Argc>1) {
+		int length = Args[1]->toNumber().toInt32();
+		return tinyJS->newScriptVar(str.substr(start, length));
 	} else
-		c->setReturnVar(c->newScriptVar(str.substr(start)));
+		return tinyJS->newScriptVar(str.substr(start));
 }
 
-static void scStringToLowerCase(const CFunctionsScopePtr &c, void *) {
-	string str = this2string(c);
+static CScriptVarPtr scStringToLowerCase(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	string str = this2string(tinyJS, This).str();
 	transform(str.begin(), str.end(), str.begin(), ::tolower);
-	c->setReturnVar(c->newScriptVar(str));
+	return tinyJS->newScriptVar(str);
 }
 
-static void scStringToUpperCase(const CFunctionsScopePtr &c, void *) {
-	string str = this2string(c);
+static CScriptVarPtr scStringToUpperCase(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	string str = this2string(tinyJS, This).str();
 	transform(str.begin(), str.end(), str.begin(), ::toupper);
-	c->setReturnVar(c->newScriptVar(str));
+	return tinyJS->newScriptVar(str);
 }
 
-static void scStringTrim(const CFunctionsScopePtr &c, void *userdata) {
-	string str = this2string(c);
+static CScriptVarPtr scStringTrim(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *userdata) {
+	CScriptStringRef str = this2string(tinyJS, This);
 	string::size_type start = 0;
-	string::size_type end = string::npos;
+	string::size_type end = str.length();
 	if(((ptr2int32(userdata)) & 2) == 0) {
-		start = str.find_first_not_of(" \t\r\n");
-		if(start == string::npos) start = 0;
+		while(start < end && memchr(" \t\r\n", str[start], 4)) start++;
 	}
 	if(((ptr2int32(userdata)) & 1) == 0) {
-		end = str.find_last_not_of(" \t\r\n");
-		if(end != string::npos) end = 1+end-start;
+		while(end > start && memchr(" \t\r\n", str[end-1], 4)) end--;
 	}
-	c->setReturnVar(c->newScriptVar(str.substr(start, end)));
+	end -= start;
+	return tinyJS->newScriptVar(str.substr(start, end));
 }
 
 
 
-static void scCharToInt(const CFunctionsScopePtr &c, void *) {
-	string str = c->getArgument("ch")->toString();;
+static CScriptVarPtr scCharToInt(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	string str = ARGUMENT(0)->toString();;
 	int val = 0;
 	if (str.length()>0)
 		val = (int)str.c_str()[0];
-	c->setReturnVar(c->newScriptVar(val));
+	return tinyJS->newScriptVar(val);
 }
 
 
-static void scStringFromCharCode(const CFunctionsScopePtr &c, void *) {
+static CScriptVarPtr scStringFromCharCode(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
 	char str[2];
-	str[0] = c->getArgument("char")->toNumber().toInt32();
+	str[0] = ARGUMENT(0)->toNumber().toInt32();
 	str[1] = 0;
-	c->setReturnVar(c->newScriptVar(str));
+	return tinyJS->newScriptVar(str);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -479,96 +477,93 @@ static void scStringFromCharCode(const CFunctionsScopePtr &c, void *) {
 
 #ifndef NO_REGEXP
 
-static void scRegExpTest(const CFunctionsScopePtr &c, void *) {
-	CScriptVarRegExpPtr This = c->getArgument("this");
-	if(This)
-		c->setReturnVar(This->exec(c->getArgument("str")->toString(), true));
-	else
-		c->throwError(TypeError, "Object is not a RegExp-Object in test(str)");
+static CScriptVarPtr scRegExpTest(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	CScriptVarRegExpPtr RegExp = This;
+	if(RegExp) {
+		try {
+			return RegExp->exec(ARGUMENT(0)->toString(), true);
+		} catch(CScriptRegexError &e) {
+			throw newScriptVarError(tinyJS, SyntaxError, e.what());
+		}
+	} else
+		throw newScriptVarError(tinyJS, TypeError, "Object is not a RegExp-Object in test(str)");
 }
-static void scRegExpExec(const CFunctionsScopePtr &c, void *) {
-	CScriptVarRegExpPtr This = c->getArgument("this");
-	if(This)
-		c->setReturnVar(This->exec(c->getArgument("str")->toString()));
-	else
-		c->throwError(TypeError, "Object is not a RegExp-Object in exec(str)");
+static CScriptVarPtr scRegExpExec(CTinyJS *tinyJS, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	CScriptVarRegExpPtr RegExp = This;
+	if(RegExp) {
+		try {
+			return RegExp->exec(ARGUMENT(0)->toString());
+		} catch(CScriptRegexError &e) {
+			throw newScriptVarError(tinyJS, SyntaxError, e.what());
+		}
+	} else
+		throw newScriptVarError(tinyJS, TypeError, "Object is not a RegExp-Object in exec(str)");
 }
 #endif /* NO_REGEXP */
 
 // ----------------------------------------------- Register Functions
-void registerStringFunctions(CTinyJS *tinyJS) {}
-extern "C" void _registerStringFunctions(CTinyJS *tinyJS) {
-	CScriptVarPtr fnc;
-	// charAt
-	tinyJS->addNative("function String.prototype.charAt(pos)", scStringCharAt, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	tinyJS->addNative("function String.charAt(this,pos)", scStringCharAt, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	// charCodeAt
-	tinyJS->addNative("function String.prototype.charCodeAt(pos)", scStringCharCodeAt, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	tinyJS->addNative("function String.charCodeAt(this,pos)", scStringCharCodeAt, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	// concat
-	tinyJS->addNative("function String.prototype.concat()", scStringConcat, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	tinyJS->addNative("function String.concat(this)", scStringConcat, (void*)1, SCRIPTVARLINK_BUILDINDEFAULT);
-	// indexOf
-	tinyJS->addNative("function String.prototype.indexOf(search,pos)", scStringIndexOf, 0, SCRIPTVARLINK_BUILDINDEFAULT); // find the position of a string in a string, -1 if not
-	tinyJS->addNative("function String.indexOf(this,search,pos)", scStringIndexOf, 0, SCRIPTVARLINK_BUILDINDEFAULT); // find the position of a string in a string, -1 if not
-	// lastIndexOf
-	tinyJS->addNative("function String.prototype.lastIndexOf(search,pos)", scStringIndexOf, (void*)-1, SCRIPTVARLINK_BUILDINDEFAULT); // find the last position of a string in a string, -1 if not
-	tinyJS->addNative("function String.lastIndexOf(this,search,pos)", scStringIndexOf, (void*)-1, SCRIPTVARLINK_BUILDINDEFAULT); // find the last position of a string in a string, -1 if not
-	// localeCompare
-	tinyJS->addNative("function String.prototype.localeCompare(compareString)", scStringLocaleCompare, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	tinyJS->addNative("function String.localeCompare(this,compareString)", scStringLocaleCompare, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	// quote
-	tinyJS->addNative("function String.prototype.quote()", scStringQuote, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	tinyJS->addNative("function String.quote(this)", scStringQuote, 0, SCRIPTVARLINK_BUILDINDEFAULT);
+// the natives of String.prototype and the generic variants in String (with this as first argument)
+static const struct {
+	const char *name;
+	const char *params;
+	JSFastCallback fnc;
+	void *data;
+} stringFunctions[] = {
+	{ "charAt", "pos", scStringCharAt, 0 },
+	{ "charCodeAt", "pos", scStringCharCodeAt, 0 },
+	{ "concat", "", scStringConcat, 0 },
+	{ "indexOf", "search,pos", scStringIndexOf, 0 }, // find the position of a string in a string, -1 if not
+	{ "lastIndexOf", "search,pos", scStringIndexOf, (void*)-1 }, // find the last position of a string in a string, -1 if not
+	{ "localeCompare", "compareString", scStringLocaleCompare, 0 },
+	{ "quote", "", scStringQuote, 0 },
 #ifndef NO_REGEXP
-	// match
-	tinyJS->addNative("function String.prototype.match(regexp, flags)", scStringMatch, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	tinyJS->addNative("function String.match(this, regexp, flags)", scStringMatch, 0, SCRIPTVARLINK_BUILDINDEFAULT);
+	{ "match", "regexp, flags", scStringMatch, 0 },
 #endif /* !REGEXP */
-	// replace
-	tinyJS->addNative("function String.prototype.replace(substr, newsubstr, flags)", scStringReplace, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	tinyJS->addNative("function String.replace(this, substr, newsubstr, flags)", scStringReplace, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	// search
-	tinyJS->addNative("function String.prototype.search(regexp, flags)", scStringSearch, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	tinyJS->addNative("function String.search(this, regexp, flags)", scStringSearch, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	// slice
-	tinyJS->addNative("function String.prototype.slice(start,end)", scStringSlice, 0, SCRIPTVARLINK_BUILDINDEFAULT); // find the last position of a string in a string, -1 if not
-	tinyJS->addNative("function String.slice(this,start,end)", scStringSlice, (void*)1, SCRIPTVARLINK_BUILDINDEFAULT); // find the last position of a string in a string, -1 if not
-	// split
-	tinyJS->addNative("function String.prototype.split(separator,limit)", scStringSplit, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	tinyJS->addNative("function String.split(this,separator,limit)", scStringSplit, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	// substr
-	tinyJS->addNative("function String.prototype.substr(start,length)", scStringSubstr, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	tinyJS->addNative("function String.substr(this,start,length)", scStringSubstr, (void*)1, SCRIPTVARLINK_BUILDINDEFAULT);
-	// substring
-	tinyJS->addNative("function String.prototype.substring(start,end)", scStringSlice, (void*)2, SCRIPTVARLINK_BUILDINDEFAULT);
-	tinyJS->addNative("function String.substring(this,start,end)", scStringSlice, (void*)3, SCRIPTVARLINK_BUILDINDEFAULT);
+	{ "replace", "substr, newsubstr, flags", scStringReplace, 0 },
+	{ "search", "regexp, flags", scStringSearch, 0 },
+	{ "slice", "start,end", scStringSlice, 0 },
+	{ "split", "separator,limit", scStringSplit, 0 },
+	{ "substr", "start,length", scStringSubstr, 0 },
+	{ "substring", "start,end", scStringSlice, (void*)2 },
 	// toLowerCase toLocaleLowerCase currently the same function
-	tinyJS->addNative("function String.prototype.toLowerCase()", scStringToLowerCase, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	tinyJS->addNative("function String.toLowerCase(this)", scStringToLowerCase, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	tinyJS->addNative("function String.prototype.toLocaleLowerCase()", scStringToLowerCase, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	tinyJS->addNative("function String.toLocaleLowerCase(this)", scStringToLowerCase, 0, SCRIPTVARLINK_BUILDINDEFAULT);
+	{ "toLowerCase", "", scStringToLowerCase, 0 },
+	{ "toLocaleLowerCase", "", scStringToLowerCase, 0 },
 	// toUpperCase toLocaleUpperCase currently the same function
-	tinyJS->addNative("function String.prototype.toUpperCase()", scStringToUpperCase, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	tinyJS->addNative("function String.toUpperCase(this)", scStringToUpperCase, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	tinyJS->addNative("function String.prototype.toLocaleUpperCase()", scStringToUpperCase, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	tinyJS->addNative("function String.toLocaleUpperCase(this)", scStringToUpperCase, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	// trim
-	tinyJS->addNative("function String.prototype.trim()", scStringTrim, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	tinyJS->addNative("function String.trim(this)", scStringTrim, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	// trimLeft
-	tinyJS->addNative("function String.prototype.trimLeft()", scStringTrim, (void*)1, SCRIPTVARLINK_BUILDINDEFAULT);
-	tinyJS->addNative("function String.trimLeft(this)", scStringTrim, (void*)1, SCRIPTVARLINK_BUILDINDEFAULT);
-	// trimRight
-	tinyJS->addNative("function String.prototype.trimRight()", scStringTrim, (void*)2, SCRIPTVARLINK_BUILDINDEFAULT);
-	tinyJS->addNative("function String.trimRight(this)", scStringTrim, (void*)2, SCRIPTVARLINK_BUILDINDEFAULT);
-
-	tinyJS->addNative("function charToInt(ch)", scCharToInt, 0, SCRIPTVARLINK_BUILDINDEFAULT); //  convert a character to an int - get its value
-	
+	{ "toUpperCase", "", scStringToUpperCase, 0 },
+	{ "toLocaleUpperCase", "", scStringToUpperCase, 0 },
+	{ "trim", "", scStringTrim, 0 },
+	{ "trimLeft", "", scStringTrim, (void*)1 },
+	{ "trimRight", "", scStringTrim, (void*)2 },
+};
+
+// added on first access of String.prototype
+static void installStringPrototype(CTinyJS *tinyJS, const CScriptVarPtr &) {
+	for(size_t i=0; i<sizeof(stringFunctions)/sizeof(*stringFunctions); ++i)
+		tinyJS->addNative(string("function String.prototype.")+stringFunctions[i].name+"("+stringFunctions[i].params+")", stringFunctions[i].fnc, stringFunctions[i].data, SCRIPTVARLINK_BUILDINDEFAULT);
 	tinyJS->addNative("function String.prototype.fromCharCode(char)", scStringFromCharCode, 0, SCRIPTVARLINK_BUILDINDEFAULT);
+}
+
+// added on first access of String
+static void installStringGenerics(CTinyJS *tinyJS, const CScriptVarPtr &) {
+	for(size_t i=0; i<sizeof(stringFunctions)/sizeof(*stringFunctions); ++i)
+		tinyJS->addNative(string("function String.")+stringFunctions[i].name+"(this"+(*stringFunctions[i].params ? "," : "")+stringFunctions[i].params+")", stringFunctions[i].fnc, stringFunctions[i].data, SCRIPTVARLINK_BUILDINDEFAULT);
+}
+
 #ifndef NO_REGEXP
+// added on first access of RegExp.prototype
+static void installRegExpPrototype(CTinyJS *tinyJS, const CScriptVarPtr &) {
 	tinyJS->addNative("function RegExp.prototype.test(str)", scRegExpTest, 0, SCRIPTVARLINK_BUILDINDEFAULT);
 	tinyJS->addNative("function RegExp.prototype.exec(str)", scRegExpExec, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-#endif /* NO_REGEXP */
 }
+#endif /* NO_REGEXP */
 
+void registerStringFunctions(CTinyJS *tinyJS) {}
+extern "C" void _registerStringFunctions(CTinyJS *tinyJS) {
+	tinyJS->addLazyNatives(tinyJS->stringPrototype, installStringPrototype);
+	tinyJS->addLazyNatives(tinyJS->getRoot()->findChild("String"), installStringGenerics);
+
+	tinyJS->addNative("function charToInt(ch)", scCharToInt, 0, SCRIPTVARLINK_BUILDINDEFAULT); //  convert a character to an int - get its value
+#ifndef NO_REGEXP
+	tinyJS->addLazyNatives(tinyJS->regexpPrototype, installRegExpPrototype);
+#endif /* NO_REGEXP */
+}
@@ -27,10 +27,26 @@
  * SOFTWARE.
  */
 
+#if defined(__APPLE__) && !defined(_XOPEN_SOURCE)
+#	define _XOPEN_SOURCE 600 // needed for <ucontext.h>
+#endif
 #include "TinyJS_Threading.h"
 #include <exception>
+#include <new>
 #include <cstdio>
 #include <cstddef>
+#ifdef HAVE_UCONTEXT_COROUTINES
+#	include <ucontext.h>
+#	include <sys/mman.h>
+#	include <unistd.h>
+#	include <stdint.h>
+#	ifndef MAP_ANONYMOUS
+#		define MAP_ANONYMOUS MAP_ANON
+#	endif
+#	ifndef MAP_NORESERVE
+#		define MAP_NORESERVE 0
+#	endif
+#endif
 
 #undef HAVE_THREADING
 #if !defined(NO_THREADING) && !defined(HAVE_CUSTOM_THREADING_IMPL)
@@ -170,7 +186,7 @@ CScriptCondVar::~CScriptCondVar() {
 
 class CScriptThread_impl : public CScriptThread::CScriptThread_t {
 public:
-	CScriptThread_impl(CScriptThread *_this) : retvar((void*)-1), activ(false), running(false), started(false), This(_this) {}
+	CScriptThread_impl(CScriptThread *_this) : retvar((void*)-1), activ(false), running(false), started(false), joined(false), This(_this) {}
 	~CScriptThread_impl() {}
 	void Run() {
 		if(started) return;
@@ -183,10 +199,11 @@ public:
 		while(!started);
 	}
 	int Stop(bool Wait) {
-		if(!running) return started ? retValue() : -1;
+		if(!started) return -1;
 		activ = false;
-		if(Wait) {
+		if(Wait && !joined) { // also a finished thread is joined (a joinable std::thread must not be destroyed)
 			pthread_join(thread, &retvar);
+			joined = true;
 		}
 		return (int32_t)((ptrdiff_t)retvar);
 	}
@@ -205,6 +222,7 @@ public:
 	volatile bool activ;
 	volatile bool running;
 	volatile bool started;
+	bool joined;
 	CScriptThread *This;
 	pthread_t thread;
 };
@@ -217,6 +235,8 @@ CScriptThread::~CScriptThread() {
 }
 void CScriptThread::ThreadFncFinished() {}
 
+#ifndef HAVE_UCONTEXT_COROUTINES
+
 CScriptCoroutine::StopIteration_t CScriptCoroutine::StopIteration;
 
 bool CScriptCoroutine::next()
@@ -245,6 +265,8 @@ void CScriptCoroutine::yield() {
 	}
 }
 int CScriptCoroutine::ThreadFnc() {
+	char top;
+	stackLimit = &top - SCRIPT_COROUTINE_THREAD_STACK_USABLE;
 	int ret=-1;
 	try {
 		ret = Coroutine();
@@ -263,6 +285,162 @@ void CScriptCoroutine::ThreadFncFinished() {
 	wake_main.post();
 }
 
+#endif /* !HAVE_UCONTEXT_COROUTINES */
+
 
 #endif // HAVE_THREADING
 
+#ifdef HAVE_UCONTEXT_COROUTINES
+
+//////////////////////////////////////////////////////////////////////////
+// Coroutine (ucontext)
+//////////////////////////////////////////////////////////////////////////
+
+struct CScriptCoroutineStack {
+	ucontext_t caller;
+	ucontext_t coroutine;
+	char *base; ///< lowest address - the first page is a guard-page
+	CScriptCoroutineStack *nextFree;
+};
+
+static CScriptMutex coroutineStackPoolMutex;
+static CScriptCoroutineStack *coroutineStackPool = 0;
+static int coroutineStackPoolSize = 0;
+
+static CScriptCoroutineStack *allocCoroutineStack() {
+	{
+		CScriptUniqueLock lock(coroutineStackPoolMutex);
+		if(coroutineStackPool) {
+			CScriptCoroutineStack *stack = coroutineStackPool;
+			coroutineStackPool = stack->nextFree;
+			--coroutineStackPoolSize;
+			return stack;
+		}
+	}
+	void *base = mmap(0, SCRIPT_COROUTINE_STACK_SIZE, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0);
+	if(base == MAP_FAILED) throw std::bad_alloc();
+	mprotect(base, sysconf(_SC_PAGESIZE), PROT_NONE); // guard-page
+	CScriptCoroutineStack *stack = new CScriptCoroutineStack;
+	stack->base = (char*)base;
+	return stack;
+}
+
+static void freeCoroutineStack(CScriptCoroutineStack *stack) {
+	{
+		CScriptUniqueLock lock(coroutineStackPoolMutex);
+		if(coroutineStackPoolSize < SCRIPT_COROUTINE_STACK_POOL) {
+			stack->nextFree = coroutineStackPool;
+			coroutineStackPool = stack;
+			++coroutineStackPoolSize;
+			return;
+		}
+	}
+	munmap(stack->base, SCRIPT_COROUTINE_STACK_SIZE);
+	delete stack;
+}
+
+CScriptCoroutine::StopIteration_t CScriptCoroutine::StopIteration;
+
+CScriptCoroutine::~CScriptCoroutine() {
+	if(running) Stop(); // unwind the stack of the coroutine
+	if(stack) freeCoroutineStack(stack);
+}
+
+void CScriptCoroutine::entry(unsigned int hi, unsigned int lo) {
+	// makecontext passes int-arguments only
+	CScriptCoroutine *This = (CScriptCoroutine*)((uintptr_t(hi) << 16 << 16) | uintptr_t(lo));
+	try {
+		This->retvar = This->Coroutine();
+	} catch(StopIteration_t &) {
+		This->retvar = 0;
+	} catch(std::exception & e) {
+		printf("CScriptCoroutine has received an uncaught exception: %s\n", e.what());
+		This->retvar = -1;
+	} catch(...) {
+		printf("CScriptCoroutine has received an uncaught and unknown exception\n");
+		This->retvar = -1;
+	}
+	This->running = false;
+	swapcontext(&This->stack->coroutine, &This->stack->caller); // never resumed
+}
+
+void CScriptCoroutine::resume() {
+	swapcontext(&stack->caller, &stack->coroutine);
+}
+
+bool CScriptCoroutine::next()
+{
+	if(!started) {
+		stack = allocCoroutineStack();
+		getcontext(&stack->coroutine);
+		stack->coroutine.uc_stack.ss_sp = stack->base;
+		stack->coroutine.uc_stack.ss_size = SCRIPT_COROUTINE_STACK_SIZE;
+		stack->coroutine.uc_link = 0;
+		uintptr_t This = uintptr_t(this);
+		makecontext(&stack->coroutine, (void(*)())entry, 2, (unsigned int)(This >> 16 >> 16), (unsigned int)This);
+		started = running = activ = true;
+		resume();
+	} else if(running)
+		resume();
+	else
+		return false;
+	if(!running) { // finished - the stack is not longer needed
+		freeCoroutineStack(stack);
+		stack = 0;
+		return false;
+	}
+	return true;
+}
+bool CScriptCoroutine::yield_no_throw() {
+	swapcontext(&stack->coroutine, &stack->caller);
+	return activ;
+}
+void CScriptCoroutine::yield() {
+	if(!yield_no_throw()) {
+		throw StopIteration;
+	}
+}
+int CScriptCoroutine::Stop(bool Wait/*=true*/) {
+	if(!running) return started ? retvar : -1;
+	activ = false;
+	if(Wait) {
+		while(running) next();
+	}
+	return retvar;
+}
+void *CScriptCoroutine::getStackLimit() {
+	return stack ? stack->base + SCRIPT_COROUTINE_STACK_RESERVE : 0;
+}
+
+#endif /* HAVE_UCONTEXT_COROUTINES */
+
+#if !defined(NO_THREADING) && !defined(HAVE_CXX11_ATOMIC)
+
+//////////////////////////////////////////////////////////////////////////
+// AtomicCounter (without <atomic>)
+//////////////////////////////////////////////////////////////////////////
+
+static CScriptMutex counterMutex;
+int32_t CScriptAtomicCounter::operator++() {
+	CScriptUniqueLock lock(counterMutex);
+	return ++value;
+}
+int32_t CScriptAtomicCounter::operator--() {
+	CScriptUniqueLock lock(counterMutex);
+	return --value;
+}
+int32_t CScriptAtomicCounter::get() const {
+	CScriptUniqueLock lock(counterMutex);
+	return value;
+}
+bool CScriptAtomicCounter::compareExchange(int32_t &Expected, int32_t Desired) {
+	CScriptUniqueLock lock(counterMutex);
+	if(value != Expected) {
+		Expected = value;
+		return false;
+	}
+	value = Desired;
+	return true;
+}
+
+#endif /* !NO_THREADING && !HAVE_CXX11_ATOMIC */
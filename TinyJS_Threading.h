@@ -137,12 +137,56 @@ private:
 	CScriptThread_t *thread;
 };
 
+#ifdef HAVE_UCONTEXT_COROUTINES
+
+#define SCRIPT_COROUTINE_STACK_SIZE (8*1024*1024) ///< like the default thread-stack - pages are committed on first use
+#define SCRIPT_COROUTINE_STACK_RESERVE (64*1024) ///< below this the recursion-check (see getStackLimit) stops the script
+#define SCRIPT_COROUTINE_STACK_POOL 64 ///< max. number of unused stacks kept for reuse
+
+/// a stackful coroutine - switches with swapcontext to an own stack in the thread of the caller.
+/// The stacks are pooled, so a resume costs a context-switch only (no thread, no semaphores)
+class CScriptCoroutine {
+public:
+	CScriptCoroutine() : stack(0), retvar(-1), activ(false), running(false), started(false) {}
+	virtual ~CScriptCoroutine();
+	typedef struct{} StopIteration_t;
+	static StopIteration_t StopIteration;
+	bool next(); // returns true if coroutine is running
+	void *getStackLimit(); ///< the lowest usable address of the stack (for CTinyJS' recursion-check)
+protected:
+	virtual int Coroutine()=0;
+	void yield();
+	bool yield_no_throw();
+	int Stop(bool Wait=true); ///< the next yield throws StopIteration - with Wait the coroutine is resumed until it is finished
+	int retValue() { return retvar; }
+	bool isActiv() { return activ; }
+	bool isRunning() { return running; }
+	bool isStarted() { return started; }
+private:
+	static void entry(unsigned int hi, unsigned int lo);
+	void resume();
+	struct CScriptCoroutineStack *stack; ///< the stack and the contexts - taken from the pool on start
+	int retvar;
+	bool activ;
+	bool running;
+	bool started;
+};
+
+#else /* HAVE_UCONTEXT_COROUTINES */
+
+#ifdef _WIN32
+#	define SCRIPT_COROUTINE_THREAD_STACK_USABLE (768*1024) ///< the part of the thread-stack used by the script (the default stack is 1MB)
+#else
+#	define SCRIPT_COROUTINE_THREAD_STACK_USABLE (7*1024*1024) ///< the part of the thread-stack used by the script (the default stack is 8MB)
+#endif
+
 class CScriptCoroutine : protected CScriptThread {
 public:
-	CScriptCoroutine() : wake_thread(0), wake_main(0) {}
+	CScriptCoroutine() : wake_thread(0), wake_main(0), stackLimit(0) {}
 	typedef struct{} StopIteration_t;
 	static StopIteration_t StopIteration;
 	bool next(); // returns true if coroutine is running
+	void *getStackLimit() { return stackLimit; } ///< SCRIPT_COROUTINE_THREAD_STACK_USABLE below the begin of the thread (for CTinyJS' recursion-check)
 protected:
 	virtual int Coroutine()=0;
 	void yield();
@@ -152,9 +196,50 @@ private:
 	virtual void ThreadFncFinished();
 	CScriptSemaphore wake_thread;
 	CScriptSemaphore wake_main;
+	char *stackLimit;
 };
 
+#endif /* HAVE_UCONTEXT_COROUTINES */
+
 
 
 #endif // NO_THREADING
+
+#include <stdint.h>
+#ifdef HAVE_CXX11_ATOMIC
+#	include <atomic>
+#endif
+
+/// a counter that can be changed by more threads at the same time - e.g. the references
+/// to data that is shared by contexts in different threads (see CScriptAtom)
+class CScriptAtomicCounter {
+public:
+	explicit CScriptAtomicCounter(int32_t Value=0) : value(Value) {}
+#ifdef HAVE_CXX11_ATOMIC
+	int32_t operator++() { return value.fetch_add(1, std::memory_order_relaxed)+1; } ///< returns the new value
+	int32_t operator--() { return value.fetch_sub(1, std::memory_order_acq_rel)-1; } ///< returns the new value
+	int32_t get() const { return value.load(std::memory_order_relaxed); }
+	/// sets the value to Desired if it is Expected - otherwise Expected is set to the value
+	bool compareExchange(int32_t &Expected, int32_t Desired) { return value.compare_exchange_weak(Expected, Desired, std::memory_order_acq_rel, std::memory_order_relaxed); }
+#elif defined(NO_THREADING)
+	int32_t operator++() { return ++value; }
+	int32_t operator--() { return --value; }
+	int32_t get() const { return value; }
+	bool compareExchange(int32_t &Expected, int32_t Desired) { if(value != Expected) { Expected = value; return false; } value = Desired; return true; }
+#else // protected by a mutex (see TinyJS_Threading.cpp)
+	int32_t operator++();
+	int32_t operator--();
+	int32_t get() const;
+	bool compareExchange(int32_t &Expected, int32_t Desired);
+#endif
+private:
+	CScriptAtomicCounter(const CScriptAtomicCounter &Copy) MEMBER_DELETE;
+	CScriptAtomicCounter &operator=(const CScriptAtomicCounter &Copy) MEMBER_DELETE;
+#ifdef HAVE_CXX11_ATOMIC
+	std::atomic<int32_t> value;
+#else
+	int32_t value;
+#endif
+};
+
 #endif // TinyJS_Threading_h__
@@ -0,0 +1,428 @@
+/*
+ * 42TinyJS
+ *
+ * A fork of TinyJS with the goal to makes a more JavaScript/ECMA compliant engine
+ *
+ * Authored By Armin Diedering <armin@diedering.de>
+ *
+ * Copyright (C) 2010-2015 ardisoft
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+#include "TinyJS.h"
+
+using namespace std;
+
+const char *TYPEDARRAY_NAME[] = {
+	"Int8Array", "Uint8Array", "Uint8ClampedArray", "Int16Array", "Uint16Array",
+	"Int32Array", "Uint32Array", "Float32Array", "Float64Array"
+};
+const uint32_t TYPEDARRAY_ELEMENT_SIZE[] = { 1, 1, 1, 2, 2, 4, 4, 4, 8 };
+
+uint32_t typedArrayToUint32(const CNumber &Value) {
+	if(Value.isInt32()) return uint32_t(Value.toInt32());
+	if(!Value.isFinite()) return 0; // NaN, +/-Infinity
+	double d = fmod(Value.toDouble() < 0 ? ceil(Value.toDouble()) : floor(Value.toDouble()), 4294967296.0);
+	if(d < 0) d += 4294967296.0;
+	return uint32_t(d);
+}
+uint8_t typedArrayToUint8Clamped(const CNumber &Value) {
+	if(Value.isInt32()) {
+		int32_t i = Value.toInt32();
+		return i < 0 ? 0 : i > 255 ? 255 : uint8_t(i);
+	}
+	if(Value.isNaN()) return 0;
+	double d = Value.toDouble();
+	if(d <= 0) return 0;
+	if(d >= 255) return 255;
+	double f = floor(d);
+	if(d - f > 0.5 || (d - f == 0.5 && fmod(f, 2) != 0)) ++f; // round half to even
+	return uint8_t(f);
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+/// CScriptVarArrayBuffer
+//////////////////////////////////////////////////////////////////////////
+
+CScriptVarArrayBuffer::CScriptVarArrayBuffer(CTinyJS *Context, uint32_t ByteLength)
+	: CScriptVarObject(Context, Context->arrayBufferPrototype), data((uint8_t*)calloc(ByteLength ? ByteLength : 1, 1)), byteLength(data ? ByteLength : 0), release(0), releaseUserdata(0) {
+	init();
+}
+CScriptVarArrayBuffer::CScriptVarArrayBuffer(CTinyJS *Context, void *Data, uint32_t ByteLength, ArrayBufferRelease Release, void *Userdata)
+	: CScriptVarObject(Context, Context->arrayBufferPrototype), data((uint8_t*)Data), byteLength(ByteLength), release(Release), releaseUserdata(Userdata) {
+	init();
+}
+CScriptVarArrayBuffer::CScriptVarArrayBuffer(const CScriptVarArrayBuffer &Copy)
+	: CScriptVarObject(Copy), data((uint8_t*)malloc(Copy.byteLength ? Copy.byteLength : 1)), byteLength(data ? Copy.byteLength : 0), release(0), releaseUserdata(0) {
+	if(data) memcpy(data, Copy.data, byteLength);
+}
+void CScriptVarArrayBuffer::init() {
+	addChild("byteLength", newScriptVar(byteLength), SCRIPTVARLINK_CONSTANT);
+}
+CScriptVarArrayBuffer::~CScriptVarArrayBuffer() {
+	if(release)
+		release(data, byteLength, releaseUserdata);
+	else
+		free(data);
+}
+CScriptVarPtr CScriptVarArrayBuffer::clone() { return new CScriptVarArrayBuffer(*this); }
+bool CScriptVarArrayBuffer::isArrayBuffer() { return true; }
+
+
+//////////////////////////////////////////////////////////////////////////
+/// CScriptVarTypedArray
+//////////////////////////////////////////////////////////////////////////
+
+CScriptVarTypedArray::CScriptVarTypedArray(CTinyJS *Context, TYPEDARRAY_KIND Kind, const CScriptVarArrayBufferPtr &Buffer, uint32_t ByteOffset, uint32_t Length)
+	: CScriptVarObject(Context, Context->typedArrayPrototypes[Kind]), kind(Kind), buffer(Buffer), byteOffset(ByteOffset), length(Length), data(Buffer->getData()+ByteOffset) {
+	ASSERT(ByteOffset % getElementSize() == 0 && uint64_t(ByteOffset) + uint64_t(Length)*getElementSize() <= Buffer->getByteLength());
+	addChild("length", newScriptVar(length), SCRIPTVARLINK_CONSTANT);
+	addChild("byteLength", newScriptVar(length*getElementSize()), SCRIPTVARLINK_CONSTANT);
+	addChild("byteOffset", newScriptVar(byteOffset), SCRIPTVARLINK_CONSTANT);
+	addChild("buffer", buffer, SCRIPTVARLINK_CONSTANT);
+}
+CScriptVarTypedArray::CScriptVarTypedArray(const CScriptVarTypedArray &Copy)
+	: CScriptVarObject(Copy), kind(Copy.kind), buffer(Copy.buffer), byteOffset(Copy.byteOffset), length(Copy.length), data(Copy.data) {}
+CScriptVarTypedArray::~CScriptVarTypedArray() {}
+CScriptVarPtr CScriptVarTypedArray::clone() { return new CScriptVarTypedArray(*this); }
+bool CScriptVarTypedArray::isTypedArray() { return true; }
+string CScriptVarTypedArray::getParsableString(const string &indentString, const string &indent, uint32_t uniqueID, bool &hasRecursion) {
+	string destination;
+	const char *nl = indent.size() ? "\n" : " ";
+	const char *comma = "";
+	destination.append("[");
+	if(length) {
+		string new_indentString = indentString + indent;
+		for(uint32_t i=0; i<length; i++) {
+			destination.append(comma); comma = ",";
+			destination.append(nl).append(new_indentString).append(getElement(i).toString());
+		}
+		destination.append(nl).append(indentString);
+	}
+	destination.append("]");
+	return destination;
+}
+CScriptVarPtr CScriptVarTypedArray::toString_CallBack( CScriptResult &execute, int radix/*=0*/ ) {
+	string destination;
+	for(uint32_t i=0; i<length; i++) {
+		if(i) destination.append(",");
+		destination.append(getElement(i).toString());
+	}
+	return newScriptVar(destination);
+}
+void CScriptVarTypedArray::getReferences(vector<CScriptVar*> &Refs) {
+	CScriptVarObject::getReferences(Refs);
+	Refs.push_back(buffer.getVar());
+}
+void CScriptVarTypedArray::forkReferences(CScriptVarForker &Forker) {
+	CScriptVarObject::forkReferences(Forker);
+	Forker.forkPtr(buffer);
+	data = buffer->getData()+byteOffset;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+/// CScriptVarDataView
+//////////////////////////////////////////////////////////////////////////
+
+CScriptVarDataView::CScriptVarDataView(CTinyJS *Context, const CScriptVarArrayBufferPtr &Buffer, uint32_t ByteOffset, uint32_t ByteLength)
+	: CScriptVarObject(Context, Context->dataViewPrototype), buffer(Buffer), byteOffset(ByteOffset), byteLength(ByteLength) {
+	ASSERT(uint64_t(ByteOffset) + ByteLength <= Buffer->getByteLength());
+	addChild("byteLength", newScriptVar(byteLength), SCRIPTVARLINK_CONSTANT);
+	addChild("byteOffset", newScriptVar(byteOffset), SCRIPTVARLINK_CONSTANT);
+	addChild("buffer", buffer, SCRIPTVARLINK_CONSTANT);
+}
+CScriptVarDataView::CScriptVarDataView(const CScriptVarDataView &Copy)
+	: CScriptVarObject(Copy), buffer(Copy.buffer), byteOffset(Copy.byteOffset), byteLength(Copy.byteLength) {}
+CScriptVarDataView::~CScriptVarDataView() {}
+CScriptVarPtr CScriptVarDataView::clone() { return new CScriptVarDataView(*this); }
+void CScriptVarDataView::getReferences(vector<CScriptVar*> &Refs) {
+	CScriptVarObject::getReferences(Refs);
+	Refs.push_back(buffer.getVar());
+}
+void CScriptVarDataView::forkReferences(CScriptVarForker &Forker) {
+	CScriptVarObject::forkReferences(Forker);
+	Forker.forkPtr(buffer);
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+/// helpers
+//////////////////////////////////////////////////////////////////////////
+
+/// ToIndex of ECMA-262 limited to uint32_t - throws a RangeError if Arg is not a valid index
+static uint32_t scToIndex(const CFunctionsScopePtr &c, const CScriptVarPtr &Arg, const char *What) {
+	if(Arg->isUndefined()) return 0;
+	CNumber n = Arg->toNumber();
+	if(n.isNaN()) return 0;
+	if(n.isInt32() && n.toInt32() >= 0) return uint32_t(n.toInt32());
+	double d = n.toDouble();
+	d = d < 0 ? ceil(d) : floor(d);
+	if(d < 0 || d > 4294967295.0) c->throwError(RangeError, string("invalid ") + What);
+	return uint32_t(d);
+}
+/// the relative index of slice & subarray - negative values counts from the end
+static uint32_t scRelativeIndex(const CScriptVarPtr &Arg, uint32_t Length, uint32_t Default) {
+	if(Arg->isUndefined()) return Default;
+	CNumber n = Arg->toNumber();
+	if(n.isNaN()) return 0;
+	double d = n.toDouble();
+	d = d < 0 ? ceil(d) : floor(d);
+	if(d < 0) return d + Length < 0 ? 0 : uint32_t(d + Length);
+	return d > Length ? Length : uint32_t(d);
+}
+static CScriptVarArrayBufferPtr scNewArrayBuffer(const CFunctionsScopePtr &c, uint32_t ByteLength) {
+	CScriptVarArrayBufferPtr buffer = ::newScriptVarArrayBuffer(c->getContext(), ByteLength);
+	if(buffer->getByteLength() != ByteLength)
+		c->throwError(RangeError, "out of memory for ArrayBuffer");
+	return buffer;
+}
+static void scConstructorCalledAsFunction(const CFunctionsScopePtr &c, void *data) {
+	c->throwError(TypeError, string("calling a builtin ") + (const char *)data + " constructor without new is forbidden");
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+/// ArrayBuffer
+//////////////////////////////////////////////////////////////////////////
+
+static void scArrayBuffer_Constructor(const CFunctionsScopePtr &c, void *data) {
+	c->setReturnVar(scNewArrayBuffer(c, scToIndex(c, c->getArgument(0), "array length")));
+}
+static void scArrayBuffer_isView(const CFunctionsScopePtr &c, void *data) {
+	CScriptVarPtr arg = c->getArgument(0);
+	c->setReturnVar(c->constScriptVar(arg->isTypedArray() || CScriptVarDataViewPtr(arg)));
+}
+static void scArrayBuffer_prototype_slice(const CFunctionsScopePtr &c, void *data) {
+	CScriptVarArrayBufferPtr This(c->getArgument("this"));
+	if(!This) c->throwError(TypeError, "ArrayBuffer.prototype.slice called on incompatible Object");
+	uint32_t len = This->getByteLength();
+	uint32_t begin = scRelativeIndex(c->getArgument(0), len, 0);
+	uint32_t end = scRelativeIndex(c->getArgument(1), len, len);
+	uint32_t newLen = end > begin ? end - begin : 0;
+	CScriptVarArrayBufferPtr ret = scNewArrayBuffer(c, newLen);
+	memcpy(ret->getData(), This->getData()+begin, newLen);
+	c->setReturnVar(ret);
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+/// Int8Array ... Float64Array
+//////////////////////////////////////////////////////////////////////////
+
+/// new TypedArray(length), new TypedArray(typedArray), new TypedArray(arrayLike) or new TypedArray(buffer [, byteOffset [, length]])
+static void scTypedArray_Constructor(const CFunctionsScopePtr &c, void *data) {
+	CTinyJS *context = c->getContext();
+	TYPEDARRAY_KIND kind = TYPEDARRAY_KIND((intptr_t)data);
+	uint32_t elementSize = TYPEDARRAY_ELEMENT_SIZE[kind];
+	CScriptVarPtr arg0 = c->getArgument(0);
+	if(!arg0->isObject()) {
+		uint32_t length = scToIndex(c, arg0, "typed array length");
+		if(length > uint32_t(-1) / elementSize) c->throwError(RangeError, "invalid typed array length");
+		c->setReturnVar(::newScriptVarTypedArray(context, kind, scNewArrayBuffer(c, length*elementSize), 0, length));
+	} else if(arg0->isArrayBuffer()) {
+		CScriptVarArrayBufferPtr buffer(arg0);
+		uint32_t byteOffset = scToIndex(c, c->getArgument(1), "typed array offset");
+		if(byteOffset % elementSize)
+			c->throwError(RangeError, string("start offset of ") + TYPEDARRAY_NAME[kind] + " should be a multiple of " + int2string(elementSize));
+		if(byteOffset > buffer->getByteLength())
+			c->throwError(RangeError, "start offset is outside the bounds of the buffer");
+		uint32_t length;
+		CScriptVarPtr arg2 = c->getArgument(2);
+		if(arg2->isUndefined()) {
+			if((buffer->getByteLength() - byteOffset) % elementSize)
+				c->throwError(RangeError, string("byte length of ") + TYPEDARRAY_NAME[kind] + " should be a multiple of " + int2string(elementSize));
+			length = (buffer->getByteLength() - byteOffset) / elementSize;
+		} else {
+			length = scToIndex(c, arg2, "typed array length");
+			if(uint64_t(byteOffset) + uint64_t(length)*elementSize > buffer->getByteLength())
+				c->throwError(RangeError, "invalid typed array length");
+		}
+		c->setReturnVar(::newScriptVarTypedArray(context, kind, buffer, byteOffset, length));
+	} else if(arg0->isTypedArray()) {
+		CScriptVarTypedArrayPtr source(arg0);
+		uint32_t length = source->getLength();
+		if(length > uint32_t(-1) / elementSize) c->throwError(RangeError, "invalid typed array length");
+		CScriptVarTypedArrayPtr ret = ::newScriptVarTypedArray(context, kind, scNewArrayBuffer(c, length*elementSize), 0, length);
+		if(source->getKind() == kind)
+			memcpy(ret->getData(), source->getData(), length*elementSize);
+		else
+			for(uint32_t i=0; i<length; ++i) ret->setElement(i, source->getElement(i));
+		c->setReturnVar(ret);
+	} else { // array-like Object
+		uint32_t length = arg0->isArray() ? arg0->getArrayLength() : scToIndex(c, arg0->findChildWithPrototypeChain("length").getter()->getVarPtr(), "typed array length");
+		if(length > uint32_t(-1) / elementSize) c->throwError(RangeError, "invalid typed array length");
+		CScriptVarTypedArrayPtr ret = ::newScriptVarTypedArray(context, kind, scNewArrayBuffer(c, length*elementSize), 0, length);
+		for(uint32_t i=0; i<length; ++i) {
+			CScriptVarLinkWorkPtr element = arg0->findChildWithPrototypeChain(i);
+			if(element) ret->setElement(i, element.getter()->getVarPtr()->toNumber());
+			else ret->setElement(i, CNumber(NaN));
+		}
+		c->setReturnVar(ret);
+	}
+}
+/// typedArray.subarray(begin, end) - a new view of the same buffer
+static void scTypedArray_prototype_subarray(const CFunctionsScopePtr &c, void *data) {
+	CScriptVarTypedArrayPtr This(c->getArgument("this"));
+	if(!This) c->throwError(TypeError, "subarray method called on incompatible Object");
+	uint32_t len = This->getLength();
+	uint32_t begin = scRelativeIndex(c->getArgument(0), len, 0);
+	uint32_t end = scRelativeIndex(c->getArgument(1), len, len);
+	c->setReturnVar(::newScriptVarTypedArray(c->getContext(), This->getKind(), This->getBuffer(), This->getByteOffset()+begin*This->getElementSize(), end > begin ? end - begin : 0));
+}
+/// typedArray.set(source, offset) - copies the elements of an array or a typed array
+static void scTypedArray_prototype_set(const CFunctionsScopePtr &c, void *data) {
+	CScriptVarTypedArrayPtr This(c->getArgument("this"));
+	if(!This) c->throwError(TypeError, "set method called on incompatible Object");
+	CScriptVarPtr source = c->getArgument(0);
+	uint32_t offset = scToIndex(c, c->getArgument(1), "offset");
+	if(source->isTypedArray()) {
+		CScriptVarTypedArrayPtr Source(source);
+		uint32_t length = Source->getLength();
+		if(uint64_t(offset) + length > This->getLength()) c->throwError(RangeError, "source is too large");
+		if(Source->getKind() == This->getKind())
+			memmove((uint8_t*)This->getData()+offset*This->getElementSize(), Source->getData(), length*This->getElementSize());
+		else if(Source->getBuffer() == This->getBuffer()) { // overlapping with conversion - copy the source first
+			vector<CNumber> tmp(length);
+			for(uint32_t i=0; i<length; ++i) tmp[i] = Source->getElement(i);
+			for(uint32_t i=0; i<length; ++i) This->setElement(offset+i, tmp[i]);
+		} else
+			for(uint32_t i=0; i<length; ++i) This->setElement(offset+i, Source->getElement(i));
+	} else {
+		uint32_t length = source->isArray() ? source->getArrayLength() : scToIndex(c, source->findChildWithPrototypeChain("length").getter()->getVarPtr(), "length");
+		if(uint64_t(offset) + length > This->getLength()) c->throwError(RangeError, "source is too large");
+		for(uint32_t i=0; i<length; ++i) {
+			CScriptVarLinkWorkPtr element = source->findChildWithPrototypeChain(i);
+			This->setElement(offset+i, element ? element.getter()->getVarPtr()->toNumber() : CNumber(NaN));
+		}
+	}
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+/// DataView
+//////////////////////////////////////////////////////////////////////////
+
+static void scDataView_Constructor(const CFunctionsScopePtr &c, void *data) {
+	CScriptVarArrayBufferPtr buffer(c->getArgument(0));
+	if(!buffer) c->throwError(TypeError, "first argument to DataView constructor must be an ArrayBuffer");
+	uint32_t byteOffset = scToIndex(c, c->getArgument(1), "byteOffset");
+	if(byteOffset > buffer->getByteLength())
+		c->throwError(RangeError, "start offset is outside the bounds of the buffer");
+	CScriptVarPtr arg2 = c->getArgument(2);
+	uint32_t byteLength = arg2->isUndefined() ? buffer->getByteLength() - byteOffset : scToIndex(c, arg2, "byteLength");
+	if(uint64_t(byteOffset) + byteLength > buffer->getByteLength())
+		c->throwError(RangeError, "invalid DataView length");
+	c->setReturnVar(::newScriptVarDataView(c->getContext(), buffer, byteOffset, byteLength));
+}
+
+static inline bool isLittleEndianHost() { uint16_t v = 1; return *(uint8_t*)&v == 1; }
+/// copies Size bytes and swaps the byte-order if LittleEndian differs from the byte-order of the host
+static inline void scDataView_copy(uint8_t *Dest, const uint8_t *Src, uint32_t Size, bool LittleEndian) {
+	if(LittleEndian == isLittleEndianHost())
+		memcpy(Dest, Src, Size);
+	else
+		for(uint32_t i=0; i<Size; ++i) Dest[i] = Src[Size-1-i];
+}
+static uint8_t *scDataView_data(const CFunctionsScopePtr &c, uint32_t Size) {
+	CScriptVarDataViewPtr This(c->getArgument("this"));
+	if(!This) c->throwError(TypeError, "DataView method called on incompatible Object");
+	uint32_t byteOffset = scToIndex(c, c->getArgument(0), "byteOffset");
+	if(uint64_t(byteOffset) + Size > This->getByteLength())
+		c->throwError(RangeError, "offset is outside the bounds of the DataView");
+	return This->getData() + byteOffset;
+}
+template<typename T> static void scDataView_get(const CFunctionsScopePtr &c, void *data) {
+	uint8_t *p = scDataView_data(c, sizeof(T));
+	T value;
+	scDataView_copy((uint8_t*)&value, p, sizeof(T), c->getArgument(1)->toBoolean());
+	c->setReturnVar(c->newScriptVar(CNumber(value)));
+}
+/// the conversion of the value is the same as for the elements of a typed array
+template<typename T> static inline T scDataView_value(const CNumber &Value) { return T(typedArrayToUint32(Value)); }
+template<> inline float scDataView_value<float>(const CNumber &Value) { return float(Value.toDouble()); }
+template<> inline double scDataView_value<double>(const CNumber &Value) { return Value.toDouble(); }
+template<typename T> static void scDataView_set(const CFunctionsScopePtr &c, void *data) {
+	uint8_t *p = scDataView_data(c, sizeof(T));
+	T value = scDataView_value<T>(c->getArgument(1)->toNumber());
+	scDataView_copy(p, (uint8_t*)&value, sizeof(T), c->getArgument(2)->toBoolean());
+	c->setReturnVar(c->constScriptVar(Undefined));
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+/// Register Functions
+//////////////////////////////////////////////////////////////////////////
+
+// added on first access of DataView.prototype
+static void installDataViewPrototype(CTinyJS *tinyJS, const CScriptVarPtr &) {
+#define DATAVIEW_PROTOTYPE_NATIVE(NAME, T) \
+	tinyJS->addNative("function DataView.prototype.get"#NAME"(byteOffset, littleEndian)", scDataView_get<T>, 0, SCRIPTVARLINK_BUILDINDEFAULT); \
+	tinyJS->addNative("function DataView.prototype.set"#NAME"(byteOffset, value, littleEndian)", scDataView_set<T>, 0, SCRIPTVARLINK_BUILDINDEFAULT)
+	DATAVIEW_PROTOTYPE_NATIVE(Int8, int8_t);
+	DATAVIEW_PROTOTYPE_NATIVE(Uint8, uint8_t);
+	DATAVIEW_PROTOTYPE_NATIVE(Int16, int16_t);
+	DATAVIEW_PROTOTYPE_NATIVE(Uint16, uint16_t);
+	DATAVIEW_PROTOTYPE_NATIVE(Int32, int32_t);
+	DATAVIEW_PROTOTYPE_NATIVE(Uint32, uint32_t);
+	DATAVIEW_PROTOTYPE_NATIVE(Float32, float);
+	DATAVIEW_PROTOTYPE_NATIVE(Float64, double);
+#undef DATAVIEW_PROTOTYPE_NATIVE
+}
+
+extern "C" void _registerTypedArrayFunctions(CTinyJS *tinyJS) {
+	CScriptVarPtr var = tinyJS->addNative("function ArrayBuffer(length)", scConstructorCalledAsFunction, (void*)"ArrayBuffer", SCRIPTVARLINK_CONSTANT);
+	tinyJS->arrayBufferPrototype = var->findChild(TINYJS_PROTOTYPE_CLASS);
+	tinyJS->arrayBufferPrototype->addChild(TINYJS_CONSTRUCTOR_VAR, var, SCRIPTVARLINK_BUILDINDEFAULT);
+	tinyJS->addNative("function ArrayBuffer.__constructor__(length)", scArrayBuffer_Constructor, 0, SCRIPTVARLINK_CONSTANT);
+	tinyJS->addNative("function ArrayBuffer.isView(arg)", scArrayBuffer_isView, 0, SCRIPTVARLINK_BUILDINDEFAULT);
+	tinyJS->addNative("function ArrayBuffer.prototype.slice(begin, end)", scArrayBuffer_prototype_slice, 0, SCRIPTVARLINK_BUILDINDEFAULT);
+
+	CScriptVarPtr subarray, set;
+	for(int kind=0; kind<TYPEDARRAY_KIND_COUNT; ++kind) {
+		string name = TYPEDARRAY_NAME[kind];
+		var = tinyJS->addNative("function "+name+"(arg, byteOffset, length)", scConstructorCalledAsFunction, (void*)TYPEDARRAY_NAME[kind], SCRIPTVARLINK_CONSTANT);
+		CScriptVarPtr prototype = tinyJS->typedArrayPrototypes[kind] = var->findChild(TINYJS_PROTOTYPE_CLASS);
+		prototype->addChild(TINYJS_CONSTRUCTOR_VAR, var, SCRIPTVARLINK_BUILDINDEFAULT);
+		prototype->addChild("valueOf", tinyJS->objectPrototype_valueOf, SCRIPTVARLINK_BUILDINDEFAULT);
+		prototype->addChild("toString", tinyJS->objectPrototype_toString, SCRIPTVARLINK_BUILDINDEFAULT);
+		var->addChild("BYTES_PER_ELEMENT", var->newScriptVar(TYPEDARRAY_ELEMENT_SIZE[kind]), SCRIPTVARLINK_CONSTANT);
+		prototype->addChild("BYTES_PER_ELEMENT", var->newScriptVar(TYPEDARRAY_ELEMENT_SIZE[kind]), SCRIPTVARLINK_CONSTANT);
+		tinyJS->addNative("function "+name+".__constructor__(arg, byteOffset, length)", scTypedArray_Constructor, (void*)(intptr_t)kind, SCRIPTVARLINK_CONSTANT);
+		if(subarray) {
+			prototype->addChild("subarray", subarray, SCRIPTVARLINK_BUILDINDEFAULT);
+			prototype->addChild("set", set, SCRIPTVARLINK_BUILDINDEFAULT);
+		} else {
+			subarray = tinyJS->addNative("function "+name+".prototype.subarray(begin, end)", scTypedArray_prototype_subarray, 0, SCRIPTVARLINK_BUILDINDEFAULT);
+			set = tinyJS->addNative("function "+name+".prototype.set(source, offset)", scTypedArray_prototype_set, 0, SCRIPTVARLINK_BUILDINDEFAULT);
+		}
+	}
+
+	var = tinyJS->addNative("function DataView(buffer, byteOffset, byteLength)", scConstructorCalledAsFunction, (void*)"DataView", SCRIPTVARLINK_CONSTANT);
+	tinyJS->dataViewPrototype = var->findChild(TINYJS_PROTOTYPE_CLASS);
+	tinyJS->dataViewPrototype->addChild(TINYJS_CONSTRUCTOR_VAR, var, SCRIPTVARLINK_BUILDINDEFAULT);
+	tinyJS->addNative("function DataView.__constructor__(buffer, byteOffset, byteLength)", scDataView_Constructor, 0, SCRIPTVARLINK_CONSTANT);
+	tinyJS->addLazyNatives(tinyJS->dataViewPrototype, installDataViewPrototype);
+}
@@ -0,0 +1,352 @@
+/*
+ * 42TinyJS
+ *
+ * A fork of TinyJS with the goal to makes a more JavaScript/ECMA compliant engine
+ *
+ * Authored By Armin Diedering <armin@diedering.de>
+ *
+ * Copyright (C) 2010-2015 ardisoft
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Vector - reductions and elementwise operations over typed arrays
+ *
+ *   Vector.sum(v), Vector.min(v), Vector.max(v), Vector.dot(a, b)
+ *   Vector.scale(v, k), Vector.add(a, b), Vector.fill(v, x), Vector.clamp(v, lo, hi)
+ *
+ * The elementwise operations works in-place and returns the first argument.
+ * Float64Array and Float32Array are processed by SSE2 or AVX2 kernels (selected at runtime, see
+ * config.h VECTOR-KERNELS), all other kinds by the scalar kernels. The kernels computes in double
+ * and the sums are accumulated in more than one lane, so the last bits of sum and dot can differ
+ * from a loop in JS.
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include "TinyJS.h"
+
+#ifdef HAVE_SIMD_X86
+#	include <emmintrin.h>
+#	ifdef HAVE_SIMD_AVX2
+#		include <immintrin.h>
+#	endif
+#	ifdef _MSC_VER
+#		include <intrin.h>
+#	endif
+#endif
+
+using namespace std;
+
+//////////////////////////////////////////////////////////////////////////
+/// kernels
+//////////////////////////////////////////////////////////////////////////
+
+namespace vector_scalar {
+	struct V {
+		typedef double vd;
+		enum { W = 1 };
+		static vd zero() { return 0.0; }
+		static vd set1(double d) { return d; }
+		static vd add(vd a, vd b) { return a + b; }
+		static vd mul(vd a, vd b) { return a * b; }
+		static vd min(vd a, vd b) { return a < b ? a : b; }
+		static vd max(vd a, vd b) { return a > b ? a : b; }
+		static vd orNaN(vd nan, vd v) { return v != v ? 1.0 : nan; }
+		static bool anyNaN(vd nan) { return nan != 0.0; }
+		static double hsum(vd v) { return v; }
+		static double hmin(vd v) { return v; }
+		static double hmax(vd v) { return v; }
+		template<typename E> static vd load(const E *p) { return double(*p); }
+		template<typename E> static void store(E *p, vd v) { *p = E(v); }
+	};
+#	include "TinyJS_VectorKernels.h"
+}
+
+#ifdef HAVE_SIMD_X86
+namespace vector_sse2 {
+	struct V {
+		typedef __m128d vd;
+		enum { W = 2 };
+		static vd zero() { return _mm_setzero_pd(); }
+		static vd set1(double d) { return _mm_set1_pd(d); }
+		static vd add(vd a, vd b) { return _mm_add_pd(a, b); }
+		static vd mul(vd a, vd b) { return _mm_mul_pd(a, b); }
+		static vd min(vd a, vd b) { return _mm_min_pd(a, b); }
+		static vd max(vd a, vd b) { return _mm_max_pd(a, b); }
+		static vd orNaN(vd nan, vd v) { return _mm_or_pd(nan, _mm_cmpunord_pd(v, v)); }
+		static bool anyNaN(vd nan) { return _mm_movemask_pd(nan) != 0; }
+		static double hsum(vd v) { return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v))); }
+		static double hmin(vd v) { return _mm_cvtsd_f64(_mm_min_sd(v, _mm_unpackhi_pd(v, v))); }
+		static double hmax(vd v) { return _mm_cvtsd_f64(_mm_max_sd(v, _mm_unpackhi_pd(v, v))); }
+		static vd load(const double *p) { return _mm_loadu_pd(p); }
+		static vd load(const float *p) { return _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64((const __m128i*)p))); }
+		static void store(double *p, vd v) { _mm_storeu_pd(p, v); }
+		static void store(float *p, vd v) { _mm_storel_epi64((__m128i*)p, _mm_castps_si128(_mm_cvtpd_ps(v))); }
+	};
+#	include "TinyJS_VectorKernels.h"
+}
+
+#ifdef HAVE_SIMD_AVX2
+#	if defined(__clang__)
+#		pragma clang attribute push (__attribute__((target("avx2"))), apply_to = function)
+#	elif defined(__GNUC__)
+#		pragma GCC push_options
+#		pragma GCC target("avx2")
+#	endif
+namespace vector_avx2 {
+	struct V {
+		typedef __m256d vd;
+		enum { W = 4 };
+		static vd zero() { return _mm256_setzero_pd(); }
+		static vd set1(double d) { return _mm256_set1_pd(d); }
+		static vd add(vd a, vd b) { return _mm256_add_pd(a, b); }
+		static vd mul(vd a, vd b) { return _mm256_mul_pd(a, b); }
+		static vd min(vd a, vd b) { return _mm256_min_pd(a, b); }
+		static vd max(vd a, vd b) { return _mm256_max_pd(a, b); }
+		static vd orNaN(vd nan, vd v) { return _mm256_or_pd(nan, _mm256_cmp_pd(v, v, _CMP_UNORD_Q)); }
+		static bool anyNaN(vd nan) { return _mm256_movemask_pd(nan) != 0; }
+		static __m128d lo(vd v) { return _mm256_castpd256_pd128(v); }
+		static __m128d hi(vd v) { return _mm256_extractf128_pd(v, 1); }
+		static double hsum(vd v) { __m128d s = _mm_add_pd(lo(v), hi(v)); return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s))); }
+		static double hmin(vd v) { __m128d s = _mm_min_pd(lo(v), hi(v)); return _mm_cvtsd_f64(_mm_min_sd(s, _mm_unpackhi_pd(s, s))); }
+		static double hmax(vd v) { __m128d s = _mm_max_pd(lo(v), hi(v)); return _mm_cvtsd_f64(_mm_max_sd(s, _mm_unpackhi_pd(s, s))); }
+		static vd load(const double *p) { return _mm256_loadu_pd(p); }
+		static vd load(const float *p) { return _mm256_cvtps_pd(_mm_loadu_ps(p)); }
+		static void store(double *p, vd v) { _mm256_storeu_pd(p, v); }
+		static void store(float *p, vd v) { _mm_storeu_ps(p, _mm256_cvtpd_ps(v)); }
+	};
+#	include "TinyJS_VectorKernels.h"
+}
+#	if defined(__clang__)
+#		pragma clang attribute pop
+#	elif defined(__GNUC__)
+#		pragma GCC pop_options
+#	endif
+#endif /* HAVE_SIMD_AVX2 */
+#endif /* HAVE_SIMD_X86 */
+
+template<typename E> struct CVectorKernels {
+	double (*sum)(const E *p, size_t n);
+	double (*dot)(const E *a, const E *b, size_t n);
+	double (*minimum)(const E *p, size_t n);
+	double (*maximum)(const E *p, size_t n);
+	void (*scale)(E *p, size_t n, double k);
+	void (*add)(E *a, const E *b, size_t n);
+	void (*fill)(E *p, size_t n, double x);
+	void (*clamp)(E *p, size_t n, double lo, double hi);
+};
+#define VECTOR_KERNELS(NS, E) { NS::sum<E>, NS::dot<E>, NS::minimum<E>, NS::maximum<E>, NS::scale<E>, NS::add<E>, NS::fill<E>, NS::clamp<E> }
+
+struct CVectorKernelSet {
+	const char *name;
+	CVectorKernels<double> f64;
+	CVectorKernels<float> f32;
+};
+#define VECTOR_KERNEL_SET(NAME, NS) { NAME, VECTOR_KERNELS(NS, double), VECTOR_KERNELS(NS, float) }
+
+#if defined(HAVE_SIMD_AVX2)
+static bool cpuHasAVX2() {
+#	ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	if(info[0] < 7) return false;
+	__cpuid(info, 1);
+	if((info[2] & (1<<27)) == 0 || (info[2] & (1<<28)) == 0) return false; // OSXSAVE & AVX
+	if((_xgetbv(0) & 6) != 6) return false; // the OS saves the YMM-registers
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1<<5)) != 0;
+#	else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") != 0;
+#	endif
+}
+#endif
+
+/// the kernels for the CPU - selected on first use
+static const CVectorKernelSet &vectorKernels() {
+#ifdef HAVE_SIMD_X86
+	static const CVectorKernelSet sse2 = VECTOR_KERNEL_SET("sse2", vector_sse2);
+#	ifdef HAVE_SIMD_AVX2
+	static const CVectorKernelSet avx2 = VECTOR_KERNEL_SET("avx2", vector_avx2);
+	static const CVectorKernelSet &selected = cpuHasAVX2() ? avx2 : sse2;
+	return selected;
+#	else
+	return sse2;
+#	endif
+#else
+	static const CVectorKernelSet scalar = VECTOR_KERNEL_SET("scalar", vector_scalar);
+	return scalar;
+#endif
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+/// Vector
+//////////////////////////////////////////////////////////////////////////
+
+static CScriptVarTypedArrayPtr scVectorArgument(const CFunctionsScopePtr &c, int Idx, const char *Fnc) {
+	CScriptVarTypedArrayPtr ret(c->getArgument(Idx));
+	if(!ret) c->throwError(TypeError, string("Vector.") + Fnc + ": argument " + int2string(Idx+1) + " is not a typed array");
+	return ret;
+}
+static CScriptVarTypedArrayPtr scVectorSecondArgument(const CFunctionsScopePtr &c, const CScriptVarTypedArrayPtr &First, const char *Fnc) {
+	CScriptVarTypedArrayPtr ret = scVectorArgument(c, 1, Fnc);
+	if(ret->getLength() != First->getLength()) c->throwError(RangeError, string("Vector.") + Fnc + ": the typed arrays differ in length");
+	return ret;
+}
+static double scVectorNumber(const CFunctionsScopePtr &c, int Idx) {
+	return c->getArgument(Idx)->toNumber().toDouble();
+}
+
+/// the reductions of the integer kinds uses the scalar kernels directly
+#define VECTOR_REDUCE(RET, FNC, V) do { \
+	size_t n = V->getLength(); void *p = V->getData(); \
+	switch(V->getKind()) { \
+	case TypedArrayFloat64:			RET = vectorKernels().f64.FNC((const double*)p, n); break; \
+	case TypedArrayFloat32:			RET = vectorKernels().f32.FNC((const float*)p, n); break; \
+	case TypedArrayInt8:				RET = vector_scalar::FNC((const int8_t*)p, n); break; \
+	case TypedArrayUint8: \
+	case TypedArrayUint8Clamped:	RET = vector_scalar::FNC((const uint8_t*)p, n); break; \
+	case TypedArrayInt16:			RET = vector_scalar::FNC((const int16_t*)p, n); break; \
+	case TypedArrayUint16:			RET = vector_scalar::FNC((const uint16_t*)p, n); break; \
+	case TypedArrayInt32:			RET = vector_scalar::FNC((const int32_t*)p, n); break; \
+	case TypedArrayUint32:			RET = vector_scalar::FNC((const uint32_t*)p, n); break; \
+	} \
+} while(0)
+
+static void scVectorSum(const CFunctionsScopePtr &c, void *data) {
+	CScriptVarTypedArrayPtr v = scVectorArgument(c, 0, "sum");
+	double ret = 0;
+	VECTOR_REDUCE(ret, sum, v);
+	c->setReturnVar(c->newScriptVar(ret));
+}
+static void scVectorMin(const CFunctionsScopePtr &c, void *data) {
+	CScriptVarTypedArrayPtr v = scVectorArgument(c, 0, "min");
+	double ret = 0;
+	VECTOR_REDUCE(ret, minimum, v);
+	c->setReturnVar(c->newScriptVar(ret));
+}
+static void scVectorMax(const CFunctionsScopePtr &c, void *data) {
+	CScriptVarTypedArrayPtr v = scVectorArgument(c, 0, "max");
+	double ret = 0;
+	VECTOR_REDUCE(ret, maximum, v);
+	c->setReturnVar(c->newScriptVar(ret));
+}
+static void scVectorDot(const CFunctionsScopePtr &c, void *data) {
+	CScriptVarTypedArrayPtr a = scVectorArgument(c, 0, "dot");
+	CScriptVarTypedArrayPtr b = scVectorSecondArgument(c, a, "dot");
+	double ret = 0;
+	if(a->getKind() == b->getKind()) {
+		const void *q = b->getData();
+		switch(a->getKind()) {
+		case TypedArrayFloat64:	ret = vectorKernels().f64.dot((const double*)a->getData(), (const double*)q, a->getLength()); break;
+		case TypedArrayFloat32:	ret = vectorKernels().f32.dot((const float*)a->getData(), (const float*)q, a->getLength()); break;
+		default:
+			for(uint32_t i=0; i<a->getLength(); ++i) ret += a->getElement(i).toDouble() * b->getElement(i).toDouble();
+		}
+	} else
+		for(uint32_t i=0; i<a->getLength(); ++i) ret += a->getElement(i).toDouble() * b->getElement(i).toDouble();
+	c->setReturnVar(c->newScriptVar(ret));
+}
+
+static void scVectorScale(const CFunctionsScopePtr &c, void *data) {
+	CScriptVarTypedArrayPtr v = scVectorArgument(c, 0, "scale");
+	double k = scVectorNumber(c, 1);
+	switch(v->getKind()) {
+	case TypedArrayFloat64:	vectorKernels().f64.scale((double*)v->getData(), v->getLength(), k); break;
+	case TypedArrayFloat32:	vectorKernels().f32.scale((float*)v->getData(), v->getLength(), k); break;
+	default:
+		for(uint32_t i=0; i<v->getLength(); ++i) v->setElement(i, v->getElement(i).toDouble() * k);
+	}
+	c->setReturnVar(v);
+}
+static void scVectorAdd(const CFunctionsScopePtr &c, void *data) {
+	CScriptVarTypedArrayPtr a = scVectorArgument(c, 0, "add");
+	CScriptVarTypedArrayPtr b = scVectorSecondArgument(c, a, "add");
+	// the kernels reads ahead - overlapping views of the same buffer are added element by element
+	uint8_t *pa = (uint8_t*)a->getData(), *pb = (uint8_t*)b->getData();
+	bool overlapping = a->getBuffer() == b->getBuffer() && pb < pa && pa < pb + b->getLength()*b->getElementSize();
+	if(a->getKind() == b->getKind() && a->getKind() == TypedArrayFloat64 && !overlapping)
+		vectorKernels().f64.add((double*)pa, (const double*)pb, a->getLength());
+	else if(a->getKind() == b->getKind() && a->getKind() == TypedArrayFloat32 && !overlapping)
+		vectorKernels().f32.add((float*)pa, (const float*)pb, a->getLength());
+	else
+		for(uint32_t i=0; i<a->getLength(); ++i) a->setElement(i, a->getElement(i).toDouble() + b->getElement(i).toDouble());
+	c->setReturnVar(a);
+}
+static void scVectorFill(const CFunctionsScopePtr &c, void *data) {
+	CScriptVarTypedArrayPtr v = scVectorArgument(c, 0, "fill");
+	CNumber x = c->getArgument(1)->toNumber();
+	switch(v->getKind()) {
+	case TypedArrayFloat64:	vectorKernels().f64.fill((double*)v->getData(), v->getLength(), x.toDouble()); break;
+	case TypedArrayFloat32:	vectorKernels().f32.fill((float*)v->getData(), v->getLength(), x.toDouble()); break;
+	default:
+		if(v->getLength()) {
+			v->setElement(0, x);
+			// all integer-elements are equal - copy the bytes of the first one
+			uint8_t *p = (uint8_t*)v->getData();
+			uint32_t size = v->getElementSize(), bytes = v->getLength()*size;
+			for(uint32_t i=size; i<bytes; ++i) p[i] = p[i-size];
+		}
+	}
+	c->setReturnVar(v);
+}
+/// Vector.clamp(v, lo, hi) - each element is limited like Math.range(element, lo, hi)
+static void scVectorClamp(const CFunctionsScopePtr &c, void *data) {
+	CScriptVarTypedArrayPtr v = scVectorArgument(c, 0, "clamp");
+	double lo = scVectorNumber(c, 1), hi = scVectorNumber(c, 2);
+	if(!(lo <= hi)) c->throwError(RangeError, "Vector.clamp: invalid range");
+	switch(v->getKind()) {
+	case TypedArrayFloat64:	vectorKernels().f64.clamp((double*)v->getData(), v->getLength(), lo, hi); break;
+	case TypedArrayFloat32:	vectorKernels().f32.clamp((float*)v->getData(), v->getLength(), lo, hi); break;
+	default:
+		for(uint32_t i=0; i<v->getLength(); ++i) {
+			double x = v->getElement(i).toDouble();
+			if(x < lo) v->setElement(i, lo);
+			else if(x > hi) v->setElement(i, hi);
+		}
+	}
+	c->setReturnVar(v);
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+/// Register Functions
+//////////////////////////////////////////////////////////////////////////
+
+// added on first access of Vector
+static void installVectorFunctions(CTinyJS *tinyJS, const CScriptVarPtr &Vector) {
+	Vector->addChild("kernels", Vector->newScriptVar(vectorKernels().name), SCRIPTVARLINK_READONLY);
+	tinyJS->addNative("function Vector.sum(v)", scVectorSum, 0, SCRIPTVARLINK_BUILDINDEFAULT);
+	tinyJS->addNative("function Vector.min(v)", scVectorMin, 0, SCRIPTVARLINK_BUILDINDEFAULT);
+	tinyJS->addNative("function Vector.max(v)", scVectorMax, 0, SCRIPTVARLINK_BUILDINDEFAULT);
+	tinyJS->addNative("function Vector.dot(a,b)", scVectorDot, 0, SCRIPTVARLINK_BUILDINDEFAULT);
+	tinyJS->addNative("function Vector.scale(v,k)", scVectorScale, 0, SCRIPTVARLINK_BUILDINDEFAULT);
+	tinyJS->addNative("function Vector.add(a,b)", scVectorAdd, 0, SCRIPTVARLINK_BUILDINDEFAULT);
+	tinyJS->addNative("function Vector.fill(v,x)", scVectorFill, 0, SCRIPTVARLINK_BUILDINDEFAULT);
+	tinyJS->addNative("function Vector.clamp(v,lo,hi)", scVectorClamp, 0, SCRIPTVARLINK_BUILDINDEFAULT);
+}
+
+extern "C" void _registerVectorFunctions(CTinyJS *tinyJS) {
+	tinyJS->addLazyNatives(tinyJS->getRoot()->addChild("Vector", tinyJS->newScriptVar(Object), SCRIPTVARLINK_BUILDINDEFAULT), installVectorFunctions);
+}
@@ -0,0 +1,130 @@
+/*
+ * 42TinyJS
+ *
+ * A fork of TinyJS with the goal to makes a more JavaScript/ECMA compliant engine
+ *
+ * Authored By Armin Diedering <armin@diedering.de>
+ *
+ * Copyright (C) 2010-2015 ardisoft
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// The kernels of TinyJS_VectorFunctions.cpp written against the vector-type V.
+// This file has intentionally no include-guard. It is included once for each instruction-set
+// inside a namespace that defines V (and with the target-options of the instruction-set),
+// so each instruction-set gets its own instantiations of the kernels.
+//
+// V provides: the double-vector vd with W lanes, zero, set1, add, mul, min, max (min/max returns the
+// second operand if one of the operands is NaN), orNaN/anyNaN to track NaNs, hsum/hmin/hmax and
+// load/store of W doubles or floats. All computations are done in double.
+
+template<typename E> static double sum(const E *p, size_t n) {
+	V::vd acc0 = V::zero(), acc1 = V::zero();
+	size_t i = 0;
+	for(; i+2*V::W <= n; i += 2*V::W) {
+		acc0 = V::add(acc0, V::load(p+i));
+		acc1 = V::add(acc1, V::load(p+i+V::W));
+	}
+	for(; i+V::W <= n; i += V::W)
+		acc0 = V::add(acc0, V::load(p+i));
+	double ret = V::hsum(V::add(acc0, acc1));
+	for(; i < n; ++i) ret += double(p[i]);
+	return ret;
+}
+
+template<typename E> static double dot(const E *a, const E *b, size_t n) {
+	V::vd acc0 = V::zero(), acc1 = V::zero();
+	size_t i = 0;
+	for(; i+2*V::W <= n; i += 2*V::W) {
+		acc0 = V::add(acc0, V::mul(V::load(a+i), V::load(b+i)));
+		acc1 = V::add(acc1, V::mul(V::load(a+i+V::W), V::load(b+i+V::W)));
+	}
+	for(; i+V::W <= n; i += V::W)
+		acc0 = V::add(acc0, V::mul(V::load(a+i), V::load(b+i)));
+	double ret = V::hsum(V::add(acc0, acc1));
+	for(; i < n; ++i) ret += double(a[i]) * double(b[i]);
+	return ret;
+}
+
+/// the minimum (Max==false) or maximum. NaN if one of the elements is NaN, +/-Infinity if n is 0
+template<typename E> static double extremum(const E *p, size_t n, bool Max) {
+	double ret = Max ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
+	V::vd acc = V::set1(ret), nan = V::zero();
+	size_t i = 0;
+	if(Max)
+		for(; i+V::W <= n; i += V::W) { V::vd v = V::load(p+i); nan = V::orNaN(nan, v); acc = V::max(acc, v); }
+	else
+		for(; i+V::W <= n; i += V::W) { V::vd v = V::load(p+i); nan = V::orNaN(nan, v); acc = V::min(acc, v); }
+	if(V::anyNaN(nan)) return std::numeric_limits<double>::quiet_NaN();
+	ret = Max ? V::hmax(acc) : V::hmin(acc);
+	for(; i < n; ++i) {
+		double v = double(p[i]);
+		if(v != v) return v;
+		if(Max ? v > ret : v < ret) ret = v;
+	}
+	if(ret == 0) // the compares doesn't distinguish -0 and +0 - the maximum of -0 and +0 is +0, the minimum is -0
+		for(i = 0; i < n; ++i) {
+			double v = double(p[i]);
+			if(v == 0 && (1/v < 0) != Max) return v;
+		}
+	return ret;
+}
+template<typename E> static double minimum(const E *p, size_t n) { return extremum(p, n, false); }
+template<typename E> static double maximum(const E *p, size_t n) { return extremum(p, n, true); }
+
+/// p[i] *= k
+template<typename E> static void scale(E *p, size_t n, double k) {
+	V::vd f = V::set1(k);
+	size_t i = 0;
+	for(; i+V::W <= n; i += V::W)
+		V::store(p+i, V::mul(V::load(p+i), f));
+	for(; i < n; ++i) p[i] = E(double(p[i]) * k);
+}
+
+/// a[i] += b[i]
+template<typename E> static void add(E *a, const E *b, size_t n) {
+	size_t i = 0;
+	for(; i+V::W <= n; i += V::W)
+		V::store(a+i, V::add(V::load(a+i), V::load(b+i)));
+	for(; i < n; ++i) a[i] = E(double(a[i]) + double(b[i]));
+}
+
+/// p[i] = x
+template<typename E> static void fill(E *p, size_t n, double x) {
+	V::vd v = V::set1(x);
+	size_t i = 0;
+	for(; i+V::W <= n; i += V::W)
+		V::store(p+i, v);
+	for(; i < n; ++i) p[i] = E(x);
+}
+
+/// p[i] = Math.range(p[i], lo, hi) - NaN's are kept. lo must not be greater than hi
+template<typename E> static void clamp(E *p, size_t n, double lo, double hi) {
+	V::vd l = V::set1(lo), h = V::set1(hi);
+	size_t i = 0;
+	for(; i+V::W <= n; i += V::W)
+		V::store(p+i, V::min(h, V::max(l, V::load(p+i))));
+	for(; i < n; ++i) {
+		double v = double(p[i]);
+		if(v < lo) p[i] = E(lo);
+		else if(v > hi) p[i] = E(hi);
+	}
+}
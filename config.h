@@ -65,12 +65,13 @@
 
 /* REGEXP-SUPPORT
  * ==============
- * The RegExp-support needs c++11, boost-regex or TR1-regex
+ * By default the built-in regex-engine is used (see TinyJS_RegExp.h). It needs no external library
+ * and runs in linear time (a Pike-VM) - only patterns with back-references or lookaheads are backtracked
  * To deactivate this stuff define NO_REGEXP 
  */
 //#define NO_REGEXP
 
-/* if NO_REGEXP not defined <regex> is included and std::regex is used
+/* instead of the built-in engine
  * you can define HAVE_BOOST_REGEX and <boost/regex.hpp> is included and boost::regex is used
  */
 //#define HAVE_BOOST_REGEX
@@ -83,6 +84,34 @@
  */
 //#define HAVE_CXX_REGEX
 
+/* the built-in engine runs patterns with back-references on a backtracking-VM. A search that needs more
+ * than REGEX_BACKTRACK_LIMIT steps throws an error instead of running for a very long time (default 10000000)
+ */
+//#define REGEX_BACKTRACK_LIMIT 10000000
+
+
+//////////////////////////////////////////////////////////////////////////
+
+/* VALUE-CACHES
+ * ============
+ * Each context shares the vars of the 256 single-char strings and of the integers
+ * from VALUE_CACHE_INT_MIN to VALUE_CACHE_INT_MAX (newScriptVar returns these instead of new vars).
+ * The char-table is allocated with the context, the integer-table in blocks of 256 on first use
+ * and the vars are created on first use.
+ * The default range is -1024..65535, to disable the integer-cache define VALUE_CACHE_INT_MAX below VALUE_CACHE_INT_MIN
+ */
+//#define VALUE_CACHE_INT_MIN -1024
+//#define VALUE_CACHE_INT_MAX 65535
+
+//////////////////////////////////////////////////////////////////////////
+
+/* VECTOR-KERNELS
+ * ==============
+ * The Vector-functions (see TinyJS_VectorFunctions.cpp) processes Float64Array and Float32Array
+ * with SSE2- or AVX2-kernels on x86/x64. AVX2 is used only if the CPU supports it (checked at runtime).
+ * To use always the scalar kernels define NO_SIMD
+ */
+//#define NO_SIMD
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -106,6 +135,12 @@
  */
 //#define NO_GENERATORS
 
+/* on non-Windows systems the generators runs as coroutines (ucontext) on own stacks
+ * in the thread of the caller. Otherwise each generator runs in its own thread.
+ * To force the threads define NO_UCONTEXT_COROUTINES
+ */
+//#define NO_UCONTEXT_COROUTINES
+
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -164,6 +199,17 @@
 #	define NO_THREADING
 #endif
 
+#if !defined(NO_GENERATORS) && !defined(NO_UCONTEXT_COROUTINES) && !defined(_WIN32)
+#	define HAVE_UCONTEXT_COROUTINES 1
+#endif
+
+#if !defined(NO_SIMD) && (defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#	define HAVE_SIMD_X86 1
+#	if (defined(__GNUC__) && __GNUC__ >= 5) || defined(__clang__) || _MSC_VER >= 1800 // Visual Studio 2013
+#		define HAVE_SIMD_AVX2 1
+#	endif
+#endif
+
 #if !defined(NO_POOL_ALLOCATOR) && defined(NO_THREADING)
 #pragma message("\n***********************************************************************\n\
 * You have defined NO_THREADING and not defined NO_POOL_ALLOCATOR\n\
@@ -194,6 +240,10 @@
 #	define SPINLOCK_IN_POOL_ALLOCATOR 1
 #endif
 
+#if !defined(NO_THREADING) && (__cplusplus >= 201103L || isCXX0x(4,5) || _MSC_VER >= 1700 /* Visual Studio 2012 */)
+#	define HAVE_CXX11_ATOMIC 1
+#endif
+
 #if __cplusplus >= 201103L || isCXX0x(4,6) ||  _MSC_VER > 1800 // > Visual Studio 2013
 #	define NOEXPECT noexpect
 #else
@@ -206,16 +256,8 @@
 #	define MEMBER_DEFAULT
 #endif
 
-#if !defined(NO_REGEXP) && !defined(HAVE_BOOST_REGEX) && !defined(HAVE_TR1_REGEX) && !defined(HAVE_CXX_REGEX) && __cplusplus < 201103L
-#	define NO_REGEXP
-#	if _MSC_VER > 1500 // Visual Studio 2010 and above
-#		undef NO_REGEXP
-#	elif _MSC_VER == 1500 && _MSC_FULL_VER >= 150030729 // Visual Studio 2008 SP1
-#		undef NO_REGEXP
-#		define HAVE_TR1_REGEX // untested
-#	elif isCXX0x(4,6) // a better idea?? testet with libstdc++ shipped with GCC 4.6.3
-#		undef NO_REGEXP
-#	endif
+#if !defined(NO_REGEXP) && !defined(HAVE_BOOST_REGEX) && !defined(HAVE_TR1_REGEX) && !defined(HAVE_CXX_REGEX)
+#	define HAVE_NATIVE_REGEX 1
 #endif
 #if defined(NO_REGEXP)
 #pragma message("\n***********************************************************************\n\
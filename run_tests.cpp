@@ -69,6 +69,7 @@
 #include <fstream>
 #include <cstdio>
 #include <cstring>
+#include <ctime>
 
 //#define WITH_TIME_LOGGER
 //#define INSANE_MEMORY_DEBUG
@@ -240,6 +241,49 @@ public:
 void js_print(const CFunctionsScopePtr &v, void *) {
 	printf("> %s\n", v->getArgument("text")->toString().c_str());
 }
+// the internal counters of the engine - the tests uses it to check the caches and the memory management
+void js_engineStats(const CFunctionsScopePtr &v, void *) {
+	CTinyJS *s = v->getContext();
+	CScriptVarPtr stats = s->newScriptVar(Object);
+	stats->addChild("vars", s->newScriptVar(s->getVarCount()));
+	stats->addChild("shapes", s->newScriptVar(s->getShapeCount()));
+	stats->addChild("atoms", s->newScriptVar(CScriptAtom::getCount()));
+	stats->addChild("inlineCacheHits", s->newScriptVar(double(s->getInlineCacheStats().hits)));
+	stats->addChild("inlineCacheMisses", s->newScriptVar(double(s->getInlineCacheStats().misses)));
+	v->setReturnVar(stats);
+}
+// setCollectorBudget(budget) - the tests of the incremental cycle-collector
+void js_setCollectorBudget(const CFunctionsScopePtr &v, void *) {
+	v->getContext()->setCollectorBudget(v->getArgument("budget")->toNumber().toUInt32());
+}
+bool useBytecode = true;
+bool leakReport = false;
+bool forkTests = false;
+CScriptSnapshot *snapshot = 0; // the tests are run in forks of this if forkTests is set
+void init_context(CTinyJS &s) {
+  s.setUseBytecode(useBytecode);
+  s.addNative("function print(text)", &js_print, 0);
+  s.addNative("function engineStats()", &js_engineStats, 0);
+  s.addNative("function setCollectorBudget(budget)", &js_setCollectorBudget, 0);
+#ifdef HAVE_NATIVE_REGEX
+  s.getRoot()->addChild("nativeRegExp", s.constScriptVar(true)); // the tests of the built-in regex-engine
+#else
+  s.getRoot()->addChild("nativeRegExp", s.constScriptVar(false));
+#endif
+  s.getRoot()->addChild("result", s.newScriptVar(0));
+}
+void print_leaks(CTinyJS &s) {
+  CScriptHeapReport report = s.getHeapReport();
+  if(!report.unreachable) return;
+  printf("LEAKS: %u of %u vars unreachable\n", report.unreachable, report.count);
+  for(CScriptHeapReport::TYPES_t::iterator it = report.types.begin(); it != report.types.end(); ++it) {
+    if(!it->second.unreachable) continue;
+    printf("   %s: %u", it->first.c_str(), it->second.unreachable);
+    for(size_t i=0; i<it->second.samples.size(); ++i)
+      printf(" %p", it->second.samples[i]);
+    printf("\n");
+  }
+}
 bool run_test(const char *filename) {
   printf("TEST %s ", filename);
 #ifdef _WIN32
@@ -264,14 +308,27 @@ bool run_test(const char *filename) {
   buffer[actualRead]=0;
   buffer[size]=0;
   fclose(file);
+#ifdef NO_REGEXP
+  // a test marked with "// needs regular expressions" is skipped - its regexp-literals can not even be tokenized
+  if(strstr(buffer, "// needs regular expressions")) {
+    printf("SKIP - built without regular expressions\n");
+    delete[] buffer;
+    return true;
+  }
+#endif
 
-  CTinyJS s;
-  s.addNative("function print(text)", &js_print, 0);
+  if(forkTests && !snapshot) {
+    CTinyJS init;
+    init_context(init);
+    snapshot = new CScriptSnapshot(init);
+  }
+  CTinyJS *context = snapshot ? new CTinyJS(*snapshot) : new CTinyJS;
+  CTinyJS &s = *context;
+  if(!snapshot) init_context(s);
 
 //  registerFunctions(&s);
 //  registerMathFunctions(&s);
 //  registerStringFunctions(&s);
-  s.getRoot()->addChild("result", s.newScriptVar(0));
 #ifdef WITH_TIME_LOGGER
   TimeLoggerCreate(Test, true, filename);
 #endif
@@ -305,11 +362,143 @@ bool run_test(const char *filename) {
 
 	 printf("FAIL - symbols written to %s\n", fn);
   }
+  if(leakReport)
+    print_leaks(s);
 
+  delete context;
   delete[] buffer;
   return pass;
 }
 
+// measures the construction of a context alone, of a context running a short script and of a fork
+void benchmark_construction() {
+  const int count = 1000;
+  clock_t start = clock();
+  for(int i=0; i<count; i++) {
+    CTinyJS s;
+  }
+  double construct = double(clock() - start) * 1000.0 / CLOCKS_PER_SEC / count;
+  start = clock();
+  for(int i=0; i<count; i++) {
+    CTinyJS s;
+    s.execute("var result = Math.sqrt(16) + 'abc'.length;");
+  }
+  double script = double(clock() - start) * 1000.0 / CLOCKS_PER_SEC / count;
+  printf("BENCHMARK construction: %.3f ms per context, %.3f ms with a short script\n", construct, script);
+  CTinyJS init;
+  CScriptSnapshot snapshot(init);
+  start = clock();
+  for(int i=0; i<count; i++) {
+    CTinyJS s(snapshot);
+  }
+  double fork = double(clock() - start) * 1000.0 / CLOCKS_PER_SEC / count;
+  printf("BENCHMARK fork: %.3f ms per fork of a snapshot with %u vars\n", fork, snapshot.getVarCount());
+}
+
+// the heap report counts the cycles not collected so far and the vars held only from C++
+bool run_heap_report() {
+  printf("TEST heap report ");
+  CTinyJS s;
+  init_context(s);
+  s.execute(
+    "var keep = { a:{} }; keep.a.back = keep;\n"
+    "for(var i=0; i<100; i++) { var c = { n:i }; c.self = c; }\n"
+    "c = 0;\n");
+  CScriptHeapReport before = s.getHeapReport(false, 4);
+  CScriptHeapReport::Type &objects = before.types["Object"];
+  bool pass = before.count == s.getVarCount() && before.unreachable >= 100 &&
+    objects.unreachable >= 100 && objects.samples.size() == 4;
+  CScriptVarPtr held = s.getRoot()->findChild("keep")->getVarPtr();
+  s.execute("keep = 0;");
+  CScriptHeapReport leaked = s.getHeapReport();
+  pass = pass && leaked.count == s.getVarCount() && leaked.unreachable >= 2 &&
+    leaked.types["Object"].unreachable == 2 && leaked.types["Object"].samples.size() == 2;
+  held.clear();
+  CScriptHeapReport after = s.getHeapReport();
+  pass = pass && after.unreachable == 0 && after.count == s.getVarCount() && after.count < before.count;
+  if(pass)
+    printf("PASS\n");
+  else
+    printf("FAIL - %u/%u/%u unreachable vars\n", before.unreachable, leaked.unreachable, after.unreachable);
+  return pass;
+}
+
+#ifndef NO_THREADING
+// forks of one snapshot running at the same time in more threads - the forks shares the function-bodies,
+// the strings and the compiled regexps of the snapshot
+static const char *threadedForksLibrary =
+  "var lib = {\n"
+#ifndef NO_REGEXP
+  "  mail: /(\\w+)@(\\w+)\\.com/g,\n"
+  "  count: function(text) { var n = 0, m; this.mail.lastIndex = 0; while((m = this.mail.exec(text))) n += m[1].length + m[2].length; return n; },\n"
+  "  strings: function() { return 'a-b--c'.split(/-+/).join(',') == 'a,b,c' && 'x1y22z'.replace('1', '-').match(/\\d+/)[0] == '22'; },\n"
+#else
+  "  count: function(text) { var n = 0, list = text.split(' '); for(var i=0; i<list.length; i++) { var at = list[i].indexOf('@'); if(at > 0) n += list[i].lastIndexOf('.') - 1; } return n; },\n"
+  "  strings: function() { return 'a-b--c'.split('-').join(',') == 'a,b,,c' && 'x1y22z'.replace('1', '-').indexOf('22') == 3; },\n"
+#endif
+  "  sum: function(list) { var s = 0; for(var i=0; i<list.length; i++) s += list[i].v; return s; }\n"
+  "};\n"
+  "function counter() { var n = 0; return function() { return ++n; }; }\n"
+  "function check(seed) {\n"
+  "  var list = [], text = '', next = counter();\n"
+  "  for(var i=0; i<200; i++) list.push({ v:i+seed });\n"
+  "  for(var i=0; i<50; i++) text += 'ab' + i + '@host' + seed + '.com ';\n"
+  "  while(next() < 100);\n"
+  "  try { throw new Error('e' + seed); } catch(e) { if(e.message != 'e' + seed) return false; }\n"
+  "  return lib.sum(list) == 19900 + 200*seed && lib.count(text) == 440 && next() == 101 && lib.strings();\n"
+  "}\n";
+class CForkThread : public CScriptThread {
+public:
+  CForkThread(CScriptSnapshot &Snapshot, int Seed) : snapshot(Snapshot), seed(Seed), passed(0) {}
+  virtual int ThreadFnc() {
+    for(int i=0; i<threadedForksRuns; i++) {
+      CTinyJS s(snapshot);
+      std::ostringstream code;
+      code << "result = check(" << (seed+i) % 10 << ");";
+      try {
+        s.execute(code.str());
+        if(s.getRoot()->findChild("result")->toBoolean()) passed++;
+      } catch (CScriptException &e) {
+        printf("%s\n", e.toString().c_str());
+      }
+    }
+    return 0;
+  }
+  static const int threadedForksRuns = 25;
+  CScriptSnapshot &snapshot;
+  int seed;
+  int passed;
+};
+bool run_threaded_forks() {
+  printf("TEST threaded forks ");
+  CTinyJS init;
+  init_context(init);
+  try {
+    init.execute(threadedForksLibrary);
+  } catch (CScriptException &e) {
+    printf("%s\n", e.toString().c_str());
+    printf("FAIL\n");
+    return false;
+  }
+  CScriptSnapshot snapshot(init);
+  const int count = 4;
+  CForkThread *threads[count];
+  for(int i=0; i<count; i++) (threads[i] = new CForkThread(snapshot, i))->Run();
+  int passed = 0;
+  for(int i=0; i<count; i++) {
+    threads[i]->Stop();
+    passed += threads[i]->passed;
+    delete threads[i];
+  }
+  bool pass = passed == count*CForkThread::threadedForksRuns;
+  if(pass)
+    printf("PASS\n");
+  else
+    printf("FAIL - %d of %d forks passed\n", passed, count*CForkThread::threadedForksRuns);
+  return pass;
+}
+#endif
+
 int main(int argc, char **argv)
 {
 #ifdef INSANE_MEMORY_DEBUG
@@ -317,20 +506,43 @@ int main(int argc, char **argv)
 #endif
   printf("TinyJS test runner\n");
   printf("USAGE:\n");
-  printf("   ./run_tests [-k] tests/test001.js [tests/42tests/test002.js]   : run tests\n");
-  printf("   ./run_tests [-k]                      : run all tests\n");
+  printf("   ./run_tests [-k] [-w] [-l] [-f] tests/test001.js [tests/42tests/test002.js]   : run tests\n");
+  printf("   ./run_tests [-k] [-w] [-l] [-f]            : run all tests\n");
   printf("   -k needs press enter at the end of runs\n");
+  printf("   -w runs without bytecode (token-walker only)\n");
+  printf("   -l reports the vars leaked by each test\n");
+  printf("   -f runs each test in a fork of a snapshot\n");
+  printf("   -b measures the construction time of a context and of a fork\n");
+  printf("   -t runs forks of a snapshot in more threads at the same time (also done after all tests)\n");
   int arg_num = 1;
   bool runs = false;
   for(; arg_num<argc; arg_num++) {
     if(argv[arg_num][0] == '-') {
       if(strcmp(argv[arg_num], "-k")==0)
 			end.active = true;
+      else if(strcmp(argv[arg_num], "-w")==0)
+			useBytecode = false;
+      else if(strcmp(argv[arg_num], "-l")==0)
+			leakReport = true;
+      else if(strcmp(argv[arg_num], "-f")==0)
+			forkTests = true;
+      else if(strcmp(argv[arg_num], "-b")==0) {
+			benchmark_construction();
+			runs=true;
+		}
+#ifndef NO_THREADING
+      else if(strcmp(argv[arg_num], "-t")==0) {
+			run_threaded_forks();
+			runs=true;
+		}
+#endif
 	 } else {
 		run_test(argv[arg_num]);
 		runs=true;
 	 }
   }
+  delete snapshot; // created by run_test in -f mode
+  snapshot = 0;
   if (runs) {
     return 0;
   }
@@ -363,6 +575,16 @@ int main(int argc, char **argv)
         test_num++;
     }
   }
+  delete snapshot;
+  snapshot = 0;
+  if(run_heap_report())
+    passed++;
+  count++;
+#ifndef NO_THREADING
+  if(run_threaded_forks())
+    passed++;
+  count++;
+#endif
   printf("Done. %d tests, %d pass, %d fail\n", count, passed, count-passed);
 #ifdef WITH_TIME_LOGGER
   TimeLoggerLogprint(Tests);
@@ -0,0 +1,34 @@
+// array-element-tests
+
+// dense
+var a1 = [];
+for(var i=0; i<100; i++) a1[i] = i;
+var r1 = a1.length == 100 && a1[99] == 99 && a1["42"] == 42;
+
+// holey and sparse
+var a2 = [1,,3];
+a2[1000000] = 4;
+var k2 = [];
+for(var k in a2) k2.push(k);
+var r2 = a2.length == 1000001 && a2[1] === undefined && k2.length == 3 && Object.keys(a2).length == 3;
+
+// delete of the last element shrinks the length
+var a3 = [1,2,3];
+delete a3[2];
+var r3 = a3.length == 2 && a3.join(",") == "1,2";
+
+// sparse elements becomes dense
+var a4 = [];
+a4[80] = 80;
+for(var i=0; i<80; i++) a4[i] = i;
+var s4 = 0;
+for(var i=0; i<a4.length; i++) s4 += a4[i];
+var r4 = a4.length == 81 && s4 == 3240;
+
+// property-descriptors of elements
+var a5 = [5,6];
+Object.freeze(a5);
+a5[0] = 9;
+var r5 = a5[0] == 5 && Object.isFrozen(a5);
+
+result = r1 && r2 && r3 && r4 && r5;
@@ -0,0 +1,67 @@
+// regular expressions
+// needs regular expressions - the cases that std::regex, tr1 or boost does not handle like ECMAScript runs
+// only on the built-in engine (nativeRegExp is set by run_tests)
+
+// groups, lastIndex and unmatched groups
+var re = /(\d+)-(x)?(\d+)/g;
+var m = re.exec("a 12-34 b");
+var r1 = m[0] == "12-34" && m[1] == "12" && m[2] === undefined && m[3] == "34" && m.index == 2 && re.lastIndex == 7;
+
+// global match and empty matches
+var r2 = "aXbXc".match(/X/g).length == 2 && "abc".match(/x*/g).length == 4;
+
+// replace with patterns and callbacks
+var r3 = "john smith".replace(/(\w+)\s(\w+)/, "$2, $1") == "smith, john"
+	&& "a1b22".replace(/\d+/g, function(d) { return "<" + d.length + ">"; }) == "a<1>b<2>"
+	&& "abc".replace(/x*/g, "-") == "-a-b-c-";
+
+// split
+var r4 = "a, b,c".split(/\s*,\s*/).join("|") == "a|b|c" && "abc".split(/(?:)/).length == 3;
+
+// flags, classes, backreferences and lookaheads
+var r5 = (!nativeRegExp || /^b$/m.test("a\nb\nc")) && !/^b$/.test("a\nb\nc") && /ABC/i.test("xabcx")
+	&& /(a+)b\1/.test("aabaa") && /foo(?!bar)/.exec("foobar foobaz").index == 7
+	&& /[^\s\d]+/.exec("  42 word")[0] == "word" && /a{2,3}/.exec("aaaa")[0] == "aaa"
+	&& /a+?/.exec("aaa")[0] == "a";
+
+// no exponential backtracking - the back-references are limited to a number of steps
+var s = "", r6 = true;
+for(var i=0; i<1000; i++) s += "x";
+if(nativeRegExp) {
+	r6 = !/(x*)*y/.test(s) && !/(x+x+)+y/.test(s) && /^(a+)+\1$/.test("aaaa");
+	try { /^(a+)+\1$/.test("aaaaaaaaaaaaaaaaaaaaaaaaaaaaaab"); r6 = false; } catch(e) { r6 = r6 && e instanceof SyntaxError; }
+}
+
+// invalid patterns throws a SyntaxError
+var r7 = false;
+try { new RegExp("(a"); } catch(e) { r7 = e instanceof SyntaxError; }
+
+// zero-width assertions that only match at the end of the input
+var r8 = /$/.exec("abc").index == 3 && /\B/.exec("ab").index == 1 && /()$/.exec("ab").index == 2
+	&& /\b$/.exec("ab").index == 2 && /$/m.exec("ab").index == 2 && /\bc/.exec("ab c").index == 3
+	&& "abc".replace(/$/, "!") == "abc!" && "ab".split(/\B/).join(",") == "a,b"
+	&& /\b/g.exec(" ab").index == 1 && !/a$/y.test("ab");
+
+// negated classes with ignoreCase exclude both cases (results checked with node)
+var r9 = /[^a]+/i.exec("..ba")[0] == "..b" && /[^a]{2,3}?\d??/i.exec("bab") === null && /[^A-C]+/i.exec("abcdC")[0] == "d"
+	&& /[^\W]+/i.exec("..aB")[0] == "aB";
+
+// the captures are unset at the begin of each iteration and an optional iteration must not be empty (checked with node)
+var r10 = true;
+if(nativeRegExp) { // std::regex rejects (\1x|a) - so it is compiled at runtime
+	var sp = "--x  a".split(/(a*){1,2}b*?/), bm = new RegExp("(?:(\\1x|a)b)+").exec("xabb "), zm = /(z)((a+)?(b+)?(c))*/.exec("zaacbbbcac");
+	r10 = /(a|)*/.exec("")[1] === undefined && /(?:(a)|b)+/.exec("ab")[1] === undefined && /(a)+/.exec("aa")[1] == "a"
+		&& sp.length == 11 && sp[9] == "a" && sp[7] === ""
+		&& bm[0] == "ab" && bm[1] == "a" && zm[3] == "a" && zm[4] === undefined && zm[5] == "c"
+		&& /(a?)?b/.exec("b")[1] === undefined && (m = /(?:(a)|(b)){2}/.exec("ab"))[1] === undefined && m[2] == "b";
+}
+
+// lookaheads run as linear-time sub-matches and keep their captures, empty matches in split/replace/match (checked with node)
+var xs = ""; for(var i=0;i<30;i++) xs += "x";
+var la = /(?=(a+))a*b\1/.exec("baaabac"), ln = /(?!(a)b)a(.)/.exec("abac");
+var r11 = la[0] == "aba" && la[1] == "a" && ln[0] == "ac" && ln[1] === undefined && ln[2] == "c" && /(?=(\d+))\d/.exec("a123")[1] == "123"
+	&& (!nativeRegExp || /(?=(x+x+)+y)/.test(xs) === false && /x+?(\.?(\D*?|\d\d?\w??\d)){0,}/.exec("  A xabc")[0] == "xabc")
+	&& "".split(/|/).length == 0 && "".split(/a/).length == 1 && "".split("").length == 0
+	&& "11".replace(new RegExp("", "g"), "<$&>") == "<>1<>1<>" && "11".match(new RegExp("", "g")).length == 3;
+
+result = r1 && r2 && r3 && r4 && r5 && r6 && r7 && r8 && r9 && r10 && r11;
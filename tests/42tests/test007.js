@@ -0,0 +1,27 @@
+// strings: ropes and substrings
+
+// concatenation in a loop (rope) and access of the content
+var s = "";
+for(var i=0; i<1000; i++) s += "ab" + i;
+var r1 = s.length == 4890 && s.charAt(2) == "0" && s.indexOf("ab999") == 4885 && (s + "!").lastIndexOf("!") == 4890;
+
+// substrings of substrings
+var t = "  hello world, hello tiny-js  ".trim();
+var u = t.slice(6, 13).substr(0, 5);
+var r2 = t == "hello world, hello tiny-js" && u == "world" && u.length == 5 && u.charCodeAt(4) == 100
+	&& t.substring(13, 6) == "world, " && "   ".trim() == "" && "  x".trimLeft() == "x";
+
+// split and comparison
+var parts = t.split(" ");
+var r3 = parts.length == 4 && parts[3] == "tiny-js" && parts[3] < parts[1] && parts[0] == parts[2]
+	&& "a1b2c3".split("b").join(",") == "a1,2c3" && "a1b2c3".split("3").length == 2 && t.split("").length == t.length
+	&& "abc".localeCompare("abd") == -1 && "b".localeCompare("a") == 1;
+
+// small slices of a big string are copies - the big buffer is released with the big string
+var big = "0123456789"; for(var i=0; i<10; i++) big += big;
+var small = [big.substr(10235, 3), big.slice(5, 9), big.substring(0, 2), big.split("9", 2)[1], big.charAt(10239)];
+var rest = big; while(rest.length > 7) rest = rest.substr(rest.length >> 1);
+big = 0;
+var r4 = small.join(",") == "567,5678,01,012345678,9" && rest == "56789" && small[1].substr(1, 2) == "67";
+
+result = r1 && r2 && r3 && r4;
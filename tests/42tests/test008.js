@@ -0,0 +1,53 @@
+// typed arrays, ArrayBuffer and DataView
+
+// element access and conversion
+var f = new Float64Array(4);
+for(var i=0; i<f.length; i++) f[i] = i * 1.5;
+f[1] += 10;
+f[2]++;
+var u8 = new Uint8Array([1, 255, 256, -1, 3.7]);
+var c8 = new Uint8ClampedArray([300, -5, 1.5, 2.5]);
+var i16 = new Int16Array(2);
+i16[0] = 40000; i16["1"] = -2;
+var r1 = f.length == 4 && f[1] == 11.5 && f[2] == 4 && f[3] == 4.5 && f[4] === undefined
+	&& u8.join == undefined && u8.toString() == "1,255,0,255,3" && c8.toString() == "255,0,2,2"
+	&& i16[0] == -25536 && i16[1] == -2 && Int32Array.BYTES_PER_ELEMENT == 4 && i16.byteLength == 4;
+
+// out-of-range writes are ignored
+u8[10] = 5;
+var r2 = u8[10] === undefined && u8.length == 5;
+
+// views share the buffer
+var buf = new ArrayBuffer(8);
+var all = new Uint8Array(buf);
+var words = new Uint16Array(buf, 2, 2);
+var sub = all.subarray(4, -2);
+words[1] = 0x0102;
+sub.set([7, 8]);
+var copy = new Uint8Array(all);
+copy[0] = 99;
+var r3 = buf.byteLength == 8 && words.byteOffset == 2 && sub.length == 2 && all[4] == 7 && all[5] == 8
+	&& (words[1] == 0x0807 || words[1] == 0x0708) && all[0] == 0 && copy[0] == 99 && copy[4] == 7
+	&& ArrayBuffer.isView(sub) && !ArrayBuffer.isView(buf) && buf.slice(4).byteLength == 4;
+
+// DataView with explicit byte-order
+var dv = new DataView(new ArrayBuffer(8));
+dv.setUint16(0, 0x1234);
+dv.setInt32(2, -2, true);
+dv.setFloat32(4, 1.5);
+var r4 = dv.getUint8(0) == 0x12 && dv.getUint8(1) == 0x34 && dv.getUint16(0, true) == 0x3412
+	&& dv.getFloat32(4) == 1.5 && dv.byteLength == 8;
+var rangeError = false;
+try { dv.getFloat64(4); } catch(e) { rangeError = e instanceof RangeError; }
+
+// the elements are enumerable own properties
+function compact(json) { return json.split(" ").join("").split("\n").join(""); }
+var e = new Int16Array([5, -6, 7]);
+e.extra = 1;
+var forIn = [];
+for(var k in e) forIn.push(k);
+var r5 = forIn.join(",") == "0,1,2,extra" && Object.keys(e).join(",") == "0,1,2,extra"
+	&& compact(JSON.stringify(e)) == "[5,-6,7]" && compact(JSON.stringify({ e:e })) == "{e:[5,-6,7]}"
+	&& e.hasOwnProperty(2) && !e.hasOwnProperty(3) && (1 in e) && !(3 in e) && Object.keys(new Float64Array(0)).length == 0;
+
+result = r1 && r2 && r3 && r4 && rangeError && r5;
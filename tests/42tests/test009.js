@@ -0,0 +1,60 @@
+// Vector-kernels over typed arrays
+
+// reductions - the lengths are not a multiple of the vector-width to test the tails
+var n = 1003;
+var d = new Float64Array(n), f = new Float32Array(n), i32 = new Int32Array(n), u8 = new Uint8Array(n);
+var s = 0, q = 0, mn = Infinity, mx = -Infinity;
+for(var i=0; i<n; i++) {
+	var x = (i * 7) % 101 - 50.5;
+	d[i] = f[i] = x; i32[i] = i - 500; u8[i] = i;
+	s += x; q += x * x;
+	if(x < mn) mn = x;
+	if(x > mx) mx = x;
+}
+var r1 = Vector.sum(d) == s && Vector.sum(f) == s && Vector.min(d) == mn && Vector.max(f) == mx
+	&& Vector.dot(d, d) == q && Vector.dot(f, d) == q && Vector.sum(i32) == 1003
+	&& Vector.min(i32) == -500 && Vector.max(i32) == 502 && Vector.max(u8) == 255
+	&& Vector.sum(new Float64Array(0)) == 0 && Vector.min(new Float32Array(0)) == Infinity;
+
+// NaN
+var keep = d[1001];
+d[1001] = NaN;
+var r2 = isNaN(Vector.min(d)) && isNaN(Vector.max(d)) && isNaN(Vector.sum(d));
+d[1001] = keep;
+
+// signed zeros like Math.max and Math.min - also in the vector-part of the arrays
+var zp = Vector.fill(new Float64Array(9), -0), zn = Vector.fill(new Float32Array(9), 0);
+zp[2] = 0; zn[5] = -0;
+var r7 = 1/Vector.max(new Float64Array([-0, 0])) == Infinity && 1/Vector.max(new Float64Array([0, -0])) == Infinity
+	&& 1/Vector.min(new Float64Array([0, -0])) == -Infinity && 1/Vector.min(new Float64Array([-0, 0])) == -Infinity
+	&& 1/Vector.max(zp) == Infinity && 1/Vector.min(zp) == -Infinity && 1/Vector.min(zn) == -Infinity && 1/Vector.max(zn) == Infinity
+	&& 1/Vector.max(new Float64Array([-0, -0])) == -Infinity && 1/Vector.min(new Int32Array([0, 0])) == Infinity;
+
+// elementwise operations works in-place and returns the array
+var a = new Float64Array([1, 2, 3, 4, 5, 6, 7, 8, 9]), b = new Float64Array([9, 8, 7, 6, 5, 4, 3, 2, 1]);
+var r3 = Vector.add(a, b) === a && a.toString() == "10,10,10,10,10,10,10,10,10"
+	&& Vector.scale(a, 0.5).toString() == "5,5,5,5,5,5,5,5,5"
+	&& Vector.fill(b, 2.5).toString() == "2.5,2.5,2.5,2.5,2.5,2.5,2.5,2.5,2.5"
+	&& Vector.fill(new Int16Array(5), -3).toString() == "-3,-3,-3,-3,-3"
+	&& Vector.scale(new Uint8Array([1, 2, 200]), 2).toString() == "2,4,144";
+
+// clamp like Math.range
+var c = new Float32Array([-5, 0.5, 5, NaN, 1, 2, 3, -1, 10]);
+Vector.clamp(c, 0, 2);
+var ci = Vector.clamp(new Int8Array([-100, 0, 100]), -10, 10);
+var r4 = c[0] == 0 && c[1] == 0.5 && c[2] == 2 && isNaN(c[3]) && c.toString() == "0,0.5,2,NaN,1,2,2,0,2"
+	&& ci.toString() == "-10,0,10";
+
+// overlapping views of the same buffer
+var buf = new Float64Array([1, 1, 1, 1, 1, 1]);
+Vector.add(buf.subarray(1), buf.subarray(0, 5));
+var r5 = buf.toString() == "1,2,3,4,5,6";
+
+// errors
+var r6 = 0;
+try { Vector.sum([1, 2]); } catch(e) { if(e instanceof TypeError) r6++; }
+try { Vector.dot(a, new Float64Array(2)); } catch(e) { if(e instanceof RangeError) r6++; }
+try { Vector.clamp(a, 2, 1); } catch(e) { if(e instanceof RangeError) r6++; }
+r6 = r6 == 3 && (Vector.kernels == "avx2" || Vector.kernels == "sse2" || Vector.kernels == "scalar");
+
+result = r1 && r2 && r3 && r4 && r5 && r6 && r7;
@@ -0,0 +1,60 @@
+// Map, Set and WeakMap
+
+// keys by SameValueZero - no string-conversion
+var m = new Map();
+var o = {}, f = function() {};
+m.set(1, "one").set("1", "string one").set(o, "object").set(f, "function").set(NaN, "nan").set(-0, "zero");
+m.set(null, "null").set(undefined, "undefined").set(true, "true");
+var r1 = m.size == 9 && m.get(1) == "one" && m.get("1") == "string one" && m.get(o) == "object" && m.get({}) === undefined
+	&& m.get(f) == "function" && m.get(NaN) == "nan" && m.get(0) == "zero" && m.get(+0) == "zero" && m.get(1.0) == "one"
+	&& m.get(null) == "null" && m.get(undefined) == "undefined" && m.get(true) == "true" && m.get(false) === undefined
+	&& m.get("o" + "ne") === undefined && m.has(2 / 2) && !m.has("2");
+m.set(1, "ONE");
+var r2 = m.size == 9 && m.get(1) == "ONE" && m["delete"](o) && !m["delete"](o) && m.size == 8 && !m.has(o);
+
+// insertion-order - also after deleting and re-adding
+var big = new Map();
+for(var i=0; i<1000; i++) big.set("k" + i, i);
+for(var i=0; i<1000; i+=2) big["delete"]("k" + i);
+big.set("k0", "again");
+var keys = [], sum = 0;
+for(var e of big) { keys.push(e[0]); sum += e[0] == "k0" ? 0 : e[1]; }
+var r3 = big.size == 501 && keys.length == 501 && keys[0] == "k1" && keys[499] == "k999" && keys[500] == "k0" && sum == 250000
+	&& big.get("k999") == 999 && big.get("k998") === undefined;
+
+// iterators see entries added while iterating and survive a rehash
+var s = new Set([3, 1, 3, 2]);
+var seen = "";
+for(var v of s) {
+	seen += v;
+	if(v == 3) for(var i=10; i<40; i++) { s.add(i); s["delete"](i - 1); }
+}
+var r4 = seen == "312" + "39" && s.size == 4 && s.has(39) && !s.has(10);
+
+// keys(), values(), entries() and forEach
+var m2 = new Map([["a", 1], ["b", 2]]);
+var ks = "", vs = "", es = "", fe = "";
+for(var k of m2.keys()) ks += k;
+for(var v of m2.values()) vs += v;
+for(var e of m2.entries()) es += e[0] + e[1];
+m2.forEach(function(value, key, map) { fe += key + value + (map === m2) + this.x; }, { x: "!" });
+var set2 = new Set("abc".split(""));
+var fs = "";
+set2.forEach(function(value, key) { fs += value + key; });
+m2.clear();
+var r5 = ks == "ab" && vs == "12" && es == "a1b2" && fe == "a1true!b2true!" && fs == "aabbcc" && m2.size == 0 && !m2.has("a");
+
+// WeakMap
+var w = new WeakMap(), k1 = {}, k2 = [];
+w.set(k1, 1).set(k2, 2);
+var r6 = w.get(k1) == 1 && w.has(k2) && w["delete"](k2) && !w.has(k2) && w.size === undefined;
+try { w.set("x", 1); r6 = false; } catch(e) { r6 = r6 && e instanceof TypeError; }
+try { Map(); r6 = false; } catch(e) { r6 = r6 && e instanceof TypeError; }
+
+// cycles through the entries and iterators are collected
+var cyc = new Map(), cycSet = new Set();
+cyc.set(cyc, cyc.entries()).set("set", cycSet);
+cycSet.add(cycSet.values()).add(cyc);
+cyc = cycSet = undefined;
+
+result = r1 && r2 && r3 && r4 && r5 && r6;
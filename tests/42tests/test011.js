@@ -0,0 +1,58 @@
+// objects with many properties (dictionary-mode)
+
+// many properties - lookup, overwrite and delete in the middle
+var o = {};
+for(var i=0; i<3000; i++) o["k" + i] = i;
+var r1 = o.k0 == 0 && o.k1234 == 1234 && o["k2999"] == 2999 && o.k3000 === undefined;
+for(var i=0; i<3000; i+=3) o["k" + i] = -i;
+for(var i=1; i<3000; i+=3) delete o["k" + i];
+var count = 0, sum = 0;
+for(var k in o) { count++; sum += o[k]; }
+var r2 = count == 2000 && Object.keys(o).length == 2000 && !("k1" in o) && o.k3 == -3 && o.k5 == 5 && o.hasOwnProperty("k2997");
+
+// re-add deleted properties
+for(var i=1; i<3000; i+=3) o["k" + i] = "again";
+var r3 = Object.keys(o).length == 3000 && o.k1 == "again" && o.k2998 == "again";
+
+// cached property access stays correct while the layout changes
+var p = {};
+for(var i=0; i<300; i++) p["p" + i] = i;
+var ok = true;
+for(var i=0; i<300; i++) {
+	if(p.p299 != 299) ok = false;
+	if(i < 299 && p["p" + i] != i) ok = false;
+	delete p["p" + i];
+	p["n" + i] = i;
+	if(i < 299 && p.p299 != 299) ok = false;
+}
+var r4 = ok && p.p299 === undefined && p.n299 == 299 && Object.keys(p).length == 300;
+
+// a deleted own property uncovers the prototype
+var proto = { f100:"proto" };
+var f = { __proto__:proto };
+for(var i=0; i<200; i++) f["f" + i] = i;
+var r5 = f.f100 == 100;
+delete f.f100;
+var r6 = f.f100 == "proto" && f.f199 == 199;
+
+// large objects from JSON.parse
+var json = "{";
+for(var i=0; i<1000; i++) json += (i ? ",\n" : "") + '"j' + i + '":' + i;
+var j = JSON.parse(json + "}");
+delete j.j500;
+var r7 = j.j0 == 0 && j.j999 == 999 && j.j500 === undefined && Object.keys(j).length == 999;
+
+// delete-heavy - the removed properties leaves holes, the insertion order is kept while they are compacted
+var h = {};
+for(var i=0; i<5000; i++) h["h" + i] = i;
+for(var i=0; i<5000; i++) if(i % 1000) delete h["h" + i];
+h.last = "last";
+function compact(json) { return json.split(" ").join("").split("\n").join(""); }
+var r8 = compact(JSON.stringify(h)) == '{h0:0,h1000:1000,h2000:2000,h3000:3000,h4000:4000,last:"last"}'
+	&& Object.keys(h).length == 6 && h.h4000 == 4000 && h.h4999 === undefined && !h.hasOwnProperty("h1");
+for(var i=0; i<5000; i+=1000) delete h["h" + i];
+var r9 = Object.keys(h).join(",") == "last" && compact(JSON.stringify(h)) == '{last:"last"}';
+Object.freeze(h);
+var r10 = Object.isFrozen(h);
+
+result = r1 && r2 && r3 && r4 && r5 && r6 && r7 && r8 && r9 && r10;
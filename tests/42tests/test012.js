@@ -0,0 +1,30 @@
+// call-frames: plain parameters, lazy arguments-object, default-values and destructuring
+
+function add(a, b) { return a + b; }
+function missing(a, b, c) { return c === undefined && b === undefined ? a : -1; }
+function count() { return arguments.length; }
+function extra(a) { return arguments[1] + arguments.length; }
+function viaEval(a) { return eval("arguments.length"); }
+function destructure(a) { var {length} = arguments; return length; }
+function shadow(arguments) { return arguments; }
+function nested(a) { return (function() { return arguments.length; })(1, 2, 3) + a; }
+var sum = 0;
+for(var i=0; i<100; i++) sum = add(sum, i);
+var r1 = sum == 4950 && missing(7) == 7 && count() == 0 && count(1, 2, 3) == 3 && extra(1, 10, 20) == 13
+	&& viaEval(1, 2) == 2 && destructure(1, 2) == 2 && shadow(42) == 42 && nested(1) == 4;
+
+// default-values and destructuring
+function def(a, b = a * 2, {x, y:[z]} = {x:1, y:[3]}) { return a + b + x + z + arguments.length; }
+var r2 = def(1) == 1+2+1+3+1 && def(1, 5, {x:10, y:[20]}) == 1+5+10+20+3;
+
+// apply, call, recursion and generators
+function fib(n) { return n < 2 ? n : fib(n-1) + fib(n-2); }
+function gen(n) { for(var i=0; i<n; i++) yield i; }
+var g = gen(3), gs = 0;
+for(var v in g) gs += v;
+var r3 = add.apply(null, [2, 3]) == 5 && add.call(null, 4) != add.call(null, 4) && fib(15) == 610 && gs == 3;
+
+// natives get their arguments as before
+var r4 = Math.max(1, 5, 3) == 5 && "abc".indexOf("c") == 2 && "abc".charAt(1) == "b";
+
+result = r1 && r2 && r3 && r4;
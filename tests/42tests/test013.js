@@ -0,0 +1,33 @@
+// natives with the fast calling-convention (Math and String)
+
+// missing and extra arguments
+var r1 = isNaN(Math.abs()) && Math.abs(-3, "ignored") == 3 && Math.max() == -Infinity && Math.min(4, 2, 8, 3) == 2
+	&& isNaN(Math.max(1, "x", 3)) && Math.pow(2, 10) == 1024 && Math.atan2(0, 1) == 0 && isNaN(Math.range(5, 3, 1))
+	&& Math.range(5, 1, 3) == 3;
+
+// this of String-natives
+var s = "Hello World";
+var r2 = s.charAt(4) == "o" && s.charAt() == "H" && s.charCodeAt(0) == 72 && s.indexOf("o") == 4 && s.lastIndexOf("o") == 7
+	&& s.indexOf("o", 5) == 7 && s.slice(-5) == "World" && s.substring(6, 0) == "Hello " && s.substr(6, 3) == "Wor"
+	&& s.concat("!", 1, 2) == "Hello World!12" && "  x ".trim() == "x" && s.toUpperCase() == "HELLO WORLD"
+	&& String.prototype.charAt.call(12345, 2) == "3" && String.prototype.concat.apply("a", ["b", "c"]) == "abc";
+
+// the generic variants get this as the first argument
+var r3 = String.charAt(s, 6) == "W" && String.concat(s, "!") == "Hello World!" && String.slice(s, 0, 5) == "Hello"
+	&& String.substring(s, 5, 0) == "Hello" && String.substr(s, 6) == "World" && String.indexOf(s, "l") == 2
+	&& String.trimLeft("  a ") == "a ";
+
+// split, replace and search
+var parts = "a,b,,c".split(",");
+var r4 = parts.length == 4 && parts[2] == "" && "a,b,c".split(",", 2).length == 2 && "abc".split("").length == 3
+	&& "aXbXc".replace("X", "-") == "a-bXc" && "aXbXc".replace("Y", "-") == "aXbXc"
+	&& "abc".replace("b", function(m) { return m.toUpperCase(); }) == "aBc"
+	&& "foo123bar".search("123") == 3 && "foo123bar".search("x") == -1;
+
+// errors of natives are catchable
+var e1 = false, e2 = false;
+try { String.prototype.charAt.call(undefined, 0); } catch(e) { e1 = e instanceof TypeError; }
+try { String.prototype.slice.call(null, 0); } catch(e) { e2 = e instanceof TypeError; }
+var r5 = e1 && e2;
+
+result = r1 && r2 && r3 && r4 && r5;
@@ -0,0 +1,24 @@
+// natives bound to plain C++-functions with CTinyJS::bindNative (Math.trunc, Math.fround, Math.imul, Math.clz32)
+
+var r1 = Math.trunc(4.7) == 4 && Math.trunc(-4.7) == -4 && Math.trunc("12.5") == 12 && isNaN(Math.trunc())
+	&& Math.trunc(Infinity) == Infinity && 1/Math.trunc(-0.5) == -Infinity;
+
+var r2 = Math.fround(5.5) == 5.5 && Math.fround(5.05) != 5.05 && Math.fround(0.1) == 0.10000000149011612 && isNaN(Math.fround("x"));
+
+// missing arguments are converted from undefined, additional arguments are ignored
+var r3 = Math.imul(3, 4) == 12 && Math.imul(-5, 12) == -60 && Math.imul(0xffff, 0x10001) == -1 && Math.imul(3) == 0
+	&& Math.imul("6", "7", 100) == 42;
+
+var r4 = Math.clz32(1) == 31 && Math.clz32(0) == 32 && Math.clz32() == 32 && Math.clz32(-1) == 0 && Math.clz32(0x10000) == 15;
+
+// the number and the names of the parameters come from the signature of the C++-function
+var r5 = Math.imul.length == 2 && Math.trunc.length == 1 && Math.fround.length == 1 && typeof Math.clz32 == "function"
+	&& Math.imul.toString() == "function imul(a, b) { [native code] }";
+
+// integer parameters wraps modulo 2^32 (ToInt32 / ToUint32)
+var r6 = Math.imul(0xffffffff, 5) == -5 && Math.imul(0x100000003, 2) == 6 && Math.imul(-0x80000001, 1) == 0x7fffffff
+	&& Math.imul(4294967296.7, 3) == 0 && Math.imul(NaN, 1) == 0 && Math.imul(Infinity, 1) == 0
+	&& Math.clz32(0x100000000) == 32 && Math.clz32(0x100000001) == 31 && Math.clz32(-0x100000000) == 32
+	&& Math.clz32(2.5) == 30 && Math.clz32(-Infinity) == 32;
+
+result = r1 && r2 && r3 && r4 && r5 && r6;
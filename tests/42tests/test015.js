@@ -0,0 +1,29 @@
+// lazy installed natives - each test-file runs in a new context, so the natives are not yet installed
+
+// the inline-cache of get is filled with an empty object, Object.prototype.abs must not be found for Math
+Object.prototype.abs = 1;
+function get(o) { return o.abs; }
+var r1 = get({}) == 1 && typeof get(Math) == "function" && get(Math)(-2) == 2;
+delete Object.prototype.abs;
+
+// the first access is an assignment
+JSON.stringify = function() { return "replaced"; };
+var r2 = JSON.stringify({}) == "replaced" && typeof JSON.parse == "function";
+
+// enumeration installs the natives
+var names = Object.getOwnPropertyNames(Vector).join(",");
+var r3 = names.indexOf("sum") >= 0 && names.indexOf("kernels") >= 0 && "dot" in Vector;
+
+// unknown names installs the natives too
+var r4 = Date["n"+"ow"]() > 0 && Date.prototype.hasOwnProperty("getFullYear") && new Date(2000, 0, 1).getFullYear() == 2000;
+
+// prototypes of primitives
+var r5 = "abc".charAt(1) == "b" && String.charAt("abc", 2) == "c" && "abc".indexOf("c") == 2
+	&& new DataView(new ArrayBuffer(4)).getInt8(0) == 0 && Object.keys({a:1}).length == 1;
+
+// freeze installs the natives before
+Object.freeze(Math);
+Math.sqrt = 0;
+var r6 = typeof Math.sqrt == "function" && Object.isFrozen(Math);
+
+result = r1 && r2 && r3 && r4 && r5 && r6;
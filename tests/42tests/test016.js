@@ -0,0 +1,39 @@
+// shapes (hidden classes) - objects built the same way share the shapes and the unused shapes are pruned
+
+// the same sequence of added properties reuses the shapes
+function Point(x, y) { this.x = x; this.y = y; }
+var points = [];
+var before = engineStats().shapes;
+for(var i=0; i<1000; i++) points.push(new Point(i, -i));
+for(var i=0; i<1000; i++) points.push({ x:i, y:-i });
+var r1 = engineStats().shapes - before <= 10 && points[999].x == 999 && points[1999].y == -999;
+
+// a different order is a different layout but the values stays in place
+var a = { x:1, y:2 }, b = { y:2, x:1 };
+var r2 = a.x == b.x && a.y == b.y && Object.keys(b).length == 2;
+
+// distinct computed keys on garbage objects - the unused shapes are pruned, so the shape-tree doesn't grow
+var keep = [];
+for(var i=0; i<100; i++) { var o = {}; o["keep" + i] = i; keep.push(o); }
+before = engineStats().shapes;
+for(var i=0; i<20000; i++) { var o = {}; o["key" + i] = i; o.x = i; }
+o = undefined;
+var r3 = engineStats().shapes - before < 5000;
+
+// the shapes of living objects are not pruned
+var r4 = true;
+for(var i=0; i<100; i++) {
+	keep[i].y = i;
+	if(keep[i]["keep" + i] != i || keep[i].y != i || Object.keys(keep[i]).length != 2) r4 = false;
+}
+keep = undefined;
+for(var i=0; i<20000; i++) { var o = {}; o["again" + i] = i; }
+var r5 = engineStats().shapes - before < 5000;
+
+// delete in the middle and re-add
+var d = { a:1, b:2, c:3 };
+delete d.b;
+d.b = 4;
+var r6 = Object.keys(d).length == 3 && d.a == 1 && d.b == 4 && d.c == 3;
+
+result = r1 && r2 && r3 && r4 && r5 && r6;
@@ -0,0 +1,50 @@
+// inline-caches of member-accesses and variable-lookups
+
+var PointProto = { len2:function() { return this.x*this.x + this.y*this.y; } };
+function Point(x, y) { return { __proto__:PointProto, x:x, y:y }; }
+
+// monomorphic - after the first miss each access is a hit
+var p = Point(3, 4);
+var sum = 0;
+var s0 = engineStats();
+for(var i=0; i<1000; i++) sum += p.x + p.len2();
+var s1 = engineStats();
+var r1 = sum == 28000 && s1.inlineCacheHits - s0.inlineCacheHits >= 3000 && s1.inlineCacheMisses - s0.inlineCacheMisses < 20;
+
+// polymorphic - a few shapes at the same site are cached too
+var objs = [ { x:1 }, { a:0, x:2 }, { b:0, c:0, x:3 } ];
+sum = 0;
+s0 = engineStats();
+for(var i=0; i<900; i++) sum += objs[i%3].x;
+s1 = engineStats();
+var r2 = sum == 1800 && s1.inlineCacheMisses - s0.inlineCacheMisses < 20;
+
+// megamorphic - more shapes than entries, the results stays correct
+var many = [];
+for(var i=0; i<20; i++) { var o = {}; o["m" + i] = i; o.x = i; many.push(o); }
+sum = 0;
+for(var j=0; j<5; j++) for(var i=0; i<20; i++) sum += many[i].x;
+var r3 = sum == 950;
+
+// the cached path through the prototype is checked on each hit
+var q = Point(1, 1);
+var before = q.len2();
+PointProto.len2 = function() { return -1; };
+var afterChange = q.len2();
+q.len2 = function() { return -2; };
+var own = q.len2();
+delete q.len2;
+var r4 = before == 2 && afterChange == -1 && own == -2 && q.len2() == -1;
+
+// variable-lookups in the scope-chain are cached as well
+var g = 5;
+function outer() { var a = 1; return function() { var t = 0; for(var i=0; i<100; i++) t += a + g; return t; }; }
+var f = outer();
+s0 = engineStats();
+var r5 = f() == 600;
+s1 = engineStats();
+r5 = r5 && s1.inlineCacheHits - s0.inlineCacheHits >= 200;
+g = 6;
+r5 = r5 && f() == 700;
+
+result = r1 && r2 && r3 && r4 && r5;
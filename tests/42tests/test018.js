@@ -0,0 +1,37 @@
+// atoms (interned property names) - names that are no longer in use are released
+
+// the same name is one atom
+var before = engineStats().atoms;
+var objs = [];
+for(var i=0; i<1000; i++) objs.push({ atomA:i, atomB:-i });
+var r1 = engineStats().atoms - before < 20 && objs[999].atomA == 999 && objs[999]["atom" + "B"] == -999;
+objs = undefined;
+
+// distinct computed keys on garbage objects - the atom table doesn't grow
+before = engineStats().atoms;
+for(var i=0; i<50000; i++) { var o = {}; o["computed" + i] = i; }
+o = undefined;
+var r2 = engineStats().atoms - before < 5000;
+
+// the same with keys from JSON.parse
+before = engineStats().atoms;
+for(var n=0; n<20; n++) {
+	var json = "{";
+	for(var i=0; i<1000; i++) json += (i ? "," : "") + '"json' + n + '_' + i + '":' + i;
+	var j = JSON.parse(json + "}");
+	if(j["json" + n + "_999"] != 999) before = -1e9;
+}
+j = undefined;
+var r3 = engineStats().atoms - before < 5000;
+
+// names of living objects survive and the released IDs are reused for new names
+var keep = {};
+for(var i=0; i<100; i++) keep["keep" + i] = i;
+for(var i=0; i<20000; i++) { var o = {}; o["reuse" + i] = i; }
+o = undefined;
+var fresh = { fresh1:1, fresh2:2 };
+var r4 = true;
+for(var i=0; i<100; i++) if(keep["keep" + i] != i) r4 = false;
+r4 = r4 && Object.keys(keep).length == 100 && fresh.fresh1 == 1 && fresh.fresh2 == 2 && fresh.reuse5 === undefined && !("keep5" in fresh);
+
+result = r1 && r2 && r3 && r4;
@@ -0,0 +1,45 @@
+// the cycle-collector runs while a script is executed (at the loop back-edges) - the heap stays bounded in one long evaluate
+
+function garbage(count) { // creates cycles only
+	for(var i=0; i<count; i++) {
+		var a = { n:i % 100 }, b = { a:a };
+		a.b = b;
+	}
+	return count;
+}
+function maxVars(budget) {
+	setCollectorBudget(budget);
+	var max = 0;
+	for(var j=0; j<50; j++) {
+		garbage(300);
+		var v = engineStats().vars;
+		if(v > max) max = v;
+	}
+	return max;
+}
+
+// stop-the-world and incremental slices - 15000 cycles never pile up
+var r1 = maxVars(0) < 12000;
+var r2 = maxVars(1) < 12000 && maxVars(16) < 12000;
+
+// cycles only referenced from the C++-stack (temporaries, running functions) are not collected
+function cyclic(name) { var o = { name:name }; o.self = o; o.list = [o, { back:o }]; return o; }
+var r3 = true;
+for(var budget=0; budget<=64; budget+=32) {
+	setCollectorBudget(budget);
+	var t = [ cyclic("first"), garbage(6000), cyclic("last") ];
+	r3 = r3 && t[0].self === t[0] && t[0].list[1].back.name == "first" && t[1] == 6000 && t[2].self.list[0].name == "last";
+	var obj = { f: function(arg) { var before = cyclic("before"); garbage(6000); return this.mark + arg.self.name + before.self.name; }, mark:"m-" };
+	r3 = r3 && obj.f(cyclic("arg")) == "m-argbefore";
+}
+
+// a generator suspended in a loop keeps its state
+function gen() { var state = cyclic("gen"); for(var i=0; ; i++) { yield state.self.name + i; } }
+var g = gen(), r4 = true;
+for(var i=0; i<20; i++) {
+	garbage(1000);
+	if(g.next() != "gen" + i) r4 = false;
+}
+setCollectorBudget(0);
+
+result = r1 && r2 && r3 && r4;
@@ -0,0 +1,48 @@
+// the entries of a WeakMap are ephemerons - the collector removes the entries whose key is not reachable otherwise
+// (the counters stays small - each integer used creates a var in the integer-cache)
+
+function garbage(count) { // creates cycles only - triggers the collector
+	for(var i=0; i<count; i++) {
+		var a = { n:i % 100 }, b = { a:a };
+		a.b = b;
+	}
+	return count;
+}
+function fill(wm, count) { // count*100 keys - the values refer their keys (value->key cycle)
+	for(var i=0; i<count; i++) {
+		for(var j=0; j<100; j++) {
+			var key = { n:j };
+			wm.set(key, { key:key, list:[key, { back:key }] });
+		}
+	}
+}
+function collect() { // the fewest vars seen between the collections
+	var min = engineStats().vars;
+	for(var i=0; i<40; i++) { garbage(200); min = Math.min(min, engineStats().vars); }
+	return min;
+}
+
+var r1 = true, r2 = true, r3 = true;
+for(var budget=0; budget<=16; budget+=16) {
+	setCollectorBudget(budget);
+	var wm = new WeakMap(), live = { name:"live" };
+	(function() {
+		var deep = { name:"deep" }; // only reachable through the value of live
+		wm.set(live, { name:"value", next:deep });
+		wm.set(deep, { name:"deep-value" });
+	})();
+	fill(wm, 3);
+	var base = collect();
+	fill(wm, 30); // 3000 unreachable keys with values referring them
+	r1 = r1 && collect() < base + 3000;
+	// a reachable key keeps its value - and the keys only reachable through that value
+	var value = wm.get(live);
+	r2 = r2 && value.name == "value" && wm.has(value.next) && wm.get(value.next).name == "deep-value";
+	value = undefined;
+	// the values of unreachable keys are gone - even with the WeakMap itself dropped
+	wm = undefined;
+	r3 = r3 && collect() < base + 3000;
+}
+setCollectorBudget(0);
+
+result = r1 && r2 && r3;
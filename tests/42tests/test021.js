@@ -0,0 +1,65 @@
+// bytecode: conditions, iterations and expression-statements give the same results as the token-walker
+
+// arithmetic, comparisons and precedence in expression-statements
+var a = 7, b = 3, s = "x";
+var r1;
+r1 = a + b * 2 - (a - b) / 2 == 11 && a % b == 1 && -a + +b == -4 && (a << 2 | b) == 31 && (a ^ b) == 4 && ~a == -8;
+r1 = r1 && (a > b) === true && (a <= b) === false && (a != "7") === false && a !== 8;
+r1 = r1 && s + a + b == "x73" && a + b + s == "10x" && !!s && !0 === true;
+
+// short-circuit and conditional operator evaluate only one side
+var calls = 0;
+function hit(v) { calls++; return v; }
+var r2 = false || hit(1);
+r2 = r2 && hit(0) && hit(2);
+r2 = (r2 === 0) && calls == 2;
+r2 = r2 && (hit(true) ? hit("y") : hit("n")) == "y" && calls == 4;
+
+// loop conditions and iterations with increments, compound assignments, members and subscripts
+var o = { n:0, list:[1,2,3,4,5] }, sum = 0;
+for(var i=0; i<o.list.length; i++) sum += o.list[i] * i;
+for(var j=10; j>0; j-=3) o.n++;
+var k = 0;
+while(k < 100 && o.list[k % 5] != 5) k++;
+do { o.n *= 2; } while(o.n < 40);
+var r3 = sum == 40 && o.n == 64 && k == 4 && i == 5 && j == -2;
+var x = 1;
+x += 2; x -= 1; x *= 10; x /= 4; x %= 3; x <<= 3; x >>= 1; x |= 1; x &= 7; x ^= 2;
+r3 = r3 && x == 3;
+var p = 5, q = p++ + ++p;
+r3 = r3 && p == 7 && q == 12 && o.list[1]++ == 2 && --o.list[1] == 2;
+
+// getters and setters are called from compiled member accesses
+var log = "";
+var acc = { v:1, get g() { log += "g"; return this.v; }, set g(val) { log += "s"; this.v = val; } };
+for(var m=0; acc.g < 4; m++) acc.g = acc.g + 1;
+var r4 = m == 3 && acc.v == 4 && log == "ggsggsggsg";
+
+// mixed compilable and non-compilable (typeof, in, new) conditions
+var cnt = 0;
+for(var n=0; n<6; n++) { if(typeof n == "number" && n in [0,1,2]) cnt++; if(n % 2) cnt += 10; }
+var r5 = cnt == 33;
+
+// errors thrown from compiled code are catchable (member access on undefined throws a ReferenceError here)
+var r6 = 0;
+try { undefinedVariable + 1; } catch(e) { if(e instanceof ReferenceError) r6++; }
+try { for(var t=0; t<3; t++) o.missing.deep = t; } catch(e) { if(e instanceof ReferenceError && t == 0) r6++; }
+try { if(o.list[0].nope.nope) r6 = -100; } catch(e) { if(e instanceof ReferenceError) r6++; }
+r6 = r6 == 3;
+
+// a compiled expression gives the same result after its operand types change
+function add(u, v) { var res; res = u + v; return res; }
+var r7 = add(1, 2) === 3 && add("1", 2) === "12" && add(1.5, 1.5) === 3 && isNaN(add(undefined, 1)) && add([1], [2]) == "12";
+
+// a call in a compiled condition or iteration throws
+function thrower(at) { if(at === undefined || at == 2) throw "thrown"; return true; }
+var r8 = 0;
+try { if(thrower()) r8 = -100; } catch(e) { if(e == "thrown") r8++; }
+try { while(thrower()) r8 = -100; } catch(e) { if(e == "thrown") r8++; }
+try { do {} while(thrower()); } catch(e) { if(e == "thrown") r8++; }
+try { for(;thrower();) r8 = -100; } catch(e) { if(e == "thrown") r8++; }
+try { for(var w=0; thrower(w); w++) ; } catch(e) { if(e == "thrown" && w == 2) r8++; }
+try { for(var w=0; w<5; thrower(w++)) ; } catch(e) { if(e == "thrown" && w == 3) r8++; }
+r8 = r8 == 6;
+
+result = r1 && r2 && r3 && r4 && r5 && r6 && r7 && r8;
@@ -0,0 +1,55 @@
+// variable addresses cached per identifier stay correct when the scope-chain changes
+
+var v = "global";
+function read() { return v; }
+
+// the same identifier resolves through different chains - inner declarations shadow outer ones
+function outer() {
+	var r = read();
+	var v = "outer";
+	function inner(shadow) {
+		if(shadow) { var v = "inner"; }
+		return v;
+	}
+	return r + "," + v + "," + inner(true) + "," + inner(false);
+}
+var r1 = outer() == "global,outer,inner,undefined" && read() == "global";
+for(var i=0; i<3; i++) r1 = r1 && outer() == "global,outer,inner,undefined";
+
+// closures keep their own scope - deep chains and recursion
+function counter(start) { var n = start; return function(step) { return function() { n += step; return n; }; }; }
+var c1 = counter(0)(1), c2 = counter(100)(10);
+var r2 = c1() == 1 && c2() == 110 && c1() == 2 && c2() == 120;
+function depth(n, acc) { var here = n; if(n == 0) return acc; return depth(n-1, function() { return here + acc(); }); }
+r2 = r2 && depth(10, function() { return 0; })() == 55;
+
+// an eval-declared var shadows the outer var after the lookup was cached
+function viaEval(code) {
+	var res = v;
+	for(var k=0; k<3; k++) {
+		if(k == 1) eval(code);
+		res += "," + v;
+	}
+	return res;
+}
+var r3 = viaEval("var v = 'eval'") == "global,global,eval,eval" && viaEval("1") == "global,global,global,global" && v == "global";
+
+// with-scopes take precedence while they contain the name
+var obj = { v:"with" };
+function viaWith() { var res = ""; with(obj) { for(var k=0; k<3; k++) { res += v + ","; if(k == 0) delete obj.v; else obj.v = "again"; } } return res; }
+var r4 = viaWith() == "with,global,again,";
+
+// a global added or deleted after the first lookup
+function late() { var res = "none"; try { res = lateVar; } catch(e) {} return res; }
+var r5 = late() == "none";
+this.lateVar = "set";
+r5 = r5 && late() == "set";
+delete this.lateVar;
+r5 = r5 && late() == "none";
+
+// catch parameters and function parameters shadow outer names
+function catcher() { var e = "outer"; try { throw "caught"; } catch(e) { var inCatch = e; } return inCatch + "," + e; }
+function params(v) { return v; }
+var r6 = catcher() == "caught,outer" && params("param") == "param" && params() === undefined && read() == "global";
+
+result = r1 && r2 && r3 && r4 && r5 && r6;
@@ -0,0 +1,38 @@
+// memory: acyclic garbage is freed at once, cycles are collected when the heap has grown
+
+function vars() { return engineStats().vars; }
+setCollectorBudget(0);
+
+// acyclic garbage never reaches the collector
+function acyclic(count) { for(var i=0; i<count; i++) for(var j=0; j<count; j++) { var o = { a:{ b:[1,2,3] }, s:"str" }; } }
+acyclic(25);
+var before = vars();
+for(var i=0; i<20; i++) acyclic(25);
+var r1 = vars() - before < 100;
+
+// cycles through objects, arrays and closure scopes are collected
+function cycles(count) {
+	for(var i=0; i<count; i++) {
+		var o = { list:[] }; o.list.push(o);
+		var f = function() { return f; };
+	}
+}
+var max = 0;
+for(var i=0; i<40; i++) { cycles(300); var v = vars(); if(v > max) max = v; }
+var r2 = max < before + 15000;
+
+// the threshold follows the live heap - a large live graph with internal cycles survives all collections
+var live = [];
+for(var i=0; i<50; i++) for(var j=0; j<100; j++) { var n = { id:j, owner:live }; n.self = n; live.push(n); }
+var liveBase = vars();
+max = 0;
+for(var i=0; i<40; i++) { cycles(300); var v = vars(); if(v > max) max = v; }
+var r3 = max < liveBase * 2 + 15000 && live.length == 5000 && live[4999].self.owner === live && live[0].id == 0 && live[1234].id == 34;
+
+// when the live graph is dropped its cycles are reclaimed too
+live = n = 0;
+var min = liveBase;
+for(var i=0; i<40; i++) { cycles(300); var v = vars(); if(v < min) min = v; }
+var r4 = min < liveBase - 4000;
+
+result = r1 && r2 && r3 && r4;
@@ -0,0 +1,42 @@
+// generators: many suspended at once, nested, abandoned and with deep recursion inside
+
+function range(from, to) { for(var i=from; i<to; i++) yield i; }
+
+// 300 generators alive at the same time, resumed interleaved
+var gens = [];
+for(var i=0; i<300; i++) gens.push(range(i, i+5));
+var sum = 0;
+for(var round=0; round<5; round++) for(var i=0; i<gens.length; i++) sum += gens[i].next();
+var r1 = sum == 5*300*299/2 + 300*10, stopped = 0;
+for(var i=0; i<gens.length; i++) { try { gens[i].next(); } catch(e) { if(e instanceof StopIteration) stopped++; } }
+r1 = r1 && stopped == 300;
+gens = 0;
+
+// a generator resumes other generators from its own stack
+function zip(a, b) { while(true) yield a.next() + ":" + b.next(); }
+function nested(depth) { if(depth == 0) { yield "leaf"; yield "end"; } else { var inner = nested(depth-1); while(true) yield depth + inner.next(); } }
+var z = zip(range(0, 10), nested(3));
+var r2 = z.next() == "0:321leaf" && z.next() == "1:321end";
+
+// abandoned generators - suspended and never finished, in a loop
+var r3 = true;
+for(var i=0; i<50; i++) for(var j=0; j<40; j++) {
+	var g = range(j, 100);
+	r3 = r3 && g.next() == j && g.next() == j+1;
+}
+
+// deep recursion inside a generator throws an error instead of overflowing its stack
+function deep(n) { return deep(n+1) + 1; }
+function recursing() { try { deep(0); } catch(e) { yield "caught"; } yield "after"; }
+var rg = recursing();
+var r4 = rg.next() == "caught" && rg.next() == "after";
+function bounded(n) { return n == 0 ? 0 : bounded(n-1) + 1; }
+function counting() { yield bounded(200); }
+r4 = r4 && counting().next() == 200;
+
+// values sent into and exceptions thrown out of a generator
+function echo() { var v = 0; while(true) { v = yield v * 2; if(v < 0) throw "negative"; } }
+var ec = echo(), r5 = ec.next() == 0 && ec.send(4) == 8 && ec.send(21) == 42;
+try { ec.send(-1); r5 = false; } catch(e) { r5 = r5 && e == "negative"; }
+
+result = r1 && r2 && r3 && r4 && r5;
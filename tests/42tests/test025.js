@@ -0,0 +1,35 @@
+// strings: ropes built by '+' and '+=' are flattened on the first access of their content
+
+var piece = "0123456789abcdef0123456789abcdef"; // two pieces reach the minimal rope-length
+
+// deep ropes - appended, prepended and never flattened
+var app = "", pre = "", unused = "";
+for(var i=0; i<200; i++) for(var j=0; j<100; j++) { app += piece; pre = piece + pre; unused += piece + j; }
+unused = 0;
+var r1 = app.length == 640000 && pre.length == 640000 && app == pre && app.charAt(639999) == "f" && pre.substr(320000, 10) == "0123456789";
+
+// a rope shared by more ropes - flattening one keeps the others
+var base = piece + piece;
+var left = "<" + base, right = base + ">", both = left + right;
+var r2 = right.length == 65 && right.charAt(64) == ">" && left.indexOf(piece, 1) == 1 && both.length == 130
+	&& both == "<" + piece + piece + piece + piece + ">" && base == piece + piece && base.length == 64;
+
+// doubling a rope by itself
+var dbl = piece;
+for(var i=0; i<12; i++) dbl = dbl + dbl;
+var r3 = dbl.length == 32 * 4096 && dbl.lastIndexOf("cdef") == 32 * 4096 - 4 && dbl.split(piece).length == 4097;
+
+// numbers and booleans mixed into ropes; ropes converted back to numbers
+var num = piece.substr(0, 10) + 1 + 2 + true + piece;
+var spaces = "                                        ", digits = spaces + spaces + "42.5";
+var r4 = num == "012345678912true" + piece && +digits == 42.5 && digits * 2 == 85 && 1 + 2 + piece == "3" + piece;
+
+// ropes as property names, in comparisons and in a switch
+var key = piece + "-key", obj = {};
+obj[key] = 1;
+obj[piece + "-" + "key"]++;
+var sw;
+switch(piece + "!") { case piece: sw = 1; break; case piece + "!": sw = 2; break; }
+var r5 = obj[key] == 2 && Object.keys(obj).length == 1 && key > piece && !(key < piece) && sw == 2;
+
+result = r1 && r2 && r3 && r4 && r5;
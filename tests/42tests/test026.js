@@ -0,0 +1,50 @@
+// shared single-char strings and small integers behave like fresh values
+
+// integers at and beyond the bounds of the cache
+var lo = -1024, hi = 65535;
+var r1 = lo - 1 == -1025 && lo + 1 == -1023 && hi + 1 == 65536 && (hi + 1) - 1 === hi && hi * 2 == 131070
+	&& 0.5 + 0.5 === 1 && 1.5 * 2 === 3 && 65536 / 2 == 32768 && -lo == 1024 && (lo | 0) === lo;
+// -0 is not the cached 0
+var nz = -0, pz = 0;
+r1 = r1 && 1/nz == -Infinity && 1/(0 * -1) == -Infinity && 1/pz == Infinity && 1/(nz + 0) == Infinity && nz == pz;
+
+// updating a var holding a shared value does not change other holders
+var a = 7, b = 7, c = "x", d = "x";
+a++; c += "y";
+var r2 = a == 8 && b == 7 && c == "xy" && d == "x" && 7 === b && "x" === d;
+var counters = [0, 0, 0];
+for(var i=0; i<30; i++) counters[i % 3]++;
+r2 = r2 && counters.join(",") == "10,10,10";
+// properties set on primitives are not kept - not even on the shared ones
+var p = "q", n = 42;
+p.tag = 1; n.tag = 2;
+r2 = r2 && p.tag === undefined && "q".tag === undefined && (42).tag === undefined;
+
+// all chars round trip through charAt, [] and charCodeAt
+var all = "", ok = 0;
+for(var i=1; i<256; i++) all += "".fromCharCode(i);
+for(var i=1; i<256; i++) if(all.charCodeAt(i-1) == i && all[i-1] === "".fromCharCode(i) && all.charAt(i-1) == all.substr(i-1, 1)) ok++;
+var r3 = ok == 255 && all.length == 255 && "abc"[1] == "b" && "abc".charAt(2) === "c" && "a" + "b" == "ab" && "abc"[3] === undefined;
+
+// holding chars and small integers creates no new vars once the values are cached
+var text = "the quick brown fox jumps over the lazy dog";
+function scan(hold) { var vowels = 0; for(var i=0; i<text.length; i++) { var ch = text[i]; if("aeiou".indexOf(ch) >= 0) vowels++; if(hold) hold.push(ch, i); } return vowels; }
+scan();
+var before = engineStats().vars, held = [], vowels = 0;
+for(var k=0; k<20; k++) vowels = scan(held);
+var grown = engineStats().vars - before;
+var r4 = vowels == 11 && held.length == 20 * 2 * text.length && held[2] === "h" && held[3] === 1 && grown < 50;
+
+// the cached values are shared - a script can not change their prototype or add properties
+var n = 3; n.__proto__ = {q:9}; n.z = 4;
+var c = "a"; c.__proto__ = {w:1}; c.v = 2;
+var r5 = (3).q === undefined && n.q === undefined && n.z === undefined && (3).__proto__ === Number.prototype
+	&& "abc"[0].w === undefined && "abc"[0].v === undefined && "a".__proto__ === String.prototype && (3).toString() == "3";
+
+// the same cached value in more slots is not a cycle - a shared object neither, only a real cycle is
+var shared = { k:1 }, cyclic = { k:1 }; cyclic.self = cyclic;
+var o6 = JSON.parse(JSON.stringify({ a:1, b:1, c:"x", d:"x" })), a6 = JSON.parse(JSON.stringify([1, 1, "x", "x", shared, { s:shared }]));
+var r6 = o6.a === 1 && o6.b === 1 && o6.c === "x" && o6.d === "x" && a6.length == 6 && a6[1] === 1 && a6[3] === "x" && a6[5].s.k === 1;
+try { JSON.stringify(cyclic); r6 = false; } catch(e) { r6 = r6 && e instanceof TypeError; }
+
+result = r1 && r2 && r3 && r4 && r5 && r6;